@@ -6,6 +6,7 @@
 //
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <vscp_canid.h>
 
 ///////////////////////////////////////////////////////////////////////////////
 // sendVSCPFrame
@@ -35,10 +36,7 @@ int8_t sendVSCPFrame( uint16_t vscpclass,
 			uart_puts(buf);
 		#endif
 */
-	msg.id = ( (uint32_t)priority << 26 ) |
-		( (uint32_t)vscpclass << 16 ) |
-		( (uint32_t)vscptype << 8) |
-		nodeid;		// nodeaddress (our address)
+	msg.id = VSCP_CANID_PACK( priority, vscpclass, vscptype, nodeid );
 
 
     msg.flags = CAN_IDFLAG_EXTENDED;
@@ -74,10 +72,10 @@ int8_t getVSCPFrame( uint16_t *pvscpclass,
         return FALSE;
     }
 
-    *pNodeId = msg.id & 0x0ff;
-    *pvscptype = ( msg.id >> 8 ) & 0xff;
-    *pvscpclass = ( msg.id >> 16 ) & 0x1ff;
-    *pPriority = (uint16_t)( 0x07 & ( msg.id >> 26 ) );
+    *pNodeId = VSCP_CANID_NICKNAME( msg.id );
+    *pvscptype = VSCP_CANID_TYPE( msg.id );
+    *pvscpclass = VSCP_CANID_CLASS( msg.id );
+    *pPriority = VSCP_CANID_PRIORITY( msg.id );
     *pSize = msg.len;
     if ( msg.len ) {
         memcpy( pData, msg.byte, msg.len );
@@ -23,10 +23,12 @@
 /*
  * Derive parameters from the standard-specific parameters in crc.h.
  */
-#define WIDTH    (8 * sizeof(crc))
-#define TOPBIT   (1 << (WIDTH - 1))
+#define WIDTH    CRC_WIDTH
+#define TOPBIT   ((crc)1 << (WIDTH - 1))
+#define CRC_MASK (TOPBIT | (TOPBIT - 1))
 
 #if ( REFLECT_DATA == TRUE )
+#define CRC_REFLECT_DATA
 #undef  REFLECT_DATA
 #define REFLECT_DATA(X)			((unsigned char) reflect((X), 8))
 #else
@@ -35,6 +37,7 @@
 #endif
 
 #if (REFLECT_REMAINDER == TRUE)
+#define CRC_REFLECT_REMAINDER
 #undef  REFLECT_REMAINDER
 #define REFLECT_REMAINDER(X)	((crc) reflect((X), WIDTH))
 #else
@@ -42,7 +45,243 @@
 #define REFLECT_REMAINDER(X)	(X)
 #endif
 
+/*
+ * Select engine. Slicing processes 4 or 8 bytes per step using extra
+ * tables built by crcInit(), the nibble engine uses a 16 entry table.
+ */
+#if defined(CRC_ENGINE_SLICE8)
+#define CRC_SLICE               8
+#elif defined(CRC_ENGINE_SLICE4)
+#define CRC_SLICE               4
+#endif
+
+#define CRC_BYTES               (WIDTH / 8)
+
+/*
+ * Precomputed tables (generated for the MSB first algorithm used here,
+ * reflection is handled on the data and the final remainder).
+ */
+#if defined(CRC_CCITT)
+
+#if defined(CRC_TABLE_CONST) && !defined(CRC_ENGINE_NIBBLE)
+CRC_CONST crc crcTable[256] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF,
+    0x1231, 0x0210, 0x3273, 0x2252, 0x52B5, 0x4294, 0x72F7, 0x62D6,
+    0x9339, 0x8318, 0xB37B, 0xA35A, 0xD3BD, 0xC39C, 0xF3FF, 0xE3DE,
+    0x2462, 0x3443, 0x0420, 0x1401, 0x64E6, 0x74C7, 0x44A4, 0x5485,
+    0xA56A, 0xB54B, 0x8528, 0x9509, 0xE5EE, 0xF5CF, 0xC5AC, 0xD58D,
+    0x3653, 0x2672, 0x1611, 0x0630, 0x76D7, 0x66F6, 0x5695, 0x46B4,
+    0xB75B, 0xA77A, 0x9719, 0x8738, 0xF7DF, 0xE7FE, 0xD79D, 0xC7BC,
+    0x48C4, 0x58E5, 0x6886, 0x78A7, 0x0840, 0x1861, 0x2802, 0x3823,
+    0xC9CC, 0xD9ED, 0xE98E, 0xF9AF, 0x8948, 0x9969, 0xA90A, 0xB92B,
+    0x5AF5, 0x4AD4, 0x7AB7, 0x6A96, 0x1A71, 0x0A50, 0x3A33, 0x2A12,
+    0xDBFD, 0xCBDC, 0xFBBF, 0xEB9E, 0x9B79, 0x8B58, 0xBB3B, 0xAB1A,
+    0x6CA6, 0x7C87, 0x4CE4, 0x5CC5, 0x2C22, 0x3C03, 0x0C60, 0x1C41,
+    0xEDAE, 0xFD8F, 0xCDEC, 0xDDCD, 0xAD2A, 0xBD0B, 0x8D68, 0x9D49,
+    0x7E97, 0x6EB6, 0x5ED5, 0x4EF4, 0x3E13, 0x2E32, 0x1E51, 0x0E70,
+    0xFF9F, 0xEFBE, 0xDFDD, 0xCFFC, 0xBF1B, 0xAF3A, 0x9F59, 0x8F78,
+    0x9188, 0x81A9, 0xB1CA, 0xA1EB, 0xD10C, 0xC12D, 0xF14E, 0xE16F,
+    0x1080, 0x00A1, 0x30C2, 0x20E3, 0x5004, 0x4025, 0x7046, 0x6067,
+    0x83B9, 0x9398, 0xA3FB, 0xB3DA, 0xC33D, 0xD31C, 0xE37F, 0xF35E,
+    0x02B1, 0x1290, 0x22F3, 0x32D2, 0x4235, 0x5214, 0x6277, 0x7256,
+    0xB5EA, 0xA5CB, 0x95A8, 0x8589, 0xF56E, 0xE54F, 0xD52C, 0xC50D,
+    0x34E2, 0x24C3, 0x14A0, 0x0481, 0x7466, 0x6447, 0x5424, 0x4405,
+    0xA7DB, 0xB7FA, 0x8799, 0x97B8, 0xE75F, 0xF77E, 0xC71D, 0xD73C,
+    0x26D3, 0x36F2, 0x0691, 0x16B0, 0x6657, 0x7676, 0x4615, 0x5634,
+    0xD94C, 0xC96D, 0xF90E, 0xE92F, 0x99C8, 0x89E9, 0xB98A, 0xA9AB,
+    0x5844, 0x4865, 0x7806, 0x6827, 0x18C0, 0x08E1, 0x3882, 0x28A3,
+    0xCB7D, 0xDB5C, 0xEB3F, 0xFB1E, 0x8BF9, 0x9BD8, 0xABBB, 0xBB9A,
+    0x4A75, 0x5A54, 0x6A37, 0x7A16, 0x0AF1, 0x1AD0, 0x2AB3, 0x3A92,
+    0xFD2E, 0xED0F, 0xDD6C, 0xCD4D, 0xBDAA, 0xAD8B, 0x9DE8, 0x8DC9,
+    0x7C26, 0x6C07, 0x5C64, 0x4C45, 0x3CA2, 0x2C83, 0x1CE0, 0x0CC1,
+    0xEF1F, 0xFF3E, 0xCF5D, 0xDF7C, 0xAF9B, 0xBFBA, 0x8FD9, 0x9FF8,
+    0x6E17, 0x7E36, 0x4E55, 0x5E74, 0x2E93, 0x3EB2, 0x0ED1, 0x1EF0
+};
+#endif
+
+#if defined(CRC_ENGINE_NIBBLE)
+static CRC_CONST crc crcNibbleTable[16] =
+{
+    0x0000, 0x1021, 0x2042, 0x3063, 0x4084, 0x50A5, 0x60C6, 0x70E7,
+    0x8108, 0x9129, 0xA14A, 0xB16B, 0xC18C, 0xD1AD, 0xE1CE, 0xF1EF
+};
+#endif
+
+#elif defined(CRC16)
+
+#if defined(CRC_TABLE_CONST) && !defined(CRC_ENGINE_NIBBLE)
+CRC_CONST crc crcTable[256] =
+{
+    0x0000, 0x8005, 0x800F, 0x000A, 0x801B, 0x001E, 0x0014, 0x8011,
+    0x8033, 0x0036, 0x003C, 0x8039, 0x0028, 0x802D, 0x8027, 0x0022,
+    0x8063, 0x0066, 0x006C, 0x8069, 0x0078, 0x807D, 0x8077, 0x0072,
+    0x0050, 0x8055, 0x805F, 0x005A, 0x804B, 0x004E, 0x0044, 0x8041,
+    0x80C3, 0x00C6, 0x00CC, 0x80C9, 0x00D8, 0x80DD, 0x80D7, 0x00D2,
+    0x00F0, 0x80F5, 0x80FF, 0x00FA, 0x80EB, 0x00EE, 0x00E4, 0x80E1,
+    0x00A0, 0x80A5, 0x80AF, 0x00AA, 0x80BB, 0x00BE, 0x00B4, 0x80B1,
+    0x8093, 0x0096, 0x009C, 0x8099, 0x0088, 0x808D, 0x8087, 0x0082,
+    0x8183, 0x0186, 0x018C, 0x8189, 0x0198, 0x819D, 0x8197, 0x0192,
+    0x01B0, 0x81B5, 0x81BF, 0x01BA, 0x81AB, 0x01AE, 0x01A4, 0x81A1,
+    0x01E0, 0x81E5, 0x81EF, 0x01EA, 0x81FB, 0x01FE, 0x01F4, 0x81F1,
+    0x81D3, 0x01D6, 0x01DC, 0x81D9, 0x01C8, 0x81CD, 0x81C7, 0x01C2,
+    0x0140, 0x8145, 0x814F, 0x014A, 0x815B, 0x015E, 0x0154, 0x8151,
+    0x8173, 0x0176, 0x017C, 0x8179, 0x0168, 0x816D, 0x8167, 0x0162,
+    0x8123, 0x0126, 0x012C, 0x8129, 0x0138, 0x813D, 0x8137, 0x0132,
+    0x0110, 0x8115, 0x811F, 0x011A, 0x810B, 0x010E, 0x0104, 0x8101,
+    0x8303, 0x0306, 0x030C, 0x8309, 0x0318, 0x831D, 0x8317, 0x0312,
+    0x0330, 0x8335, 0x833F, 0x033A, 0x832B, 0x032E, 0x0324, 0x8321,
+    0x0360, 0x8365, 0x836F, 0x036A, 0x837B, 0x037E, 0x0374, 0x8371,
+    0x8353, 0x0356, 0x035C, 0x8359, 0x0348, 0x834D, 0x8347, 0x0342,
+    0x03C0, 0x83C5, 0x83CF, 0x03CA, 0x83DB, 0x03DE, 0x03D4, 0x83D1,
+    0x83F3, 0x03F6, 0x03FC, 0x83F9, 0x03E8, 0x83ED, 0x83E7, 0x03E2,
+    0x83A3, 0x03A6, 0x03AC, 0x83A9, 0x03B8, 0x83BD, 0x83B7, 0x03B2,
+    0x0390, 0x8395, 0x839F, 0x039A, 0x838B, 0x038E, 0x0384, 0x8381,
+    0x0280, 0x8285, 0x828F, 0x028A, 0x829B, 0x029E, 0x0294, 0x8291,
+    0x82B3, 0x02B6, 0x02BC, 0x82B9, 0x02A8, 0x82AD, 0x82A7, 0x02A2,
+    0x82E3, 0x02E6, 0x02EC, 0x82E9, 0x02F8, 0x82FD, 0x82F7, 0x02F2,
+    0x02D0, 0x82D5, 0x82DF, 0x02DA, 0x82CB, 0x02CE, 0x02C4, 0x82C1,
+    0x8243, 0x0246, 0x024C, 0x8249, 0x0258, 0x825D, 0x8257, 0x0252,
+    0x0270, 0x8275, 0x827F, 0x027A, 0x826B, 0x026E, 0x0264, 0x8261,
+    0x0220, 0x8225, 0x822F, 0x022A, 0x823B, 0x023E, 0x0234, 0x8231,
+    0x8213, 0x0216, 0x021C, 0x8219, 0x0208, 0x820D, 0x8207, 0x0202
+};
+#endif
+
+#if defined(CRC_ENGINE_NIBBLE)
+static CRC_CONST crc crcNibbleTable[16] =
+{
+    0x0000, 0x8005, 0x800F, 0x000A, 0x801B, 0x001E, 0x0014, 0x8011,
+    0x8033, 0x0036, 0x003C, 0x8039, 0x0028, 0x802D, 0x8027, 0x0022
+};
+#endif
+
+#elif defined(CRC32)
+
+#if defined(CRC_TABLE_CONST) && !defined(CRC_ENGINE_NIBBLE)
+CRC_CONST crc crcTable[256] =
+{
+    0x00000000UL, 0x04C11DB7UL, 0x09823B6EUL, 0x0D4326D9UL,
+    0x130476DCUL, 0x17C56B6BUL, 0x1A864DB2UL, 0x1E475005UL,
+    0x2608EDB8UL, 0x22C9F00FUL, 0x2F8AD6D6UL, 0x2B4BCB61UL,
+    0x350C9B64UL, 0x31CD86D3UL, 0x3C8EA00AUL, 0x384FBDBDUL,
+    0x4C11DB70UL, 0x48D0C6C7UL, 0x4593E01EUL, 0x4152FDA9UL,
+    0x5F15ADACUL, 0x5BD4B01BUL, 0x569796C2UL, 0x52568B75UL,
+    0x6A1936C8UL, 0x6ED82B7FUL, 0x639B0DA6UL, 0x675A1011UL,
+    0x791D4014UL, 0x7DDC5DA3UL, 0x709F7B7AUL, 0x745E66CDUL,
+    0x9823B6E0UL, 0x9CE2AB57UL, 0x91A18D8EUL, 0x95609039UL,
+    0x8B27C03CUL, 0x8FE6DD8BUL, 0x82A5FB52UL, 0x8664E6E5UL,
+    0xBE2B5B58UL, 0xBAEA46EFUL, 0xB7A96036UL, 0xB3687D81UL,
+    0xAD2F2D84UL, 0xA9EE3033UL, 0xA4AD16EAUL, 0xA06C0B5DUL,
+    0xD4326D90UL, 0xD0F37027UL, 0xDDB056FEUL, 0xD9714B49UL,
+    0xC7361B4CUL, 0xC3F706FBUL, 0xCEB42022UL, 0xCA753D95UL,
+    0xF23A8028UL, 0xF6FB9D9FUL, 0xFBB8BB46UL, 0xFF79A6F1UL,
+    0xE13EF6F4UL, 0xE5FFEB43UL, 0xE8BCCD9AUL, 0xEC7DD02DUL,
+    0x34867077UL, 0x30476DC0UL, 0x3D044B19UL, 0x39C556AEUL,
+    0x278206ABUL, 0x23431B1CUL, 0x2E003DC5UL, 0x2AC12072UL,
+    0x128E9DCFUL, 0x164F8078UL, 0x1B0CA6A1UL, 0x1FCDBB16UL,
+    0x018AEB13UL, 0x054BF6A4UL, 0x0808D07DUL, 0x0CC9CDCAUL,
+    0x7897AB07UL, 0x7C56B6B0UL, 0x71159069UL, 0x75D48DDEUL,
+    0x6B93DDDBUL, 0x6F52C06CUL, 0x6211E6B5UL, 0x66D0FB02UL,
+    0x5E9F46BFUL, 0x5A5E5B08UL, 0x571D7DD1UL, 0x53DC6066UL,
+    0x4D9B3063UL, 0x495A2DD4UL, 0x44190B0DUL, 0x40D816BAUL,
+    0xACA5C697UL, 0xA864DB20UL, 0xA527FDF9UL, 0xA1E6E04EUL,
+    0xBFA1B04BUL, 0xBB60ADFCUL, 0xB6238B25UL, 0xB2E29692UL,
+    0x8AAD2B2FUL, 0x8E6C3698UL, 0x832F1041UL, 0x87EE0DF6UL,
+    0x99A95DF3UL, 0x9D684044UL, 0x902B669DUL, 0x94EA7B2AUL,
+    0xE0B41DE7UL, 0xE4750050UL, 0xE9362689UL, 0xEDF73B3EUL,
+    0xF3B06B3BUL, 0xF771768CUL, 0xFA325055UL, 0xFEF34DE2UL,
+    0xC6BCF05FUL, 0xC27DEDE8UL, 0xCF3ECB31UL, 0xCBFFD686UL,
+    0xD5B88683UL, 0xD1799B34UL, 0xDC3ABDEDUL, 0xD8FBA05AUL,
+    0x690CE0EEUL, 0x6DCDFD59UL, 0x608EDB80UL, 0x644FC637UL,
+    0x7A089632UL, 0x7EC98B85UL, 0x738AAD5CUL, 0x774BB0EBUL,
+    0x4F040D56UL, 0x4BC510E1UL, 0x46863638UL, 0x42472B8FUL,
+    0x5C007B8AUL, 0x58C1663DUL, 0x558240E4UL, 0x51435D53UL,
+    0x251D3B9EUL, 0x21DC2629UL, 0x2C9F00F0UL, 0x285E1D47UL,
+    0x36194D42UL, 0x32D850F5UL, 0x3F9B762CUL, 0x3B5A6B9BUL,
+    0x0315D626UL, 0x07D4CB91UL, 0x0A97ED48UL, 0x0E56F0FFUL,
+    0x1011A0FAUL, 0x14D0BD4DUL, 0x19939B94UL, 0x1D528623UL,
+    0xF12F560EUL, 0xF5EE4BB9UL, 0xF8AD6D60UL, 0xFC6C70D7UL,
+    0xE22B20D2UL, 0xE6EA3D65UL, 0xEBA91BBCUL, 0xEF68060BUL,
+    0xD727BBB6UL, 0xD3E6A601UL, 0xDEA580D8UL, 0xDA649D6FUL,
+    0xC423CD6AUL, 0xC0E2D0DDUL, 0xCDA1F604UL, 0xC960EBB3UL,
+    0xBD3E8D7EUL, 0xB9FF90C9UL, 0xB4BCB610UL, 0xB07DABA7UL,
+    0xAE3AFBA2UL, 0xAAFBE615UL, 0xA7B8C0CCUL, 0xA379DD7BUL,
+    0x9B3660C6UL, 0x9FF77D71UL, 0x92B45BA8UL, 0x9675461FUL,
+    0x8832161AUL, 0x8CF30BADUL, 0x81B02D74UL, 0x857130C3UL,
+    0x5D8A9099UL, 0x594B8D2EUL, 0x5408ABF7UL, 0x50C9B640UL,
+    0x4E8EE645UL, 0x4A4FFBF2UL, 0x470CDD2BUL, 0x43CDC09CUL,
+    0x7B827D21UL, 0x7F436096UL, 0x7200464FUL, 0x76C15BF8UL,
+    0x68860BFDUL, 0x6C47164AUL, 0x61043093UL, 0x65C52D24UL,
+    0x119B4BE9UL, 0x155A565EUL, 0x18197087UL, 0x1CD86D30UL,
+    0x029F3D35UL, 0x065E2082UL, 0x0B1D065BUL, 0x0FDC1BECUL,
+    0x3793A651UL, 0x3352BBE6UL, 0x3E119D3FUL, 0x3AD08088UL,
+    0x2497D08DUL, 0x2056CD3AUL, 0x2D15EBE3UL, 0x29D4F654UL,
+    0xC5A92679UL, 0xC1683BCEUL, 0xCC2B1D17UL, 0xC8EA00A0UL,
+    0xD6AD50A5UL, 0xD26C4D12UL, 0xDF2F6BCBUL, 0xDBEE767CUL,
+    0xE3A1CBC1UL, 0xE760D676UL, 0xEA23F0AFUL, 0xEEE2ED18UL,
+    0xF0A5BD1DUL, 0xF464A0AAUL, 0xF9278673UL, 0xFDE69BC4UL,
+    0x89B8FD09UL, 0x8D79E0BEUL, 0x803AC667UL, 0x84FBDBD0UL,
+    0x9ABC8BD5UL, 0x9E7D9662UL, 0x933EB0BBUL, 0x97FFAD0CUL,
+    0xAFB010B1UL, 0xAB710D06UL, 0xA6322BDFUL, 0xA2F33668UL,
+    0xBCB4666DUL, 0xB8757BDAUL, 0xB5365D03UL, 0xB1F740B4UL
+};
+#endif
+
+#if defined(CRC_ENGINE_NIBBLE)
+static CRC_CONST crc crcNibbleTable[16] =
+{
+    0x00000000UL, 0x04C11DB7UL, 0x09823B6EUL, 0x0D4326D9UL,
+    0x130476DCUL, 0x17C56B6BUL, 0x1A864DB2UL, 0x1E475005UL,
+    0x2608EDB8UL, 0x22C9F00FUL, 0x2F8AD6D6UL, 0x2B4BCB61UL,
+    0x350C9B64UL, 0x31CD86D3UL, 0x3C8EA00AUL, 0x384FBDBDUL
+};
+#endif
+
+#endif
+
+#if !defined(CRC_TABLE_CONST) && !defined(CRC_ENGINE_NIBBLE)
 crc  crcTable[256];
+#endif
+
+#if defined(CRC_SLICE) && defined(CRC_REFLECT_DATA)
+/* Byte reflection for the slicing loop, the bitwise reflect() would dominate it */
+static CRC_CONST unsigned char crcReflectTable[256] =
+{
+    0x00, 0x80, 0x40, 0xC0, 0x20, 0xA0, 0x60, 0xE0, 0x10, 0x90, 0x50, 0xD0,
+    0x30, 0xB0, 0x70, 0xF0, 0x08, 0x88, 0x48, 0xC8, 0x28, 0xA8, 0x68, 0xE8,
+    0x18, 0x98, 0x58, 0xD8, 0x38, 0xB8, 0x78, 0xF8, 0x04, 0x84, 0x44, 0xC4,
+    0x24, 0xA4, 0x64, 0xE4, 0x14, 0x94, 0x54, 0xD4, 0x34, 0xB4, 0x74, 0xF4,
+    0x0C, 0x8C, 0x4C, 0xCC, 0x2C, 0xAC, 0x6C, 0xEC, 0x1C, 0x9C, 0x5C, 0xDC,
+    0x3C, 0xBC, 0x7C, 0xFC, 0x02, 0x82, 0x42, 0xC2, 0x22, 0xA2, 0x62, 0xE2,
+    0x12, 0x92, 0x52, 0xD2, 0x32, 0xB2, 0x72, 0xF2, 0x0A, 0x8A, 0x4A, 0xCA,
+    0x2A, 0xAA, 0x6A, 0xEA, 0x1A, 0x9A, 0x5A, 0xDA, 0x3A, 0xBA, 0x7A, 0xFA,
+    0x06, 0x86, 0x46, 0xC6, 0x26, 0xA6, 0x66, 0xE6, 0x16, 0x96, 0x56, 0xD6,
+    0x36, 0xB6, 0x76, 0xF6, 0x0E, 0x8E, 0x4E, 0xCE, 0x2E, 0xAE, 0x6E, 0xEE,
+    0x1E, 0x9E, 0x5E, 0xDE, 0x3E, 0xBE, 0x7E, 0xFE, 0x01, 0x81, 0x41, 0xC1,
+    0x21, 0xA1, 0x61, 0xE1, 0x11, 0x91, 0x51, 0xD1, 0x31, 0xB1, 0x71, 0xF1,
+    0x09, 0x89, 0x49, 0xC9, 0x29, 0xA9, 0x69, 0xE9, 0x19, 0x99, 0x59, 0xD9,
+    0x39, 0xB9, 0x79, 0xF9, 0x05, 0x85, 0x45, 0xC5, 0x25, 0xA5, 0x65, 0xE5,
+    0x15, 0x95, 0x55, 0xD5, 0x35, 0xB5, 0x75, 0xF5, 0x0D, 0x8D, 0x4D, 0xCD,
+    0x2D, 0xAD, 0x6D, 0xED, 0x1D, 0x9D, 0x5D, 0xDD, 0x3D, 0xBD, 0x7D, 0xFD,
+    0x03, 0x83, 0x43, 0xC3, 0x23, 0xA3, 0x63, 0xE3, 0x13, 0x93, 0x53, 0xD3,
+    0x33, 0xB3, 0x73, 0xF3, 0x0B, 0x8B, 0x4B, 0xCB, 0x2B, 0xAB, 0x6B, 0xEB,
+    0x1B, 0x9B, 0x5B, 0xDB, 0x3B, 0xBB, 0x7B, 0xFB, 0x07, 0x87, 0x47, 0xC7,
+    0x27, 0xA7, 0x67, 0xE7, 0x17, 0x97, 0x57, 0xD7, 0x37, 0xB7, 0x77, 0xF7,
+    0x0F, 0x8F, 0x4F, 0xCF, 0x2F, 0xAF, 0x6F, 0xEF, 0x1F, 0x9F, 0x5F, 0xDF,
+    0x3F, 0xBF, 0x7F, 0xFF
+};
+#undef  REFLECT_DATA
+#define REFLECT_DATA(X)			(crcReflectTable[(unsigned char)(X)])
+#endif
+
+#if defined(CRC_SLICE)
+/* crcSliceTable[k-1][b] is the remainder of byte b followed by k zero bytes */
+static crc  crcSliceTable[CRC_SLICE - 1][256];
+#endif
+
+#if defined(CRC_REFLECT_DATA) || defined(CRC_REFLECT_REMAINDER)
 
 /*********************************************************************
  *
@@ -72,7 +311,7 @@ reflect(unsigned long data, unsigned char nBits)
          */
         if (data & 0x01)
         {
-            reflection |= (1 << ((nBits - 1) - bit));
+            reflection |= (1UL << ((nBits - 1) - bit));
         }
 
         data = (data >> 1);
@@ -82,6 +321,8 @@ reflect(unsigned long data, unsigned char nBits)
 
 }	/* reflect() */
 
+#endif
+
 
 /*********************************************************************
  *
@@ -109,7 +350,7 @@ crcSlow( unsigned char const message[], int nBytes )
         /*
          * Bring the next byte into the remainder.
          */
-        remainder ^= (REFLECT_DATA(message[byte]) << (WIDTH - 8));
+        remainder ^= ((crc)REFLECT_DATA(message[byte]) << (WIDTH - 8));
 
         /*
          * Perform modulo-2 division, a bit at a time.
@@ -133,7 +374,7 @@ crcSlow( unsigned char const message[], int nBytes )
     /*
      * The final remainder is the CRC result.
      */
-    return (REFLECT_REMAINDER(remainder) ^ FINAL_XOR_VALUE);
+    return ((REFLECT_REMAINDER(remainder & CRC_MASK) ^ FINAL_XOR_VALUE) & CRC_MASK);
 
 }   /* crcSlow() */
 
@@ -143,11 +384,13 @@ crcSlow( unsigned char const message[], int nBytes )
  *
  * Function:    crcInit()
  * 
- * Description: Populate the partial CRC lookup table.
+ * Description: Populate the partial CRC lookup table(s).
  *
  * Notes:		This function must be rerun any time the CRC standard
- *				is changed.  If desired, it can be run "offline" and
- *				the table results stored in an embedded system's ROM.
+ *				is changed. With CRC_TABLE_CONST the byte table is 
+ *				stored in ROM and nothing needs to be done here 
+ *				unless one of the slicing engines is selected. The
+ *				nibble engine never needs initialization.
  *
  * Returns:		None defined.
  *
@@ -155,6 +398,7 @@ crcSlow( unsigned char const message[], int nBytes )
 void
 crcInit(void)
 {
+#if !defined(CRC_TABLE_CONST) && !defined(CRC_ENGINE_NIBBLE)
     crc			   remainder;
     int			   dividend;
     unsigned char  bit;
@@ -168,7 +412,7 @@ crcInit(void)
         /*
          * Start with the dividend followed by zeros.
          */
-        remainder = dividend << (WIDTH - 8);
+        remainder = (crc)dividend << (WIDTH - 8);
 
         /*
          * Perform modulo-2 division, a bit at a time.
@@ -191,44 +435,173 @@ crcInit(void)
         /*
          * Store the result into the table.
          */
-        crcTable[dividend] = remainder;
+        crcTable[dividend] = remainder & CRC_MASK;
+    }
+#endif
+
+#if defined(CRC_SLICE)
+    {
+        int  k;
+        int  b;
+        crc  prev;
+
+        /*
+         * Each slice table is the previous one run through one more
+         * zero byte.
+         */
+        for (k = 0; k < (CRC_SLICE - 1); ++k)
+        {
+            for (b = 0; b < 256; ++b)
+            {
+                prev = (0 == k) ? crcTable[b] : crcSliceTable[k - 1][b];
+                crcSliceTable[k][b] = (crc)(((prev << 8) & CRC_MASK) ^ 
+                                        crcTable[(prev >> (WIDTH - 8)) & 0xFF]);
+            }
+        }
     }
+#endif
 
 }   /* crcInit() */
 
 
 /*********************************************************************
  *
- * Function:    crcFast()
+ * Function:    crcStart()
  * 
- * Description: Compute the CRC of a given message.
+ * Description: Get the start value for an incremental CRC 
+ *				calculation with crcUpdate().
  *
- * Notes:		crcInit() must be called first.
+ * Returns:		The initial remainder.
  *
- * Returns:		The CRC of the message.
+ *********************************************************************/
+crc
+crcStart(void)
+{
+    return (INITIAL_REMAINDER);
+
+}   /* crcStart() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcUpdate()
+ * 
+ * Description: Run a block of the message through the CRC. Can be 
+ *				called repeatedly as data streams in, starting with
+ *				the value from crcStart() and ending with crcFinish().
+ *
+ * Notes:		crcInit() must be called first unless the selected 
+ *				engine needs no RAM tables.
+ *
+ * Returns:		The updated remainder.
  *
  *********************************************************************/
 crc
-crcFast(unsigned char const message[], int nBytes)
+crcUpdate(crc remainder, unsigned char const message[], int nBytes)
 {
-    crc	           remainder = INITIAL_REMAINDER;
+    int            byte = 0;
+
+#if defined(CRC_ENGINE_NIBBLE)
+
     unsigned char  data;
-    int            byte;
 
+    /*
+     * Divide the message by the polynomial, a nibble at a time.
+     */
+    for (; byte < nBytes; ++byte)
+    {
+        data = REFLECT_DATA(message[byte]);
+        remainder = (crc)((remainder << 4) ^ 
+                        crcNibbleTable[((remainder >> (WIDTH - 4)) ^ (data >> 4)) & 0x0F]);
+        remainder = (crc)((remainder << 4) ^ 
+                        crcNibbleTable[((remainder >> (WIDTH - 4)) ^ data) & 0x0F]);
+    }
+
+#else
+
+    unsigned char  data;
+
+#if defined(CRC_SLICE)
+
+    unsigned char  x[CRC_SLICE];
+    int            i;
 
     /*
-     * Divide the message by the polynomial, a byte at a time.
+     * Divide the message by the polynomial, CRC_SLICE bytes at a 
+     * time. The remainder is folded into the first bytes of the 
+     * block and the contribution of each byte is looked up in the
+     * table for its distance to the end of the block.
      */
-    for (byte = 0; byte < nBytes; ++byte)
+    for (; (byte + CRC_SLICE) <= nBytes; byte += CRC_SLICE)
     {
-        data = REFLECT_DATA(message[byte]) ^ (remainder >> (WIDTH - 8));
-        remainder = crcTable[data] ^ (remainder << 8);
+        for (i = 0; i < CRC_SLICE; ++i)
+        {
+            x[i] = REFLECT_DATA(message[byte + i]);
+        }
+
+        for (i = 0; i < CRC_BYTES; ++i)
+        {
+            x[i] ^= (unsigned char)(remainder >> (WIDTH - 8 * (i + 1)));
+        }
+
+        remainder = crcTable[x[CRC_SLICE - 1]];
+        for (i = 0; i < (CRC_SLICE - 1); ++i)
+        {
+            remainder ^= crcSliceTable[CRC_SLICE - 2 - i][x[i]];
+        }
     }
 
+#endif
+
     /*
-     * The final remainder is the CRC.
+     * Divide the (rest of the) message by the polynomial, a byte at
+     * a time.
      */
-    return (REFLECT_REMAINDER(remainder) ^ FINAL_XOR_VALUE);
+    for (; byte < nBytes; ++byte)
+    {
+        data = REFLECT_DATA(message[byte]) ^ (unsigned char)(remainder >> (WIDTH - 8));
+        remainder = crcTable[data] ^ (remainder << 8);
+    }
+
+#endif
+
+    return (remainder);
+
+}   /* crcUpdate() */
+
+
+/*********************************************************************
+ *
+ * Function:    crcFinish()
+ * 
+ * Description: Get the CRC from a remainder returned by crcUpdate().
+ *
+ * Returns:		The CRC of the message.
+ *
+ *********************************************************************/
+crc
+crcFinish(crc remainder)
+{
+    return ((REFLECT_REMAINDER(remainder & CRC_MASK) ^ FINAL_XOR_VALUE) & CRC_MASK);
+
+}   /* crcFinish() */
 
-}   /* crcFast() */
 
+/*********************************************************************
+ *
+ * Function:    crcFast()
+ * 
+ * Description: Compute the CRC of a given message.
+ *
+ * Notes:		crcInit() must be called first unless the selected 
+ *				engine needs no RAM tables.
+ *
+ * Returns:		The CRC of the message.
+ *
+ *********************************************************************/
+crc
+crcFast(unsigned char const message[], int nBytes)
+{
+    return crcFinish(crcUpdate(INITIAL_REMAINDER, message, nBytes));
+
+}   /* crcFast() */
@@ -31,7 +31,26 @@ extern "C" {
 /*
  * Select the CRC standard from the list that follows.
  */
+#if !defined(CRC_CCITT) && !defined(CRC16) && !defined(CRC32)
 #define CRC_CCITT
+#endif
+
+/*
+ * Select the engine used by crcFast()/crcUpdate() by defining one of
+ *
+ *   (nothing)          Byte wise, 256 entry table.
+ *   CRC_ENGINE_SLICE4  Four bytes per step, 4 x 256 entry tables.
+ *   CRC_ENGINE_SLICE8  Eight bytes per step, 8 x 256 entry tables.
+ *   CRC_ENGINE_NIBBLE  Nibble wise, 16 entry table in ROM. For 8-bit
+ *                      parts with tight flash. No crcInit() needed.
+ *
+ * Define CRC_TABLE_CONST to have the 256 entry table precomputed in
+ * ROM so crcInit() has nothing to do (slicing tables are still built
+ * by crcInit()). CRC_CONST is the qualifier used for ROM tables.
+ */
+#ifndef CRC_CONST
+#define CRC_CONST           const
+#endif
 
 
 #if defined( CRC_CCITT )
@@ -39,6 +58,7 @@ extern "C" {
 typedef unsigned short  crc;
 
 #define CRC_NAME			"CRC-CCITT"
+#define CRC_WIDTH			16
 #define POLYNOMIAL			0x1021
 #define INITIAL_REMAINDER	0xFFFF
 #define FINAL_XOR_VALUE		0x0000
@@ -51,6 +71,7 @@ typedef unsigned short  crc;
 typedef unsigned short  crc;
 
 #define CRC_NAME			"CRC-16"
+#define CRC_WIDTH			16
 #define POLYNOMIAL			0x8005
 #define INITIAL_REMAINDER	0x0000
 #define FINAL_XOR_VALUE		0x0000
@@ -63,6 +84,7 @@ typedef unsigned short  crc;
 typedef unsigned long  crc;
 
 #define CRC_NAME			"CRC-32"
+#define CRC_WIDTH			32
 #define POLYNOMIAL			0x04C11DB7
 #define INITIAL_REMAINDER	0xFFFFFFFF
 #define FINAL_XOR_VALUE		0xFFFFFFFF
@@ -81,6 +103,16 @@ void  crcInit( void );
 crc   crcSlow( unsigned char const message[], int nBytes );
 crc   crcFast( unsigned char const message[], int nBytes) ;
 
+/*
+ * Incremental calculation:
+ *   state = crcStart();
+ *   state = crcUpdate( state, block, n );    (repeat as data arrives)
+ *   result = crcFinish( state );
+ */
+crc   crcStart( void );
+crc   crcUpdate( crc remainder, unsigned char const message[], int nBytes );
+crc   crcFinish( crc remainder );
+
 #ifdef __cplusplus
 }
 #endif
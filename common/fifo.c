@@ -2,20 +2,46 @@
 // 							 fifo implementation
 ///////////////////////////////////////////////////////////////////////////////
 
+#include <string.h>
 #include "fifo.h"
 
+// Index access with the ordering needed for the single producer/single 
+// consumer contract (see fifo.h)
+#ifdef FIFO_USE_C11_ATOMICS
+#define LOAD_OWN( x )           atomic_load_explicit( &(x), memory_order_relaxed )
+#define LOAD_ACQUIRE( x )       atomic_load_explicit( &(x), memory_order_acquire )
+#define STORE_RELEASE( x, v )   atomic_store_explicit( &(x), (v), memory_order_release )
+#else
+#define LOAD_OWN( x )           (x)
+static fifo_index_t load_acquire( fifo_atomic_index_t *p ) 
+{
+    fifo_index_t v = *p;
+    FIFO_BARRIER();
+    return v;
+}
+#define LOAD_ACQUIRE( x )       load_acquire( &(x) )
+#define STORE_RELEASE( x, v )   do { FIFO_BARRIER(); (x) = (v); } while ( 0 )
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // fifo_init
 //
 // This initializes the FIFO structure with the given buffer and size
+// The size must be a power of two. Returns non zero on success.
 //
 
-void fifo_init( fifo_t *f, uint8_t *buf, uint16_t size )
+int fifo_init( fifo_t *f, uint8_t *buf, uint16_t size )
 {
-    f->head = 0;
-    f->tail = 0;
-    f->size = size;
+    if ( !size || ( size & ( size - 1 ) ) ) return 0;
+    if ( (fifo_index_t)size != size ) return 0;  // Does not fit index type
+
     f->buf = buf;
+    f->size = size;
+    f->mask = size - 1;
+    STORE_RELEASE( f->head, 0 );
+    STORE_RELEASE( f->tail, 0 );
+
+    return 1;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -23,27 +49,27 @@ void fifo_init( fifo_t *f, uint8_t *buf, uint16_t size )
 //
 // This reads nbytes bytes from the FIFO
 // The number of bytes read is returned
+// Consumer side.
 //
 
 uint16_t fifo_read( fifo_t *f, void *buf, uint16_t nbytes )
 {
-    uint16_t i;
-    uint8_t *p;
-    p = buf;
-    
-    for ( i=0; i < nbytes; i++){
-
-        if ( f->tail != f->head ){ 		// see if any data is available
-            *p++ = f->buf[ f->tail ];  	// grab a byte from the buffer
-            f->tail++;  				// increment the tail
-            if( f->tail == f->size ){  	// check for wrap-around
-                f->tail = 0;
-            }
-        } 
-        else {
-            return i; 					// number of bytes read 
-        }
-    }
+    fifo_index_t tail = LOAD_OWN( f->tail );
+    fifo_index_t used = (fifo_index_t)( LOAD_ACQUIRE( f->head ) - tail );
+    fifo_index_t pos = tail & f->mask;
+    uint16_t first;
+
+    if ( nbytes > used ) nbytes = used;
+    if ( !nbytes ) return 0;
+
+    // Copy in (at most) two chunks, up to the end of the buffer and 
+    // then from the start
+    first = f->size - pos;
+    if ( first > nbytes ) first = nbytes;
+    memcpy( buf, f->buf + pos, first );
+    memcpy( (uint8_t *)buf + first, f->buf, nbytes - first );
+
+    STORE_RELEASE( f->tail, (fifo_index_t)( tail + nbytes ) );
 
     return nbytes;
 }
@@ -54,50 +80,114 @@ uint16_t fifo_read( fifo_t *f, void *buf, uint16_t nbytes )
 // This writes up to nbytes bytes to the FIFO
 // If the head runs in to the tail, not all bytes are written
 // The number of bytes written is returned
+// Producer side.
 //
 
-uint16_t fifo_write( fifo_t *f, const void *buf, uint32_t nbytes)
+uint16_t fifo_write( fifo_t *f, const void *buf, uint32_t nbytes )
 {
-    uint32_t i;
-    const uint8_t *p;
-    p = buf;
- 
-    for ( i=0; i < nbytes; i++ ){
-
-        // first check to see if there is space in the buffer
-        if ( (f->head + 1 == f->tail) ||
-                ( (f->head + 1 == f->size) && (f->tail == 0) ) ) {
-            return i; 					// no more room
-        } 
-        else {
-            f->buf[ f->head ] = *p++;
-            f->head++;  				// increment the head
-            if ( f->head == f->size ){  // check for wrap-around
-                f->head = 0;
-            }
-        }
-    }
+    fifo_index_t head = LOAD_OWN( f->head );
+    fifo_index_t space = f->size - (fifo_index_t)( head - LOAD_ACQUIRE( f->tail ) );
+    fifo_index_t pos = head & f->mask;
+    uint16_t first;
 
-    return nbytes;
+    if ( nbytes > space ) nbytes = space;
+    if ( !nbytes ) return 0;
+
+    first = f->size - pos;
+    if ( first > nbytes ) first = (uint16_t)nbytes;
+    memcpy( f->buf + pos, buf, first );
+    memcpy( f->buf, (const uint8_t *)buf + first, nbytes - first );
+
+    STORE_RELEASE( f->head, (fifo_index_t)( head + nbytes ) );
+
+    return (uint16_t)nbytes;
 }
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// fifo_write
-//
-// Get the size of the FIFO
+// fifo_getFree
 //
 // The number of bytes that can be written to the fifo is returned
 //
 
 uint16_t fifo_getFree( fifo_t *f )
 {
-    if ( f->head < f->tail ) {
-        return (f->tail - f->head);
-    }
-    else {
-        return (f->size + (f->tail - f->head));
-    }
+    return f->size - fifo_getUsed( f );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fifo_getUsed
+//
+// The number of bytes that can be read from the fifo is returned
+//
+
+uint16_t fifo_getUsed( fifo_t *f )
+{
+    return (fifo_index_t)( LOAD_ACQUIRE( f->head ) - LOAD_ACQUIRE( f->tail ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fifo_peekRead
+//
+// Get a pointer to the readable data without copying it. The number of 
+// contiguous bytes available at *pp is returned (may be less than the total
+// if the data wraps). Call fifo_commitRead when done with the data.
+// Consumer side.
+//
+
+uint16_t fifo_peekRead( fifo_t *f, uint8_t **pp )
+{
+    fifo_index_t tail = LOAD_OWN( f->tail );
+    fifo_index_t used = (fifo_index_t)( LOAD_ACQUIRE( f->head ) - tail );
+    fifo_index_t pos = tail & f->mask;
+
+    *pp = f->buf + pos;
+    if ( used > ( f->size - pos ) ) used = f->size - pos;
+
+    return used;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fifo_commitRead
+//
+// Release nbytes of data obtained with fifo_peekRead.
+//
+
+void fifo_commitRead( fifo_t *f, uint16_t nbytes )
+{
+    STORE_RELEASE( f->tail, (fifo_index_t)( LOAD_OWN( f->tail ) + nbytes ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fifo_peekWrite
+//
+// Get a pointer to free space in the FIFO. The number of contiguous bytes 
+// that can be written at *pp is returned. Call fifo_commitWrite to make 
+// written data available to the reader.
+// Producer side.
+//
+
+uint16_t fifo_peekWrite( fifo_t *f, uint8_t **pp )
+{
+    fifo_index_t head = LOAD_OWN( f->head );
+    fifo_index_t space = f->size - (fifo_index_t)( head - LOAD_ACQUIRE( f->tail ) );
+    fifo_index_t pos = head & f->mask;
+
+    *pp = f->buf + pos;
+    if ( space > ( f->size - pos ) ) space = f->size - pos;
+
+    return space;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// fifo_commitWrite
+//
+// Publish nbytes of data written to the area obtained with fifo_peekWrite.
+//
+
+void fifo_commitWrite( fifo_t *f, uint16_t nbytes )
+{
+    STORE_RELEASE( f->head, (fifo_index_t)( LOAD_OWN( f->head ) + nbytes ) );
 }
 
 
@@ -124,4 +214,3 @@ void uart_isr(void){
 	// execute any required ISR exit code
 }
 */
-
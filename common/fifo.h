@@ -6,23 +6,77 @@
 #ifndef __FIFO_20131120_H
 #define __FIFO_20131120_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
  extern "C" {
 #endif 
 
+/*
+    Single producer/single consumer FIFO
+
+    The FIFO is lock free as long as there is exactly one writer (for example
+    an interrupt routine) and exactly one reader (for example the main loop).
+    The writer only updates head and the reader only updates tail. Data is
+    published with release semantics and picked up with acquire semantics,
+    using C11 atomics when available. On other compilers the indexes are 
+    volatile and FIFO_BARRIER() is used to order data and index accesses. 
+    The default barrier is a compiler barrier which is enough on single core 
+    MCU's. Define FIFO_BARRIER to a memory barrier instruction (e.g. __DMB()) 
+    for multi core targets.
+
+    Reads and writes of an index must be atomic on the target. On 8-bit 
+    MCU's define FIFO_INDEX_TYPE as uint8_t (size max 128 bytes).
+
+    The buffer size must be a power of two. head and tail are free running
+    and masked on access so the full buffer can be used.
+*/
+
+#ifndef FIFO_INDEX_TYPE
+#define FIFO_INDEX_TYPE     uint16_t
+#endif
+
+typedef FIFO_INDEX_TYPE fifo_index_t;
+
+#if !defined( FIFO_NO_ATOMICS ) && !defined( __cplusplus ) && \
+    defined( __STDC_VERSION__ ) && ( __STDC_VERSION__ >= 201112L ) && \
+    !defined( __STDC_NO_ATOMICS__ )
+#define FIFO_USE_C11_ATOMICS
+#include <stdatomic.h>
+typedef _Atomic fifo_index_t fifo_atomic_index_t;
+#else
+typedef volatile fifo_index_t fifo_atomic_index_t;
+#endif
+
+#ifndef FIFO_BARRIER
+#if defined( __GNUC__ )
+#define FIFO_BARRIER()      __asm__ __volatile__( "" ::: "memory" )
+#else
+#define FIFO_BARRIER()
+#endif
+#endif
+
 typedef struct {
     uint8_t *buf;
-    uint16_t head;
-    uint16_t tail;
-    uint16_t size;
+    fifo_atomic_index_t head;   // Written by producer only
+    fifo_atomic_index_t tail;   // Written by consumer only
+    fifo_index_t size;
+    fifo_index_t mask;
 } fifo_t;
 
 
 // Prototypes
-void fifo_init( fifo_t *f, uint8_t *buf, uint16_t size );
+int fifo_init( fifo_t *f, uint8_t *buf, uint16_t size );
 uint16_t fifo_read( fifo_t *f, void *buf, uint16_t nbytes );
 uint16_t fifo_write( fifo_t *f, const void *buf, uint32_t nbytes );
 uint16_t fifo_getFree( fifo_t *f );
+uint16_t fifo_getUsed( fifo_t *f );
+
+// Zero copy access
+uint16_t fifo_peekRead( fifo_t *f, uint8_t **pp );
+void fifo_commitRead( fifo_t *f, uint16_t nbytes );
+uint16_t fifo_peekWrite( fifo_t *f, uint8_t **pp );
+void fifo_commitWrite( fifo_t *f, uint16_t nbytes );
 
 #ifdef __cplusplus
 }
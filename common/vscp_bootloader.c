@@ -38,6 +38,7 @@
  */
 
 #include <stdio.h>
+#include <string.h>
 #include <inttypes.h>
 #include <vscp_firmware.h>
 #include <vscp_class.h>
@@ -48,16 +49,128 @@
 
 #include "vscp_bootloader.h"
 
+// BLOCK_DATA_ACK and ACTIVATE_NEW_IMAGE carry a two byte CRC
+#if ( CRC_WIDTH != 16 )
+#error "The boot protocol needs a 16-bit CRC, select CRC_CCITT or CRC16 in crc.h"
+#endif
+
 // Globals
 volatile uint16_t vscpboot_timer = 0;
 uint8_t vscpboot_nickname = 0xFE;       // Assigned node nickname
 
+// Block buffers. A block is received into a free buffer and stays there
+// until the host has asked for it to be programmed and it has been
+// written to flash. The number of buffers is the number of blocks a
+// host can have in flight.
+static uint8_t blockdata[ VSCPBOOT_BUFFERS ][ VSCPBOOT_BLOCKSIZE ];
+static uint32_t blocknumber[ VSCPBOOT_BUFFERS ];
+static uint8_t blockstate[ VSCPBOOT_BUFFERS ];
+
+#define VSCPBOOT_BUF_FREE       0   // Buffer is free
+#define VSCPBOOT_BUF_FILLING    1   // Block data is being received
+#define VSCPBOOT_BUF_FILLED     2   // Complete, waiting for program request
+#define VSCPBOOT_BUF_PROGRAM    3   // Program requested, waiting for flash
+
+#define VSCPBOOT_NO_BUFFER      0xFF
+
 void vscpboot_init()
 {
     //Initialize CRC lookup table.
     crcInit();    
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// sendReply
+//
+// Send a protocol reply with the block number in the first four
+// data bytes (if size >= 4).
+//
+
+static int sendReply( vscpevent *pe, uint8_t type, uint32_t blockno, uint8_t size )
+{
+    pe->priority = VSCP_PRIORITY_NORMAL;
+    pe->flags = VSCP_VALID_MSG + size;
+    pe->vscp_class = VSCP_CLASS1_PROTOCOL;
+    pe->vscp_type = type;
+    if ( size >= 4 ) {
+        pe->data[ 0 ] = ( blockno >> 24 ) & 0xFF;
+        pe->data[ 1 ] = ( blockno >> 16 ) & 0xFF;
+        pe->data[ 2 ] = ( blockno >> 8 ) & 0xFF;
+        pe->data[ 3 ] = blockno & 0xFF;
+    }
+    return vscpboot_sendEvent( pe );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// sendBlockDataAck
+//
+// Send BLOCK_DATA_ACK for a complete block. Data is the block CRC in
+// bytes 0-1 and the write pointer after the block in bytes 2-5, both
+// MSB first.
+//
+
+static int sendBlockDataAck( vscpevent *pe, crc blockcrc, uint32_t blockno )
+{
+    uint32_t wrptr = ( blockno + 1 ) * VSCPBOOT_BLOCKSIZE;
+
+    pe->priority = VSCP_PRIORITY_NORMAL;
+    pe->flags = VSCP_VALID_MSG + 6;
+    pe->vscp_class = VSCP_CLASS1_PROTOCOL;
+    pe->vscp_type = VSCP_TYPE_PROTOCOL_BLOCK_DATA_ACK;
+    pe->data[ 0 ] = ( blockcrc >> 8 ) & 0xFF;
+    pe->data[ 1 ] = blockcrc & 0xFF;
+    pe->data[ 2 ] = ( wrptr >> 24 ) & 0xFF;
+    pe->data[ 3 ] = ( wrptr >> 16 ) & 0xFF;
+    pe->data[ 4 ] = ( wrptr >> 8 ) & 0xFF;
+    pe->data[ 5 ] = wrptr & 0xFF;
+    return vscpboot_sendEvent( pe );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// findBuffer
+//
+// Find the buffer in a given state. If blockno is not VSCPBOOT_ANY_BLOCK
+// the buffer must also hold that block.
+//
+
+#define VSCPBOOT_ANY_BLOCK      0xFFFFFFFF
+
+static uint8_t findBuffer( uint8_t state, uint32_t blockno )
+{
+    uint8_t i;
+    
+    for ( i = 0; i < VSCPBOOT_BUFFERS; i++ ) {
+        if ( ( state == blockstate[ i ] ) &&
+                ( ( VSCPBOOT_ANY_BLOCK == blockno ) || 
+                  ( blockno == blocknumber[ i ] ) ) ) {
+            return i;
+        }
+    }
+    
+    return VSCPBOOT_NO_BUFFER;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// programBuffer
+//
+// Write one buffer that the host has asked to be programmed to flash
+// and ACK it. Returns FALSE if there was nothing to program.
+//
+
+static int programBuffer( vscpevent *pe )
+{
+    uint8_t idx = findBuffer( VSCPBOOT_BUF_PROGRAM, VSCPBOOT_ANY_BLOCK );
+    
+    if ( VSCPBOOT_NO_BUFFER == idx ) return FALSE;
+    
+    boot_program_page( blocknumber[ idx ], blockdata[ idx ] );
+    blockstate[ idx ] = VSCPBOOT_BUF_FREE;
+    
+    sendReply( pe, VSCP_TYPE_PROTOCOL_PROGRAM_BLOCK_DATA_ACK, blocknumber[ idx ], 4 );
+    
+    return TRUE;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // vscpboot_loader
 //
@@ -67,9 +180,17 @@ void vscpboot_loader( void )
     vscpevent e;
     vscpboot_state state = STATE_VIRGIN;        // We haven't done anything yet
     
-    uint32_t blockno;                           // Current block to program
-    uint8_t blockdata[ VSCPBOOT_BLOCKSIZE ];    // Block data buffer
-    uint16_t offset;                            // offset into blockdata 
+    uint32_t blockno;                           // Block number from host
+    uint8_t fill = VSCPBOOT_NO_BUFFER;          // Buffer being filled
+    uint16_t offset = 0;                        // offset into fill buffer 
+    crc blockcrc = 0;                           // Running CRC for fill buffer
+    crc imagecrc = 0;                           // Running CRC for image
+    crc imagecrcBlock = 0;                      // Image CRC at start of fill block
+    crc imagecrcPrev = 0;                       // Image CRC at start of last counted block
+    uint32_t imageblock = VSCPBOOT_ANY_BLOCK;   // Next block to add to image CRC
+    crc hostcrc;                                // Image CRC from host
+    uint8_t size;                               // Data size of host event
+    uint8_t i;
     
     while ( 1 ) {     // not only diamonds are forever...
         
@@ -148,6 +269,15 @@ ENTER_BOOT_MODE:
                         e.data[ 6 ] = ( VSCPBOOT_BLOCKS >> 8 ) & 0xFF;
                         e.data[ 7 ] = ( VSCPBOOT_BLOCKS & 0xFF );
                         if ( vscpboot_sendEvent( &e ) ) {	// ACK bootloader request                       
+                            
+                            // Start over with empty buffers
+                            for ( i = 0; i < VSCPBOOT_BUFFERS; i++ ) {
+                                blockstate[ i ] = VSCPBOOT_BUF_FREE;
+                            }
+                            fill = VSCPBOOT_NO_BUFFER;
+                            imagecrc = crcStart();
+                            imageblock = VSCPBOOT_ANY_BLOCK;
+                            
                             state = STATE_BLOCKWAIT;
                         }   
                                                                      
@@ -166,106 +296,181 @@ ENTER_BOOT_MODE:
                 }                              
                 break;  
                 
-            // ----------------------------------------------------------------    
+            // ----------------------------------------------------------------
             case STATE_BLOCKWAIT:
-                if ( vscpboot_getEvent( &e ) ) {
-
-                    if ( ( e.vscp_class == VSCP_CLASS1_PROTOCOL ) &&
-                            ( e.vscp_type == VSCP_TYPE_PROTOCOL_START_BLOCK ) &&
-                            ( ( e.flags & 0x0F ) >= 4 ) ) { 
-                                  
+            case STATE_BLOCKDATA:
+            
+                if ( !vscpboot_getEvent( &e ) ) {
+                    
+                    // Nothing received - write a waiting block while
+                    // the next one is streaming in or when the host
+                    // has been quiet for a while
+                    if ( ( STATE_BLOCKDATA == state ) || 
+                            ( vscpboot_timer >= VSCPBOOT_PROGRAM_IDLE ) ) {
+                        programBuffer( &e );
+                    }
+                    break;
+                }
+                
+                vscpboot_timer = 0;
+                
+                if ( e.vscp_class != VSCP_CLASS1_PROTOCOL ) break;
+                
+                switch ( e.vscp_type ) {
+                    
+                    case VSCP_TYPE_PROTOCOL_START_BLOCK:
+                        
+                        if ( ( e.flags & 0x0F ) < 4 ) break;
+                        
                         blockno =  construct_unsigned32( e.data[0],
                                                          e.data[1],
                                                          e.data[2],
                                                          e.data[3] );
+                        
+                        // A restarted block replaces the one being filled
+                        if ( VSCPBOOT_NO_BUFFER != fill ) {
+                            blockstate[ fill ] = VSCPBOOT_BUF_FREE;
+                            fill = VSCPBOOT_NO_BUFFER;
+                            imagecrc = imagecrcBlock;
+                        }
+                        
+                        // The host sends the last counted block again when
+                        // its CRC was wrong, take it out of the image CRC
+                        if ( ( VSCPBOOT_ANY_BLOCK != imageblock ) && 
+                                ( ( blockno + 1 ) == imageblock ) ) {
+                            imagecrc = imagecrcPrev;
+                            imageblock = blockno;
+                        }
+                        
+                        // and a block that is sent again replaces the old copy
+                        for ( i = 0; i < VSCPBOOT_BUFFERS; i++ ) {
+                            if ( blockno == blocknumber[ i ] ) {
+                                blockstate[ i ] = VSCPBOOT_BUF_FREE;
+                            }
+                        }
+                        
+                        // The image CRC starts with the first block sent
+                        if ( VSCPBOOT_ANY_BLOCK == imageblock ) {
+                            imageblock = blockno;
+                        }
+                        
+                        // Make room if the window is full
+                        i = findBuffer( VSCPBOOT_BUF_FREE, VSCPBOOT_ANY_BLOCK );
+                        if ( ( VSCPBOOT_NO_BUFFER == i ) && programBuffer( &e ) ) {
+                            i = findBuffer( VSCPBOOT_BUF_FREE, VSCPBOOT_ANY_BLOCK );
+                        }
                                                          
                         // block number can't be larger than number of available blocks                                                         
-                        if ( blockno >= VSCPBOOT_BLOCKS ) {
-                            e.priority = VSCP_PRIORITY_NORMAL;
-                            e.flags = 0;
-                            e.vscp_class = VSCP_CLASS1_PROTOCOL;
-                            e.vscp_type =  VSCP_TYPE_PROTOCOL_START_BLOCK_NACK;
-                            vscpboot_sendEvent( &e );	// NACK start block request                        
+                        if ( ( blockno >= VSCPBOOT_BLOCKS ) || 
+                                ( VSCPBOOT_NO_BUFFER == i ) ) {
+                            sendReply( &e, VSCP_TYPE_PROTOCOL_START_BLOCK_NACK, blockno, 4 );
+                            state = STATE_BLOCKWAIT;
                         }                            
-                        else {            
+                        else if ( sendReply( &e, VSCP_TYPE_PROTOCOL_START_BLOCK_ACK, blockno, 4 ) ) {
+                            fill = i;
+                            blocknumber[ fill ] = blockno;
+                            blockstate[ fill ] = VSCPBOOT_BUF_FILLING;
+                            memset( blockdata[ fill ], 0xFF, VSCPBOOT_BLOCKSIZE );
+                            offset = 0;
+                            blockcrc = crcStart();
+                            imagecrcBlock = imagecrc;
+                            state = STATE_BLOCKDATA;
+                        }
+                        break;
+                        
+                    case VSCP_TYPE_PROTOCOL_BLOCK_DATA:
+                        
+                        if ( ( STATE_BLOCKDATA != state ) || 
+                                ( 8 != ( e.flags & 0x0F ) ) ) {
+                            sendReply( &e, VSCP_TYPE_PROTOCOL_BLOCK_DATA_NACK, 0, 0 );
+                            break;
+                        }
+                        
+                        // copy in data and update the CRC's as it arrives
+                        i = 8;
+                        if ( ( VSCPBOOT_BLOCKSIZE - offset ) < 8 ) {
+                            i = VSCPBOOT_BLOCKSIZE - offset;
+                        }
+                        memcpy( blockdata[ fill ] + offset, e.data, i );
+                        offset += i;
+                        blockcrc = crcUpdate( blockcrc, e.data, i );
+                        
+                        // Blocks count in the image CRC when they come in 
+                        // order, a block sent again is not counted twice
+                        if ( imageblock == blocknumber[ fill ] ) {
+                            imagecrc = crcUpdate( imagecrc, e.data, i );
+                        }
+                        
+                        // Check if the block is full
+                        if ( offset >= VSCPBOOT_BLOCKSIZE ) {
                             
-                            // ACK the block data
-                            e.priority = VSCP_PRIORITY_NORMAL;
-                            e.flags = 0;
-                            e.vscp_class = VSCP_CLASS1_PROTOCOL;
-                            e.vscp_type =  VSCP_TYPE_PROTOCOL_START_BLOCK_ACK;
-                                                 
-                            if ( vscpboot_sendEvent( &e ) ) {	// ACK program block request
-                                memset( blockdata, 0xFF, sizeof( blockdata ) );
-                                state = STATE_BLOCKDATA;
-                                offset = 0;
+                            // ACK the block with its CRC and write pointer
+                            blockcrc = crcFinish( blockcrc );
+                            blockstate[ fill ] = VSCPBOOT_BUF_FILLED;
+                            if ( imageblock == blocknumber[ fill ] ) {
+                                imagecrcPrev = imagecrcBlock;
+                                imageblock++;
                             }
-                             
-                        }                                                                            
-                    }
-                    else {
-                        // Is this an abort?
-                        if ( ( e.vscp_class == VSCP_CLASS1_PROTOCOL ) &&
-                        ( e.vscp_type == VSCP_TYPE_PROTOCOL_ENTER_BOOT_LOADER ) ) {
-                            state = STATE_BOOTWAIT;
-                            goto  ENTER_BOOT_MODE;
+                            sendBlockDataAck( &e, blockcrc, blocknumber[ fill ] );
+                            
+                            fill = VSCPBOOT_NO_BUFFER;
+                            state = STATE_BLOCKWAIT;
                         }
-                    }                       
-                }
-                                                        
-                break; 
-                
-            // ----------------------------------------------------------------
-            case STATE_BLOCKDATA:
-            if ( vscpboot_getEvent( &e ) ) { 
-                
-                if ( ( e.vscp_class == VSCP_CLASS1_PROTOCOL ) &&
-                    ( e.vscp_type == VSCP_TYPE_PROTOCOL_ENTER_BOOT_LOADER ) && 
-                    ( 8 == ( e.flags & 0x0F ) ) ) {
-
-                    // copy in data                    
-                    memcpy( blockdata + offset, e.data, 8 );
-                    offset += 8;  
-                    
-                    // ACK the block data
-                    e.priority = VSCP_PRIORITY_NORMAL;
-                    e.flags = 0;
-                    e.vscp_class = VSCP_CLASS1_PROTOCOL;
-                    e.vscp_type =  VSCP_TYPE_PROTOCOL_BLOCK_DATA_ACK;                    
-                    vscpboot_sendEvent( &e );                                          
-                    
-                    // Check if the block is full
-                    if ( offset == sizeof( blockdata ) ) {
-                     
-                        // ACK the block 
+                        break;
                         
+                    case VSCP_TYPE_PROTOCOL_PROGRAM_BLOCK_DATA:
                         
+                        if ( ( e.flags & 0x0F ) < 4 ) break;
                         
-                        e.priority = VSCP_PRIORITY_NORMAL;
-                        e.flags = 0;
-                        e.vscp_class = VSCP_CLASS1_PROTOCOL;
-                        e.vscp_type =  VSCP_TYPE_PROTOCOL_START_BLOCK_ACK;
+                        blockno =  construct_unsigned32( e.data[0],
+                                                         e.data[1],
+                                                         e.data[2],
+                                                         e.data[3] );
+                                                         
+                        // Queue it, the ACK is sent when it has been written 
+                        i = findBuffer( VSCPBOOT_BUF_FILLED, blockno );
+                        if ( VSCPBOOT_NO_BUFFER == i ) {
+                            sendReply( &e, VSCP_TYPE_PROTOCOL_PROGRAM_BLOCK_DATA_NACK, blockno, 4 );
+                        }
+                        else {
+                            blockstate[ i ] = VSCPBOOT_BUF_PROGRAM;
+                        }
+                        break;
                         
-                        if ( vscpboot_sendEvent( &e ) ) {	// ACK program block request
-                            memset( blockdata, 0xFF, sizeof( blockdata ) );
-                            state = STATE_BLOCKDATA;
-                            offset = 0;
+                    case VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE:
+                        
+                        // The program ACKs sent below reuse the event
+                        size = e.flags & 0x0F;
+                        hostcrc = ( (crc)e.data[ 0 ] << 8 ) | e.data[ 1 ];
+                        
+                        // Write everything that is pending
+                        while ( programBuffer( &e ) );
+                        
+                        // A block the host never asked to program is 
+                        // in the image CRC but not in flash
+                        if ( ( size >= 2 ) && 
+                                ( VSCPBOOT_NO_BUFFER == fill ) &&
+                                ( VSCPBOOT_NO_BUFFER == findBuffer( VSCPBOOT_BUF_FILLED, VSCPBOOT_ANY_BLOCK ) ) &&
+                                ( crcFinish( imagecrc ) == hostcrc ) ) {
+                            sendReply( &e, VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE_ACK, 0, 0 );
+                            vscpboot_setBootFlag( 0 );
+                            vscpboot_reboot();
                         }
+                        else {
+                            sendReply( &e, VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE_NACK, 0, 0 );
+                        }
+                        break;
                         
-                    }
-                    
-                }                    
-                
-            }
-            else {
-                // Is this an abort?
-                if ( ( e.vscp_class == VSCP_CLASS1_PROTOCOL ) &&
-                ( e.vscp_type == VSCP_TYPE_PROTOCOL_ENTER_BOOT_LOADER ) ) {
-                    state = STATE_BOOTWAIT;
-                    goto  ENTER_BOOT_MODE;
+                    case VSCP_TYPE_PROTOCOL_ENTER_BOOT_LOADER:
+                        
+                        // Abort
+                        state = STATE_BOOTWAIT;
+                        goto  ENTER_BOOT_MODE;
+                        
+                    default:
+                        break;
                 }
-            }
-            break;                           
+                break;                           
                 
             // ----------------------------------------------------------------    
             default:
@@ -276,4 +481,4 @@ ENTER_BOOT_MODE:
     
     } // while        
     
-}    
+}
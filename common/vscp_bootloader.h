@@ -67,6 +67,46 @@
 #define TIMOUT_ANNOUNCE             10000   // Timeout waiting for node responding with ACK after we
                                             // sent out new node on line
 
+// Number of block buffers (VSCPBOOT_BLOCKSIZE bytes each). This is the
+// window of blocks a host can have in flight. With one buffer the host
+// has to wait for PROGRAM_BLOCK_DATA_ACK before the next START_BLOCK is
+// accepted. With two or more the next block is received while the
+// previous one is waiting to be written.
+#ifndef VSCPBOOT_BUFFERS
+#define VSCPBOOT_BUFFERS            2
+#endif
+
+// Blocks waiting to be written are written while the next block is
+// received (the CAN driver must buffer frames meanwhile) or when nothing
+// has been received for this many vscpboot_timer ticks.
+#ifndef VSCPBOOT_PROGRAM_IDLE
+#define VSCPBOOT_PROGRAM_IDLE       2
+#endif
+
+/*
+ * Block transfer (after ACK_BOOT_LOADER)
+ *
+ *   START_BLOCK(blockno)           -> START_BLOCK_ACK(blockno) when a buffer is
+ *                                     free, START_BLOCK_NACK(blockno) if not.
+ *   BLOCK_DATA x BLOCKSIZE/8       -> no reply per frame. The CRC is updated as
+ *                                     each frame arrives and BLOCK_DATA_ACK
+ *                                     (crc MSB, crc LSB, write pointer MSB..LSB)
+ *                                     is sent when the block is complete. The
+ *                                     write pointer is the image offset after
+ *                                     the block, (blockno + 1) * BLOCKSIZE.
+ *   PROGRAM_BLOCK_DATA(blockno)    -> block is queued. PROGRAM_BLOCK_DATA_ACK
+ *                                     (blockno) is sent when it is written.
+ *   ACTIVATE_NEW_IMAGE(crc MSB,LSB)-> pending blocks are written and the CRC
+ *                                     is checked. It covers the blocks from the
+ *                                     first block sent and up, each counted once.
+ *
+ * A host can send START_BLOCK for the next block right after
+ * PROGRAM_BLOCK_DATA, up to VSCPBOOT_BUFFERS blocks ahead of the last
+ * PROGRAM_BLOCK_DATA_ACK.
+ * CRC's are the CRC selected in crc.h (CRC-CCITT by default). It must be
+ * a 16-bit CRC.
+ */
+
 typedef enum vscpboot_state_t {
     STATE_VIRGIN = 0,   // Haven't done anything yet
     STATE_ANNOUNCE,     // New node on line sent, testing
@@ -88,12 +128,21 @@ void vscpboot_loader( void );
 	(uint8_t priority, uint8_t zone, uint8_t subzone, uint8_t idx, 
 	uint8_t eventClass, uint8_t eventTypeId );
 */
-void boot_program_page (uint32_t page, uint8_t *buf);
-
 //*****************************************************************************
 //        The following methods should be defined by the implementor
 //*****************************************************************************
 
+///////////////////////////////////////////////////////////////////////////////
+//  boot_program_page
+//
+// Write one block (VSCPBOOT_BLOCKSIZE bytes) to flash.
+//
+// @param page Block number.
+// @param buf Pointer to block data.
+//
+
+void boot_program_page (uint32_t page, uint8_t *buf);
+
 ///////////////////////////////////////////////////////////////////////////////
 //  init_hardware
 //
@@ -0,0 +1,268 @@
+// FILE: vscp_canfilt.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "vscp_class.h"
+#include "vscp_canfilt.h"
+#ifdef VSCP_FIRMWARE_ENABLE_DM
+#include "vscp_dm.h"
+#endif
+
+#if ( VSCP_CANFILT_SLOTS < 1 ) || ( VSCP_CANFILT_MAX_TERMS < VSCP_CANFILT_SLOTS + 1 )
+#error "VSCP_CANFILT_SLOTS must be at least 1 and less than VSCP_CANFILT_MAX_TERMS"
+#endif
+
+static vscp_canfilt_t terms[ VSCP_CANFILT_MAX_TERMS ];
+static uint8_t cntTerms;
+
+static uint8_t bValid;
+static uint8_t lastNickname;
+#ifdef VSCP_FIRMWARE_ENABLE_DM
+static uint8_t lastGeneration;
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// covers
+//
+// Non zero if every id accepted by b is accepted by a
+//
+
+static uint8_t covers( const vscp_canfilt_t *a, const vscp_canfilt_t *b )
+{
+    return !( a->mask & ~b->mask ) && !( ( a->filter ^ b->filter ) & a->mask );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// merge
+//
+// Smallest term covering both a and b
+//
+
+static void merge( vscp_canfilt_t *pResult,
+                    const vscp_canfilt_t *a,
+                    const vscp_canfilt_t *b )
+{
+    pResult->mask = a->mask & b->mask & ~( a->filter ^ b->filter );
+    pResult->filter = a->filter & pResult->mask;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// size
+//
+// Number of ids a term lets through
+//
+
+static uint32_t size( uint32_t mask )
+{
+    uint8_t n = 29;
+
+    mask &= VSCP_CANFILT_ID_MASK;
+    while ( mask ) {
+        mask &= mask - 1;
+        n--;
+    }
+
+    return (uint32_t)1 << n;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// removeCovered
+//
+// Remove all terms except keep that keep covers
+//
+
+static void removeCovered( uint8_t keep )
+{
+    uint8_t i = 0;
+
+    while ( i < cntTerms ) {
+        if ( ( i != keep ) && covers( &terms[ keep ], &terms[ i ] ) ) {
+            cntTerms--;
+            terms[ i ] = terms[ cntTerms ];
+            if ( keep == cntTerms ) keep = i;
+            continue;
+        }
+        i++;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// reduce
+//
+// Merge the cheapest pair until there are at most n terms. The cost of a
+// merge is the number of ids let through that neither term let through
+// (overlap is ignored, a covered term has already been removed).
+//
+
+static void reduce( uint8_t n )
+{
+    uint8_t i, j, bi, bj;
+    uint32_t cost, best, sz;
+    vscp_canfilt_t m;
+
+    while ( cntTerms > n ) {
+
+        best = 0xffffffff;
+        bi = 0;
+        bj = 1;
+        for ( i = 0; i < cntTerms; i++ ) {
+            for ( j = i + 1; j < cntTerms; j++ ) {
+                merge( &m, &terms[ i ], &terms[ j ] );
+                cost = size( m.mask );
+                sz = size( terms[ i ].mask ) + size( terms[ j ].mask );
+                cost = ( cost > sz ) ? cost - sz : 0;
+                if ( cost < best ) {
+                    best = cost;
+                    bi = i;
+                    bj = j;
+                }
+            }
+        }
+
+        merge( &terms[ bi ], &terms[ bi ], &terms[ bj ] );
+        cntTerms--;
+        terms[ bj ] = terms[ cntTerms ];
+
+        // The wider term may now cover others
+        removeCovered( bi );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_canfilt_addTerm
+//
+
+void vscp_canfilt_addTerm( uint32_t mask, uint32_t filter )
+{
+    uint8_t i;
+    vscp_canfilt_t t;
+
+    t.mask = mask & VSCP_CANFILT_ID_MASK;
+    t.filter = filter & t.mask;
+
+    for ( i = 0; i < cntTerms; i++ ) {
+        if ( covers( &terms[ i ], &t ) ) return;
+    }
+
+    if ( cntTerms >= VSCP_CANFILT_MAX_TERMS ) reduce( VSCP_CANFILT_MAX_TERMS - 1 );
+
+    terms[ cntTerms ] = t;
+    cntTerms++;
+    removeCovered( cntTerms - 1 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_canfilt_init
+//
+
+void vscp_canfilt_init( void )
+{
+    bValid = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_canfilt_invalidate
+//
+
+void vscp_canfilt_invalidate( void )
+{
+    bValid = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_canfilt_doWork
+//
+
+void vscp_canfilt_doWork( void )
+{
+    if ( vscp_nickname != lastNickname ) bValid = 0;
+#ifdef VSCP_FIRMWARE_ENABLE_DM
+    if ( vscp_dm_getGeneration() != lastGeneration ) bValid = 0;
+#endif
+
+    if ( !bValid ) vscp_canfilt_update();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_canfilt_update
+//
+
+void vscp_canfilt_update( void )
+{
+#ifdef VSCP_FIRMWARE_ENABLE_DM
+    uint16_t i;
+    const struct _dmrow *pRow;
+#endif
+
+    cntTerms = 0;
+
+    // Protocol events
+    vscp_canfilt_addClass( VSCP_CLASS1_PROTOCOL );
+
+#if VSCP_CANFILT_OWN_NICKNAME
+    // Someone else using our nickname
+    if ( VSCP_ADDRESS_FREE != vscp_nickname ) {
+        vscp_canfilt_addTerm( VSCP_CANFILT_NICKNAME_MASK, vscp_nickname );
+    }
+#endif
+
+#ifdef VSCP_FIRMWARE_ENABLE_DM
+    lastGeneration = vscp_dm_getGeneration();
+
+    for ( i = 0; i < vscp_dm_getEnabledRows(); i++ ) {
+        pRow = vscp_dm_getEnabledRow( i );
+        vscp_canfilt_addTerm(
+            ( (uint32_t)( pRow->flags & VSCP_DM_FLAG_CLASS_MASK ) << 23 ) |
+            ( (uint32_t)pRow->class_mask << 16 ) |
+            ( (uint32_t)pRow->type_mask << 8 ) |
+            ( ( pRow->flags & VSCP_DM_FLAG_CHECK_OADDR ) ? 0xff : 0 ),
+            ( (uint32_t)( pRow->flags & VSCP_DM_FLAG_CLASS_FILTER ) << 24 ) |
+            ( (uint32_t)pRow->class_filter << 16 ) |
+            ( (uint32_t)pRow->type_filter << 8 ) |
+            pRow->oaddr );
+    }
+#endif
+
+    vscp_canfilt_addAppTerms();
+
+    reduce( VSCP_CANFILT_SLOTS );
+
+    lastNickname = vscp_nickname;
+    bValid = 1;
+
+    vscp_canfilt_program( terms, cntTerms );
+}
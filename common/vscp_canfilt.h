@@ -0,0 +1,156 @@
+// FILE: vscp_canfilt.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#ifndef _VSCP_CANFILT_H_
+#define _VSCP_CANFILT_H_
+
+#include <stdint.h>
+#include <vscp_firmware.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+    CAN acceptance filters
+
+    Computes hardware mask/filter pairs for the 29-bit id that let through
+    every frame the node needs:
+
+        - the protocol class (class 0, all types),
+        - frames with our nickname as originator (an address conflict),
+          unless VSCP_CANFILT_OWN_NICKNAME is set to 0,
+        - frames matching an enabled decision matrix row (class, type and
+          originator when the row checks it). Zone and subzone are in the
+          data and are still checked by the decision matrix,
+        - terms added by the application in vscp_canfilt_addAppTerms.
+
+    Terms covered by another term are dropped. While there are more terms
+    than filter slots the two terms whose merge lets the least extra ids
+    through are merged. A merge only turns mask bits off so the result
+    always covers all terms, frames are never lost, at worst some
+    unneeded ones are let through.
+
+    With VSCP_FIRMWARE_ENABLE_CANFILT vscp_doWork calls
+    vscp_canfilt_doWork which recomputes and programs the filters when the
+    decision matrix (vscp_dm.h) or the nickname has changed.
+
+    The driver implements vscp_canfilt_program. Each slot is an
+    independent mask/filter pair, a set bit in the mask means the id bit
+    must equal the filter bit. On controllers where masks are shared,
+    like the MCP2515 (RXM0 for RXF0-1, RXM1 for RXF2-5), use one slot per
+    mask and repeat the filter in the other filter registers of that mask.
+*/
+
+// Hardware mask/filter pairs available
+#ifndef VSCP_CANFILT_SLOTS
+#define VSCP_CANFILT_SLOTS          4
+#endif
+
+// Terms kept while the set is built. Terms are merged early when there
+// are more, so this bounds both RAM and the time to compute the set.
+#ifndef VSCP_CANFILT_MAX_TERMS
+#define VSCP_CANFILT_MAX_TERMS      16
+#endif
+
+// Let frames with our own nickname through
+#ifndef VSCP_CANFILT_OWN_NICKNAME
+#define VSCP_CANFILT_OWN_NICKNAME   1
+#endif
+
+// Fields of the 29-bit id
+#define VSCP_CANFILT_ID_MASK        0x1fffffffUL
+#define VSCP_CANFILT_CLASS_MASK     0x01ff0000UL
+#define VSCP_CANFILT_TYPE_MASK      0x0000ff00UL
+#define VSCP_CANFILT_NICKNAME_MASK  0x000000ffUL
+
+typedef struct {
+    uint32_t mask;              // Set bits must match
+    uint32_t filter;            // Id bits (only bits set in mask)
+} vscp_canfilt_t;
+
+// Filters are programmed on the next vscp_canfilt_doWork
+void vscp_canfilt_init( void );
+
+// Recompute on the next vscp_canfilt_doWork
+void vscp_canfilt_invalidate( void );
+
+// Recompute and program the filters if something they depend on changed
+void vscp_canfilt_doWork( void );
+
+// Recompute and program the filters now
+void vscp_canfilt_update( void );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_canfilt_addTerm
+//
+// Add ids that must be let through. Only to be called from
+// vscp_canfilt_addAppTerms.
+//
+
+void vscp_canfilt_addTerm( uint32_t mask, uint32_t filter );
+
+// Add the class/type of all events with class in 0-511
+#define vscp_canfilt_addEvent( vscp_class, vscp_type ) \
+    vscp_canfilt_addTerm( VSCP_CANFILT_CLASS_MASK | VSCP_CANFILT_TYPE_MASK, \
+                            ( (uint32_t)(vscp_class) << 16 ) | ( (uint32_t)(vscp_type) << 8 ) )
+
+// Add all events of a class
+#define vscp_canfilt_addClass( vscp_class ) \
+    vscp_canfilt_addTerm( VSCP_CANFILT_CLASS_MASK, (uint32_t)(vscp_class) << 16 )
+
+// --------------------------- External Functions -----------------------------
+//
+// Implemented by the application/driver
+//
+// --------------------------- External Functions -----------------------------
+
+/*!
+    Add application terms with vscp_canfilt_addTerm (events handled outside
+    the decision matrix). Can be empty.
+ */
+void vscp_canfilt_addAppTerms( void );
+
+/*!
+    Program the acceptance filters. Slots from cnt up should be disabled.
+    @param pFilters Mask/filter pairs.
+    @param cnt Number of pairs (1 - VSCP_CANFILT_SLOTS).
+ */
+void vscp_canfilt_program( const vscp_canfilt_t *pFilters, uint8_t cnt );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VSCP_CANFILT_H_ */
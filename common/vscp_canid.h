@@ -0,0 +1,86 @@
+// FILE: vscp_canid.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#ifndef _VSCP_CANID_H_
+#define _VSCP_CANID_H_
+
+#include <stdint.h>
+
+/*
+    VSCP over CAN
+
+    Level I events are sent as extended CAN frames. The 29-bit id holds
+
+        bits 26-28  priority (0 is highest)
+        bit  25     hard coded node
+        bits 16-24  class
+        bits 8-15   type
+        bits 0-7    nickname of the sending node
+
+    and the data is the event data (0-8 bytes).
+
+    The macros below only shift by multiples of eight before masking so
+    8- and 16-bit compilers turn them into byte moves instead of a long
+    shift loop. Read the id into a local once and use the macros on it.
+*/
+
+// Fields of an id
+#define VSCP_CANID_PRIORITY( id )   ( (uint8_t)( ( (uint8_t)( (id) >> 24 ) >> 2 ) & 0x07 ) )
+#define VSCP_CANID_HARDCODED( id )  ( (uint8_t)( ( (uint8_t)( (id) >> 24 ) >> 1 ) & 0x01 ) )
+#define VSCP_CANID_CLASS( id )      ( (uint16_t)( ( (uint16_t)( (uint8_t)( (id) >> 24 ) & 0x01 ) << 8 ) | \
+                                        (uint8_t)( (id) >> 16 ) ) )
+#define VSCP_CANID_TYPE( id )       ( (uint8_t)( (id) >> 8 ) )
+#define VSCP_CANID_NICKNAME( id )   ( (uint8_t)(id) )
+
+// Build an id. Class is nine bits, the hard coded bit is left zero.
+#define VSCP_CANID_PACK( priority, vscp_class, vscp_type, nickname )                \
+    ( ( (uint32_t)( ( ( (priority) & 0x07 ) << 2 ) | ( ( (vscp_class) >> 8 ) & 0x01 ) ) << 24 ) | \
+      ( (uint32_t)(uint8_t)(vscp_class) << 16 ) |                                   \
+      ( (uint16_t)(uint8_t)(vscp_type) << 8 ) |                                     \
+      (uint8_t)(nickname) )
+
+// Hard coded bit
+#define VSCP_CANID_HARDCODED_BIT    0x02000000UL
+
+/*!
+    \struct vscp_canframe_t
+    A received or outgoing CAN frame as held by a driver
+ */
+typedef struct {
+    uint32_t id;                // 29-bit id
+    uint8_t size;               // Number of data bytes
+    uint8_t data[ 8 ];
+} vscp_canframe_t;
+
+#endif /* _VSCP_CANID_H_ */
@@ -0,0 +1,310 @@
+// FILE: vscp_cantx.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "vscp_cantx.h"
+
+#if ( VSCP_CANTX_MAILBOXES < 1 ) || ( VSCP_CANTX_MAILBOXES > 8 )
+#error "VSCP_CANTX_MAILBOXES must be 1-8"
+#endif
+
+#if ( VSCP_CANTX_QUEUE_SIZE < 1 ) || ( VSCP_CANTX_QUEUE_SIZE > 254 )
+#error "VSCP_CANTX_QUEUE_SIZE must be 1-254"
+#endif
+
+#define NONE                0xff
+
+vscp_cantx_stats_t vscp_cantx_stats;
+
+// Frame slots. A slot stays allocated while its frame is in a mailbox so
+// an aborted frame can always be queued again.
+static vscp_cantx_frame_t frames[ VSCP_CANTX_QUEUE_SIZE ];
+static uint8_t next[ VSCP_CANTX_QUEUE_SIZE ];   // Next slot in list
+static uint8_t seq[ VSCP_CANTX_QUEUE_SIZE ];    // Queue order
+static uint8_t freeHead;                        // List of free slots
+static uint8_t used;                            // Allocated slots
+static uint8_t seqNext;
+
+// One list per priority
+static uint8_t head[ 8 ];
+static uint8_t tail[ 8 ];
+static uint8_t inFlight[ 8 ];                   // Frames in mailboxes
+
+// Mailboxes
+static uint8_t mbSlot[ VSCP_CANTX_MAILBOXES ];  // Slot or NONE if free
+static uint8_t mbAborting;                      // One bit per mailbox
+
+///////////////////////////////////////////////////////////////////////////////
+// isOlder
+//
+// Non zero if slot a was queued before slot b. Sequence numbers are
+// compared relative to the next one so they may wrap.
+//
+
+static int isOlder( uint8_t a, uint8_t b )
+{
+    return (uint8_t)( seq[ a ] - seqNext ) < (uint8_t)( seq[ b ] - seqNext );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// schedule
+//
+// Fill free mailboxes from the highest priority queues. If none is free
+// abort the lowest priority mailbox when a higher priority frame waits.
+// Called with interrupts disabled.
+//
+
+static void schedule( void )
+{
+    uint8_t p, q, mb, slot, worst;
+
+    for ( ;; ) {
+
+        // Highest priority frame that may be loaded
+        for ( p = 0; p < 8; p++ ) {
+#if VSCP_CANTX_KEEP_ORDER
+            if ( inFlight[ p ] ) continue;
+#endif
+            if ( NONE != head[ p ] ) break;
+        }
+
+        if ( p >= 8 ) return;
+
+        for ( mb = 0; mb < VSCP_CANTX_MAILBOXES; mb++ ) {
+            if ( NONE == mbSlot[ mb ] ) break;
+        }
+
+        if ( mb >= VSCP_CANTX_MAILBOXES ) {
+
+            // Wait for an abort already requested
+            if ( mbAborting ) return;
+
+            // Lowest priority frame in a mailbox
+            worst = 0;
+            for ( mb = 1; mb < VSCP_CANTX_MAILBOXES; mb++ ) {
+                if ( VSCP_CANTX_PRIORITY( frames[ mbSlot[ mb ] ].id ) >
+                        VSCP_CANTX_PRIORITY( frames[ mbSlot[ worst ] ].id ) ) {
+                    worst = mb;
+                }
+            }
+
+            if ( VSCP_CANTX_PRIORITY( frames[ mbSlot[ worst ] ].id ) > p ) {
+                mbAborting |= ( 1 << worst );
+                vscp_cantx_stats.cntAborts++;
+                vscp_cantx_abortMailbox( worst );
+            }
+
+            return;
+        }
+
+        slot = head[ p ];
+        head[ p ] = next[ slot ];
+        if ( NONE == head[ p ] ) tail[ p ] = NONE;
+
+        // Count it if an older frame with lower priority had to wait
+        for ( q = p + 1; q < 8; q++ ) {
+            if ( ( NONE != head[ q ] ) && isOlder( head[ q ], slot ) ) {
+                vscp_cantx_stats.cntReordered++;
+                break;
+            }
+        }
+
+        mbSlot[ mb ] = slot;
+        inFlight[ p ]++;
+        vscp_cantx_loadMailbox( mb, &frames[ slot ] );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// releaseMailbox
+//
+
+static uint8_t releaseMailbox( uint8_t mb )
+{
+    uint8_t slot = mbSlot[ mb ];
+
+    mbSlot[ mb ] = NONE;
+    mbAborting &= ~( 1 << mb );
+    inFlight[ VSCP_CANTX_PRIORITY( frames[ slot ].id ) ]--;
+
+    return slot;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_cantx_init
+//
+
+void vscp_cantx_init( void )
+{
+    uint8_t i;
+
+    VSCP_CANTX_ENTER_CRITICAL();
+
+    for ( i = 0; i < VSCP_CANTX_QUEUE_SIZE; i++ ) {
+        next[ i ] = ( i + 1 < VSCP_CANTX_QUEUE_SIZE ) ? i + 1 : NONE;
+    }
+    freeHead = 0;
+    used = 0;
+    seqNext = 0;
+
+    for ( i = 0; i < 8; i++ ) {
+        head[ i ] = NONE;
+        tail[ i ] = NONE;
+        inFlight[ i ] = 0;
+    }
+
+    for ( i = 0; i < VSCP_CANTX_MAILBOXES; i++ ) {
+        mbSlot[ i ] = NONE;
+    }
+    mbAborting = 0;
+
+    memset( &vscp_cantx_stats, 0, sizeof( vscp_cantx_stats ) );
+
+    VSCP_CANTX_LEAVE_CRITICAL();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_cantx_send
+//
+
+int8_t vscp_cantx_send( uint32_t id, uint8_t size, const uint8_t *pData )
+{
+    uint8_t slot, p;
+
+    if ( size > 8 ) size = 8;
+
+    VSCP_CANTX_ENTER_CRITICAL();
+
+    slot = freeHead;
+    if ( NONE == slot ) {
+        vscp_cantx_stats.cntOverruns++;
+        VSCP_CANTX_LEAVE_CRITICAL();
+        return 0;
+    }
+    freeHead = next[ slot ];
+    used++;
+
+    frames[ slot ].id = id & 0x1fffffff;
+    frames[ slot ].size = size;
+    if ( size ) memcpy( frames[ slot ].data, pData, size );
+    seq[ slot ] = seqNext++;
+
+    // Last in its priority list
+    p = VSCP_CANTX_PRIORITY( id );
+    next[ slot ] = NONE;
+    if ( NONE == tail[ p ] ) {
+        head[ p ] = slot;
+    }
+    else {
+        next[ tail[ p ] ] = slot;
+    }
+    tail[ p ] = slot;
+
+    schedule();
+
+    VSCP_CANTX_LEAVE_CRITICAL();
+
+    return 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_cantx_txDone
+//
+
+void vscp_cantx_txDone( uint8_t mb )
+{
+    uint8_t slot;
+
+    if ( mb >= VSCP_CANTX_MAILBOXES ) return;
+
+    VSCP_CANTX_ENTER_CRITICAL();
+
+    if ( NONE == mbSlot[ mb ] ) {
+        VSCP_CANTX_LEAVE_CRITICAL();
+        return;
+    }
+
+    slot = releaseMailbox( mb );
+    next[ slot ] = freeHead;
+    freeHead = slot;
+    used--;
+
+    vscp_cantx_stats.cntSent++;
+
+    schedule();
+
+    VSCP_CANTX_LEAVE_CRITICAL();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_cantx_txAborted
+//
+
+void vscp_cantx_txAborted( uint8_t mb )
+{
+    uint8_t slot, p;
+
+    if ( mb >= VSCP_CANTX_MAILBOXES ) return;
+
+    VSCP_CANTX_ENTER_CRITICAL();
+
+    if ( NONE == mbSlot[ mb ] ) {
+        VSCP_CANTX_LEAVE_CRITICAL();
+        return;
+    }
+
+    slot = releaseMailbox( mb );
+
+    // First in its priority list again, it is older than the rest
+    p = VSCP_CANTX_PRIORITY( frames[ slot ].id );
+    next[ slot ] = head[ p ];
+    head[ p ] = slot;
+    if ( NONE == tail[ p ] ) tail[ p ] = slot;
+
+    schedule();
+
+    VSCP_CANTX_LEAVE_CRITICAL();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_cantx_pending
+//
+
+uint8_t vscp_cantx_pending( void )
+{
+    return used;
+}
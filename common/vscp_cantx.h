@@ -0,0 +1,161 @@
+// FILE: vscp_cantx.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#ifndef _VSCP_CANTX_H_
+#define _VSCP_CANTX_H_
+
+#include <stdint.h>
+#include <vscp_projdefs.h>  // This file should be in your project folder
+#include <vscp_canid.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+    CAN transmit scheduler
+
+    Keeps one software queue for each of the eight VSCP priorities (bits
+    26-28 of the 29-bit id, 0 is the highest) and loads the hardware
+    transmit mailboxes from them highest priority first. Frames of the
+    same priority are sent in the order they were queued.
+
+    When all mailboxes are busy and a frame with higher priority than one
+    of them is queued, the mailbox holding the lowest priority frame is
+    aborted with vscp_cantx_abortMailbox. When the driver reports the abort
+    done the frame is put back first in its queue and the mailbox is
+    loaded with the higher priority frame. A low priority heartbeat can
+    therefore never keep an alarm waiting for a mailbox.
+
+    The driver implements the External Functions below and calls
+    vscp_cantx_txDone/vscp_cantx_txAborted from its transmit interrupt (or
+    when polling finds a mailbox empty). If those are called from an
+    interrupt define VSCP_CANTX_ENTER_CRITICAL/VSCP_CANTX_LEAVE_CRITICAL to
+    disable/enable that interrupt.
+
+    With VSCP_CANTX_KEEP_ORDER (default) only one frame of each priority is
+    in the mailboxes at a time. Controllers pick between pending mailboxes
+    by id or by mailbox number, not by queue order, so without this the
+    frames of a multi frame response could go out in the wrong order.
+*/
+
+#ifndef VSCP_CANTX_ENTER_CRITICAL
+#define VSCP_CANTX_ENTER_CRITICAL()
+#endif
+
+#ifndef VSCP_CANTX_LEAVE_CRITICAL
+#define VSCP_CANTX_LEAVE_CRITICAL()
+#endif
+
+// Number of hardware transmit mailboxes used (at most 8)
+#ifndef VSCP_CANTX_MAILBOXES
+#define VSCP_CANTX_MAILBOXES        3
+#endif
+
+// Frames that can be queued in software, shared by all priorities (< 255)
+#ifndef VSCP_CANTX_QUEUE_SIZE
+#define VSCP_CANTX_QUEUE_SIZE       16
+#endif
+
+#ifndef VSCP_CANTX_KEEP_ORDER
+#define VSCP_CANTX_KEEP_ORDER       1
+#endif
+
+// Priority of a 29-bit VSCP id
+#define VSCP_CANTX_PRIORITY( id )   VSCP_CANID_PRIORITY( id )
+
+typedef vscp_canframe_t vscp_cantx_frame_t;
+
+typedef struct {
+    uint32_t cntSent;           // Frames reported sent
+    uint32_t cntOverruns;       // Frames not queued because the queue was full
+    uint32_t cntAborts;         // Mailboxes aborted for a higher priority frame
+    uint32_t cntReordered;      // Frames loaded ahead of older lower priority frames
+} vscp_cantx_stats_t;
+
+// Priority inversions avoided = cntAborts + cntReordered
+extern vscp_cantx_stats_t vscp_cantx_stats;
+
+// Empty all queues, all mailboxes free, zero statistics
+void vscp_cantx_init( void );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_cantx_send
+//
+// Queue a frame and load the mailboxes if possible. Never blocks.
+//
+// @param id        29-bit id.
+// @param size      Number of data bytes (0-8).
+// @param pData     Data.
+// @return          Non zero if the frame was queued.
+//
+
+int8_t vscp_cantx_send( uint32_t id, uint8_t size, const uint8_t *pData );
+
+// The frame in mailbox mb has been sent
+void vscp_cantx_txDone( uint8_t mb );
+
+// The frame in mailbox mb was aborted as requested and not sent
+void vscp_cantx_txAborted( uint8_t mb );
+
+// Number of frames queued or in mailboxes
+uint8_t vscp_cantx_pending( void );
+
+// --------------------------- External Functions -----------------------------
+//
+// Implemented by the driver
+//
+// --------------------------- External Functions -----------------------------
+
+/*!
+    Load a free transmit mailbox and request transmission.
+    @param mb Mailbox (0 - VSCP_CANTX_MAILBOXES-1).
+    @param pFrame Frame to send.
+ */
+void vscp_cantx_loadMailbox( uint8_t mb, const vscp_cantx_frame_t *pFrame );
+
+/*!
+    Request abort of the transmission in a mailbox. Report the result
+    later with vscp_cantx_txAborted, or with vscp_cantx_txDone if the
+    frame was sent anyway. Must not call back into the scheduler
+    directly.
+    @param mb Mailbox.
+ */
+void vscp_cantx_abortMailbox( uint8_t mb );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VSCP_CANTX_H_ */
@@ -0,0 +1,394 @@
+// FILE: vscp_dm.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <vscp_firmware.h>
+#include "vscp_dm.h"
+
+#ifndef FALSE
+#define FALSE  0
+#endif
+
+#ifndef TRUE
+#define TRUE   !FALSE
+#endif
+
+#if ( VSCP_DM_BUCKETS & ( VSCP_DM_BUCKETS - 1 ) ) || ( VSCP_DM_ROWS > 256 )
+#error "VSCP_DM_BUCKETS must be a power of two and VSCP_DM_ROWS at most 256"
+#endif
+
+#define BUCKET_MASK     ( VSCP_DM_BUCKETS - 1 )
+
+// Enabled rows in row order
+static struct _dmrow dmrows[ VSCP_DM_ROWS ];
+static uint16_t cntRows;            // Rows in the decision matrix
+static uint16_t cntEnabled;         // Enabled rows in dmrows
+
+// Rows bucketed on class, dmrows index in row order within each bucket.
+// Bucket b is bucketrows[ bucketstart[ b ] ] to bucketrows[ bucketstart[ b + 1 ] - 1 ]
+static uint8_t bucketrows[ VSCP_DM_ROWS ];
+static uint16_t bucketstart[ VSCP_DM_BUCKETS + 1 ];
+
+// Rows that can match classes in more than one bucket
+static uint8_t wildrows[ VSCP_DM_ROWS ];
+static uint16_t cntWild;
+
+static uint8_t zone;
+static uint8_t subzone;
+static uint8_t bValid;
+static uint8_t generation;          // Increased on each rebuild
+
+// Rows matching the event being handled
+static uint8_t matchrows[ VSCP_DM_ROWS ];
+
+// Outbox
+typedef struct {
+    uint16_t vscp_class;
+    uint8_t vscp_type;
+    uint8_t priority;
+    uint8_t size;
+    uint8_t seq;                // Queue order within a priority
+    uint8_t data[ 8 ];
+} dmevent_t;
+
+static dmevent_t outbox[ VSCP_DM_OUTBOX_SIZE ];
+static uint8_t cntOutbox;
+static uint8_t outseq;
+
+///////////////////////////////////////////////////////////////////////////////
+// rowClassMask/rowClassFilter
+//
+// Nine bit class mask and filter of a row
+//
+
+static uint16_t rowClassMask( const struct _dmrow *pRow )
+{
+    return ( (uint16_t)( pRow->flags & VSCP_DM_FLAG_CLASS_MASK ) << 7 ) | pRow->class_mask;
+}
+
+static uint16_t rowClassFilter( const struct _dmrow *pRow )
+{
+    return ( (uint16_t)( pRow->flags & VSCP_DM_FLAG_CLASS_FILTER ) << 8 ) | pRow->class_filter;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// rowMatch
+//
+// Check a row against the event. The class bucket only narrows the search
+// so the full compare is always done.
+//
+
+static uint8_t rowMatch( const struct _dmrow *pRow, const vscpevent_t *pEvent )
+{
+    if ( ( pRow->flags & VSCP_DM_FLAG_CHECK_OADDR ) &&
+            ( pRow->oaddr != pEvent->oaddr ) ) {
+        return FALSE;
+    }
+
+    if ( ( ( pEvent->vscp_class ^ rowClassFilter( pRow ) ) & rowClassMask( pRow ) ) ||
+            ( ( pEvent->vscp_type ^ pRow->type_filter ) & pRow->type_mask ) ) {
+        return FALSE;
+    }
+
+    // Zone/subzone 255 is all zones/subzones. An event too short to
+    // carry them doesn't match.
+    if ( pRow->flags & VSCP_DM_FLAG_CHECK_ZONE ) {
+        if ( ( pEvent->flags & 0x0f ) < 2 ) return FALSE;
+        if ( ( 0xff != pEvent->data[ 1 ] ) && ( zone != pEvent->data[ 1 ] ) ) return FALSE;
+    }
+
+    if ( pRow->flags & VSCP_DM_FLAG_CHECK_SUBZONE ) {
+        if ( ( pEvent->flags & 0x0f ) < 3 ) return FALSE;
+        if ( ( 0xff != pEvent->data[ 2 ] ) && ( subzone != pEvent->data[ 2 ] ) ) return FALSE;
+    }
+
+    return TRUE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_init
+//
+
+void vscp_dm_init( uint16_t rows )
+{
+    cntRows = ( rows > VSCP_DM_ROWS ) ? VSCP_DM_ROWS : rows;
+    bValid = FALSE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_invalidate
+//
+
+void vscp_dm_invalidate( void )
+{
+    bValid = FALSE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_rebuild
+//
+
+void vscp_dm_rebuild( void )
+{
+    uint16_t cnt[ VSCP_DM_BUCKETS ];
+    uint16_t i, b;
+    struct _dmrow *pRow;
+
+    cntEnabled = 0;
+    cntWild = 0;
+    memset( cnt, 0, sizeof( cnt ) );
+
+    // Copy enabled rows and count the rows of each bucket
+    for ( i = 0; i < cntRows; i++ ) {
+
+        pRow = &dmrows[ cntEnabled ];
+        vscp_dm_loadRow( i, pRow );
+        if ( !( pRow->flags & VSCP_DM_FLAG_ENABLED ) ) continue;
+
+        if ( BUCKET_MASK == ( rowClassMask( pRow ) & BUCKET_MASK ) ) {
+            cnt[ rowClassFilter( pRow ) & BUCKET_MASK ]++;
+        }
+        else {
+            wildrows[ cntWild++ ] = cntEnabled;
+        }
+
+        cntEnabled++;
+    }
+
+    // Bucket start positions
+    bucketstart[ 0 ] = 0;
+    for ( b = 0; b < VSCP_DM_BUCKETS; b++ ) {
+        bucketstart[ b + 1 ] = bucketstart[ b ] + cnt[ b ];
+        cnt[ b ] = bucketstart[ b ];
+    }
+
+    // Place rows, this keeps row order within each bucket
+    for ( i = 0; i < cntEnabled; i++ ) {
+        pRow = &dmrows[ i ];
+        if ( BUCKET_MASK == ( rowClassMask( pRow ) & BUCKET_MASK ) ) {
+            bucketrows[ cnt[ rowClassFilter( pRow ) & BUCKET_MASK ]++ ] = i;
+        }
+    }
+
+    zone = vscp_getZone();
+    subzone = vscp_getSubzone();
+
+    generation++;
+    bValid = TRUE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_feed
+//
+
+uint16_t vscp_dm_feed( const vscpevent_t *pEvent )
+{
+    uint16_t b, bend, w, i;
+    uint16_t cntMatch = 0;
+    uint8_t row;
+
+    if ( !bValid ) vscp_dm_rebuild();
+
+    b = bucketstart[ pEvent->vscp_class & BUCKET_MASK ];
+    bend = bucketstart[ ( pEvent->vscp_class & BUCKET_MASK ) + 1 ];
+    w = 0;
+
+    // Merge bucket rows and wildcard rows so actions are done in row order
+    while ( ( b < bend ) || ( w < cntWild ) ) {
+
+        if ( ( w >= cntWild ) ||
+                ( ( b < bend ) && ( bucketrows[ b ] < wildrows[ w ] ) ) ) {
+            row = bucketrows[ b++ ];
+        }
+        else {
+            row = wildrows[ w++ ];
+        }
+
+        if ( rowMatch( &dmrows[ row ], pEvent ) ) {
+            matchrows[ cntMatch++ ] = row;
+        }
+    }
+
+    // Do the actions as one batch and send what they reported
+    for ( i = 0; i < cntMatch; i++ ) {
+        vscp_dm_doAction( &dmrows[ matchrows[ i ] ], pEvent );
+    }
+
+    if ( cntOutbox ) vscp_dm_flush();
+
+    return cntMatch;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_getEnabledRows
+//
+
+uint16_t vscp_dm_getEnabledRows( void )
+{
+    if ( !bValid ) vscp_dm_rebuild();
+    return cntEnabled;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_getEnabledRow
+//
+
+const struct _dmrow *vscp_dm_getEnabledRow( uint16_t idx )
+{
+    if ( !bValid ) vscp_dm_rebuild();
+    return ( idx < cntEnabled ) ? &dmrows[ idx ] : NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_getGeneration
+//
+
+uint8_t vscp_dm_getGeneration( void )
+{
+    if ( !bValid ) vscp_dm_rebuild();
+    return generation;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_sendEvent
+//
+
+uint8_t vscp_dm_sendEvent( uint16_t vscp_class,
+                            uint8_t vscp_type,
+                            uint8_t priority,
+                            uint8_t size,
+                            const uint8_t *pData )
+{
+    dmevent_t *pe;
+    uint8_t i;
+
+    if ( size > 8 ) size = 8;
+    priority &= 0x07;
+
+    // Several rows reporting the same thing is sent once
+    for ( i = 0; i < cntOutbox; i++ ) {
+        pe = &outbox[ i ];
+        if ( ( pe->vscp_class == vscp_class ) &&
+                ( pe->vscp_type == vscp_type ) &&
+                ( pe->size == size ) &&
+                !memcmp( pe->data, pData, size ) ) {
+            if ( priority < pe->priority ) pe->priority = priority;
+            return TRUE;
+        }
+    }
+
+    if ( cntOutbox >= VSCP_DM_OUTBOX_SIZE ) return FALSE;
+
+    pe = &outbox[ cntOutbox++ ];
+    pe->vscp_class = vscp_class;
+    pe->vscp_type = vscp_type;
+    pe->priority = priority;
+    pe->size = size;
+    pe->seq = outseq++;
+    memcpy( pe->data, pData, size );
+
+    return TRUE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_flush
+//
+
+void vscp_dm_flush( void )
+{
+    dmevent_t *pe;
+    uint8_t i, best;
+#ifdef VSCP_FIRMWARE_ENABLE_QUEUES
+    vscpevent_t omsg = vscp_omsg;   // May hold an event being built
+#endif
+
+    while ( cntOutbox ) {
+
+#ifdef VSCP_FIRMWARE_ENABLE_QUEUES
+        // Only move events while the transmit queue has room, equal events
+        // are still merged while they are kept here
+        if ( vscp_sendQueuedEvents() >= VSCP_TX_QUEUE_SIZE ) break;
+#endif
+
+        // Highest priority, oldest first
+        best = 0;
+        for ( i = 1; i < cntOutbox; i++ ) {
+            if ( ( outbox[ i ].priority < outbox[ best ].priority ) ||
+                    ( ( outbox[ i ].priority == outbox[ best ].priority ) &&
+                        ( (int8_t)( outbox[ i ].seq - outbox[ best ].seq ) < 0 ) ) ) {
+                best = i;
+            }
+        }
+
+        pe = &outbox[ best ];
+#ifdef VSCP_FIRMWARE_ENABLE_QUEUES
+        // Through the transmit queue so it is sent in priority order with
+        // all other events
+        vscp_omsg.flags = VSCP_VALID_MSG + pe->size;
+        vscp_omsg.priority = pe->priority;
+        vscp_omsg.vscp_class = pe->vscp_class;
+        vscp_omsg.vscp_type = pe->vscp_type;
+        memcpy( vscp_omsg.data, pe->data, pe->size );
+        vscp_sendEvent();
+#else
+        if ( !sendVSCPFrame( pe->vscp_class,
+                                pe->vscp_type,
+                                vscp_nickname,
+                                pe->priority,
+                                pe->size,
+                                pe->data ) ) {
+            // Driver is full, try again later
+            return;
+        }
+#endif
+
+        outbox[ best ] = outbox[ --cntOutbox ];
+    }
+
+#ifdef VSCP_FIRMWARE_ENABLE_QUEUES
+    vscp_omsg = omsg;
+#endif
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_getPending
+//
+
+uint8_t vscp_dm_getPending( void )
+{
+    return cntOutbox;
+}
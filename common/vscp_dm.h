@@ -0,0 +1,169 @@
+// FILE: vscp_dm.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#ifndef _VSCP_DM_H_
+#define _VSCP_DM_H_
+
+#include <stdint.h>
+#include <vscp_firmware.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+    Level I decision matrix
+
+    The enabled rows of the decision matrix are kept in RAM together with
+    an index that buckets them on the low bits of the class they match.
+    An event is only compared with the rows of its bucket and the rows
+    that match more than one bucket (class mask not covering the bucket
+    bits), so no storage is read when an event is dispatched. Matching
+    rows are handed to vscp_dm_doAction in row order.
+
+    The index is built from vscp_dm_loadRow. Call vscp_dm_invalidate when
+    a DM register or the zone/subzone changes (typically from
+    vscp_writeAppReg). The index is rebuilt on the next vscp_dm_feed so a
+    whole configuration download costs one rebuild.
+
+    All rows matching an event are found before any action is done, then
+    the actions are done as a batch. Actions report with
+    vscp_dm_sendEvent which queues the event in the DM outbox instead of
+    sending it through vscp_omsg. An event equal to one already queued is
+    only sent once. The outbox is sent with sendVSCPFrame when the batch
+    is done, highest priority first. With VSCP_FIRMWARE_ENABLE_QUEUES it
+    is moved to the transmit queue with vscp_sendEvent instead, so it is
+    ordered with all other events. Events the driver (or the full
+    transmit queue) can't take are kept and sent by vscp_dm_flush, which
+    vscp_doWork calls when VSCP_FIRMWARE_ENABLE_DM is defined.
+*/
+
+// Max number of rows
+#ifndef VSCP_DM_ROWS
+#define VSCP_DM_ROWS                16
+#endif
+
+// Number of class buckets. Must be a power of two.
+#ifndef VSCP_DM_BUCKETS
+#define VSCP_DM_BUCKETS             16
+#endif
+
+// Number of events the outbox can hold
+#ifndef VSCP_DM_OUTBOX_SIZE
+#define VSCP_DM_OUTBOX_SIZE         8
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_init
+//
+// @param rows  Number of rows in the decision matrix (<= VSCP_DM_ROWS).
+//
+
+void vscp_dm_init( uint16_t rows );
+
+// Rebuild the index before the next event is dispatched
+void vscp_dm_invalidate( void );
+
+// Rebuild the index now
+void vscp_dm_rebuild( void );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_feed
+//
+// Feed the decision matrix with an event. vscp_dm_doAction is called for
+// each matching row.
+//
+// @return  Number of matching rows.
+//
+
+uint16_t vscp_dm_feed( const vscpevent_t *pEvent );
+
+// Number of enabled rows in the index
+uint16_t vscp_dm_getEnabledRows( void );
+
+// Enabled row idx (0 - vscp_dm_getEnabledRows()-1) or NULL
+const struct _dmrow *vscp_dm_getEnabledRow( uint16_t idx );
+
+// Changes each time the index is rebuilt, so users of the enabled rows
+// (vscp_canfilt.h) can tell when the decision matrix has changed.
+uint8_t vscp_dm_getGeneration( void );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm_sendEvent
+//
+// Queue an event from an action. Sent from this node (vscp_nickname).
+//
+// @param priority  Priority 0-7 where 0 is highest.
+// @return          TRUE if queued or equal to a queued event. FALSE if
+//                  the outbox is full.
+//
+
+uint8_t vscp_dm_sendEvent( uint16_t vscp_class,
+                            uint8_t vscp_type,
+                            uint8_t priority,
+                            uint8_t size,
+                            const uint8_t *pData );
+
+// Send queued events, highest priority first, until the driver is full
+void vscp_dm_flush( void );
+
+// Number of queued events
+uint8_t vscp_dm_getPending( void );
+
+// --------------------------- External Functions -----------------------------
+//
+// Implemented by the application
+//
+// --------------------------- External Functions -----------------------------
+
+/*!
+    Read one decision matrix row from storage.
+    @param row Row to read.
+    @param pRow Pointer to row that will get the data.
+ */
+void vscp_dm_loadRow( uint16_t row, struct _dmrow *pRow );
+
+/*!
+    Perform the action of a matching row. Events should be sent with
+    vscp_dm_sendEvent.
+    @param pRow Row that matched.
+    @param pEvent Event that triggered the row.
+ */
+void vscp_dm_doAction( const struct _dmrow *pRow, const vscpevent_t *pEvent );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VSCP_DM_H_ */
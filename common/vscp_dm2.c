@@ -0,0 +1,301 @@
+// FILE: vscp_dm2.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "vscp.h"
+#include "vscp_dm2.h"
+
+#if ( VSCP_DM2_GUID_BUCKETS & ( VSCP_DM2_GUID_BUCKETS - 1 ) ) || ( VSCP_DM2_GUID_BUCKETS > 256 )
+#error "VSCP_DM2_GUID_BUCKETS must be a power of two (max 256)"
+#endif
+
+#if ( VSCP_DM2_PARAM_SIZE < 16 )
+#error "VSCP_DM2_PARAM_SIZE must be at least 16 to hold the GUID of GUID matched rows"
+#endif
+
+#define GUID_MASK   ( VSCP_DM2_GUID_BUCKETS - 1 )
+
+// Enabled rows in row order
+static vscp_dm2_row_t dmrows[ VSCP_DM2_ROWS ];
+static uint16_t cntRows;            // Rows in the decision matrix
+static uint16_t cntEnabled;         // Enabled rows in dmrows
+
+// Rows that don't match on GUID
+static uint16_t plainrows[ VSCP_DM2_ROWS ];
+static uint16_t cntPlain;
+
+// Rows that match on GUID, bucketed on GUID hash. Bucket b is
+// guidrows[ guidstart[ b ] ] to guidrows[ guidstart[ b + 1 ] - 1 ]
+static uint16_t guidrows[ VSCP_DM2_ROWS ];
+static uint16_t guidstart[ VSCP_DM2_GUID_BUCKETS + 1 ];
+
+static uint8_t zone;
+static uint8_t subzone;
+static uint8_t bValid;
+
+///////////////////////////////////////////////////////////////////////////////
+// guidHash
+//
+
+static uint8_t guidHash( const uint8_t *pGUID )
+{
+    uint8_t h = 0;
+    uint8_t i;
+
+    // Rotate and xor, GUID's on one segment often only differ in the
+    // last bytes
+    for ( i = 0; i < 16; i++ ) {
+        h = (uint8_t)( ( h << 1 ) | ( h >> 7 ) ) ^ pGUID[ i ];
+    }
+
+    return h & GUID_MASK;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// decodeRow
+//
+
+static void decodeRow( vscp_dm2_row_t *pRow, const uint8_t *p, uint16_t row )
+{
+    uint32_t filter;
+
+    pRow->control = ( (uint32_t)p[ VSCP_DM2_POS_CONTROL ] << 24 ) |
+                    ( (uint32_t)p[ VSCP_DM2_POS_CONTROL + 1 ] << 16 ) |
+                    ( (uint32_t)p[ VSCP_DM2_POS_CONTROL + 2 ] << 8 ) |
+                    p[ VSCP_DM2_POS_CONTROL + 3 ];
+
+    pRow->mask = ( (uint32_t)p[ VSCP_DM2_POS_CLASSMASK ] << 24 ) |
+                    ( (uint32_t)p[ VSCP_DM2_POS_CLASSMASK + 1 ] << 16 ) |
+                    ( (uint32_t)p[ VSCP_DM2_POS_TYPEMASK ] << 8 ) |
+                    p[ VSCP_DM2_POS_TYPEMASK + 1 ];
+
+    filter = ( (uint32_t)p[ VSCP_DM2_POS_CLASSFILTER ] << 24 ) |
+                    ( (uint32_t)p[ VSCP_DM2_POS_CLASSFILTER + 1 ] << 16 ) |
+                    ( (uint32_t)p[ VSCP_DM2_POS_TYPEFILTER ] << 8 ) |
+                    p[ VSCP_DM2_POS_TYPEFILTER + 1 ];
+
+    // Filter bits outside the mask never take part in a compare
+    pRow->filter = filter & pRow->mask;
+
+    pRow->action = ( (uint16_t)p[ VSCP_DM2_POS_ACTION ] << 8 ) |
+                    p[ VSCP_DM2_POS_ACTION + 1 ];
+
+    pRow->row = row;
+    memcpy( pRow->param, p + VSCP_DM2_POS_PARAM, VSCP_DM2_PARAM_SIZE );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// rowMatch
+//
+
+static uint8_t rowMatch( const vscp_dm2_row_t *pRow,
+                            uint16_t vscp_class,
+                            const uint8_t *pData,
+                            uint16_t sizeData )
+{
+    // Zone and subzone are only in Level I style events. 255 is all.
+    if ( pRow->control & VSCP_DM_CONTROL_MATCH_ZONE ) {
+        if ( ( vscp_class >= 1024 ) || ( sizeData < 2 ) ) return 0;
+        if ( ( 0xff != pData[ 1 ] ) && ( zone != pData[ 1 ] ) ) return 0;
+    }
+
+    if ( pRow->control & VSCP_DM_CONTROL_MATCH_SUBZONE ) {
+        if ( ( vscp_class >= 1024 ) || ( sizeData < 3 ) ) return 0;
+        if ( ( 0xff != pData[ 2 ] ) && ( subzone != pData[ 2 ] ) ) return 0;
+    }
+
+    return 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_feedData
+//
+
+uint16_t vscp_dm2_feedData( uint16_t vscp_class,
+                            uint16_t vscp_type,
+                            const uint8_t *pGUID,
+                            const uint8_t *pData,
+                            uint16_t sizeData )
+{
+    uint32_t key = ( (uint32_t)vscp_class << 16 ) | vscp_type;
+    uint16_t g, gend, p;
+    uint16_t idx;
+    uint16_t cntMatch = 0;
+    uint8_t h;
+    const vscp_dm2_row_t *pRow;
+
+    if ( !bValid ) vscp_dm2_rebuild();
+
+    h = guidHash( pGUID );
+    g = guidstart[ h ];
+    gend = guidstart[ h + 1 ];
+    p = 0;
+
+    // Merge GUID rows and other rows so actions are done in row order
+    while ( ( g < gend ) || ( p < cntPlain ) ) {
+
+        if ( ( p >= cntPlain ) ||
+                ( ( g < gend ) && ( guidrows[ g ] < plainrows[ p ] ) ) ) {
+            idx = guidrows[ g++ ];
+            pRow = &dmrows[ idx ];
+            if ( ( key & pRow->mask ) != pRow->filter ) continue;
+            if ( memcmp( pGUID, pRow->param, 16 ) ) continue;
+        }
+        else {
+            idx = plainrows[ p++ ];
+            pRow = &dmrows[ idx ];
+            if ( ( key & pRow->mask ) != pRow->filter ) continue;
+        }
+
+        if ( !rowMatch( pRow, vscp_class, pData, sizeData ) ) continue;
+
+        cntMatch++;
+        vscp_dm2_doAction( pRow, vscp_class, vscp_type, pData, sizeData );
+    }
+
+    return cntMatch;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_init
+//
+
+void vscp_dm2_init( uint16_t rows )
+{
+    cntRows = ( rows > VSCP_DM2_ROWS ) ? VSCP_DM2_ROWS : rows;
+    bValid = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_invalidate
+//
+
+void vscp_dm2_invalidate( void )
+{
+    bValid = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_rebuild
+//
+
+void vscp_dm2_rebuild( void )
+{
+    uint8_t buf[ VSCP_DM2_ROW_SIZE ];
+    uint16_t cnt[ VSCP_DM2_GUID_BUCKETS ];
+    uint16_t i, b;
+    vscp_dm2_row_t *pRow;
+
+    cntEnabled = 0;
+    cntPlain = 0;
+    memset( cnt, 0, sizeof( cnt ) );
+
+    // Decode enabled rows and count the GUID rows of each bucket
+    for ( i = 0; i < cntRows; i++ ) {
+
+        vscp_dm2_loadRow( i, buf );
+        if ( !( buf[ VSCP_DM2_POS_CONTROL ] & ( VSCP_DM_CONTROL_ENABLED >> 24 ) ) ) continue;
+
+        pRow = &dmrows[ cntEnabled ];
+        decodeRow( pRow, buf, i );
+
+        if ( pRow->control & VSCP_DM_CONTROL_MATCH_GUID ) {
+            cnt[ guidHash( pRow->param ) ]++;
+        }
+        else {
+            plainrows[ cntPlain++ ] = cntEnabled;
+        }
+
+        cntEnabled++;
+    }
+
+    // Bucket start positions
+    guidstart[ 0 ] = 0;
+    for ( b = 0; b < VSCP_DM2_GUID_BUCKETS; b++ ) {
+        guidstart[ b + 1 ] = guidstart[ b ] + cnt[ b ];
+        cnt[ b ] = guidstart[ b ];
+    }
+
+    // Place GUID rows, this keeps row order within each bucket
+    for ( i = 0; i < cntEnabled; i++ ) {
+        pRow = &dmrows[ i ];
+        if ( pRow->control & VSCP_DM_CONTROL_MATCH_GUID ) {
+            guidrows[ cnt[ guidHash( pRow->param ) ]++ ] = i;
+        }
+    }
+
+    zone = vscp_dm2_getZone();
+    subzone = vscp_dm2_getSubzone();
+
+    bValid = 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_feed
+//
+
+uint16_t vscp_dm2_feed( const vscpEvent *pEvent )
+{
+    return vscp_dm2_feedData( pEvent->vscp_class,
+                                pEvent->vscp_type,
+                                pEvent->GUID,
+                                pEvent->pdata,
+                                pEvent->sizeData );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_feedEx
+//
+
+uint16_t vscp_dm2_feedEx( const vscpEventEx *pEventEx )
+{
+    return vscp_dm2_feedData( pEventEx->vscp_class,
+                                pEventEx->vscp_type,
+                                pEventEx->GUID,
+                                pEventEx->data,
+                                pEventEx->sizeData );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_getEnabledRows
+//
+
+uint16_t vscp_dm2_getEnabledRows( void )
+{
+    if ( !bValid ) vscp_dm2_rebuild();
+    return cntEnabled;
+}
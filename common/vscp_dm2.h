@@ -0,0 +1,191 @@
+// FILE: vscp_dm2.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#ifndef _VSCP_DM2_H_
+#define _VSCP_DM2_H_
+
+#include <stdint.h>
+#include <vscp_projdefs.h>  // This file should be in your project folder
+#include "vscp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+    Level II decision matrix
+
+    A row is stored as VSCP_DM2_ROW_SIZE bytes, multi byte values MSB first
+
+        0-3     Control (VSCP_DM_CONTROL_*)
+        4-5     Class mask
+        6-7     Class filter
+        8-9     Type mask
+        10-11   Type filter
+        12-13   Action
+        14-     Action parameter (VSCP_DM2_PARAM_SIZE bytes). For rows with
+                VSCP_DM_CONTROL_MATCH_GUID the first 16 bytes is the GUID
+                to match.
+
+    Enabled rows are decoded once into RAM with class and type combined
+    into one 32-bit key/mask so the class/type test is a single compare.
+    Rows that match on GUID are hashed on the GUID and only the rows in the
+    bucket of the GUID of the event are compared with it. Matching rows
+    are handed to vscp_dm2_doAction in row order.
+
+    Call vscp_dm2_invalidate when a DM register or the zone/subzone
+    changes. The rows are read again on the next event.
+*/
+
+// Control bits
+#define VSCP_DM_CONTROL_ENABLED         0x80000000  // Row is enabled
+#define VSCP_DM_CONTROL_MATCH_GUID      0x00000008  // GUID must match
+#define VSCP_DM_CONTROL_MATCH_ZONE      0x00000004  // Zone must match
+#define VSCP_DM_CONTROL_MATCH_SUBZONE   0x00000002  // Subzone must match
+
+// Row layout
+#define VSCP_DM2_POS_CONTROL            0
+#define VSCP_DM2_POS_CLASSMASK          4
+#define VSCP_DM2_POS_CLASSFILTER        6
+#define VSCP_DM2_POS_TYPEMASK           8
+#define VSCP_DM2_POS_TYPEFILTER         10
+#define VSCP_DM2_POS_ACTION             12
+#define VSCP_DM2_POS_PARAM              14
+
+// Size of action parameter
+#ifndef VSCP_DM2_PARAM_SIZE
+#define VSCP_DM2_PARAM_SIZE             16
+#endif
+
+#define VSCP_DM2_ROW_SIZE               ( VSCP_DM2_POS_PARAM + VSCP_DM2_PARAM_SIZE )
+
+// Max number of rows
+#ifndef VSCP_DM2_ROWS
+#define VSCP_DM2_ROWS                   16
+#endif
+
+// Number of GUID hash buckets. Must be a power of two.
+#ifndef VSCP_DM2_GUID_BUCKETS
+#define VSCP_DM2_GUID_BUCKETS           16
+#endif
+
+/*!
+    Decoded decision matrix row
+ */
+typedef struct {
+    uint32_t control;                       // Control bits
+    uint32_t mask;                          // Class (MSW) and type (LSW) mask
+    uint32_t filter;                        // Class and type filter, masked
+    uint16_t action;                        // Action code
+    uint16_t row;                           // Row number in storage
+    uint8_t param[ VSCP_DM2_PARAM_SIZE ];   // Action parameter
+} vscp_dm2_row_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_init
+//
+// @param rows  Number of rows in the decision matrix (<= VSCP_DM2_ROWS).
+//
+
+void vscp_dm2_init( uint16_t rows );
+
+// Read the rows again before the next event is handled
+void vscp_dm2_invalidate( void );
+
+// Read the rows now
+void vscp_dm2_rebuild( void );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_feed
+//
+// Feed the decision matrix with an event. vscp_dm2_doAction is called
+// for each matching row.
+//
+// @return  Number of matching rows.
+//
+
+uint16_t vscp_dm2_feed( const vscpEvent *pEvent );
+
+// Same for vscpEventEx
+uint16_t vscp_dm2_feedEx( const vscpEventEx *pEventEx );
+
+// Same for an event held in some other layout, for example one with
+// the data in an array
+uint16_t vscp_dm2_feedData( uint16_t vscp_class,
+                            uint16_t vscp_type,
+                            const uint8_t *pGUID,
+                            const uint8_t *pData,
+                            uint16_t sizeData );
+
+// Number of enabled rows
+uint16_t vscp_dm2_getEnabledRows( void );
+
+// --------------------------- External Functions -----------------------------
+//
+// Implemented by the application
+//
+// --------------------------- External Functions -----------------------------
+
+/*!
+    Read one decision matrix row from storage.
+    @param row Row to read.
+    @param pRow Buffer that gets VSCP_DM2_ROW_SIZE bytes.
+ */
+void vscp_dm2_loadRow( uint16_t row, uint8_t *pRow );
+
+/*!
+    Get zone/subzone of this node. Read when the rows are read.
+ */
+uint8_t vscp_dm2_getZone( void );
+uint8_t vscp_dm2_getSubzone( void );
+
+/*!
+    Perform the action of a matching row.
+    @param pRow Row that matched.
+    @param vscp_class Class of the event.
+    @param vscp_type Type of the event.
+    @param pData Event data.
+    @param sizeData Number of data bytes.
+ */
+void vscp_dm2_doAction( const vscp_dm2_row_t *pRow,
+                            uint16_t vscp_class,
+                            uint16_t vscp_type,
+                            const uint8_t *pData,
+                            uint16_t sizeData );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VSCP_DM2_H_ */
@@ -0,0 +1,203 @@
+// FILE: vscp_evring.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "vscp.h"
+#include "vscp_evring.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_init
+//
+
+void vscp_evring_init( vscp_evring_t *ring, 
+                        vscpEventEx *slots, 
+                        uint16_t size, 
+                        uint8_t policy )
+{
+    VSCP_EVRING_ENTER_CRITICAL();
+    ring->slots = slots;
+    ring->size = size;
+    ring->head = 0;
+    ring->tail = 0;
+    ring->used = 0;
+    ring->busy = 0;
+    ring->filling = 0;
+    ring->policy = policy;
+    ring->highWater = 0;
+    ring->cntOverruns = 0;
+    VSCP_EVRING_LEAVE_CRITICAL();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_count
+//
+
+uint16_t vscp_evring_count( vscp_evring_t *ring )
+{
+    uint16_t used;
+
+    VSCP_EVRING_ENTER_CRITICAL();
+    used = ring->used;
+    VSCP_EVRING_LEAVE_CRITICAL();
+
+    return used;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_empty
+//
+
+int vscp_evring_empty( vscp_evring_t *ring )
+{
+    return ( 0 == vscp_evring_count( ring ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_full
+//
+
+int vscp_evring_full( vscp_evring_t *ring )
+{
+    return ( vscp_evring_count( ring ) >= ring->size );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_getEnqueuePtr
+//
+
+vscpEventEx *vscp_evring_getEnqueuePtr( vscp_evring_t *ring )
+{
+    vscpEventEx *pex = NULL;
+
+    VSCP_EVRING_ENTER_CRITICAL();
+
+    if ( ring->used < ring->size ) {
+        pex = &ring->slots[ ring->head ];
+    }
+    else if ( ( VSCP_EVRING_DROP_OLDEST == ring->policy ) && 
+                ring->size && !ring->busy ) {
+        // Full so head is the slot of the oldest event. It is dropped 
+        // when the new event is committed
+        ring->filling = 1;
+        pex = &ring->slots[ ring->head ];
+    }
+    else {
+        ring->cntOverruns++;
+    }
+
+    VSCP_EVRING_LEAVE_CRITICAL();
+
+    return pex;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_enqueue
+//
+
+void vscp_evring_enqueue( vscp_evring_t *ring )
+{
+    VSCP_EVRING_ENTER_CRITICAL();
+    if ( ring->filling ) {
+        // The new event replaced the oldest one
+        ring->filling = 0;
+        ring->cntOverruns++;
+        if ( ++ring->tail >= ring->size ) ring->tail = 0;
+    }
+    else {
+        ring->used++;
+    }
+    if ( ++ring->head >= ring->size ) ring->head = 0;
+    if ( ring->used > ring->highWater ) ring->highWater = ring->used;
+    VSCP_EVRING_LEAVE_CRITICAL();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_getDequeuePtr
+//
+
+vscpEventEx *vscp_evring_getDequeuePtr( vscp_evring_t *ring )
+{
+    vscpEventEx *pex = NULL;
+
+    VSCP_EVRING_ENTER_CRITICAL();
+    if ( ring->used && !ring->filling ) {
+        pex = &ring->slots[ ring->tail ];
+        ring->busy = 1;
+    }
+    VSCP_EVRING_LEAVE_CRITICAL();
+
+    return pex;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_dequeue
+//
+
+void vscp_evring_dequeue( vscp_evring_t *ring )
+{
+    VSCP_EVRING_ENTER_CRITICAL();
+    if ( ring->busy ) {
+        ring->busy = 0;
+        ring->used--;
+        if ( ++ring->tail >= ring->size ) ring->tail = 0;
+    }
+    VSCP_EVRING_LEAVE_CRITICAL();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_clear
+//
+
+void vscp_evring_clear( vscp_evring_t *ring )
+{
+    VSCP_EVRING_ENTER_CRITICAL();
+    ring->head = 0;
+    ring->tail = 0;
+    ring->used = 0;
+    VSCP_EVRING_LEAVE_CRITICAL();
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_clearStatistics
+//
+
+void vscp_evring_clearStatistics( vscp_evring_t *ring )
+{
+    VSCP_EVRING_ENTER_CRITICAL();
+    ring->highWater = ring->used;
+    ring->cntOverruns = 0;
+    VSCP_EVRING_LEAVE_CRITICAL();
+}
@@ -0,0 +1,143 @@
+// FILE: vscp_evring.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#ifndef _VSCP_EVRING_H_
+#define _VSCP_EVRING_H_
+
+#include <stdint.h>
+#include "vscp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+    Event ring
+
+    Fixed capacity queue of vscpEventEx slots. Events are built and consumed
+    in place: get a slot with vscp_evring_getEnqueuePtr, fill it and commit it
+    with vscp_evring_enqueue. On the other side vscp_evring_getDequeuePtr
+    gives the oldest event which is released with vscp_evring_dequeue when
+    done. 
+
+    If the ring is used from both interrupt and main level define 
+    VSCP_EVRING_ENTER_CRITICAL/VSCP_EVRING_LEAVE_CRITICAL to disable/enable
+    interrupts. With VSCP_EVRING_DROP_OLDEST the slot of the oldest event is
+    handed out when the ring is full and that event is dropped when the new
+    one is committed. The consumer does not get the slot while it is being
+    filled, and if the consumer holds it the new event is dropped instead.
+    A slot that is never committed holds the consumer back.
+*/
+
+#ifndef VSCP_EVRING_ENTER_CRITICAL
+#define VSCP_EVRING_ENTER_CRITICAL()
+#endif
+
+#ifndef VSCP_EVRING_LEAVE_CRITICAL
+#define VSCP_EVRING_LEAVE_CRITICAL()
+#endif
+
+// Overflow policies
+#define VSCP_EVRING_DROP_NEWEST     0   // New event is discarded when full
+#define VSCP_EVRING_DROP_OLDEST     1   // Oldest event is discarded when full
+
+typedef struct {
+    vscpEventEx *slots;         // Event storage
+    uint16_t size;              // Number of slots
+    volatile uint16_t head;     // Next slot to enqueue
+    volatile uint16_t tail;     // Next slot to dequeue
+    volatile uint16_t used;     // Number of queued events
+    volatile uint8_t busy;      // Consumer holds the tail slot
+    volatile uint8_t filling;   // Producer fills the tail slot of a full ring
+    uint8_t policy;             // Overflow policy
+    uint16_t highWater;         // Max number of queued events seen
+    uint32_t cntOverruns;       // Number of dropped events
+} vscp_evring_t;
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_init
+//
+// @param ring      Ring to initialize.
+// @param slots     Array with size events used as storage.
+// @param size      Number of events the ring can hold.
+// @param policy    VSCP_EVRING_DROP_NEWEST or VSCP_EVRING_DROP_OLDEST.
+//
+
+void vscp_evring_init( vscp_evring_t *ring, 
+                        vscpEventEx *slots, 
+                        uint16_t size, 
+                        uint8_t policy );
+
+// Number of queued events
+uint16_t vscp_evring_count( vscp_evring_t *ring );
+
+// Non zero if ring is empty
+int vscp_evring_empty( vscp_evring_t *ring );
+
+// Non zero if ring is full
+int vscp_evring_full( vscp_evring_t *ring );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_evring_getEnqueuePtr
+//
+// Get the slot for the next event. When the ring is full NULL is returned
+// and the overrun counter is increased (drop newest). With drop oldest the
+// slot of the oldest event is returned, that event is dropped and counted
+// as an overrun when the new one is committed. If the consumer holds the
+// oldest event NULL is returned and the overrun counter is increased.
+//
+
+vscpEventEx *vscp_evring_getEnqueuePtr( vscp_evring_t *ring );
+
+// Commit the slot obtained with vscp_evring_getEnqueuePtr
+void vscp_evring_enqueue( vscp_evring_t *ring );
+
+// Get the oldest event or NULL if the ring is empty or the producer is
+// filling the slot of the oldest event
+vscpEventEx *vscp_evring_getDequeuePtr( vscp_evring_t *ring );
+
+// Release the slot obtained with vscp_evring_getDequeuePtr
+void vscp_evring_dequeue( vscp_evring_t *ring );
+
+// Discard all queued events
+void vscp_evring_clear( vscp_evring_t *ring );
+
+// Reset high water mark and overrun counter
+void vscp_evring_clearStatistics( vscp_evring_t *ring );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VSCP_EVRING_H_ */
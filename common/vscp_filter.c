@@ -0,0 +1,199 @@
+// FILE: vscp_filter.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#include <string.h>
+#include <stdint.h>
+
+#include "vscp.h"
+#include "vscp_filter.h"
+
+///////////////////////////////////////////////////////////////////////////////
+// makeKey
+//
+// Combine priority, class and type into one key
+//
+
+static uint64_t makeKey( uint8_t priority, uint16_t vscp_class, uint16_t vscp_type )
+{
+    return ( (uint64_t)priority << 32 ) | 
+            ( (uint32_t)vscp_class << 16 ) | 
+            vscp_type;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// loadGuid
+//
+// Load a 16 byte GUID as two 64-bit words. Works on unaligned data and the
+// byte order does not matter as filter and event are loaded the same way.
+//
+
+static void loadGuid( const uint8_t *guid, uint64_t *pwords )
+{
+    memcpy( pwords, guid, 16 );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// matchKey
+//
+
+static int matchKey( const vscpCompiledFilter *pCompiled, 
+                        uint64_t key, 
+                        const uint64_t *pguid )
+{
+    return ( ( ( key & pCompiled->mask ) == pCompiled->filter ) &&
+             ( ( pguid[0] & pCompiled->mask_GUID[0] ) == pCompiled->filter_GUID[0] ) &&
+             ( ( pguid[1] & pCompiled->mask_GUID[1] ) == pCompiled->filter_GUID[1] ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_filter_compile
+//
+
+int vscp_filter_compile( const vscpEventFilter *pFilter, 
+                            vscpCompiledFilter *pCompiled )
+{
+    // Check pointers
+    if ( NULL == pFilter ) return VSCP_ERROR_INVALID_POINTER;
+    if ( NULL == pCompiled ) return VSCP_ERROR_INVALID_POINTER;
+
+    pCompiled->mask = makeKey( pFilter->mask_priority, 
+                                pFilter->mask_class, 
+                                pFilter->mask_type );
+    pCompiled->filter = makeKey( pFilter->filter_priority, 
+                                    pFilter->filter_class, 
+                                    pFilter->filter_type ) & pCompiled->mask;
+
+    loadGuid( pFilter->mask_GUID, pCompiled->mask_GUID );
+    loadGuid( pFilter->filter_GUID, pCompiled->filter_GUID );
+    pCompiled->filter_GUID[0] &= pCompiled->mask_GUID[0];
+    pCompiled->filter_GUID[1] &= pCompiled->mask_GUID[1];
+
+    return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_filter_clear
+//
+
+void vscp_filter_clear( vscpCompiledFilter *pCompiled )
+{
+    if ( NULL == pCompiled ) return;
+    memset( pCompiled, 0, sizeof( vscpCompiledFilter ) );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_filter_match
+//
+
+int vscp_filter_match( const vscpCompiledFilter *pCompiled, 
+                        const vscpEvent *pEvent )
+{
+    uint64_t guid[2];
+
+    // No filter or no event
+    if ( NULL == pCompiled ) return 1;
+    if ( NULL == pEvent ) return 0;
+
+    loadGuid( pEvent->GUID, guid );
+    return matchKey( pCompiled, 
+                        makeKey( ( pEvent->head >> 5 ) & 0x07, 
+                                    pEvent->vscp_class, 
+                                    pEvent->vscp_type ),
+                        guid );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_filter_matchEx
+//
+
+int vscp_filter_matchEx( const vscpCompiledFilter *pCompiled, 
+                            const vscpEventEx *pEventEx )
+{
+    uint64_t guid[2];
+
+    // No filter or no event
+    if ( NULL == pCompiled ) return 1;
+    if ( NULL == pEventEx ) return 0;
+
+    loadGuid( pEventEx->GUID, guid );
+    return matchKey( pCompiled, 
+                        makeKey( ( pEventEx->head >> 5 ) & 0x07, 
+                                    pEventEx->vscp_class, 
+                                    pEventEx->vscp_type ),
+                        guid );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_filter_matchBatch
+//
+
+uint32_t vscp_filter_matchBatch( const vscpCompiledFilter *pFilters,
+                                    uint16_t nFilters,
+                                    const vscpEvent * const *ppEvents,
+                                    uint16_t nEvents,
+                                    uint8_t *pMatch )
+{
+    uint16_t e, f;
+    uint16_t rowsize = VSCP_FILTER_ROW_SIZE( nFilters );
+    uint32_t cnt = 0;
+    uint64_t key;
+    uint64_t guid[2];
+
+    // Check pointers
+    if ( ( NULL == pFilters ) || ( NULL == ppEvents ) || ( NULL == pMatch ) ) {
+        return 0;
+    }
+
+    memset( pMatch, 0, (size_t)rowsize * nEvents );
+
+    for ( e=0; e<nEvents; e++ ) {
+
+        if ( NULL == ppEvents[e] ) continue;
+
+        // Load event once for all filters
+        key = makeKey( ( ppEvents[e]->head >> 5 ) & 0x07, 
+                            ppEvents[e]->vscp_class, 
+                            ppEvents[e]->vscp_type );
+        loadGuid( ppEvents[e]->GUID, guid );
+
+        for ( f=0; f<nFilters; f++ ) {
+            if ( matchKey( &pFilters[f], key, guid ) ) {
+                pMatch[ e * rowsize + ( f >> 3 ) ] |= ( 1 << ( f & 7 ) );
+                cnt++;
+            }
+        }
+    }
+
+    return cnt;
+}
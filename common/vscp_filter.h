@@ -0,0 +1,137 @@
+// FILE: vscp_filter.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#ifndef _VSCP_FILTER_H_
+#define _VSCP_FILTER_H_
+
+#include <stdint.h>
+#include "vscp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+    Compiled filter
+
+    A vscpEventFilter prepared for fast evaluation. Priority, class and 
+    type are combined into one 64-bit key (priority << 32 | class << 16 | type)
+    and the GUID is held as two 64-bit words so an event is tested with 
+    three masked compares instead of a byte by byte loop.
+*/
+
+typedef struct {
+    uint64_t mask;              // Combined priority/class/type mask
+    uint64_t filter;            // Combined priority/class/type filter (masked)
+    uint64_t mask_GUID[2];      // GUID mask as two 64-bit words
+    uint64_t filter_GUID[2];    // GUID filter as two 64-bit words (masked)
+} vscpCompiledFilter;
+
+// Number of bytes needed for the match bitmap of one event when
+// evaluated against n filters with vscp_filter_matchBatch
+#define VSCP_FILTER_ROW_SIZE(n)     ( ( (n) + 7 ) / 8 )
+
+// Test bit for filter f in a match bitmap row
+#define VSCP_FILTER_IS_MATCH(row,f) ( (row)[ (f) >> 3 ] & ( 1 << ( (f) & 7 ) ) )
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_filter_compile
+//
+// Compile a filter/mask pair for fast evaluation.
+//
+// @param pFilter   Filter to compile.
+// @param pCompiled Compiled filter.
+// @return VSCP_ERROR_SUCCESS on success.
+//
+
+int vscp_filter_compile( const vscpEventFilter *pFilter, 
+                            vscpCompiledFilter *pCompiled );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_filter_clear
+//
+// Set a compiled filter that let all events through.
+//
+
+void vscp_filter_clear( vscpCompiledFilter *pCompiled );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_filter_match
+//
+// Check if an event passes a compiled filter.
+//
+// @param pCompiled Compiled filter.
+// @param pEvent    Event to test.
+// @return Non zero if the event passes the filter.
+//
+
+int vscp_filter_match( const vscpCompiledFilter *pCompiled, 
+                        const vscpEvent *pEvent );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_filter_matchEx
+//
+// Check if an ex event passes a compiled filter.
+//
+
+int vscp_filter_matchEx( const vscpCompiledFilter *pCompiled, 
+                            const vscpEventEx *pEventEx );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_filter_matchBatch
+//
+// Evaluate a set of compiled filters (typically one per session) against
+// a batch of events. The key and GUID of each event is only loaded once.
+//
+// @param pFilters  Array with nFilters compiled filters.
+// @param nFilters  Number of filters.
+// @param ppEvents  Array with nEvents event pointers.
+// @param nEvents   Number of events.
+// @param pMatch    Match bitmap. One row of VSCP_FILTER_ROW_SIZE(nFilters) 
+//                  bytes per event where bit f is set if the event passed 
+//                  filter f.
+// @return Total number of matches.
+//
+
+uint32_t vscp_filter_matchBatch( const vscpCompiledFilter *pFilters,
+                                    uint16_t nFilters,
+                                    const vscpEvent * const *ppEvents,
+                                    uint16_t nEvents,
+                                    uint8_t *pMatch );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VSCP_FILTER_H_ */
@@ -39,6 +39,15 @@
 #include <vscp_class.h>
 #include <vscp_type.h>
 #include <vscp_firmware.h>
+#ifdef VSCP_FIRMWARE_ENABLE_REGCACHE
+#include <vscp_regcache.h>
+#endif
+#ifdef VSCP_FIRMWARE_ENABLE_DM
+#include <vscp_dm.h>
+#endif
+#ifdef VSCP_FIRMWARE_ENABLE_CANFILT
+#include <vscp_canfilt.h>
+#endif
 
 #ifndef FALSE
 #define FALSE  0
@@ -110,6 +119,35 @@ uint8_t vscp_second;
 uint8_t vscp_minute;
 uint8_t vscp_hour;
 
+// Extended page read in progress. The response frames are sent from
+// vscp_doWork() so the main loop is not held up while they are paced.
+static struct {
+    uint16_t page;          // Page to read from
+    uint16_t left;          // Registers left to send, zero if idle
+    uint8_t reg;            // Next register to send
+    uint8_t index;          // Index of next response frame
+    uint16_t sendtimer;     // vscp_timer when last frame was sent
+} vscp_xpr;
+
+#ifdef VSCP_FIRMWARE_ENABLE_QUEUES
+
+// Outgoing events waiting for the driver. Slots are unordered, the event
+// with the highest priority (lowest value) and then the lowest sequence
+// number is sent first.
+static struct {
+    vscpevent_t ev;
+    uint8_t seq;            // Enqueue order
+} vscp_txq[ VSCP_TX_QUEUE_SIZE ];
+static uint8_t vscp_txcnt;  // Used slots
+static uint8_t vscp_txseq;  // Next sequence number
+
+// Incoming events read from the driver but not yet in vscp_imsg (FIFO)
+static vscpevent_t vscp_rxq[ VSCP_RX_QUEUE_SIZE ];
+static uint8_t vscp_rxhead; // Oldest event
+static uint8_t vscp_rxcnt;  // Used slots
+
+#endif
+
 
 ///////////////////////////////////////////////////////////////////////////////
 // vscp_init
@@ -152,6 +190,22 @@ void vscp_init(void)
     vscp_probe_cnt = 0;
     vscp_page_select = 0;
 
+    // No extended page read in progress
+    vscp_xpr.left = 0;
+
+#ifdef VSCP_FIRMWARE_ENABLE_QUEUES
+    // Empty event queues
+    vscp_txcnt = 0;
+    vscp_txseq = 0;
+    vscp_rxhead = 0;
+    vscp_rxcnt = 0;
+#endif
+
+#ifdef VSCP_FIRMWARE_ENABLE_CANFILT
+    // Program acceptance filters on first vscp_doWork()
+    vscp_canfilt_init();
+#endif
+
     // Initialise time keeping
     vscp_timer = 0;
     vscp_configtimer = 0;
@@ -463,6 +517,10 @@ void vscp_handleDropNickname(void)
             // bit 5 set: reset device, keep nickname, disregard other option
             // below this by using 'brake'
             if ((vscp_imsg.data[1] & (1<<5)) && (brake == 0)) {
+#ifdef VSCP_FIRMWARE_ENABLE_REGCACHE
+                // Configuration must be in storage before the reset
+                vscp_regcache_flush();
+#endif
                 vscp_hardreset();
                 brake = 1;
             }
@@ -471,6 +529,10 @@ void vscp_handleDropNickname(void)
             if ((vscp_imsg.data[1] & (1<<7)) && (brake == 0)) {
                 vscp_nickname = VSCP_ADDRESS_FREE;
                 vscp_writeNicknamePermanent(VSCP_ADDRESS_FREE);
+#ifdef VSCP_FIRMWARE_ENABLE_REGCACHE
+                // Nothing runs after this, so write back now
+                vscp_regcache_flush();
+#endif
                 for (;;) {}; // wait forever
             }
         }
@@ -711,6 +773,81 @@ uint8_t vscp_writeRegister(uint8_t reg, uint8_t value)
     }
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// vscp_readRegisters
+//
+
+void vscp_readRegisters(uint8_t reg, uint8_t *pData, uint8_t cnt)
+{
+    uint8_t n;
+
+    while (cnt) {
+
+        if (reg >= 0x80) {
+            *pData++ = vscp_readStdReg(reg++);
+            cnt--;
+            continue;
+        }
+
+        // Application registers up to the standard register space
+        n = 0x80 - reg;
+        if (n > cnt) n = cnt;
+
+#ifdef VSCP_FIRMWARE_ENABLE_BULK_APPREGS
+        vscp_readAppRegs(vscp_page_select, reg, pData, n);
+#else
+        {
+            uint8_t i;
+            for (i = 0; i < n; i++) {
+                pData[ i ] = vscp_readAppReg(reg + i);
+            }
+        }
+#endif
+
+        reg += n;
+        pData += n;
+        cnt -= n;
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_writeRegisters
+//
+
+void vscp_writeRegisters(uint8_t reg, uint8_t *pData, uint8_t cnt)
+{
+    uint8_t n;
+
+    while (cnt) {
+
+        if (reg >= 0x80) {
+            *pData = vscp_writeStdReg(reg++, *pData);
+            pData++;
+            cnt--;
+            continue;
+        }
+
+        // Application registers up to the standard register space
+        n = 0x80 - reg;
+        if (n > cnt) n = cnt;
+
+#ifdef VSCP_FIRMWARE_ENABLE_BULK_APPREGS
+        vscp_writeAppRegs(vscp_page_select, reg, pData, n);
+#else
+        {
+            uint8_t i;
+            for (i = 0; i < n; i++) {
+                pData[ i ] = vscp_writeAppReg(reg + i, pData[ i ]);
+            }
+        }
+#endif
+
+        reg += n;
+        pData += n;
+        cnt -= n;
+    }
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // vscp_writeStdReg
 //
@@ -924,6 +1061,10 @@ void vscp_handleProtocolEvent(void)
                 ((vscp_page_select & 0xff) == vscp_imsg.data[ 7 ])) {
 /*
                 if ((vscp_nickname == vscp_imsg.data[ 0 ])){*/
+#ifdef VSCP_FIRMWARE_ENABLE_REGCACHE
+                // Configuration must be in storage before the bootloader runs
+                vscp_regcache_flush();
+#endif
 				vscp_goBootloaderMode( vscp_imsg.data[ 1 ] );
             }
             break;
@@ -983,35 +1124,28 @@ void vscp_handleProtocolEvent(void)
 
             if (vscp_nickname == vscp_imsg.data[ 0 ]) {
 
-                uint8_t i;
+                uint8_t i = 0;
                 uint8_t pos = 0;
                 uint8_t offset = vscp_imsg.data[ 1 ];
                 uint8_t len = vscp_imsg.data[ 2 ];
+                uint8_t bytes;
 
-                for (i = 0; i < len; i++) {
-                    vscp_omsg.data[ (i % 7) + 1 ] = vscp_readRegister(offset + i);
-
-                    if ( (i % 7) == 6 || i == (len - 1) ) {
-
-                        uint8_t bytes;
+                while (i < len) {
 
-                        if ( ( i % 7 ) == 6 ) {
-                            bytes = 7;
-                        }
-                        else {
-                            bytes = ( i % 7 ) + 1;
-                        }
+                    // Up to seven registers in each response
+                    bytes = ( (len - i) > 7 ) ? 7 : (len - i);
+                    vscp_readRegisters(offset + i, &vscp_omsg.data[ 1 ], bytes);
 
-                        vscp_omsg.flags = VSCP_VALID_MSG + bytes + 1;
-                        vscp_omsg.priority = VSCP_PRIORITY_LOW;
-                        vscp_omsg.vscp_class = VSCP_CLASS1_PROTOCOL;
-                        vscp_omsg.vscp_type = VSCP_TYPE_PROTOCOL_RW_PAGE_RESPONSE;
-                        vscp_omsg.data[ 0 ] = pos; // index
+                    vscp_omsg.flags = VSCP_VALID_MSG + bytes + 1;
+                    vscp_omsg.priority = VSCP_PRIORITY_LOW;
+                    vscp_omsg.vscp_class = VSCP_CLASS1_PROTOCOL;
+                    vscp_omsg.vscp_type = VSCP_TYPE_PROTOCOL_RW_PAGE_RESPONSE;
+                    vscp_omsg.data[ 0 ] = pos; // index
 
-                        // send the event
-                        vscp_sendEvent();
-                        pos++;
-                    }
+                    // send the event
+                    vscp_sendEvent();
+                    pos++;
+                    i += bytes;
                 }
             }
             break;
@@ -1019,15 +1153,12 @@ void vscp_handleProtocolEvent(void)
         case VSCP_TYPE_PROTOCOL_PAGE_WRITE:
 
             if (vscp_nickname == vscp_imsg.data[ 0 ]) {
-                uint8_t i;
                 uint8_t pos = vscp_imsg.data[ 1 ];
                 uint8_t len = (vscp_imsg.flags - 2) & 0x07;
 
-                for (i = 0; i < len; i++) {
-                    // Write VSCP register
-                    vscp_writeRegister(pos + i, vscp_imsg.data[ 2 + i ]);
-                    vscp_omsg.data[ 1 + i ] = vscp_readRegister(pos + i);
-                }
+                // Write VSCP registers, the response holds their new content
+                memcpy( &vscp_omsg.data[ 1 ], &vscp_imsg.data[ 2 ], len );
+                vscp_writeRegisters(pos, &vscp_omsg.data[ 1 ], len);
 
                 vscp_omsg.priority = VSCP_PRIORITY_LOW;
                 vscp_omsg.vscp_class = VSCP_CLASS1_PROTOCOL;
@@ -1163,10 +1294,7 @@ void vscp_handleProtocolEvent(void)
 
             if ( vscp_nickname == vscp_imsg.data[0] ) {
 
-                uint16_t page_save, bytes = 0;
-                uint8_t byte = 0;
-                uint8_t bytes_this_time, cb;
-				uint16_t vscp_sendtimer; // when was last event sent?
+                uint16_t bytes;
 
                 // if data byte 4 of the request is present probably more than 1 register should be
                 // read/written, therefore check lower 4 bits of the flags and decide
@@ -1176,70 +1304,21 @@ void vscp_handleProtocolEvent(void)
                     bytes = (uint16_t)vscp_imsg.data[4];
                     // if number of bytes was zero we read 256 bytes
                     if (bytes == 0) bytes = 256;
-                    // insane range checking
-                    if (bytes > 256) bytes = 256;
                 }
                 else {
                     bytes = 1;
                 }
 
-                // Save the current page
-                page_save = vscp_page_select;
-
-                // Assign the requested page, this variable is used in the implementation
-                // specific function 'vscp_readAppReg()' and 'vscp_writeAppReg()' to actually
-                // switch pages there
-                vscp_page_select = ((vscp_imsg.data[1] << 8) | vscp_imsg.data[2]);
-
-                // Construct response event
-                vscp_omsg.priority = VSCP_PRIORITY_LOW;
-                vscp_omsg.vscp_class = VSCP_CLASS1_PROTOCOL;
-                vscp_omsg.vscp_type = VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_RESPONSE;
-                vscp_omsg.data[0] = 0; // index of event, this is the first
-                vscp_omsg.data[1] = vscp_imsg.data[1]; // mirror page msb
-                vscp_omsg.data[2] = vscp_imsg.data[2]; // mirror page lsb
-
-                do {
-                    // calculate bytes to transfer in this event
-                    if ( ( bytes - byte ) >= 4 ) {
-                        bytes_this_time = 4;
-                    }
-                    else {
-                        bytes_this_time = (bytes - byte);
-                    }
-
-                    // define length of this event
-                    vscp_omsg.flags = VSCP_VALID_MSG + 4 + bytes_this_time;
-                    vscp_omsg.data[3] =
-                    vscp_imsg.data[3] + byte; // first register in this event
-
-                    // Put up to four registers to data space
-                    for ( cb = 0; cb < bytes_this_time; cb++ ) {
-                        vscp_omsg.data[ (4 + cb) ] =
-                        vscp_readRegister( ( vscp_imsg.data[3] + byte + cb ) );
-                    }
-					// save when last event is sent out
-					vscp_sendtimer = vscp_timer;
-
-					// send the event
-                    vscp_sendEvent();
-
-					//wait at least 1 msec for next message to be sent
-					//prevent overflow of bus or receiver
-					//100�sec should be sufficient, but requires separate timer
-					while (vscp_timer < vscp_sendtimer+2) ;
-
-                    // increment byte by bytes_this_time and the event number by one
-                    byte += bytes_this_time;
-
-                    // increment the index
-                    vscp_omsg.data[0] += 1;
-
-                } while (byte < bytes);
-
-                // Restore the saved page
-                vscp_page_select = page_save;
+                // Queue the read, a read in progress is replaced. The
+                // first frame is sent right away and the rest from
+                // vscp_doWork()
+                vscp_xpr.page = ((vscp_imsg.data[1] << 8) | vscp_imsg.data[2]);
+                vscp_xpr.reg = vscp_imsg.data[3];
+                vscp_xpr.left = bytes;
+                vscp_xpr.index = 0;
+                vscp_xpr.sendtimer = vscp_timer - VSCP_XPR_FRAME_INTERVAL;
 
+                vscp_doWork();
             }
             break;
 
@@ -1247,7 +1326,7 @@ void vscp_handleProtocolEvent(void)
 
             if ( vscp_nickname == vscp_imsg.data[ 0 ] ) {
 
-                uint8_t i;
+                uint8_t len;
                 uint16_t page_save;
 
                 // Save the current page
@@ -1257,20 +1336,18 @@ void vscp_handleProtocolEvent(void)
                 // specific function 'vscp_readAppReg()' and 'vscp_writeAppReg()' to actually
                 vscp_page_select = (vscp_imsg.data[1] << 8) | vscp_imsg.data[2];
 
-                for (i = vscp_imsg.data[ 3 ]; // register to write
-                        // number of registers to write comes from byte length of write event
-                        // reduced by four bytes
-                        i < (vscp_imsg.data[ 3 ] + ((vscp_imsg.flags & 0x0f) - 4));
-                        i++) {
-                    vscp_omsg.data[ 4 + (i - vscp_imsg.data[ 3 ]) ] =
-                        vscp_writeRegister(i, vscp_imsg.data[ 4 + (i - vscp_imsg.data[ 3 ]) ]);
-                }
+                // number of registers to write comes from byte length of write event
+                // reduced by four bytes
+                len = (vscp_imsg.flags & 0x0f);
+                len = ( len > 8 ) ? 4 : ( ( len > 4 ) ? len - 4 : 0 );
+                memcpy( &vscp_omsg.data[ 4 ], &vscp_imsg.data[ 4 ], len );
+                vscp_writeRegisters(vscp_imsg.data[ 3 ], &vscp_omsg.data[ 4 ], len);
 
                 // Restore the saved page
                 vscp_page_select = page_save;
 
                 vscp_omsg.priority = VSCP_PRIORITY_LOW;
-                vscp_omsg.flags = VSCP_VALID_MSG + 4 + ((vscp_imsg.flags & 0x0f) - 4);
+                vscp_omsg.flags = VSCP_VALID_MSG + 4 + len;
                 vscp_omsg.vscp_class = VSCP_CLASS1_PROTOCOL;
                 vscp_omsg.vscp_type = VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_RESPONSE;
                 vscp_omsg.data[0] = 0; // index of event, this is the first and only
@@ -1296,10 +1373,152 @@ void vscp_handleProtocolEvent(void)
 }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// vscp_doWork
+//
+
+void vscp_doWork(void)
+{
+    uint8_t data[ 8 ];
+    uint8_t bytes_this_time;
+    uint16_t page_save;
+
+#ifdef VSCP_FIRMWARE_ENABLE_REGCACHE
+    // Write back cached register writes when the writing has stopped
+    vscp_regcache_doWork( vscp_timer );
+#endif
+
+#ifdef VSCP_FIRMWARE_ENABLE_QUEUES
+    // Queued events the driver couldn't take
+    if ( vscp_txcnt ) vscp_sendQueuedEvents();
+#endif
+
+#ifdef VSCP_FIRMWARE_ENABLE_DM
+    // Events from decision matrix actions the driver couldn't take
+    if ( vscp_dm_getPending() ) vscp_dm_flush();
+#endif
+
+#ifdef VSCP_FIRMWARE_ENABLE_CANFILT
+    // Reprogram acceptance filters if the decision matrix or nickname changed
+    vscp_canfilt_doWork();
+#endif
+
+    if ( !vscp_xpr.left ) return;
+
+    // Wait at least VSCP_XPR_FRAME_INTERVAL ms between frames so the bus
+    // or the receiver is not flooded
+    if ( (uint16_t)( vscp_timer - vscp_xpr.sendtimer ) < VSCP_XPR_FRAME_INTERVAL ) return;
+
+#ifdef VSCP_FIRMWARE_ENABLE_QUEUES
+    // Events queued before this reply go first
+    if ( vscp_txcnt ) return;
+#endif
+
+    // calculate bytes to transfer in this event
+    bytes_this_time = ( vscp_xpr.left >= 4 ) ? 4 : vscp_xpr.left;
+
+    data[0] = vscp_xpr.index;                   // index of event
+    data[1] = ( vscp_xpr.page >> 8 ) & 0xff;    // page msb
+    data[2] = vscp_xpr.page & 0xff;             // page lsb
+    data[3] = vscp_xpr.reg;                     // first register in this event
+
+    // Assign the requested page, this variable is used in the implementation
+    // specific function 'vscp_readAppReg()' and 'vscp_writeAppReg()' to actually
+    // switch pages there
+    page_save = vscp_page_select;
+    vscp_page_select = vscp_xpr.page;
+
+    // Put up to four registers to data space
+    vscp_readRegisters( vscp_xpr.reg, &data[ 4 ], bytes_this_time );
+
+    // Restore the saved page
+    vscp_page_select = page_save;
+
+    // Try again next time if the frame can't be sent. The driver being
+    // busy is not an error.
+    if ( !sendVSCPFrame( VSCP_CLASS1_PROTOCOL,
+                            VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_RESPONSE,
+                            vscp_nickname,
+                            VSCP_PRIORITY_LOW,
+                            4 + bytes_this_time,
+                            data ) ) {
+        return;
+    }
+
+    vscp_xpr.sendtimer = vscp_timer;
+    vscp_xpr.reg += bytes_this_time;
+    vscp_xpr.left -= bytes_this_time;
+    vscp_xpr.index++;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // vscp_sendEvent
 //
 
+#ifdef VSCP_FIRMWARE_ENABLE_QUEUES
+
+int8_t vscp_sendEvent(void)
+{
+    // Make room by sending what the driver takes now
+    if ( vscp_txcnt >= VSCP_TX_QUEUE_SIZE ) vscp_sendQueuedEvents();
+
+    if ( vscp_txcnt >= VSCP_TX_QUEUE_SIZE ) {
+        // Queue is full, the bus is most likely jammed. See below.
+        vscp_errorcnt++;
+        return FALSE;
+    }
+
+    vscp_txq[ vscp_txcnt ].ev = vscp_omsg;
+    vscp_txq[ vscp_txcnt ].seq = vscp_txseq++;
+    vscp_txcnt++;
+
+    vscp_sendQueuedEvents();
+
+    return TRUE;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_sendQueuedEvents
+//
+
+uint8_t vscp_sendQueuedEvents(void)
+{
+    uint8_t i, best;
+
+    while ( vscp_txcnt ) {
+
+        // Highest priority, oldest first. Sequence numbers are compared
+        // relative to the oldest possible one so they may wrap.
+        best = 0;
+        for ( i = 1; i < vscp_txcnt; i++ ) {
+            if ( ( vscp_txq[ i ].ev.priority < vscp_txq[ best ].ev.priority ) ||
+                 ( ( vscp_txq[ i ].ev.priority == vscp_txq[ best ].ev.priority ) &&
+                   ( (uint8_t)( vscp_txq[ i ].seq - vscp_txseq ) <
+                     (uint8_t)( vscp_txq[ best ].seq - vscp_txseq ) ) ) ) {
+                best = i;
+            }
+        }
+
+        // Keep it for next time if the driver is full
+        if ( !sendVSCPFrame( vscp_txq[ best ].ev.vscp_class,
+                                vscp_txq[ best ].ev.vscp_type,
+                                vscp_nickname,
+                                vscp_txq[ best ].ev.priority,
+                                ( vscp_txq[ best ].ev.flags & 0x0f ),
+                                vscp_txq[ best ].ev.data ) ) {
+            break;
+        }
+
+        // Move the last slot into the freed one
+        vscp_txcnt--;
+        if ( best != vscp_txcnt ) vscp_txq[ best ] = vscp_txq[ vscp_txcnt ];
+    }
+
+    return vscp_txcnt;
+}
+
+#else
+
 int8_t vscp_sendEvent(void)
 {
     int8_t rv;
@@ -1320,25 +1539,114 @@ int8_t vscp_sendEvent(void)
     return rv;
 }
 
+#endif
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_readFrame
+//
+// Read one frame from the driver into pev. VSCP_VALID_MSG is not set.
+//
+
+static int8_t vscp_readFrame( vscpevent_t *pev )
+{
+#ifdef VSCP_FIRMWARE_ENABLE_CANFRAME
+    const vscp_canframe_t *pf;
+    uint32_t id;
+    uint8_t size;
+
+    if ( NULL == ( pf = getVSCPCanFrame() ) ) return FALSE;
+
+    // Decode straight from the driver buffer, the id is read once
+    id = pf->id;
+    pev->priority = VSCP_CANID_PRIORITY( id );
+    pev->vscp_class = VSCP_CANID_CLASS( id );
+    pev->vscp_type = VSCP_CANID_TYPE( id );
+    pev->oaddr = VSCP_CANID_NICKNAME( id );
+
+    size = ( pf->size > 8 ) ? 8 : pf->size;
+    pev->flags = size;
+    memcpy( pev->data, pf->data, size );
+
+    releaseVSCPCanFrame();
+
+    return TRUE;
+#else
+    return getVSCPFrame( &pev->vscp_class,
+                            &pev->vscp_type,
+                            &pev->oaddr,
+                            &pev->priority,
+                            &pev->flags,
+                            pev->data );
+#endif
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // vscp_getEvent
 //
 
+#ifdef VSCP_FIRMWARE_ENABLE_QUEUES
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_fillRxQueue
+//
+// Read everything the driver has (up to free space) so its buffers can
+// take new frames while the application works on vscp_imsg.
+//
+
+static void vscp_fillRxQueue(void)
+{
+    vscpevent_t *pev;
+
+    while ( vscp_rxcnt < VSCP_RX_QUEUE_SIZE ) {
+
+        pev = &vscp_rxq[ ( vscp_rxhead + vscp_rxcnt ) % VSCP_RX_QUEUE_SIZE ];
+
+        if ( !vscp_readFrame( pev ) ) break;
+
+        pev->flags |= VSCP_VALID_MSG;
+        vscp_rxcnt++;
+    }
+}
+
+int8_t vscp_getEvent(void)
+{
+    // Send pending response frames
+    vscp_doWork();
+
+    vscp_fillRxQueue();
+
+    // Don't read in new event if there already is an event
+    // in the input buffer. We return TRUE though to indicate there is
+    // a valid event.
+    if (vscp_imsg.flags & VSCP_VALID_MSG) return TRUE;
+
+    if ( !vscp_rxcnt ) return FALSE;
+
+    vscp_imsg = vscp_rxq[ vscp_rxhead ];
+    vscp_rxhead = ( vscp_rxhead + 1 ) % VSCP_RX_QUEUE_SIZE;
+    vscp_rxcnt--;
+
+    // Use the freed slot
+    vscp_fillRxQueue();
+
+    return TRUE;
+}
+
+#else
+
 int8_t vscp_getEvent(void)
 {
     int8_t rv;
 
+    // Send pending response frames
+    vscp_doWork();
+
     // Don't read in new event if there already is an event
     // in the input buffer. We return TRUE though to indicate there is
     // a valid event.
     if (vscp_imsg.flags & VSCP_VALID_MSG) return TRUE;
 
-    if ( ( rv = getVSCPFrame( &vscp_imsg.vscp_class,
-                                &vscp_imsg.vscp_type,
-                                &vscp_imsg.oaddr,
-                                &vscp_imsg.priority,
-                                &vscp_imsg.flags,
-                                vscp_imsg.data ) ) ) {
+    if ( ( rv = vscp_readFrame( &vscp_imsg ) ) ) {
 
         vscp_imsg.flags |= VSCP_VALID_MSG;
     }
@@ -1346,6 +1654,8 @@ int8_t vscp_getEvent(void)
     return rv;
 }
 
+#endif
+
 ///////////////////////////////////////////////////////////////////////////////
 // vscp_sendErrorEvent
 //
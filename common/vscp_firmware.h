@@ -64,6 +64,9 @@ low end hardware device.
 #include <vscp_compiler.h> 	// This file should be in your project folder
 #include <vscp_projdefs.h>	// This file should be in your project folder
 #include <inttypes.h>
+#ifdef VSCP_FIRMWARE_ENABLE_CANFRAME
+#include <vscp_canid.h>
+#endif
 
 // Macros
 
@@ -77,15 +80,15 @@ low end hardware device.
 
 // This macro construct a signed long from four unsigned chars in a safe way
 #define construct_signed32( b0, b1, b2, b3 )  ((int32_t)( (((uint32_t)b0)<<24) + \
-                                                            (((uint32_t)b0)<<16) + \
-                                                            (((uint32_t)b0)<<8) + \
-                                                            (uint32_t)b0 ) )
+                                                            (((uint32_t)b1)<<16) + \
+                                                            (((uint32_t)b2)<<8) + \
+                                                            (uint32_t)b3 ) )
 
 // This macro construct a unsigned long from four unsigned chars in a safe way
 #define construct_unsigned32( b0, b1, b2, b3 )  ((uint32_t)( (((uint32_t)b0)<<24) + \
-                                                            (((uint32_t)b0)<<16) + \
-                                                            (((uint32_t)b0)<<8) + \
-                                                            (uint32_t)b0 ) )
+                                                            (((uint32_t)b1)<<16) + \
+                                                            (((uint32_t)b2)<<8) + \
+                                                            (uint32_t)b3 ) )
 
 
 // ******************************************************************************
@@ -149,6 +152,22 @@ low end hardware device.
 #define VSCP_PROBE_TIMEOUT              1000    // ms - one second
 #define VSCP_PROBE_TIMEOUT_COUNT        3       // Max # probe time-outs allowed
 
+// Minimum time in ms between the response frames of an extended page
+// read. Set to zero to send one frame each time vscp_doWork() is called.
+#ifndef VSCP_XPR_FRAME_INTERVAL
+#define VSCP_XPR_FRAME_INTERVAL         2
+#endif
+
+// Number of slots in the outgoing and incoming event queues used when
+// VSCP_FIRMWARE_ENABLE_QUEUES is defined.
+#ifndef VSCP_TX_QUEUE_SIZE
+#define VSCP_TX_QUEUE_SIZE              8
+#endif
+
+#ifndef VSCP_RX_QUEUE_SIZE
+#define VSCP_RX_QUEUE_SIZE              4
+#endif
+
 // Two bytes used to indicate that persistent storage is
 // initialized. They are read with vscp_getControlByte which
 // for index = 0/1 should return 0x55/0xAA if the persistent
@@ -439,6 +458,25 @@ uint8_t vscp_writeRegister(uint8_t reg, uint8_t value);
  */
 uint8_t vscp_writeStdReg(uint8_t reg, uint8_t value);
 
+/*!
+    Read a run of VSCP registers. Application registers are read on the
+    current page with vscp_readAppRegs() if the port provides it.
+    @param reg First register to read.
+    @param pData Buffer that will get the register content.
+    @param cnt Number of registers to read.
+ */
+void vscp_readRegisters(uint8_t reg, uint8_t *pData, uint8_t cnt);
+
+/*!
+    Write a run of VSCP registers. Application registers are written on the
+    current page with vscp_writeAppRegs() if the port provides it.
+    @param reg First register to write.
+    @param pData Values to write. Gets the content of the registers after
+            the write.
+    @param cnt Number of registers to write.
+ */
+void vscp_writeRegisters(uint8_t reg, uint8_t *pData, uint8_t cnt);
+
 /*!
     Do One second work
 
@@ -447,6 +485,22 @@ uint8_t vscp_writeStdReg(uint8_t reg, uint8_t value);
  */
 void vscp_doOneSecondWork(void);
 
+/*!
+    Do pending work
+
+    Sends the next frame of a multi frame response (extended page
+    read) when it is time for it. With VSCP_FIRMWARE_ENABLE_REGCACHE
+    it also writes back one page of the register cache (vscp_regcache.h)
+    when it is time to flush. With VSCP_FIRMWARE_ENABLE_DM events queued
+    by decision matrix actions (vscp_dm.h) that could not be sent yet
+    are sent. With VSCP_FIRMWARE_ENABLE_QUEUES queued outgoing events
+    are sent. With VSCP_FIRMWARE_ENABLE_CANFILT the acceptance filters
+    (vscp_canfilt.h) are reprogrammed when needed. Called from
+    vscp_getEvent() so it runs every turn of a normal main loop. Never
+    blocks.
+ */
+void vscp_doWork(void);
+
 /*!
     Check if we need to initialize persistent data
  */
@@ -454,12 +508,36 @@ int8_t vscp_check_pstorage(void);
 
 /*!
     Send VSCP event in the out-buffer.
-    @return TRUE on success.
+
+    With VSCP_FIRMWARE_ENABLE_QUEUES the event is copied to the outgoing
+    queue (VSCP_TX_QUEUE_SIZE slots) and as many queued events as the
+    driver takes are sent. vscp_omsg can be reused directly. Events are
+    sent highest priority first and in order within a priority.
+    @return TRUE on success. Without VSCP_FIRMWARE_ENABLE_QUEUES FALSE
+    if the driver did not take the event. With VSCP_FIRMWARE_ENABLE_QUEUES
+    FALSE if the queue was full and the event was dropped, TRUE means it
+    was sent or queued.
  */
 int8_t vscp_sendEvent(void);
 
+#ifdef VSCP_FIRMWARE_ENABLE_QUEUES
+/*!
+    Send queued outgoing events until the queue is empty or the driver
+    refuses a frame. Called from vscp_sendEvent() and vscp_doWork(). A
+    driver can also call it when a transmit buffer frees up but it must
+    then not be called from an interrupt that can preempt the main level
+    code using the queue.
+    @return Number of events still queued.
+ */
+uint8_t vscp_sendQueuedEvents(void);
+#endif
+
 /*!
     Get VSCP Event if there is no message in the input buffer.
+
+    With VSCP_FIRMWARE_ENABLE_QUEUES all frames the driver has are read
+    into the incoming queue (VSCP_RX_QUEUE_SIZE slots) each call so
+    driver buffers are freed also while vscp_imsg is busy.
     @return TRUE if a valid event is placed in the in-buffer.
  */
 int8_t vscp_getEvent(void);
@@ -505,6 +583,25 @@ uint8_t vscp_sendLogEvent( uint8_t type,
 // --------------------------- External Functions -----------------------------
 
 
+#ifdef VSCP_FIRMWARE_ENABLE_CANFRAME
+
+/*!
+    Get the oldest received CAN frame in place. Used instead of
+    getVSCPFrame with VSCP_FIRMWARE_ENABLE_CANFRAME so the frame is
+    decoded (vscp_canid.h) straight from the driver receive buffer.
+    @return Pointer to the frame, valid until releaseVSCPCanFrame is
+    called, or NULL if there is no frame.
+ */
+const vscp_canframe_t *getVSCPCanFrame( void );
+
+/*!
+    Release the frame returned by getVSCPCanFrame so the driver can
+    reuse the buffer.
+ */
+void releaseVSCPCanFrame( void );
+
+#else
+
 /*!
     Get a VSCP frame frame
     @param pvscpclass Pointer to variable that will get VSCP class.
@@ -522,6 +619,8 @@ int8_t getVSCPFrame( uint16_t *pvscpclass,
                         uint8_t *pSize,
                         uint8_t *pData);
 
+#endif
+
 /*!
     Send a VSCP frame
     @param vscpclass VSCP class for event.
@@ -656,6 +755,34 @@ uint8_t vscp_readAppReg(uint8_t reg);
  */
 uint8_t vscp_writeAppReg(uint8_t reg, uint8_t value);
 
+/*!
+    Read a run of application registers in one go. Define
+    VSCP_FIRMWARE_ENABLE_BULK_APPREGS and implement this and
+    vscp_writeAppRegs() to let the port burst read EEPROM/NVM instead of
+    being called through vscp_readAppReg() for each byte.
+    @param page Register page to read from.
+    @param reg First register to read (<0x80). reg + cnt never goes
+            above 0x80.
+    @param pData Buffer that will get the register content.
+    @param cnt Number of registers to read.
+ */
+#ifdef VSCP_FIRMWARE_ENABLE_BULK_APPREGS
+void vscp_readAppRegs(uint16_t page, uint8_t reg, uint8_t *pData, uint8_t cnt);
+#endif
+
+/*!
+    Write a run of application registers in one go.
+    @param page Register page to write to.
+    @param reg First register to write (<0x80). reg + cnt never goes
+            above 0x80.
+    @param pData Values to write. Should be filled with the register
+            content after the write.
+    @param cnt Number of registers to write.
+ */
+#ifdef VSCP_FIRMWARE_ENABLE_BULK_APPREGS
+void vscp_writeAppRegs(uint16_t page, uint8_t reg, uint8_t *pData, uint8_t cnt);
+#endif
+
 /*!
     Get DM matrix info
     The output message data structure should be filled with
@@ -144,7 +144,7 @@ int8_t vscp2_getEvent(void) {
 
 void vscp2_readRegister( void )
 {
-    uint32_t i;
+    uint32_t i, j, n;
     uint32_t reg = ((uint32_t) wrkEvent.data[ 16 ] << 24) +
             ((uint32_t) wrkEvent.data[ 17 ] << 16) +
             ((uint32_t) wrkEvent.data[ 18 ] << 8) +
@@ -157,17 +157,30 @@ void vscp2_readRegister( void )
         cnt = ( LIMITED_DEVICE_DATASIZE - 8 );
     }
 
-    for ( i = 0; i < cnt; i++ ) {
+    for ( i = 0; i < cnt; i += n ) {
 
         if ( ( reg + i) > VSCP_LEVEL2_COMMON_REGISTER_START ) {
             /* Common register */
             wrkEvent.data[ 4 + i ] =
                     vscp_readStdReg( reg + i );
-        } else {
-            /* User register */
-            wrkEvent.data[ 4 + i ] = vscp_readAppReg( reg + i );
+            n = 1;
+            continue;
         }
 
+        /* Run of user registers up to the common registers */
+        n = VSCP_LEVEL2_COMMON_REGISTER_START + 1 - ( reg + i );
+        if ( n > ( cnt - i ) ) {
+            n = cnt - i;
+        }
+
+#ifdef VSCP_FIRMWARE_ENABLE_BULK_APPREGS
+        vscp2_readAppRegs( reg + i, &wrkEvent.data[ 4 + i ], n );
+#else
+        for ( j = 0; j < n; j++ ) {
+            wrkEvent.data[ 4 + i + j ] = vscp_readAppReg( reg + i + j );
+        }
+#endif
+
     }
 
     wrkEvent.sizeData = 4 + cnt;
@@ -190,7 +203,7 @@ void vscp2_readRegister( void )
 void vscp2_writeRegister( void )
 {
     uint8_t saveData[ 4 ];
-    uint32_t i;
+    uint32_t i, j, n;
     uint32_t idx = ((uint32_t) wrkEvent.data[ 0 ] << 24) +
             ((uint32_t) wrkEvent.data[ 1 ] << 16) +
             ((uint32_t) wrkEvent.data[ 2 ] << 8) +
@@ -202,21 +215,36 @@ void vscp2_writeRegister( void )
         cnt = (LIMITED_DEVICE_DATASIZE - 24);
     }
 
-    for (i = 0; i < cnt; i++) {
+    /* Values to write are replaced in place by the register content */
+    memmove((void *) &wrkEvent.data[ 8 ], (void *) &wrkEvent.data[ 24 ], cnt);
+
+    for (i = 0; i < cnt; i += n) {
 
         if ( (idx + i) > VSCP_LEVEL2_COMMON_REGISTER_START ) {
             /* Common register */
             wrkEvent.data[ 8 + i ] =
                     vscp_writeStdReg((idx & 0xff) + i,
-                    wrkEvent.data[ 24 + i ]);
-        } 
-        else {
-            /* User register */
-            wrkEvent.data[ 8 + i ] =
-                    vscp_writeAppReg(idx + i,
-                    wrkEvent.data[ 24 + i ]);
+                    wrkEvent.data[ 8 + i ]);
+            n = 1;
+            continue;
+        }
+
+        /* Run of user registers up to the common registers */
+        n = VSCP_LEVEL2_COMMON_REGISTER_START + 1 - (idx + i);
+        if (n > (cnt - i)) {
+            n = cnt - i;
         }
 
+#ifdef VSCP_FIRMWARE_ENABLE_BULK_APPREGS
+        vscp2_writeAppRegs(idx + i, &wrkEvent.data[ 8 + i ], n);
+#else
+        for (j = 0; j < n; j++) {
+            wrkEvent.data[ 8 + i + j ] =
+                    vscp_writeAppReg(idx + i + j,
+                    wrkEvent.data[ 8 + i + j ]);
+        }
+#endif
+
     }
 
     /* Save address */
@@ -276,6 +276,31 @@ vscp2_readAppReg(uint32_t reg);
 int
 vscp2_writeAppReg(uint32_t reg, uint8_t data);
 
+#ifdef VSCP_FIRMWARE_ENABLE_BULK_APPREGS
+
+/*!
+    Read a run of application registers in one go. Only called if
+    VSCP_FIRMWARE_ENABLE_BULK_APPREGS is defined, otherwise the
+    registers are read one by one.
+    @param reg First register to read.
+    @param pData Buffer that will get the register content.
+    @param cnt Number of registers to read.
+*/
+void
+vscp2_readAppRegs(uint32_t reg, uint8_t *pData, uint32_t cnt);
+
+/*!
+    Write a run of application registers in one go.
+    @param reg First register to write.
+    @param pData Values to write. Should be filled with the register
+            content after the write.
+    @param cnt Number of registers to write.
+*/
+void
+vscp2_writeAppRegs(uint32_t reg, uint8_t *pData, uint32_t cnt);
+
+#endif
+
 uint8_t
 vscp2_getControlByte(void);
 void
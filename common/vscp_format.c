@@ -0,0 +1,105 @@
+// FILE: vscp_format.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "vscp_format.h"
+
+static const char digitPairs[] = 
+    "00010203040506070809"
+    "10111213141516171819"
+    "20212223242526272829"
+    "30313233343536373839"
+    "40414243444546474849"
+    "50515253545556575859"
+    "60616263646566676869"
+    "70717273747576777879"
+    "80818283848586878889"
+    "90919293949596979899";
+
+static const char hexDigits[] = "0123456789ABCDEF";
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_fmt_writeUint
+//
+
+char *vscp_fmt_writeUint( char *p, uint32_t val )
+{
+    char wrk[10];
+    char *pw = wrk + sizeof( wrk );
+    size_t n;
+
+    while ( val >= 100 ) {
+        pw -= 2;
+        memcpy( pw, digitPairs + 2 * ( val % 100 ), 2 );
+        val /= 100;
+    }
+
+    if ( val >= 10 ) {
+        pw -= 2;
+        memcpy( pw, digitPairs + 2 * val, 2 );
+    }
+    else {
+        *--pw = (char)( '0' + val );
+    }
+
+    n = (size_t)( wrk + sizeof( wrk ) - pw );
+    memcpy( p, pw, n );
+    return p + n;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_fmt_write2Digits
+//
+
+char *vscp_fmt_write2Digits( char *p, uint8_t val )
+{
+    // Out of range values are written in full, as "%02d" would
+    if ( val > 99 ) return vscp_fmt_writeUint( p, val );
+
+    memcpy( p, digitPairs + 2 * val, 2 );
+    return p + 2;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_fmt_writeHex2
+//
+
+char *vscp_fmt_writeHex2( char *p, uint8_t val )
+{
+    *p++ = hexDigits[ val >> 4 ];
+    *p++ = hexDigits[ val & 0x0f ];
+    return p;
+}
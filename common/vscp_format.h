@@ -0,0 +1,83 @@
+// FILE: vscp_format.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#ifndef _VSCP_FORMAT_H_
+#define _VSCP_FORMAT_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+    Formatting helpers
+
+    Cursor based writers used on the hot output paths of the link and 
+    server interfaces. Each writes at p and returns a pointer to the 
+    position after the last written character. No null termination and 
+    no bounds checking is done, the caller must make sure the buffer can
+    hold the worst case output.
+*/
+
+/*!
+    Write unsigned decimal value (at most 10 characters)
+    @param p Position to write at
+    @param val Value to write
+    @return Pointer to position after the last written character
+*/
+char *vscp_fmt_writeUint( char *p, uint32_t val );
+
+/*!
+    Write a value 0-99 as two digits. Larger values are written with
+    vscp_fmt_writeUint (three digits), so p needs room for three.
+    @param p Position to write at
+    @param val Value to write
+    @return Pointer to position after the last written character
+*/
+char *vscp_fmt_write2Digits( char *p, uint8_t val );
+
+/*!
+    Write a byte as two upper case hex digits
+    @param p Position to write at
+    @param val Value to write
+    @return Pointer to position after the last written character
+*/
+char *vscp_fmt_writeHex2( char *p, uint8_t val );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VSCP_FORMAT_H_ */
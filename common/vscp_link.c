@@ -36,170 +36,157 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <ctype.h>
 
 #include "vscp.h"
+#include "vscp_format.h"
 #include "vscp_link.h"
 
+static int parseEventRange( const char *strevent, 
+                                const char *pend,
+                                vscpEvent *ev, 
+                                uint8_t *pdata, 
+                                uint16_t size );
+static char *writeEvent( char *p, const vscpEvent *ev );
+
+///////////////////////////////////////////////////////////////////////////////
+// Command table
+//
+// Must be kept sorted on the (lower case) command name as the parser
+// looks up the first token of a command line with a binary search.
+//
+
+typedef int (*vscp_link_cmd_handler)( const char *cmd );
+
+typedef struct {
+    const char *name;                   // Command name (lower case)
+    vscp_link_cmd_handler handler;      // Handler for the command
+} vscp_link_cmd;
+
+static const vscp_link_cmd vscp_link_commands[] = {
+    { "+",              vscp_link_doCmdCommandAgain },
+    { "cdta",           vscp_link_doCmdCmdCheckData },
+    { "challenge",      vscp_link_doCmdChallenge },
+    { "chid",           vscp_link_doCmdGetChannelId },
+    { "chkdata",        vscp_link_doCmdCheckData },
+    { "clra",           vscp_link_doCmdClearAll },
+    { "clrall",         vscp_link_doCmdClearAll },
+    { "dm",             vscp_link_doCmdDM },
+    { "getchid",        vscp_link_doCmdGetChannelId },
+    { "getguid",        vscp_link_doCmdGetGUID },
+    { "ggid",           vscp_link_doCmdGetGUID },
+    { "help",           vscp_link_doCmdHelp },
+    { "info",           vscp_link_doCmdInfo },
+#ifdef VSCP_LINK_ENABLE_CMD_INTERFACE
+    { "interface",      vscp_link_doCmdInterface },
+#endif
+    { "noop",           vscp_link_doCmdNoop },
+    { "pass",           vscp_link_doCmdPassword },
+    { "quit",           vscp_link_doCmdQuit },
+    { "quitloop",       vscp_link_doCmdQuitLoop },
+    { "rcvloop",        vscp_link_doCmdRcvLoop },
+    { "retr",           vscp_link_doCmdRetrive },
+    { "send",           vscp_link_doCmdSend },
+    { "setfilter",      vscp_link_doCmdSetFilter },
+    { "setguid",        vscp_link_doCmdSetChannelId },
+    { "setmask",        vscp_link_doCmdSetMask },
+    { "sflt",           vscp_link_doCmdSetFilter },
+    { "sgid",           vscp_link_doCmdSetChannelId },
+    { "smsk",           vscp_link_doCmdSetMask },
+    { "stat",           vscp_link_doCmdStatistics },
+    { "user",           vscp_link_doCmdUser },
+#ifdef VSCP_LINK_ENABLE_CMD_VAR
+    { "var",            vscp_link_doCmdVariable },
+#endif
+    { "vers",           vscp_link_doCmdGetVersion },
+    { "version",        vscp_link_doCmdGetVersion },
+    { "wcyd",           vscp_link_doCmdWhatCanYouDo },
+    { "whatcanyoudo",   vscp_link_doCmdWhatCanYouDo },
+};
+
+#define VSCP_LINK_CMD_COUNT  ( sizeof( vscp_link_commands ) / sizeof( vscp_link_commands[0] ) )
+
+///////////////////////////////////////////////////////////////////////////////
+// compareToken
+//
+// Compare a (not null terminated) command token of length len with a
+// lower case command name. The token is compared case insensitive.
+// Returns <0, 0 or >0 in the same way as strcmp.
+//
+
+static int compareToken( const char *token, size_t len, const char *name )
+{
+    size_t i;
+    int c;
+
+    for ( i=0; i<len; i++ ) {
+        if ( !name[i] ) return 1;       // Token is longer than name
+        c = tolower( (unsigned char)token[i] );
+        if ( c != name[i] ) return c - (unsigned char)name[i];
+    }
+
+    // Equal only if name also ends here
+    return name[len] ? -1 : 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// findCommand
+//
+
+static const vscp_link_cmd *findCommand( const char *token, size_t len )
+{
+    size_t low = 0;
+    size_t high = VSCP_LINK_CMD_COUNT;
+    size_t mid;
+    int rv;
+
+    while ( low < high ) {
+        mid = ( low + high ) / 2;
+        rv = compareToken( token, len, vscp_link_commands[mid].name );
+        if ( 0 == rv ) return &vscp_link_commands[mid];
+        if ( rv < 0 ) {
+            high = mid;
+        }
+        else {
+            low = mid + 1;
+        }
+    }
+
+    return NULL;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_link_parser
+//
+
 int vscp_link_parser( const char *cmd ) 
 {
     const char *p = cmd;
     const char *pcmd;
+    const vscp_link_cmd *pEntry;
 
     // Check pointer
     if ( NULL == cmd ) return VSCP_ERROR_INVALID_POINTER;
 
     // Remove whitespace from command
-    while( *p && ( *p == ' ' ) ) {
+    while( *p && ( ( ' ' == *p ) || ( '\t' == *p ) ) ) {
         p++;
     }
 
+    // Find end of command token
     pcmd = p;
-
-    if ( NULL != ( p = strstr( pcmd, "noop" ) ) ) {
-        p += 4;
-        vscp_link_doCmdNoop( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "help" ) ) ) {
-        p += 4;
-        vscp_link_doCmdHelp( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "quit" ) ) ) {
-        p += 4;
-        vscp_link_doCmdQuit( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "user" ) ) ) {
-        p +=4;
-        vscp_link_doCmdUser( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "pass" ) ) ) {
-        p +=4;
-        vscp_link_doCmdPassword( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "challenge" ) ) ) {
-        p +=9;
-        vscp_link_doCmdChallenge( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "send" ) ) ) {
-        p +=4;
-        vscp_link_doCmdSend( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "retr" ) ) ) {
-        p +=4;
-        vscp_link_doCmdRetrive( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "rcvloop" ) ) ) {
-        p +=7;
-        vscp_link_doCmdRcvLoop( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "quitloop" ) ) ) {
-        p +=8;
-        vscp_link_doCmdQuitLoop( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "cdta" ) ) ) {
-        p +=4;
-        vscp_link_doCmdCmdCheckData( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "chkdata" ) ) ) {
-        p +=7;
-        vscp_link_doCmdCheckData( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "clra" ) ) ) {
-        p +=4;
-        vscp_link_doCmdClearAll( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "clrall" ) ) ) {
-        p +=6;
-        vscp_link_doCmdClearAll( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "stat" ) ) ) {
-        p +=4;
-        vscp_link_doCmdStatistics( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "info" ) ) ) {
-        p +=4;
-        vscp_link_doCmdInfo( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "chid" ) ) ) {
-        p +=4;
-        vscp_link_doCmdGetChannelId( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "getchid" ) ) ) {
-        p +=7;
-        vscp_link_doCmdGetChannelId( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "sgid" ) ) ) {
-        p +=4;
-        vscp_link_doCmdSetChannelId( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "setguid" ) ) ) {
-        p +=7;
-        vscp_link_doCmdSetChannelId( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "ggid" ) ) ) {
-        p +=4;
-        vscp_link_doCmdGetGUID( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "getguid" ) ) ) {
-        p +=7;
-        vscp_link_doCmdGetGUID( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "vers" ) ) ) {
-        p +=4;
-        vscp_link_doCmdGetVersion( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "version" ) ) ) {
-        p +=7;
-        vscp_link_doCmdGetVersion( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "sflt" ) ) ) {
-        p +=4;
-        vscp_link_doCmdSetFilter( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "setfilter" ) ) ) {
-        p +=9;
-        vscp_link_doCmdSetFilter( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "smsk" ) ) ) {
-        p +=4;
-        vscp_link_doCmdSetMask( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "setmask" ) ) ) {
-        p +=7;
-        vscp_link_doCmdSetMask( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "wcyd" ) ) ) {
-        p +=4;
-        vscp_link_doCmdWhatCanYouDo( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "whatcanyoudo" ) ) ) {
-        p +=12;
-        vscp_link_doCmdWhatCanYouDo( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "+" ) ) ) {
-        p +=1;
-        vscp_link_doCmdCommandAgain( p );
-    }
-    else if ( NULL != ( p = strstr( pcmd, "dm" ) ) ) {
-        p +=2;
-        vscp_link_doCmdDM( p );
-    }
-#ifdef VSCP_LINK_ENABLE_CMD_VAR
-    else if ( NULL != ( p = strstr( pcmd, "var" ) ) ) {
-        p +=3;
-        vscp_link_doCmdVariable( p );
-    }
-#endif   
-#ifdef VSCP_LINK_ENABLE_CMD_INTERFACE
-    else if ( NULL != ( p = strstr( pcmd, "interface" ) ) ) {
-        p +=9;
-        vscp_link_doCmdInterface( p );
+    while ( *p && ( ' ' != *p ) && ( '\t' != *p ) && ( '\r' != *p ) && ( '\n' != *p ) ) {
+        p++;
     }
-#endif  
-    else {
-        vscp_link_reply("-OK - Unknown command\r\n");
+
+    pEntry = findCommand( pcmd, (size_t)( p - pcmd ) );
+    if ( NULL == pEntry ) {
+        vscp_link_reply( VSCP_LINK_MSG_UNKNOWN_COMMAND );
+        return VSCP_ERROR_SUCCESS;
     }
 
-    return VSCP_ERROR_SUCCESS;
+    // Handler get the arguments that follow the command
+    return pEntry->handler( p );
 }
 
 
@@ -316,7 +303,7 @@ int vscp_link_reply( const char *msg )
 
 int vscp_link_doCmdNoop( const char *cmd )
 {
-    vscp_link_callback_write("+OK\r\n");
+    vscp_link_callback_writeClient( "+OK\r\n" );
     return VSCP_ERROR_SUCCESS;
 }
 
@@ -345,14 +332,126 @@ int vscp_link_doCmdChallenge( const char *cmd )
     return VSCP_ERROR_SUCCESS;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// vscp_link_doCmdSend
+//
+// send event1[;event2;event3...]
+//
+// Several events can be sent with one command by separating them with ';'. 
+// Each event is handed to vscp_link_callback_eventReceived and one reply is
+// sent for the whole command.
+//
+
 int vscp_link_doCmdSend( const char *cmd )
 {
+    const char *p = cmd;
+    const char *pend;
+    const char *pnext;
+    vscpEvent ev;
+    uint8_t evdata[ VSCP_MAX_DATA ];
+
+    // Check pointer
+    if ( NULL == cmd ) return VSCP_ERROR_INVALID_POINTER;
+
+    while ( *p ) {
+
+        // Remove whitespace before event
+        while ( ' ' == *p ) p++;
+
+        // Find end of this event
+        pnext = strchr( p, ';' );
+        if ( NULL == pnext ) pnext = p + strlen( p );
+        
+        // Trim trailing whitespace and line ending
+        pend = pnext;
+        while ( ( pend > p ) && 
+                ( ( ' ' == pend[-1] ) || ( '\r' == pend[-1] ) || ( '\n' == pend[-1] ) ) ) {
+            pend--;
+        }
+
+        if ( pend > p ) {
+            if ( VSCP_ERROR_SUCCESS != parseEventRange( p, pend, &ev, evdata, sizeof( evdata ) ) ) {
+                vscp_link_callback_writeClient( VSCP_LINK_MSG_PARAMETER_ERROR );
+                return VSCP_ERROR_PARAMETER;
+            }
+
+            if ( VSCP_ERROR_SUCCESS != vscp_link_callback_eventReceived( &ev ) ) {
+                vscp_link_callback_writeClient( VSCP_LINK_MSG_UNABLE_TO_SEND_EVENT );
+                return VSCP_ERROR_TRM_FULL;
+            }
+        }
+
+        if ( !*pnext ) break;
+        p = pnext + 1;  // Move beyond ';'
+    }
+
+    vscp_link_callback_writeClient( VSCP_LINK_MSG_OK );
     return VSCP_ERROR_SUCCESS;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// vscp_link_doCmdRetrive
+//
+// retr [n]
+//
+// Up to n events (default one) are fetched with vscp_link_callback_eventGet.
+// The event lines and the final reply are collected in the output buffer
+// of the session (vscp_link_callback_getOutBuf) that is handed to
+// vscp_link_callback_writeClientBuf when it is full and when done. A host
+// can thus drain many events with one socket write.
+//
+
 int vscp_link_doCmdRetrive( const char *cmd )
 {
-    return VSCP_ERROR_SUCCESS;
+    vscpEvent ev;
+    uint8_t evdata[ VSCP_MAX_DATA ];
+    long count;
+    long cnt = 0;
+    char *outbuf;
+    char *p;
+    const char *reply;
+    size_t replylen;
+
+    // Check pointer
+    if ( NULL == cmd ) return VSCP_ERROR_INVALID_POINTER;
+
+    outbuf = vscp_link_callback_getOutBuf();
+    if ( NULL == outbuf ) return VSCP_ERROR_INVALID_POINTER;
+    p = outbuf;
+
+    count = strtol( cmd, NULL, 0 );
+    if ( count <= 0 ) count = 1;
+
+    while ( count-- ) {
+
+        ev.pdata = evdata;
+        ev.sizeData = 0;
+        if ( VSCP_ERROR_SUCCESS != vscp_link_callback_eventGet( &ev ) ) break;
+        if ( ev.sizeData > sizeof( evdata ) ) ev.sizeData = sizeof( evdata );
+
+        // Flush if the worst case line does not fit 
+        if ( (size_t)( outbuf + VSCP_LINK_OUTBUF_SIZE - p ) < 
+                ( VSCP_LINK_EVENT_STR_SIZE( ev.sizeData ) + 2 ) ) {
+            vscp_link_callback_writeClientBuf( outbuf, (size_t)( p - outbuf ) );
+            p = outbuf;
+        }
+
+        p = writeEvent( p, &ev );
+        *p++ = '\r';
+        *p++ = '\n';
+        cnt++;
+    }
+
+    reply = cnt ? VSCP_LINK_MSG_OK : VSCP_LINK_MSG_NO_MSG;
+    replylen = strlen( reply );
+    if ( (size_t)( outbuf + VSCP_LINK_OUTBUF_SIZE - p ) < replylen ) {
+        vscp_link_callback_writeClientBuf( outbuf, (size_t)( p - outbuf ) );
+        p = outbuf;
+    }
+    memcpy( p, reply, replylen );
+    p += replylen;
+
+    return vscp_link_callback_writeClientBuf( outbuf, (size_t)( p - outbuf ) );
 }
 
 int vscp_link_doCmdRcvLoop( const char *cmd )
@@ -499,6 +598,7 @@ int parseGuid( const char *strguid, char **endptr, uint8_t *guid )
 
     // Empty GUID or GUID  set to '-' means all nulls
     if ( !*p || ( '-' == *p ) )  {
+        if ( '-' == *p ) p++;   // Move beyond '-'
         if ( NULL != endptr ) *endptr = p;
         return VSCP_ERROR_SUCCESS;
     }
@@ -509,10 +609,6 @@ int parseGuid( const char *strguid, char **endptr, uint8_t *guid )
         if ( i != 15 ) {
             if ( ':' != *p )   return VSCP_ERROR_ERROR;
             p++;    // Move beyond ':'
-            if ( p > (strguid + strlen(strguid) ) ) {
-                if ( NULL != endptr ) *endptr = p;
-                return VSCP_ERROR_ERROR;
-            }
         }
     }
 
@@ -520,6 +616,25 @@ int parseGuid( const char *strguid, char **endptr, uint8_t *guid )
     return VSCP_ERROR_SUCCESS;
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// Formatting helpers
+//
+// Cursor based writers used on the hot output paths, see vscp_format.h.
+//
+
+// Write GUID as 00:11:22:33:44:55:66:77:88:99:AA:BB:CC:DD:EE:FF
+static char *writeGuid( char *p, const uint8_t *guid )
+{
+    int i;
+
+    for ( i=0; i<16; i++ ) {
+        p = vscp_fmt_writeHex2( p, guid[i] );
+        *p++ = ':';
+    }
+
+    return p - 1;   // No colon after last byte
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // writeGuidToString
 //
@@ -530,13 +645,7 @@ int writeGuidToString( const uint8_t *guid, char *strguid )
     if ( NULL == strguid ) return VSCP_ERROR_INVALID_POINTER;
     if ( NULL == guid ) return VSCP_ERROR_INVALID_POINTER;
 
-    sprintf( strguid, 
-                "%02X:%02X:%02X:%02X:%02X:%02X:%02X:%02X:"
-                "%02X:%02X:%02X:%02X:%02X:%02X:%02X:%02X",
-                guid[0], guid[1], guid[2], guid[3],
-                guid[4], guid[5], guid[6], guid[7],
-                guid[8], guid[9], guid[10], guid[11],
-                guid[12], guid[13], guid[14], guid[15] );
+    *writeGuid( strguid, guid ) = '\0';
     
     return VSCP_ERROR_SUCCESS;
 }
@@ -627,54 +736,72 @@ int parseMask( const char *strmask, vscpEventFilter *evfilter )
 
 
 ///////////////////////////////////////////////////////////////////////////////
-// parseEvent
+// parseEventToBuffer
 //
 // head,class,type,obid,datetime,timestamp,GUID,data1,data2,data3....
 //
+// No heap is used. Data is stored in the caller supplied buffer and 
+// ev->pdata is set to point at it. The string length is only calculated
+// once so the parser is linear in the length of the string.
+//
 
-int parseEvent( const char *strevent, vscpEvent *ev )
+int parseEventToBuffer( const char *strevent, 
+                            vscpEvent *ev, 
+                            uint8_t *pdata, 
+                            uint16_t size )
+{
+    // Check pointers
+    if ( NULL == strevent ) return VSCP_ERROR_INVALID_POINTER;
+
+    return parseEventRange( strevent, 
+                                strevent + strlen( strevent ), 
+                                ev, 
+                                pdata, 
+                                size );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// parseEventRange
+//
+// Parse the event in strevent up to pend (which does not need to be a 
+// null terminator).
+//
+
+static int parseEventRange( const char *strevent, 
+                                const char *pend,
+                                vscpEvent *ev, 
+                                uint8_t *pdata, 
+                                uint16_t size )
 {
-    uint8_t buf[512];
     char *p = (char *)strevent;
 
     // Check pointers
     if ( NULL == strevent ) return VSCP_ERROR_INVALID_POINTER;
     if ( NULL == ev ) return VSCP_ERROR_INVALID_POINTER;
+    if ( ( NULL == pdata ) && size ) return VSCP_ERROR_INVALID_POINTER;
 
     // Set all defaults
-    memset( ev, 0, sizeof(ev) );
+    memset( ev, 0, sizeof( vscpEvent ) );
 
     // head
     ev->head = (uint16_t)strtol( p, &p, 0 );
     if ( ',' != *p ) return VSCP_ERROR_ERROR;
     p++; // point beyond comma
-    if ( p > (strevent + strlen(strevent) ) ) {
-        return VSCP_ERROR_ERROR;
-    }
 
     // VSCP class
     ev->vscp_class = (uint16_t)strtol( p, &p, 0 );
     if ( ',' != *p ) return VSCP_ERROR_ERROR;
     p++; // point beyond comma
-    if ( p > (strevent + strlen(strevent) ) ) {
-        return VSCP_ERROR_ERROR;
-    }
 
     // VSCP type
     ev->vscp_type = (uint16_t)strtol( p, &p, 0 );
     if ( ',' != *p ) return VSCP_ERROR_ERROR;
-    p++;
-    if ( p > (strevent + strlen(strevent) ) ) {
-        return VSCP_ERROR_ERROR;
-    }
+    p++; // point beyond comma
 
     // obid
-    ev->obid = (uint32_t)strtol( p, &p, 0 );
+    ev->obid = (uint32_t)strtoul( p, &p, 0 );
     if ( ',' != *p ) return VSCP_ERROR_ERROR;
     p++; // point beyond comma
-    if ( p > (strevent + strlen(strevent) ) ) {
-        return VSCP_ERROR_ERROR;
-    }
 
     // datetime YYYY-MM-DDTHH:MM:SS
 
@@ -690,58 +817,37 @@ int parseEvent( const char *strevent, vscpEvent *ev )
         ev->year = (uint16_t)strtol( p, &p, 0 );
         if ( '-' != *p ) return VSCP_ERROR_ERROR;
         p++; // point beyond dash
-        if ( p > (strevent + strlen(strevent) ) ) {
-            return VSCP_ERROR_ERROR;
-        }
 
         // month
         ev->month = (uint16_t)strtol( p, &p, 0 );
         if ( '-' != *p ) return VSCP_ERROR_ERROR;
         p++; // point beyond dash
-        if ( p > (strevent + strlen(strevent) ) ) {
-            return VSCP_ERROR_ERROR;
-        }
 
         // day
         ev->day = (uint16_t)strtol( p, &p, 0 );
         if ( 'T' != *p ) return VSCP_ERROR_ERROR;
-        p++; // point beyond dash
-        if ( p > (strevent + strlen(strevent) ) ) {
-            return VSCP_ERROR_ERROR;
-        }
+        p++; // point beyond 'T'
 
         // hour
         ev->hour = (uint16_t)strtol( p, &p, 0 );
         if ( ':' != *p ) return VSCP_ERROR_ERROR;
         p++; // point beyond colon
-        if ( p > (strevent + strlen(strevent) ) ) {
-            return VSCP_ERROR_ERROR;
-        }
 
         // minute
         ev->minute = (uint16_t)strtol( p, &p, 0 );
         if ( ':' != *p ) return VSCP_ERROR_ERROR;
         p++; // point beyond colon
-        if ( p > (strevent + strlen(strevent) ) ) {
-            return VSCP_ERROR_ERROR;
-        }
 
         // second
         ev->second = (uint16_t)strtol( p, &p, 0 );
         if ( ',' != *p ) return VSCP_ERROR_ERROR;
         p++; // point beyond comma
-        if ( p > (strevent + strlen(strevent) ) ) {
-            return VSCP_ERROR_ERROR;
-        }
     }
 
     // timestamp
-    ev->timestamp = (uint32_t)strtol( p, &p, 0 );
+    ev->timestamp = (uint32_t)strtoul( p, &p, 0 );
     if ( ',' != *p ) return VSCP_ERROR_ERROR;
     p++; // point beyond comma
-    if ( p > (strevent + strlen(strevent) ) ) {
-        return VSCP_ERROR_ERROR;
-    }
  
     // Get GUID
     if ( VSCP_ERROR_SUCCESS != parseGuid( p, &p, ev->GUID ) ) {
@@ -750,20 +856,39 @@ int parseEvent( const char *strevent, vscpEvent *ev )
 
     if ( ',' != *p ) return VSCP_ERROR_ERROR;
     p++; // point beyond comma
-    ev->sizeData = 0;
     
     // Get data (if any )
-    while ( ( p <= ( strevent + strlen( strevent ) ) ) &&
-            ( ev->sizeData < 512 ) ) {      
-        buf[ev->sizeData] = (uint8_t)strtol( p, &p, 0 );
+    ev->pdata = pdata;
+    while ( p < pend ) {
+        if ( ev->sizeData >= size ) return VSCP_ERROR_BUFFER_TO_SMALL;
+        pdata[ev->sizeData] = (uint8_t)strtol( p, &p, 0 );
         ev->sizeData++;
         p++; // point beyond comma
     }
 
+    return VSCP_ERROR_SUCCESS;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// parseEvent
+//
+
+int parseEvent( const char *strevent, vscpEvent *ev )
+{
+    int rv;
+    uint8_t buf[VSCP_MAX_DATA];
+
+    rv = parseEventToBuffer( strevent, ev, buf, sizeof( buf ) );
+    if ( VSCP_ERROR_SUCCESS != rv ) {
+        if ( NULL != ev ) ev->pdata = NULL;
+        return rv;
+    }
+
     // Copy in data (if any)
+    ev->pdata = NULL;
     if ( ev->sizeData ) {
         ev->pdata = VSCP_LINK_MALLOC(ev->sizeData);
-        if ( NULL == ev->pdata ) return VSCP_ERROR_ERROR;
+        if ( NULL == ev->pdata ) return VSCP_ERROR_MEMORY;
         memcpy( ev->pdata, buf, ev->sizeData );
     }
 
@@ -773,10 +898,13 @@ int parseEvent( const char *strevent, vscpEvent *ev )
 ///////////////////////////////////////////////////////////////////////////////
 // parseEventEx
 //
+// Data is parsed directly into the data array of the ex event
+//
 
 int parseEventEx( const char *streventex, vscpEventEx *evex )
 {
-    char *p = (char *)streventex;
+    int rv;
+    vscpEvent ev;
 
     // Check pointers
     if ( NULL == streventex ) return VSCP_ERROR_INVALID_POINTER;
@@ -784,33 +912,23 @@ int parseEventEx( const char *streventex, vscpEventEx *evex )
 
     memset( evex, 0, sizeof( vscpEventEx ) );
 
-    vscpEvent *ev = newEvent();
-    if ( NULL == ev ) return VSCP_ERROR_ERROR;
-
-    if ( VSCP_ERROR_SUCCESS != parseEvent( streventex, ev ) ) {
-        deleteEvent( &ev );
-        return VSCP_ERROR_ERROR;
-    }
-
-    // Copy in data
-    evex->head = ev->head;
-    evex->obid = ev->obid;
-    evex->year = ev->year;
-    evex->month = ev->month;
-    evex->day = ev->day;
-    evex->hour = ev->hour;
-    evex->minute = ev->minute;
-    evex->second = ev->second;
-    evex->timestamp = ev->timestamp;
-    evex->vscp_class = ev->vscp_class;
-    evex->vscp_type = ev->vscp_type;
-    memcpy( evex->GUID, ev->GUID, 16 );
-    evex->sizeData = ev->sizeData;
-    if ( evex->sizeData ) {
-        memcpy( evex->data, ev->pdata, evex->sizeData );
-    }
-
-    deleteEvent( &ev );
+    rv = parseEventToBuffer( streventex, &ev, evex->data, sizeof( evex->data ) );
+    if ( VSCP_ERROR_SUCCESS != rv ) return rv;
+
+    // Copy in header
+    evex->head = ev.head;
+    evex->obid = ev.obid;
+    evex->year = ev.year;
+    evex->month = ev.month;
+    evex->day = ev.day;
+    evex->hour = ev.hour;
+    evex->minute = ev.minute;
+    evex->second = ev.second;
+    evex->timestamp = ev.timestamp;
+    evex->vscp_class = ev.vscp_class;
+    evex->vscp_type = ev.vscp_type;
+    memcpy( evex->GUID, ev.GUID, 16 );
+    evex->sizeData = ev.sizeData;
 
     return VSCP_ERROR_SUCCESS;
 }
@@ -820,77 +938,99 @@ int parseEventEx( const char *streventex, vscpEventEx *evex )
 ///////////////////////////////////////////////////////////////////////////////
 // eventToString
 //
-// head       4  - 0xff or 255
-// class      6  - 0xFFFF or 65535
-// type       6  - 0xFFFF or 65535
-// obid       10 - 0xFFFFFFFF
-// time       20 - YYYY-MM-DDTHH:MM:SSZ
-// timestamp  10 - 0xFFFFFFFF
+// head       5  - 65535
+// class      5  - 65535
+// type       5  - 65535
+// obid       10 - 4294967295
+// time       26 - YYYYY-MMM-DDDTHHH:MMM:SSSZ (out of range fields in full)
+// timestamp  10 - 4294967295
 // GUID       47 - 00:11:22:33:44:55:66:77:88:99:AA:BB:CC:DD:EE:FF
 // ---------------------------------------------------------------
-// Total:     103 + 7 (commas) + data = 110 + data
+// Total:     108 + 6 (commas) + data = 114 + data
+//
+// Each data byte needs at most four characters (",255") and the 
+// string is null terminated, see VSCP_LINK_EVENT_STR_SIZE. The buffer is checked once against this
+// worst case and the string is then written in a single pass.
 //
 
 int eventToString( const vscpEvent *ev, char *strevent, size_t len )
 {
-    char buf[48];   // Can hold full GUID
+    char *p = strevent;
+    uint16_t sizeData;
 
     // Check pointers
     if ( NULL == ev ) return VSCP_ERROR_INVALID_POINTER;
     if ( NULL == strevent ) return VSCP_ERROR_INVALID_POINTER;
 
-    // Len must be able to hold content 
-    if ( len < 110 ) return VSCP_ERROR_BUFFER_TO_SMALL;
+    sizeData = ( NULL != ev->pdata ) ? ev->sizeData : 0;
 
-    if ( ev->year || ev->month || ev->day || ev->hour || ev->minute || ev->second ) {
-        sprintf( strevent, 
-                    "%u,%u,%u,%lu,%4d-%02d-%02dT%02d:%02d:%02dZ,%lu,", 
-                    (unsigned)ev->head, (unsigned)ev->vscp_class, (unsigned)ev->vscp_type, 
-                    (unsigned long)ev->obid, 
-                    (int)ev->year, (int)ev->month, (int)ev->day, 
-                    (int)ev->hour, (int)ev->minute, (int)ev->second,
-                    (unsigned long)ev->timestamp );
-    }
-    else {
-        sprintf( strevent, 
-                    "%d,%u,%u,%lu,,%lu,", 
-                    (unsigned)ev->head, (unsigned)ev->vscp_class, (unsigned)ev->vscp_type, 
-                    (unsigned long)ev->obid, (unsigned long)ev->timestamp );
+    // Len must be able to hold content 
+    if ( len < ( VSCP_LINK_EVENT_STR_SIZE(sizeData) ) ) {
+        return VSCP_ERROR_BUFFER_TO_SMALL;
     }
 
-    // GUID
-    writeGuidToString( ev->GUID, buf );                
-    strcat( strevent, buf );
-
-    // Data
-    if ( ( NULL != ev->pdata ) && ev->sizeData ) {
+    *writeEvent( p, ev ) = '\0';
 
-        if ( len < ( strlen(strevent) + 1 + 1 ) ) {
-            return VSCP_ERROR_BUFFER_TO_SMALL;
-        }
-        strcat( strevent, "," );
+    return VSCP_ERROR_SUCCESS;
+}
 
-        for ( int i=0; i < ev->sizeData; i++ ) {
+///////////////////////////////////////////////////////////////////////////////
+// writeEvent
+//
+// Write event on string form at p and return pointer to the position after
+// the last written character. No null termination and no bounds checking,
+// the buffer must be able to hold VSCP_LINK_EVENT_STR_SIZE(ev->sizeData).
+//
 
-            if ( i < (ev->sizeData-1) ) {
-                sprintf( buf, "%d,", (int)ev->pdata[i] );
-            }
-            else {
-                sprintf( buf, "%d", (int)ev->pdata[i] );
-            }
+static char *writeEvent( char *p, const vscpEvent *ev )
+{
+    uint16_t sizeData;
+    int i;
 
-            // Check that data fits
-            if ( len < ( strlen(strevent) + 1 + strlen( buf ) ) ) {
-                return VSCP_ERROR_BUFFER_TO_SMALL;
-            }
+    sizeData = ( NULL != ev->pdata ) ? ev->sizeData : 0;
 
-            // Copy in the data
-            strcat( strevent, buf );
+    p = vscp_fmt_writeUint( p, ev->head );
+    *p++ = ',';
+    p = vscp_fmt_writeUint( p, ev->vscp_class );
+    *p++ = ',';
+    p = vscp_fmt_writeUint( p, ev->vscp_type );
+    *p++ = ',';
+    p = vscp_fmt_writeUint( p, ev->obid );
+    *p++ = ',';
 
+    if ( ev->year || ev->month || ev->day || ev->hour || ev->minute || ev->second ) {
+        if ( ev->year < 10000 ) {
+            p = vscp_fmt_write2Digits( p, (uint8_t)( ev->year / 100 ) );
+            p = vscp_fmt_write2Digits( p, (uint8_t)( ev->year % 100 ) );
+        }
+        else {
+            p = vscp_fmt_writeUint( p, ev->year );
         }
+        *p++ = '-';
+        p = vscp_fmt_write2Digits( p, ev->month );
+        *p++ = '-';
+        p = vscp_fmt_write2Digits( p, ev->day );
+        *p++ = 'T';
+        p = vscp_fmt_write2Digits( p, ev->hour );
+        *p++ = ':';
+        p = vscp_fmt_write2Digits( p, ev->minute );
+        *p++ = ':';
+        p = vscp_fmt_write2Digits( p, ev->second );
+        *p++ = 'Z';
+    }
+    *p++ = ',';
+
+    p = vscp_fmt_writeUint( p, ev->timestamp );
+    *p++ = ',';
+
+    // GUID
+    p = writeGuid( p, ev->GUID );
 
+    // Data
+    for ( i=0; i < sizeData; i++ ) {
+        *p++ = ',';
+        p = vscp_fmt_writeUint( p, ev->pdata[i] );
     }
 
-    return VSCP_ERROR_SUCCESS;
+    return p;
 }
-
@@ -34,6 +34,7 @@
 
 #include "vscp.h"
 
+// Queue sizes for hosts that keep the link queues in vscp_evring_t's
 #define MAX_INQUEUE         10      // Max # events in in-queue
 #define MAX_OUTQUEUE        10      // Max # events in out-queue
 
@@ -82,6 +83,23 @@
 #define VSCP_LINK_MSG_INVALID_PATH                    "-OK - Invalid path.\r\n"
 #define VSCP_LINK_MSG_FAILED_TO_GENERATE_SID          "-OK - Failed to generate sid.\r\n"
 
+// Worst case buffer size needed by eventToString for an event with
+// sizeData data bytes (including terminating null). That is head, class,
+// type and obid (5+5+5+10), a date with out of range fields written in
+// full (5+5*3+6), timestamp (10), GUID (47), six commas and ",255" for
+// each data byte
+#define VSCP_LINK_EVENT_STR_SIZE(sizeData)     ( 114 + 4 * (sizeData) + 1 )
+
+// Size of the buffer used to collect batched replies (RETR n). Must be able
+// to hold at least one event line with full data.
+#ifndef VSCP_LINK_OUTBUF_SIZE
+#define VSCP_LINK_OUTBUF_SIZE   4096
+#endif
+
+#if ( VSCP_LINK_OUTBUF_SIZE < ( VSCP_LINK_EVENT_STR_SIZE( VSCP_MAX_DATA ) + 2 ) )
+#error "VSCP_LINK_OUTBUF_SIZE must be able to hold one full event line"
+#endif
+
 #define VSCP_LINK_MALLOC(s)     malloc(s)
 #define VSCP_LINK_REMALLOC(s)   remalloc(s)
 #define VSCP_LINK_FREE(x)       free(x)
@@ -117,8 +135,41 @@ int parseMask( const char *strmask, vscpEventFilter *evfilter );
 
 int parseEvent( const char *strevent, vscpEvent *ev );
 
+///////////////////////////////////////////////////////////////////////////////
+// parseEventToBuffer
+//
+// Parse event without using the heap. Event data is written to the caller
+// supplied buffer pdata (which can be a pool/arena slot) and ev->pdata is set
+// to point at it.
+//
+// @param strevent  Event on string form.
+// @param ev        Event that will get the parsed content.
+// @param pdata     Buffer for event data.
+// @param size      Size of data buffer.
+// @return VSCP_ERROR_SUCCESS on success, VSCP_ERROR_BUFFER_TO_SMALL if the
+//          data does not fit in the supplied buffer.
+//
+
+int parseEventToBuffer( const char *strevent, 
+                            vscpEvent *ev, 
+                            uint8_t *pdata, 
+                            uint16_t size );
+
 int parseEventEx( const char *streventex, vscpEventEx *evex );
 
+///////////////////////////////////////////////////////////////////////////////
+// eventToString
+//
+// Write event on string form. The buffer must be able to hold the worst
+// case string for the event, use VSCP_LINK_EVENT_STR_SIZE to size it.
+//
+// @param ev        Event to convert.
+// @param strevent  Buffer that will get the null terminated string.
+// @param len       Size of buffer.
+// @return VSCP_ERROR_SUCCESS on success, VSCP_ERROR_BUFFER_TO_SMALL if the
+//          buffer can't hold the worst case string for the event.
+//
+
 int eventToString( const vscpEvent *ev, char *strevent, size_t len );
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -131,7 +182,7 @@ int vscp_link_doCmdQuit( const char *cmd );
 int vscp_link_doCmdUser( const char *cmd );
 int vscp_link_doCmdPassword( const char *cmd );
 int vscp_link_doCmdChallenge( const char *cmd );
-int vscp_link_doCmdSend( const char *cmd );;
+int vscp_link_doCmdSend( const char *cmd );
 int vscp_link_doCmdRetrive( const char *cmd );
 int vscp_link_doCmdRcvLoop( const char *cmd );
 int vscp_link_doCmdQuitLoop( const char *cmd );
@@ -169,6 +220,16 @@ int vscp_link_callback_welcome( const char *msg );
 // Send null terminated data to client
 int vscp_link_callback_writeClient( const char *msg );
 
+// Send len bytes of data to client. Used for batched replies where 
+// many event lines and the final "+OK" are written with one call. 
+// The data is not null terminated.
+int vscp_link_callback_writeClientBuf( const char *buf, size_t len );
+
+// Get the output buffer of the current session. It must hold
+// VSCP_LINK_OUTBUF_SIZE chars and not be used by other sessions, so
+// sessions can be served concurrently. Return NULL if there is none.
+char *vscp_link_callback_getOutBuf( void );
+
 // Read a command line form client. Can get max len chars.
 int vscp_link_callback_readClient( const char *msg, size_t len );
 
@@ -185,9 +246,15 @@ int vscp_link_callback_checkUser( const char *user );
 
 int vscp_link_callback_checkPassword( const char *user );
 
-// Event has ben received from client.
+// Event has ben received from client. Called once for each event of a 
+// multi event send. ev->pdata is only valid during the call so the event
+// must be copied if it is queued. Return VSCP_ERROR_SUCCESS if the event 
+// was accepted.
 int vscp_link_callback_eventReceived( const vscpEvent *ev );
 
-// Fetch one event from output queue (if any)
-int vscp_link_callback_eventGet( const vscpEvent *ev );
+// Fetch one event from output queue (if any). ev->pdata points to a buffer
+// that can hold VSCP_MAX_DATA bytes which the data should be copied to.
+// Return VSCP_ERROR_SUCCESS if an event was fetched and VSCP_ERROR_RCV_EMPTY
+// if no event is available.
+int vscp_link_callback_eventGet( vscpEvent *ev );
 
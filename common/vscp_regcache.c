@@ -0,0 +1,225 @@
+// FILE: vscp_regcache.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "vscp_regcache.h"
+
+#if ( VSCP_REGCACHE_PAGE_SIZE & ( VSCP_REGCACHE_PAGE_SIZE - 1 ) ) || \
+        ( VSCP_REGCACHE_SIZE % VSCP_REGCACHE_PAGE_SIZE ) || \
+        ( VSCP_REGCACHE_PAGE_SIZE < 8 ) || ( VSCP_REGCACHE_PAGE_SIZE > 128 )
+#error "VSCP_REGCACHE_PAGE_SIZE must be a power of two (8-128) that divides VSCP_REGCACHE_SIZE"
+#endif
+
+// Shadow of storage
+static uint8_t shadow[ VSCP_REGCACHE_SIZE ];
+
+// One bit for each byte that differs from storage
+static uint8_t dirty[ VSCP_REGCACHE_SIZE / 8 ];
+
+// One bit for each page with dirty bytes
+static uint8_t dirtyPage[ ( VSCP_REGCACHE_PAGES + 7 ) / 8 ];
+
+static uint16_t cntDirtyPages;      // Pages waiting to be written
+static uint16_t nextPage;           // Where the search for a dirty page starts
+static uint16_t lastWrite;          // Time of last write
+static uint16_t firstWrite;         // Time of oldest unflushed write
+
+///////////////////////////////////////////////////////////////////////////////
+// flushPage
+//
+// Write the dirty bytes of one page as a single run from the first to the
+// last dirty byte. Clean bytes in between are written with the value
+// storage already has.
+//
+
+static void flushPage( uint16_t page )
+{
+    uint16_t base = page * VSCP_REGCACHE_PAGE_SIZE;
+    uint8_t *pbits = &dirty[ base / 8 ];
+    uint8_t first = 0xff;
+    uint8_t last = 0;
+    uint8_t i;
+
+    for ( i = 0; i < VSCP_REGCACHE_PAGE_SIZE; i++ ) {
+        if ( pbits[ i / 8 ] & ( 1 << ( i & 7 ) ) ) {
+            if ( 0xff == first ) first = i;
+            last = i;
+        }
+    }
+
+    memset( pbits, 0, VSCP_REGCACHE_PAGE_SIZE / 8 );
+    dirtyPage[ page / 8 ] &= ~( 1 << ( page & 7 ) );
+    cntDirtyPages--;
+
+    if ( 0xff != first ) {
+        vscp_regcache_storePage( base + first,
+                                    &shadow[ base + first ],
+                                    last - first + 1 );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// flushNext
+//
+
+static void flushNext( void )
+{
+    uint16_t page = nextPage;
+
+    while ( !( dirtyPage[ page / 8 ] & ( 1 << ( page & 7 ) ) ) ) {
+        if ( ++page >= VSCP_REGCACHE_PAGES ) page = 0;
+    }
+
+    flushPage( page );
+
+    nextPage = page + 1;
+    if ( nextPage >= VSCP_REGCACHE_PAGES ) nextPage = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_regcache_init
+//
+
+void vscp_regcache_init( void )
+{
+    vscp_regcache_loadStorage( 0, shadow, VSCP_REGCACHE_SIZE );
+    memset( dirty, 0, sizeof( dirty ) );
+    memset( dirtyPage, 0, sizeof( dirtyPage ) );
+    cntDirtyPages = 0;
+    nextPage = 0;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_regcache_read
+//
+
+uint8_t vscp_regcache_read( uint16_t addr )
+{
+    if ( addr >= VSCP_REGCACHE_SIZE ) return 0xff;
+    return shadow[ addr ];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_regcache_readBuf
+//
+
+void vscp_regcache_readBuf( uint16_t addr, uint8_t *pData, uint16_t cnt )
+{
+    while ( cnt-- ) {
+        *pData++ = vscp_regcache_read( addr++ );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_regcache_write
+//
+
+uint8_t vscp_regcache_write( uint16_t addr, uint8_t value, uint16_t now )
+{
+    uint16_t page;
+
+    if ( addr >= VSCP_REGCACHE_SIZE ) return 0xff;
+
+    // Nothing to do if storage will not change
+    if ( shadow[ addr ] == value ) return value;
+
+    shadow[ addr ] = value;
+    dirty[ addr / 8 ] |= ( 1 << ( addr & 7 ) );
+
+    page = addr / VSCP_REGCACHE_PAGE_SIZE;
+    if ( !( dirtyPage[ page / 8 ] & ( 1 << ( page & 7 ) ) ) ) {
+        dirtyPage[ page / 8 ] |= ( 1 << ( page & 7 ) );
+        if ( !cntDirtyPages++ ) firstWrite = now;
+    }
+
+    lastWrite = now;
+
+    return value;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_regcache_writeBuf
+//
+
+void vscp_regcache_writeBuf( uint16_t addr,
+                                const uint8_t *pData,
+                                uint16_t cnt,
+                                uint16_t now )
+{
+    while ( cnt-- ) {
+        vscp_regcache_write( addr++, *pData++, now );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_regcache_doWork
+//
+
+int vscp_regcache_doWork( uint16_t now )
+{
+    if ( !cntDirtyPages ) return 0;
+
+    // Wait for the burst of writes to end, but not forever
+    if ( ( (uint16_t)( now - lastWrite ) < VSCP_REGCACHE_FLUSH_DELAY ) &&
+            ( (uint16_t)( now - firstWrite ) < VSCP_REGCACHE_MAX_AGE ) ) {
+        return 1;
+    }
+
+    flushNext();
+
+    return ( 0 != cntDirtyPages );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_regcache_flush
+//
+
+void vscp_regcache_flush( void )
+{
+    while ( cntDirtyPages ) {
+        flushNext();
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_regcache_dirty
+//
+
+int vscp_regcache_dirty( void )
+{
+    return ( 0 != cntDirtyPages );
+}
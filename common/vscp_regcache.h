@@ -0,0 +1,164 @@
+// FILE: vscp_regcache.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#ifndef _VSCP_REGCACHE_H_
+#define _VSCP_REGCACHE_H_
+
+#include <stdint.h>
+#include <vscp_projdefs.h>  // This file should be in your project folder
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+    Register cache
+
+    RAM shadow of the part of EEPROM/NVM that holds registers, nickname and
+    other configuration. Reads are served from RAM. Writes only update RAM
+    and mark the byte dirty, a write with the value already stored is
+    skipped. Dirty bytes are written back one storage page at a time with
+    vscp_regcache_storePage when nothing has been written for
+    VSCP_REGCACHE_FLUSH_DELAY ms or when the oldest dirty byte is
+    VSCP_REGCACHE_MAX_AGE ms old. Call vscp_regcache_doWork from the main
+    loop for this. Call vscp_regcache_flush before a reset, before entering
+    the bootloader and before power down.
+
+    Addresses are storage addresses. The application decides where the
+    registers of each page, the nickname etc are located.
+*/
+
+// Bytes of storage shadowed (starting at address 0)
+#ifndef VSCP_REGCACHE_SIZE
+#define VSCP_REGCACHE_SIZE          512
+#endif
+
+// Storage page size. Must be a power of two. A flush never writes across
+// a page boundary.
+#ifndef VSCP_REGCACHE_PAGE_SIZE
+#define VSCP_REGCACHE_PAGE_SIZE     16
+#endif
+
+// Flush when no write has been done for this many ms
+#ifndef VSCP_REGCACHE_FLUSH_DELAY
+#define VSCP_REGCACHE_FLUSH_DELAY   200
+#endif
+
+// Flush when the oldest unflushed write is this many ms old
+#ifndef VSCP_REGCACHE_MAX_AGE
+#define VSCP_REGCACHE_MAX_AGE       2000
+#endif
+
+#define VSCP_REGCACHE_PAGES         ( VSCP_REGCACHE_SIZE / VSCP_REGCACHE_PAGE_SIZE )
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_regcache_init
+//
+// Load the shadow from storage with vscp_regcache_loadStorage. Nothing is
+// dirty after this.
+//
+
+void vscp_regcache_init( void );
+
+// Read one byte
+uint8_t vscp_regcache_read( uint16_t addr );
+
+// Read cnt bytes starting at addr
+void vscp_regcache_readBuf( uint16_t addr, uint8_t *pData, uint16_t cnt );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_regcache_write
+//
+// Write one byte. It is written to storage on a later flush.
+//
+// @param now   Current time in ms (a free running 16-bit counter such as
+//              vscp_timer). Used for the flush timing.
+// @return      The byte now stored at addr.
+//
+
+uint8_t vscp_regcache_write( uint16_t addr, uint8_t value, uint16_t now );
+
+// Write cnt bytes starting at addr
+void vscp_regcache_writeBuf( uint16_t addr,
+                                const uint8_t *pData,
+                                uint16_t cnt,
+                                uint16_t now );
+
+///////////////////////////////////////////////////////////////////////////////
+// vscp_regcache_doWork
+//
+// Write at most one dirty page to storage if it is time to flush. Never
+// writes more than one page per call so the main loop is not held up.
+//
+// @param now   Current time in ms.
+// @return      Non zero if there still is unflushed data.
+//
+
+int vscp_regcache_doWork( uint16_t now );
+
+// Write all dirty pages to storage now
+void vscp_regcache_flush( void );
+
+// Non zero if there is unflushed data
+int vscp_regcache_dirty( void );
+
+// --------------------------- External Functions -----------------------------
+//
+// Implemented by the application
+//
+// --------------------------- External Functions -----------------------------
+
+/*!
+    Read storage.
+    @param addr First address to read.
+    @param pData Buffer that will get the data.
+    @param cnt Number of bytes to read.
+ */
+void vscp_regcache_loadStorage( uint16_t addr, uint8_t *pData, uint16_t cnt );
+
+/*!
+    Write storage. The bytes always lie within one storage page
+    (VSCP_REGCACHE_PAGE_SIZE) so this can be done with a single page
+    write.
+    @param addr First address to write.
+    @param pData Data to write.
+    @param cnt Number of bytes to write.
+ */
+void vscp_regcache_storePage( uint16_t addr, const uint8_t *pData, uint8_t cnt );
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _VSCP_REGCACHE_H_ */
@@ -41,8 +41,53 @@
 #include <inttypes.h>
 #include "vscp_compiler.h"
 #include "vscp_projdefs.h"
+#include "vscp_format.h"
 #include "vscp_server.h"
 
+// Worst case RETR line for an event with n data bytes. 
+// head,class,type,obid,timestamp = 5+5+5+1+10 + 5 commas, GUID 47,
+// four characters per data byte and <cr><lf> + null.
+#define VSCP_SERVER_RETR_BUF_SIZE( n )      ( 31 + 47 + 4 * ( n ) + 3 )
+
+///////////////////////////////////////////////////////////////////////////////
+// writeGUID
+//
+// Write GUID at p on the same form (and order) as vscp_server_GUID2String.
+// Returns pointer to position after the last written character. 
+// No null termination.
+//
+
+static char *writeGUID( char *p, const uint8_t *pGUID )
+{
+    uint8_t i;
+
+    for ( i=0; i<16; i++ ) {
+        p = vscp_fmt_writeHex2( p, pGUID[ 15-i ] );
+        *p++ = ':';
+    }
+
+    return p - 1;   // No colon after last byte
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// writeData
+//
+// Write data bytes as ",d0,d1,d2..." at p. Returns pointer to position 
+// after the last written character. No null termination.
+//
+
+static char *writeData( char *p, const uint8_t *pData, uint16_t size )
+{
+    uint16_t i;
+
+    for ( i=0; i<size; i++ ) {
+        *p++ = ',';
+        p = vscp_fmt_writeUint( p, pData[ i ] );
+    }
+
+    return p;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // vscpServerParser
 //
@@ -99,9 +144,11 @@ int vscpServerParser( char *pCommand )
         char *p = pCommand + 4;
         vscpEvent event;
 #ifdef VSCP_LEVEL2_LIMITED_DEVICE
-        char buf[ 31 + 64 +  3 * ( 512 - 25 + 1 ) ];
+        const uint16_t maxData = LIMITED_DEVICE_DATASIZE;
+        char buf[ VSCP_SERVER_RETR_BUF_SIZE( LIMITED_DEVICE_DATASIZE ) ];
 #else        
-        char buf[ 31 + 64 +  3 * ( LIMITED_DEVICE_DATASIZE + 1 ) ];
+        const uint16_t maxData = 512 - 25;
+        char buf[ VSCP_SERVER_RETR_BUF_SIZE( 512 - 25 ) ];
 #endif        
 
         // Get read count
@@ -110,50 +157,48 @@ int vscpServerParser( char *pCommand )
         // Default to read one event
         if ( 0 == count ) count = 1;
         
-        char wrkbuf[ 32 ];
         while ( count-- ) {
             
             // Get event
             if ( !vscp_server_command_retr( &event ) ) break; 
             
-            // Empty reply string
-            buf[ 0 ] = 0x00;
-        
             // Event available. We should output a dataline.
             // Format is
             // head,class,type,obid,timestamp,GUID,data0,data1,data2,...........<cr><lf>
+            // The buffer is sized for the worst case line so it is 
+            // written in one pass. Only the data size, which comes from
+            // the application, is checked.
+            if ( event.sizeData > maxData ) event.sizeData = maxData;
+            p = buf;
             
             // head
-            itoa( event.head, wrkbuf );
-            strcat( buf, wrkbuf ); 
-            strcat( buf, "," );
+            p = vscp_fmt_writeUint( p, event.head );
+            *p++ = ',';
              
             // class 
-            itoa( event.vscp_class, wrkbuf );
-            strcat( buf, wrkbuf ); 
-            strcat( buf, "," ); 
+            p = vscp_fmt_writeUint( p, event.vscp_class );
+            *p++ = ',';
             
             // type
-            itoa( event.vscp_type, wrkbuf );
-            strcat( buf, wrkbuf ); 
-            strcat( buf, "," );
+            p = vscp_fmt_writeUint( p, event.vscp_type );
+            *p++ = ',';
             
             // obid  
-            strcat( buf, "0," );
+            *p++ = '0';
+            *p++ = ',';
             
             // timestamp
-            itoa( vscp_server_getTicks(), wrkbuf );
-            strcat( buf, wrkbuf ); 
-            strcat( buf, "," );
+            p = vscp_fmt_writeUint( p, vscp_server_getTicks() );
+            *p++ = ',';
             
             // GUID
-            vscp_server_GUID2String( event.GUID, wrkbuf );
-            strcat( buf, wrkbuf ); 
-            strcat( buf, "," );
+            p = writeGUID( p, event.GUID );
             
             // Data
-            vscp_server_Data2String( event.data, event.sizeData, buf + strlen( buf ) );
-            strcat( buf, "\r\n" );
+            p = writeData( p, event.data, event.sizeData );
+            *p++ = '\r';
+            *p++ = '\n';
+            *p = 0x00;
             vscp_server_sendReply( buf );
         }
             
@@ -293,7 +338,7 @@ int vscpServerParser( char *pCommand )
     //*********************************************************************
     else if ( NULL != strstr( pCommand, "GGID" ) ) {
         uint8_t GUID[ 16 ];
-        char buf[ 32 ];
+        char buf[ 50 ];     // GUID + <cr><lf> + null
         
         // Fetch the interface GUID
         vscp_server_command_ggid( GUID );
@@ -702,15 +747,7 @@ void vscp_server_ParseGUID( char *pArg, uint8_t *pGUID )
 
 void vscp_server_GUID2String( uint8_t *pGUID, char *pbuf )
 {
-    int i;
-    char wrkbuf[ 2 ];
-    
-    pbuf[ 0 ] = 0x00;    // Empty string
-    for ( i=0; i<16; i++ ) {
-        dec2hex( pGUID[ 15-i ], wrkbuf, 2 );
-        strcat( pbuf, wrkbuf );
-        if ( i != 15 ) strcat( pbuf, ":" );
-    }
+    *writeGUID( pbuf, pGUID ) = 0x00;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -744,15 +781,14 @@ uint16_t vscp_server_ParseData( char *pArg, uint8_t *pData, uint16_t *pcntData )
 
 void vscp_server_Data2String( uint8_t *pData, uint16_t size, char *pbuf )
 {
-    int i;
-    char wrkbuf[ 2 ];
-    
-    pbuf[ 0 ] = 0x00;    // Empty string
+    uint16_t i;
+
     for ( i=0; i<size; i++ ) {
-        dec2hex( pData[ 15-i ], wrkbuf, 2 );
-        strcat( pbuf, wrkbuf );
-        if ( i != 15 ) strcat( pbuf, ":" );
+        if ( i ) *pbuf++ = ',';
+        pbuf = vscp_fmt_writeUint( pbuf, pData[ i ] );
     }
+
+    *pbuf = 0x00;
 }
 
 ///////////////////////////////////////////////////////////////////////////////
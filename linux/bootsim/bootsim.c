@@ -0,0 +1,695 @@
+// FILE: bootsim.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Host side bootloader simulator. Runs common/vscp_bootloader.c against
+// an in-memory CAN bus and a host that programs an image using the
+// VSCP boot protocol. Time is simulated so results are repeatable.
+//
+//   bootsim [-b bitrate] [-l latency us] [-p loss %] [-w flash write us]
+//           [-W window] [-s image KB] [-a]
+//
+// With -a the host sends activate new image as soon as every block has
+// been sent, without waiting for the program ACKs. The node must write
+// the pending blocks first.
+//
+// Without -s image sizes from 32 KB to 512 KB are run.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <setjmp.h>
+#include <unistd.h>
+
+#include "hardware.h"
+#include <vscp_firmware.h>
+#include <vscp_class.h>
+#include <vscp_type.h>
+#include <crc.h>
+#include <vscp_bootloader.h>
+
+extern volatile uint16_t vscpboot_timer;
+extern uint8_t vscpboot_nickname;
+
+// Bits in an extended CAN frame with n data bytes (no stuff bits)
+#define CAN_FRAME_BITS( n )     ( 67 + 8 * ( n ) )
+
+#define SIM_QUEUE_SIZE          4096    // Frames in flight in each direction
+#define SIM_MAX_WINDOW          64      // Max blocks in flight for host
+#define SIM_TIME_LIMIT          3600e6  // Give up after an hour (us)
+
+#define SIM_EXIT_REBOOT         1
+#define SIM_EXIT_TIMEOUT        2
+
+// Simulation parameters
+static struct {
+    uint32_t bitrate;           // CAN bitrate (bits/s)
+    uint32_t latency;           // Host adapter latency each way (us)
+    double loss;                // Probability a frame is lost
+    double corrupt;             // Probability block data reaches node damaged
+    uint32_t flashTime;         // Time to write one block (us)
+    uint32_t nodeTime;          // Time for node to handle an event (us)
+    int window;                 // Blocks host keeps in flight
+    uint32_t timeout;           // Host reply timeout (us)
+    int earlyActivate;          // Activate before all program ACKs are in
+} cfg = { 125000, 1000, 0.0, 0.0, 5000, 20, VSCPBOOT_BUFFERS, 250000, 0 };
+
+// Frame queue for one direction
+typedef struct {
+    double at[ SIM_QUEUE_SIZE ];        // Time frame is seen by receiver
+    vscpevent ev[ SIM_QUEUE_SIZE ];
+    uint32_t head;
+    uint32_t tail;
+} frameq;
+
+static frameq toNode;
+static frameq toHost;
+
+static double now;              // Simulated time (us)
+static double hostTime;         // Time the host acts at (us)
+static double busFree;          // Time the bus is free
+static double lastTick;         // Time of last vscpboot_timer tick
+static int nodeActive;          // Node did something since last poll
+static uint32_t rnd = 1;        // Loss generator state
+
+static jmp_buf simExit;
+
+// Image and flash
+static uint8_t image[ VSCPBOOT_BLOCKS * VSCPBOOT_BLOCKSIZE ];
+static uint8_t flash[ VSCPBOOT_BLOCKS * VSCPBOOT_BLOCKSIZE ];
+static uint32_t imageBlocks;
+static uint8_t bootflag;
+
+// Statistics
+static uint32_t cntFrames;
+static uint32_t cntLost;
+static uint32_t cntRetries;
+
+// Host state
+typedef enum {
+    HOST_WAIT = 0,              // Waiting for node to be ready
+    HOST_ENTER,                 // Sent enter boot loader
+    HOST_BLOCKS,                // Sending blocks
+    HOST_ACTIVATE,              // Sent activate new image
+    HOST_DONE                   // New image activated
+} hoststate;
+
+#define BLK_PENDING             0
+#define BLK_START               1   // Sent START_BLOCK
+#define BLK_DATA                2   // Sent block data
+#define BLK_PROGRAM             3   // Sent PROGRAM_BLOCK_DATA
+#define BLK_DONE                4
+
+static struct {
+    hoststate state;
+    double start;               // Time host starts
+    double deadline;            // Timeout for enter/activate
+    uint32_t nextBlock;         // Next block never sent
+    uint32_t retry[ SIM_MAX_WINDOW + 1 ];   // Blocks to send again
+    int cntRetry;
+    uint8_t blkState[ VSCPBOOT_BLOCKS ];
+    int32_t xfer;               // Block in transfer or -1
+    double xferDeadline;
+    uint32_t inflight[ SIM_MAX_WINDOW ];    // Blocks waiting for program ACK
+    double inflightDeadline[ SIM_MAX_WINDOW ];
+    int cntInflight;
+    int early;                  // 1 = activate sent with blocks in flight,
+                                // 2 = that was NACK'ed
+} host;
+
+///////////////////////////////////////////////////////////////////////////////
+// Bus
+//
+
+static int chance( double p )
+{
+    if ( p <= 0 ) return 0;
+    rnd ^= rnd << 13;
+    rnd ^= rnd >> 17;
+    rnd ^= rnd << 5;
+    return ( ( rnd / 4294967296.0 ) < p );
+}
+
+static void busSend( frameq *pq, const vscpevent *pe, double t, double delay )
+{
+    double start = ( t > busFree ) ? t : busFree;
+
+    busFree = start + 1e6 * CAN_FRAME_BITS( pe->flags & 0x0F ) / cfg.bitrate;
+    cntFrames++;
+
+    if ( chance( cfg.loss ) ) {
+        cntLost++;
+        return;
+    }
+
+    if ( ( pq->tail - pq->head ) >= SIM_QUEUE_SIZE ) {
+        printf("Frame queue overflow.\n");
+        exit( -1 );
+    }
+
+    pq->at[ pq->tail % SIM_QUEUE_SIZE ] = busFree + delay;
+    pq->ev[ pq->tail % SIM_QUEUE_SIZE ] = *pe;
+    pq->tail++;
+}
+
+static int busReceive( frameq *pq, vscpevent *pe, double *pat )
+{
+    if ( ( pq->head == pq->tail ) || ( pq->at[ pq->head % SIM_QUEUE_SIZE ] > now ) ) {
+        return 0;
+    }
+
+    *pat = pq->at[ pq->head % SIM_QUEUE_SIZE ];
+    *pe = pq->ev[ pq->head % SIM_QUEUE_SIZE ];
+    pq->head++;
+    return 1;
+}
+
+static double busNext( frameq *pq )
+{
+    return ( pq->head == pq->tail ) ? SIM_TIME_LIMIT : pq->at[ pq->head % SIM_QUEUE_SIZE ];
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Host
+//
+
+static void hostSend( uint8_t type, uint32_t blockno, uint8_t size, const uint8_t *pdata )
+{
+    vscpevent e;
+
+    e.flags = VSCP_VALID_MSG + size;
+    e.priority = VSCP_PRIORITY_NORMAL;
+    e.vscp_class = VSCP_CLASS1_PROTOCOL;
+    e.vscp_type = type;
+    e.oaddr = 0;
+    if ( NULL != pdata ) {
+        memcpy( e.data, pdata, size );
+        
+        // Damaged data gets past the bus, the block CRC must catch it
+        if ( ( VSCP_TYPE_PROTOCOL_BLOCK_DATA == type ) && chance( cfg.corrupt ) ) {
+            e.data[ 0 ] ^= 0x01;
+        }
+    }
+    else {
+        e.data[ 0 ] = ( blockno >> 24 ) & 0xFF;
+        e.data[ 1 ] = ( blockno >> 16 ) & 0xFF;
+        e.data[ 2 ] = ( blockno >> 8 ) & 0xFF;
+        e.data[ 3 ] = blockno & 0xFF;
+    }
+
+    busSend( &toNode, &e, hostTime + cfg.latency, 0 );
+}
+
+static void hostRetryBlock( uint32_t blockno )
+{
+    host.blkState[ blockno ] = BLK_PENDING;
+    host.retry[ host.cntRetry++ ] = blockno;
+    cntRetries++;
+}
+
+static void hostRemoveInflight( int idx )
+{
+    host.cntInflight--;
+    host.inflight[ idx ] = host.inflight[ host.cntInflight ];
+    host.inflightDeadline[ idx ] = host.inflightDeadline[ host.cntInflight ];
+}
+
+static void hostEnter( void )
+{
+    uint8_t data[ 8 ];
+
+    data[ 0 ] = vscpboot_nickname;
+    data[ 1 ] = VSCP_BOOTLOADER_VSCP;
+    data[ 2 ] = vscpboot_getGUID( 0 );
+    data[ 3 ] = vscpboot_getGUID( 3 );
+    data[ 4 ] = vscpboot_getGUID( 5 );
+    data[ 5 ] = vscpboot_getGUID( 7 );
+    data[ 6 ] = ( vscpboot_getPage() >> 8 ) & 0xFF;
+    data[ 7 ] = vscpboot_getPage() & 0xFF;
+    hostSend( VSCP_TYPE_PROTOCOL_ENTER_BOOT_LOADER, 0, 8, data );
+    host.deadline = hostTime + cfg.timeout;
+}
+
+static void hostActivate( void )
+{
+    uint8_t data[ 2 ];
+    crc imagecrc = crcFast( image, imageBlocks * VSCPBOOT_BLOCKSIZE );
+
+    data[ 0 ] = ( imagecrc >> 8 ) & 0xFF;
+    data[ 1 ] = imagecrc & 0xFF;
+    hostSend( VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE, 0, 2, data );
+    host.deadline = hostTime + cfg.timeout;
+}
+
+static void hostReceive( vscpevent *pe )
+{
+    uint32_t blockno;
+    crc blockcrc;
+    int i;
+
+    if ( VSCP_CLASS1_PROTOCOL != pe->vscp_class ) return;
+
+    blockno = construct_unsigned32( pe->data[ 0 ], pe->data[ 1 ],
+                                    pe->data[ 2 ], pe->data[ 3 ] );
+
+    switch ( pe->vscp_type ) {
+
+        case VSCP_TYPE_PROTOCOL_ACK_BOOT_LOADER:
+            if ( HOST_ENTER == host.state ) host.state = HOST_BLOCKS;
+            break;
+
+        case VSCP_TYPE_PROTOCOL_START_BLOCK_ACK:
+            if ( ( host.xfer == (int32_t)blockno ) && 
+                    ( BLK_START == host.blkState[ blockno ] ) ) {
+                for ( i = 0; i < VSCPBOOT_BLOCKSIZE; i += 8 ) {
+                    hostSend( VSCP_TYPE_PROTOCOL_BLOCK_DATA, 0, 
+                                ( ( VSCPBOOT_BLOCKSIZE - i ) < 8 ) ? ( VSCPBOOT_BLOCKSIZE - i ) : 8,
+                                image + blockno * VSCPBOOT_BLOCKSIZE + i );
+                }
+                host.blkState[ blockno ] = BLK_DATA;
+                host.xferDeadline = hostTime + cfg.timeout;
+            }
+            break;
+
+        case VSCP_TYPE_PROTOCOL_START_BLOCK_NACK:
+            if ( host.xfer == (int32_t)blockno ) {
+                hostRetryBlock( blockno );
+                host.xfer = -1;
+            }
+            break;
+
+        case VSCP_TYPE_PROTOCOL_BLOCK_DATA_ACK:
+            // CRC in bytes 0-1, write pointer after the block in bytes 2-5
+            blockno = construct_unsigned32( pe->data[ 2 ], pe->data[ 3 ],
+                                            pe->data[ 4 ], pe->data[ 5 ] ) / VSCPBOOT_BLOCKSIZE - 1;
+            if ( ( host.xfer == (int32_t)blockno ) && 
+                    ( BLK_DATA == host.blkState[ blockno ] ) ) {
+                blockcrc = crcFast( image + blockno * VSCPBOOT_BLOCKSIZE, VSCPBOOT_BLOCKSIZE );
+                if ( construct_unsigned16( pe->data[ 0 ], pe->data[ 1 ] ) == blockcrc ) {
+                    hostSend( VSCP_TYPE_PROTOCOL_PROGRAM_BLOCK_DATA, blockno, 4, NULL );
+                    host.blkState[ blockno ] = BLK_PROGRAM;
+                    host.inflight[ host.cntInflight ] = blockno;
+                    host.inflightDeadline[ host.cntInflight ] = hostTime + cfg.timeout;
+                    host.cntInflight++;
+                }
+                else {
+                    hostRetryBlock( blockno );
+                }
+                host.xfer = -1;
+            }
+            break;
+
+        case VSCP_TYPE_PROTOCOL_PROGRAM_BLOCK_DATA_ACK:
+        case VSCP_TYPE_PROTOCOL_PROGRAM_BLOCK_DATA_NACK:
+            for ( i = 0; i < host.cntInflight; i++ ) {
+                if ( host.inflight[ i ] == blockno ) {
+                    hostRemoveInflight( i );
+                    if ( VSCP_TYPE_PROTOCOL_PROGRAM_BLOCK_DATA_ACK == pe->vscp_type ) {
+                        host.blkState[ blockno ] = BLK_DONE;
+                    }
+                    else {
+                        hostRetryBlock( blockno );
+                    }
+                    break;
+                }
+            }
+            break;
+
+        case VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE_ACK:
+            if ( HOST_ACTIVATE == host.state ) host.state = HOST_DONE;
+            break;
+
+        case VSCP_TYPE_PROTOCOL_ACTIVATE_NEW_IMAGE_NACK:
+            // A program request may have been lost, wait for all
+            // blocks and activate again
+            if ( ( 1 == host.early ) && ( HOST_ACTIVATE == host.state ) ) {
+                host.early = 2;
+                host.state = HOST_BLOCKS;
+                cntRetries++;
+                break;
+            }
+            printf("Image CRC NACK'ed by node.\n");
+            longjmp( simExit, SIM_EXIT_TIMEOUT );
+            break;
+    }
+}
+
+static void hostStep( void )
+{
+    uint32_t blockno;
+    int i;
+
+    switch ( host.state ) {
+
+        case HOST_WAIT:
+            if ( hostTime >= host.start ) {
+                hostEnter();
+                host.state = HOST_ENTER;
+            }
+            break;
+
+        case HOST_ENTER:
+            if ( hostTime >= host.deadline ) {
+                cntRetries++;
+                hostEnter();
+            }
+            break;
+
+        case HOST_BLOCKS:
+
+            // Block transfer timed out
+            if ( ( host.xfer >= 0 ) && ( hostTime >= host.xferDeadline ) ) {
+                hostRetryBlock( host.xfer );
+                host.xfer = -1;
+            }
+
+            // Program request or its ACK lost
+            for ( i = 0; i < host.cntInflight; i++ ) {
+                if ( hostTime >= host.inflightDeadline[ i ] ) {
+                    cntRetries++;
+                    hostSend( VSCP_TYPE_PROTOCOL_PROGRAM_BLOCK_DATA, host.inflight[ i ], 4, NULL );
+                    host.inflightDeadline[ i ] = hostTime + cfg.timeout;
+                }
+            }
+
+            if ( ( host.xfer < 0 ) && ( host.cntInflight < cfg.window ) ) {
+                if ( host.cntRetry ) {
+                    blockno = host.retry[ --host.cntRetry ];
+                }
+                else if ( host.nextBlock < imageBlocks ) {
+                    blockno = host.nextBlock++;
+                }
+                else {
+                    if ( 0 == host.cntInflight ) {
+                        hostActivate();
+                        host.state = HOST_ACTIVATE;
+                    }
+                    else if ( cfg.earlyActivate && !host.early ) {
+                        hostActivate();
+                        host.state = HOST_ACTIVATE;
+                        host.early = 1;
+                    }
+                    break;
+                }
+                hostSend( VSCP_TYPE_PROTOCOL_START_BLOCK, blockno, 4, NULL );
+                host.blkState[ blockno ] = BLK_START;
+                host.xfer = blockno;
+                host.xferDeadline = hostTime + cfg.timeout;
+            }
+            break;
+
+        case HOST_ACTIVATE:
+            if ( hostTime >= host.deadline ) {
+                cntRetries++;
+                hostActivate();
+            }
+            break;
+
+        default:
+            break;
+    }
+}
+
+// Let the host handle what it has received up to now, each frame at
+// the time it arrived.
+static void hostRun( void )
+{
+    vscpevent e;
+
+    while ( busReceive( &toHost, &e, &hostTime ) ) {
+        hostReceive( &e );
+        hostStep();
+    }
+
+    hostTime = now;
+    hostStep();
+}
+
+// Next time the host has something to do
+static double hostNext( void )
+{
+    double next = busNext( &toHost );
+    int i;
+
+    switch ( host.state ) {
+
+        case HOST_WAIT:
+            if ( host.start < next ) next = host.start;
+            break;
+
+        case HOST_ENTER:
+        case HOST_ACTIVATE:
+            if ( host.deadline < next ) next = host.deadline;
+            break;
+
+        case HOST_BLOCKS:
+            if ( ( host.xfer >= 0 ) && ( host.xferDeadline < next ) ) next = host.xferDeadline;
+            for ( i = 0; i < host.cntInflight; i++ ) {
+                if ( host.inflightDeadline[ i ] < next ) next = host.inflightDeadline[ i ];
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return next;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// nodeBusy
+//
+// Node is busy for some time. The host keeps running meanwhile.
+//
+
+static void nodeBusy( double t )
+{
+    double end = now + t;
+    double next;
+
+    while ( ( next = hostNext() ) < end ) {
+        if ( next > now ) now = next;
+        hostRun();
+    }
+
+    now = end;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Bootloader hooks
+//
+
+int vscpboot_sendEvent( vscpevent *pmsg )
+{
+    busSend( &toHost, pmsg, now, cfg.latency );
+    nodeActive = 1;
+    return TRUE;
+}
+
+int vscpboot_getEvent( vscpevent *pmsg )
+{
+    double next;
+
+    // Millisecond timer interrupt
+    while ( ( lastTick + 1000 ) <= now ) {
+        lastTick += 1000;
+        if ( vscpboot_timer < 0xFFFF ) vscpboot_timer++;
+    }
+
+    hostRun();
+
+    if ( busReceive( &toNode, pmsg, &next ) ) {
+        nodeBusy( cfg.nodeTime );
+        nodeActive = 1;
+        return TRUE;
+    }
+
+    // Nothing to do since last poll, skip ahead to the next thing
+    // that happens or the next timer tick.
+    if ( !nodeActive ) {
+        next = hostNext();
+        if ( busNext( &toNode ) < next ) next = busNext( &toNode );
+        if ( ( lastTick + 1000 ) < next ) next = lastTick + 1000;
+        now = ( next > now ) ? next : now + 1;
+        if ( now >= SIM_TIME_LIMIT ) {
+            longjmp( simExit, SIM_EXIT_TIMEOUT );
+        }
+    }
+
+    nodeActive = 0;
+
+    return FALSE;
+}
+
+void boot_program_page( uint32_t page, uint8_t *buf )
+{
+    memcpy( flash + page * VSCPBOOT_BLOCKSIZE, buf, VSCPBOOT_BLOCKSIZE );
+    nodeBusy( cfg.flashTime );
+    nodeActive = 1;
+}
+
+uint8_t vscpboot_getGUID( uint8_t idxGUID )
+{
+    return 0xF0 + ( idxGUID & 0x0F );
+}
+
+uint16_t vscpboot_getPage( void )
+{
+    return 0;
+}
+
+void vscpboot_setBootFlag( uint8_t flag )
+{
+    bootflag = flag;
+}
+
+void vscpboot_reboot( void )
+{
+    longjmp( simExit, SIM_EXIT_REBOOT );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// runImage
+//
+// Program an image of the given size and report the result.
+//
+
+static int runImage( uint32_t size )
+{
+    uint32_t i;
+    double secs;
+
+    memset( &toNode, 0, sizeof( toNode ) );
+    memset( &toHost, 0, sizeof( toHost ) );
+    memset( &host, 0, sizeof( host ) );
+    memset( flash, 0xFF, sizeof( flash ) );
+    now = hostTime = busFree = lastTick = 0;
+    vscpboot_timer = 0;
+    nodeActive = 0;
+    bootflag = VSCPBOOT_FLAG_BOOT;
+    cntFrames = cntLost = cntRetries = 0;
+
+    imageBlocks = ( size + VSCPBOOT_BLOCKSIZE - 1 ) / VSCPBOOT_BLOCKSIZE;
+    memset( image, 0xFF, sizeof( image ) );
+    for ( i = 0; i < size; i++ ) {
+        image[ i ] = (uint8_t)( i * 31 + ( i >> 9 ) );
+    }
+
+    // Start when the node has stopped waiting for nickname conflicts
+    host.start = ( TIMOUT_ANNOUNCE + 1 ) * 1000.0;
+    host.xfer = -1;
+
+    if ( SIM_EXIT_REBOOT != setjmp( simExit ) ) {
+        vscpboot_init();
+        vscpboot_loader();
+    }
+    else {
+        
+        // Let the host see the ACKs sent before the reboot
+        while ( busNext( &toHost ) < SIM_TIME_LIMIT ) {
+            now = busNext( &toHost );
+            hostRun();
+        }
+
+        // If the activate ACK was lost the host sees the new firmware
+        // come online instead
+        if ( ( HOST_ACTIVATE == host.state ) && !bootflag ) {
+            host.state = HOST_DONE;
+        }
+    }
+
+    if ( ( HOST_DONE != host.state ) || bootflag ||
+            memcmp( image, flash, imageBlocks * VSCPBOOT_BLOCKSIZE ) ) {
+        printf("%7u KB  FAILED (state %d)\n", size / 1024, host.state );
+        return -1;
+    }
+
+    secs = ( now - host.start ) / 1e6;
+    printf("%7u KB %9.2f s %10.0f B/s %8.1f frames/block %6u lost %6u retries\n",
+                size / 1024,
+                secs,
+                size / secs,
+                (double)cntFrames / imageBlocks,
+                cntLost,
+                cntRetries );
+
+    return 0;
+}
+
+int main( int argc, char *argv[] )
+{
+    uint32_t sizes[] = { 32, 64, 128, 256, 512 };
+    uint32_t size = 0;
+    int rv = 0;
+    int opt;
+    int i;
+
+    while ( -1 != ( opt = getopt( argc, argv, "b:l:p:c:w:W:s:a" ) ) ) {
+        switch ( opt ) {
+            case 'b': cfg.bitrate = atoi( optarg ); break;
+            case 'l': cfg.latency = atoi( optarg ); break;
+            case 'p': cfg.loss = atof( optarg ) / 100; break;
+            case 'c': cfg.corrupt = atof( optarg ) / 100; break;
+            case 'w': cfg.flashTime = atoi( optarg ); break;
+            case 'W': cfg.window = atoi( optarg ); break;
+            case 's': size = atoi( optarg ); break;
+            case 'a': cfg.earlyActivate = 1; break;
+            default:
+                printf("usage: bootsim [-b bitrate] [-l latency us] [-p loss %%] "
+                        "[-c corrupt %%] [-w flash write us] [-W window] [-s image KB] [-a]\n");
+                return -1;
+        }
+    }
+
+    if ( ( cfg.window < 1 ) || ( cfg.window > SIM_MAX_WINDOW ) || 
+            ( 0 == cfg.bitrate ) || ( size * 1024 > sizeof( image ) ) ) {
+        printf("Invalid parameters.\n");
+        return -1;
+    }
+
+    printf("%u bit/s, %u us latency, %.2f %% loss, %.2f %% corrupt, "
+            "%u us/block flash, block %u bytes, window %d\n",
+            cfg.bitrate, cfg.latency, cfg.loss * 100, cfg.corrupt * 100, cfg.flashTime, 
+            VSCPBOOT_BLOCKSIZE, cfg.window );
+
+    if ( size ) {
+        return runImage( size * 1024 );
+    }
+
+    for ( i = 0; i < sizeof( sizes ) / sizeof( sizes[ 0 ] ); i++ ) {
+        rv |= runImage( sizes[ i ] * 1024 );
+    }
+
+    return rv;
+}
@@ -0,0 +1,58 @@
+// FILE: hardware.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Host build of the VSCP bootloader for the bootloader simulator.
+
+#ifndef _VSCP_BOOTSIM_HARDWARE_H_
+#define _VSCP_BOOTSIM_HARDWARE_H_
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+
+// Room for a 512 KB image
+#define VSCPBOOT_BLOCKSIZE      256
+#define VSCPBOOT_BLOCKS         2048
+
+// Level I event as seen by the bootloader
+typedef struct {
+    uint8_t flags;              // Bit 7 valid, bit 0-3 number of data bytes
+    uint8_t priority;           // Priority 0-7
+    uint16_t vscp_class;        // VSCP class
+    uint8_t vscp_type;          // VSCP type
+    uint8_t oaddr;              // Originating address
+    uint8_t data[ 8 ];          // Data bytes
+} vscpevent;
+
+#endif
@@ -0,0 +1,224 @@
+// FILE: testdm2.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Host test and benchmark for the Level II decision matrix in
+// common/vscp_dm2.c. Random rows and events are fed both to the DM and to
+// a reference that walks every row, as the Level II node projects do, and
+// the actions of the two are compared.
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+
+#include "../../common/vscp.h"
+#include "../../common/vscp_dm2.h"
+
+#define DM2_BENCH_EVENTS    1024
+#define DM2_GUIDS           64      // Nodes the DM rows refer to
+
+// Level II decision matrix storage and action log
+static uint8_t dm2store[ VSCP_DM2_ROWS ][ VSCP_DM2_ROW_SIZE ];
+static uint8_t dm2guids[ DM2_GUIDS ][ 16 ];
+static uint32_t dm2ActionSum;
+static uint32_t cntDM2Actions;
+
+void vscp_dm2_loadRow( uint16_t row, uint8_t *pRow )
+{
+    memcpy( pRow, dm2store[ row ], VSCP_DM2_ROW_SIZE );
+}
+
+uint8_t vscp_dm2_getZone( void ) { return 3; }
+uint8_t vscp_dm2_getSubzone( void ) { return 5; }
+
+void vscp_dm2_doAction( const vscp_dm2_row_t *pRow,
+                            uint16_t vscp_class,
+                            uint16_t vscp_type,
+                            const uint8_t *pData,
+                            uint16_t sizeData )
+{
+    cntDM2Actions++;
+    dm2ActionSum = dm2ActionSum * 31 + pRow->row;
+}
+
+// Row walk as the Level II node projects do it. Every row is read and
+// decoded for each event.
+static void refDM2( const vscpEvent *pe, uint16_t rows )
+{
+    uint8_t dm[ VSCP_DM2_ROW_SIZE ];
+    uint32_t control, mask, filter;
+    uint16_t i;
+    vscp_dm2_row_t row;
+
+    for ( i = 0; i < rows; i++ ) {
+
+        vscp_dm2_loadRow( i, dm );
+
+        control = ( (uint32_t)dm[ 0 ] << 24 ) | ( (uint32_t)dm[ 1 ] << 16 ) |
+                    ( (uint32_t)dm[ 2 ] << 8 ) | dm[ 3 ];
+        if ( !( VSCP_DM_CONTROL_ENABLED & control ) ) continue;
+
+        if ( ( VSCP_DM_CONTROL_MATCH_GUID & control ) &&
+                memcmp( pe->GUID, dm + VSCP_DM2_POS_PARAM, 16 ) ) continue;
+
+        mask = ( (uint32_t)dm[ 4 ] << 24 ) | ( (uint32_t)dm[ 5 ] << 16 ) |
+                    ( (uint32_t)dm[ 8 ] << 8 ) | dm[ 9 ];
+        filter = ( (uint32_t)dm[ 6 ] << 24 ) | ( (uint32_t)dm[ 7 ] << 16 ) |
+                    ( (uint32_t)dm[ 10 ] << 8 ) | dm[ 11 ];
+        if ( ( filter ^ ( ( (uint32_t)pe->vscp_class << 16 ) | pe->vscp_type ) ) & mask ) continue;
+
+        if ( VSCP_DM_CONTROL_MATCH_ZONE & control ) {
+            if ( ( pe->vscp_class >= 1024 ) || ( pe->sizeData < 2 ) ) continue;
+            if ( ( 0xff != pe->pdata[ 1 ] ) && ( vscp_dm2_getZone() != pe->pdata[ 1 ] ) ) continue;
+        }
+
+        if ( VSCP_DM_CONTROL_MATCH_SUBZONE & control ) {
+            if ( ( pe->vscp_class >= 1024 ) || ( pe->sizeData < 3 ) ) continue;
+            if ( ( 0xff != pe->pdata[ 2 ] ) && ( vscp_dm2_getSubzone() != pe->pdata[ 2 ] ) ) continue;
+        }
+
+        row.row = i;
+        vscp_dm2_doAction( &row, pe->vscp_class, pe->vscp_type, pe->pdata, pe->sizeData );
+    }
+}
+
+static void makeDM2Rows( uint16_t rows )
+{
+    static const uint16_t classes[] = { 10, 20, 30, 40, 50, 60, 85, 1040, 1060 };
+    uint32_t control;
+    uint16_t i, cls;
+    uint8_t *p;
+
+    for ( i = 0; i < rows; i++ ) {
+        p = dm2store[ i ];
+        memset( p, 0, VSCP_DM2_ROW_SIZE );
+        cls = classes[ rand() % 9 ];
+        control = ( ( rand() % 4 ) ? VSCP_DM_CONTROL_ENABLED : 0 ) |
+                    ( ( rand() % 8 ) ? VSCP_DM_CONTROL_MATCH_GUID : 0 ) |
+                    ( ( rand() % 2 ) ? 0 : VSCP_DM_CONTROL_MATCH_ZONE ) |
+                    ( ( rand() % 4 ) ? 0 : VSCP_DM_CONTROL_MATCH_SUBZONE );
+        p[ 0 ] = control >> 24;
+        p[ 1 ] = control >> 16;
+        p[ 2 ] = control >> 8;
+        p[ 3 ] = control;
+        p[ 4 ] = p[ 5 ] = ( rand() % 16 ) ? 0xff : 0x00;  // Class mask
+        p[ 6 ] = cls >> 8;
+        p[ 7 ] = cls & 0xff;
+        p[ 9 ] = ( rand() % 2 ) ? 0xff : 0x00;            // Type mask
+        p[ 11 ] = rand() % 8;
+        p[ 13 ] = 1 + rand() % 20;
+        memcpy( p + VSCP_DM2_POS_PARAM, dm2guids[ rand() % DM2_GUIDS ], 16 );
+    }
+}
+
+int main()
+{
+    int i,j;
+
+    printf("Decision matrix test 1 (Level II)\n");
+    {
+        static vscpEvent events[ DM2_BENCH_EVENTS ];
+        static uint8_t evdata[ DM2_BENCH_EVENTS ][ 3 ];
+        static const uint16_t rowcnt[] = { 256, 1024, 4096 };
+        uint32_t sumDM, cntRef, cntDM;
+        clock_t start;
+        double tRef, tDM;
+        int r, n, loops;
+
+        srand( 2 );
+        for ( i = 0; i < DM2_GUIDS; i++ ) {
+            for ( j = 0; j < 16; j++ ) dm2guids[ i ][ j ] = ( j < 12 ) ? 0xfa : rand();
+        }
+
+        for ( i = 0; i < DM2_BENCH_EVENTS; i++ ) {
+            static const uint16_t evclasses[] = { 10, 20, 30, 40, 50, 60, 85, 1040, 1060, 100 };
+            memset( &events[ i ], 0, sizeof( vscpEvent ) );
+            events[ i ].vscp_class = evclasses[ rand() % 10 ];
+            events[ i ].vscp_type = rand() % 8;
+            memcpy( events[ i ].GUID, dm2guids[ rand() % DM2_GUIDS ], 16 );
+            evdata[ i ][ 0 ] = 0;
+            evdata[ i ][ 1 ] = ( rand() % 4 ) ? 3 : 0xff;
+            evdata[ i ][ 2 ] = ( rand() % 2 ) ? 5 : 1;
+            events[ i ].pdata = evdata[ i ];
+            events[ i ].sizeData = 3;
+        }
+
+        for ( r = 0; r < 3; r++ ) {
+
+            makeDM2Rows( rowcnt[ r ] );
+            vscp_dm2_init( rowcnt[ r ] );
+            loops = 4096 / rowcnt[ r ];
+
+            dm2ActionSum = cntDM2Actions = 0;
+            start = clock();
+            for ( n = 0; n < loops; n++ ) {
+                for ( i = 0; i < DM2_BENCH_EVENTS; i++ ) refDM2( &events[ i ], rowcnt[ r ] );
+            }
+            tRef = (double)( clock() - start ) / CLOCKS_PER_SEC;
+            cntRef = cntDM2Actions;
+
+            dm2ActionSum = cntDM2Actions = 0;
+            start = clock();
+            for ( n = 0; n < loops * 16; n++ ) {
+                for ( i = 0; i < DM2_BENCH_EVENTS; i++ ) vscp_dm2_feed( &events[ i ] );
+            }
+            tDM = (double)( clock() - start ) / CLOCKS_PER_SEC / 16;
+            sumDM = dm2ActionSum;
+            cntDM = cntDM2Actions / 16;
+
+            if ( ( cntRef != cntDM ) || ( !cntRef ) ) {
+                printf("Decision matrix test 1, %d rows, matches differ from reference.\n", rowcnt[ r ] );
+            }
+
+            // Same action sequence for one pass over the events
+            dm2ActionSum = 0;
+            for ( i = 0; i < DM2_BENCH_EVENTS; i++ ) vscp_dm2_feed( &events[ i ] );
+            sumDM = dm2ActionSum;
+            dm2ActionSum = 0;
+            for ( i = 0; i < DM2_BENCH_EVENTS; i++ ) refDM2( &events[ i ], rowcnt[ r ] );
+            if ( sumDM != dm2ActionSum ) {
+                printf("Decision matrix test 1, %d rows, action order differs from reference.\n", rowcnt[ r ] );
+            }
+
+            if ( ( tRef > 0 ) && ( tDM > 0 ) ) {
+                printf("Level II DM %4d rows (%4d enabled): row walk %.0f events/s, indexed %.0f events/s\n",
+                        rowcnt[ r ], vscp_dm2_getEnabledRows(),
+                        loops * DM2_BENCH_EVENTS / tRef, loops * DM2_BENCH_EVENTS / tDM );
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,1166 @@
+// FILE: testfw.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Host tests for common/vscp_firmware.c. The application callbacks are
+// backed by RAM and the CAN bus by two frame queues. vscp_timer is
+// driven by a 1 ms timer thread as it would be by a timer interrupt.
+// The nickname and register page 0 live in a simulated EEPROM behind
+// the register cache (common/vscp_regcache.c).
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+
+#include <vscp_class.h>
+#include <vscp_type.h>
+#include <vscp_firmware.h>
+#include <vscp_regcache.h>
+#include <vscp_dm.h>
+#include <vscp_cantx.h>
+#include <vscp_canfilt.h>
+
+#ifndef FALSE
+#define FALSE               0
+#endif
+
+#ifndef TRUE
+#define TRUE                !FALSE
+#endif
+
+#define NICKNAME            0x42
+#define QUEUE_SIZE          512
+
+// Simulated EEPROM layout
+#define EEPROM_NICKNAME     0x00
+#define EEPROM_PAGE0        0x80    // Application registers of page 0
+
+// Simulated EEPROM timing, page write as for a typical serial EEPROM
+#define EEPROM_WRITE_MS     5.0
+#define EEPROM_BYTE_MS      0.02
+
+typedef struct {
+    uint16_t vscp_class;
+    uint8_t vscp_type;
+    uint8_t priority;
+    uint8_t size;
+    uint8_t data[ 8 ];
+} frame_t;
+
+// Bus
+static vscp_canframe_t rxq[ QUEUE_SIZE ];
+static int rxHead, rxTail;
+static frame_t txq[ QUEUE_SIZE ];
+static int cntTx;
+static int txBlocked;                     // Driver buffer full
+
+// Application storage
+static uint8_t appreg[ 256 ][ 128 ];    // [page][reg]
+static uint8_t guid[ 16 ];
+static uint8_t userid[ 5 ];
+static uint8_t manufacturer[ 8 ];
+static uint8_t controlbyte[ 2 ];
+
+// Simulated EEPROM
+static uint8_t eeprom[ VSCP_REGCACHE_SIZE ];
+static int cntEepromWrites;
+static int cntEepromBytes;
+static double eepromMs;                   // Simulated time spent writing
+
+// Decision matrix
+static struct _dmrow dmstore[ VSCP_DM_ROWS ];
+static uint8_t zoneReg = 3;
+static uint8_t subzoneReg = 5;
+static uint32_t dmActionSum;              // Checksum of the actions done
+static uint32_t cntDMActions;
+static int dmReport;                      // Actions send a status event
+static int cntAppRegCalls;                // Per-byte register callbacks
+static int cntAppRegsCalls;               // Bulk register callbacks
+
+// Simulated CAN controller for the transmit scheduler
+static vscp_cantx_frame_t mbox[ VSCP_CANTX_MAILBOXES ];
+static uint8_t mboxLoaded;                // One bit per mailbox
+static uint8_t mboxAbort;                 // Abort requested
+static vscp_cantx_frame_t busLog[ 64 ];
+static int cntBus;
+
+// Acceptance filters as programmed
+static vscp_canfilt_t hwFilters[ VSCP_CANFILT_SLOTS ];
+static uint8_t cntHwFilters;
+static int cntProgram;
+
+static volatile int timerRun;
+
+///////////////////////////////////////////////////////////////////////////////
+// Helpers
+//
+
+static void *timerThread( void *arg )
+{
+    struct timespec ts = { 0, 1000000 };
+
+    while ( timerRun ) {
+        nanosleep( &ts, NULL );
+        vscp_timer++;
+    }
+
+    return NULL;
+}
+
+static double msNow( void )
+{
+    struct timespec ts;
+
+    clock_gettime( CLOCK_MONOTONIC, &ts );
+    return ts.tv_sec * 1e3 + ts.tv_nsec / 1e6;
+}
+
+static void putFrame( uint8_t type, uint8_t size, const uint8_t *pdata )
+{
+    vscp_canframe_t *pf = &rxq[ rxTail++ % QUEUE_SIZE ];
+
+    pf->id = VSCP_CANID_PACK( VSCP_PRIORITY_NORMAL, VSCP_CLASS1_PROTOCOL, type, 0 );
+    pf->size = size;
+    memcpy( pf->data, pdata, size );
+}
+
+// One turn of a typical node main loop. Returns time spent in ms.
+static double mainLoop( void )
+{
+    double start = msNow();
+
+    vscp_imsg.flags = 0;
+    vscp_getEvent();
+
+    if ( ( VSCP_STATE_ACTIVE == vscp_node_state ) &&
+            ( vscp_imsg.flags & VSCP_VALID_MSG ) ) {
+        vscp_handleProtocolEvent();
+    }
+
+    return msNow() - start;
+}
+
+// One frame time on the bus. Requested aborts are done first, else the
+// loaded mailbox with the lowest id wins arbitration and is sent.
+static void busStep( void )
+{
+    int mb, best = -1;
+
+    if ( mboxAbort ) {
+        for ( mb = 0; mb < VSCP_CANTX_MAILBOXES; mb++ ) {
+            if ( mboxAbort & ( 1 << mb ) ) {
+                mboxAbort &= ~( 1 << mb );
+                mboxLoaded &= ~( 1 << mb );
+                vscp_cantx_txAborted( mb );
+            }
+        }
+    }
+
+    for ( mb = 0; mb < VSCP_CANTX_MAILBOXES; mb++ ) {
+        if ( !( mboxLoaded & ( 1 << mb ) ) ) continue;
+        if ( ( best < 0 ) || ( mbox[ mb ].id < mbox[ best ].id ) ) best = mb;
+    }
+
+    if ( best < 0 ) return;
+
+    busLog[ cntBus++ % 64 ] = mbox[ best ];
+    mboxLoaded &= ~( 1 << best );
+    vscp_cantx_txDone( best );
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Application callbacks
+//
+
+void vscp_cantx_loadMailbox( uint8_t mb, const vscp_cantx_frame_t *pFrame )
+{
+    if ( mboxLoaded & ( 1 << mb ) ) printf("CAN TX scheduler, mailbox overwritten.\n");
+    mbox[ mb ] = *pFrame;
+    mboxLoaded |= ( 1 << mb );
+}
+
+void vscp_cantx_abortMailbox( uint8_t mb )
+{
+    mboxAbort |= ( 1 << mb );
+}
+
+void vscp_canfilt_addAppTerms( void ) { }
+
+void vscp_canfilt_program( const vscp_canfilt_t *pFilters, uint8_t cnt )
+{
+    if ( ( cnt < 1 ) || ( cnt > VSCP_CANFILT_SLOTS ) ) printf("Acceptance filter, slot count fail.\n");
+    memcpy( hwFilters, pFilters, cnt * sizeof( vscp_canfilt_t ) );
+    cntHwFilters = cnt;
+    cntProgram++;
+}
+
+// Non zero if the programmed filters let id through
+static int hwAccept( uint32_t id )
+{
+    int i;
+
+    for ( i = 0; i < cntHwFilters; i++ ) {
+        if ( !( ( id ^ hwFilters[ i ].filter ) & hwFilters[ i ].mask ) ) return 1;
+    }
+
+    return 0;
+}
+
+// Non zero if the node needs the frame. Zone and subzone are in the data
+// so any row matching class, type and originator counts.
+static int idNeeded( uint16_t vscp_class, uint8_t vscp_type, uint8_t oaddr, uint16_t rows )
+{
+    uint16_t i, cmask, cfilter;
+    struct _dmrow *pRow;
+
+    if ( VSCP_CLASS1_PROTOCOL == vscp_class ) return 1;
+    if ( vscp_nickname == oaddr ) return 1;
+
+    for ( i = 0; i < rows; i++ ) {
+        pRow = &dmstore[ i ];
+        if ( !( pRow->flags & VSCP_DM_FLAG_ENABLED ) ) continue;
+        if ( ( pRow->flags & VSCP_DM_FLAG_CHECK_OADDR ) && ( pRow->oaddr != oaddr ) ) continue;
+        cmask = ( ( pRow->flags & VSCP_DM_FLAG_CLASS_MASK ) << 7 ) | pRow->class_mask;
+        cfilter = ( ( pRow->flags & VSCP_DM_FLAG_CLASS_FILTER ) << 8 ) | pRow->class_filter;
+        if ( ( ( vscp_class ^ cfilter ) & cmask ) ||
+                ( ( vscp_type ^ pRow->type_filter ) & pRow->type_mask ) ) continue;
+        return 1;
+    }
+
+    return 0;
+}
+
+const vscp_canframe_t *getVSCPCanFrame( void )
+{
+    if ( rxHead == rxTail ) return NULL;
+    return &rxq[ rxHead % QUEUE_SIZE ];
+}
+
+void releaseVSCPCanFrame( void )
+{
+    rxHead++;
+}
+
+// Frame decode as done in the port glue before vscp_canid.h: the driver
+// frame is copied to a local and unpacked with long shifts.
+static int8_t glueDecode( const vscp_canframe_t *pFrame, uint16_t *pvscpclass,
+                            uint8_t *pvscptype, uint8_t *pNodeId,
+                            uint8_t *pPriority, uint8_t *pSize, uint8_t *pData )
+{
+    vscp_canframe_t msg;
+    uint8_t i;
+
+    msg = *pFrame;
+
+    *pNodeId = msg.id & 0x0ff;
+    *pvscptype = ( msg.id >> 8 ) & 0xff;
+    *pvscpclass = ( msg.id >> 16 ) & 0x1ff;
+    *pPriority = (uint16_t)( 0x07 & ( msg.id >> 26 ) );
+    *pSize = msg.size;
+    for ( i = 0; i < msg.size; i++ ) pData[ i ] = msg.data[ i ];
+
+    return TRUE;
+}
+
+int8_t sendVSCPFrame( uint16_t vscpclass, uint8_t vscptype, uint8_t nodeid,
+                        uint8_t priority, uint8_t size, uint8_t *pData )
+{
+    frame_t *pf;
+
+    if ( txBlocked ) return FALSE;
+
+    pf = &txq[ cntTx++ % QUEUE_SIZE ];
+    pf->vscp_class = vscpclass;
+    pf->vscp_type = vscptype;
+    pf->priority = priority;
+    pf->size = size;
+    memcpy( pf->data, pData, size );
+
+    return TRUE;
+}
+
+uint8_t vscp_readAppReg( uint8_t reg )
+{
+    cntAppRegCalls++;
+    if ( 0 == vscp_page_select ) return vscp_regcache_read( EEPROM_PAGE0 + ( reg & 0x7f ) );
+    return appreg[ vscp_page_select & 0xff ][ reg & 0x7f ];
+}
+
+uint8_t vscp_writeAppReg( uint8_t reg, uint8_t value )
+{
+    if ( 0 == vscp_page_select ) {
+        cntAppRegCalls++;
+        return vscp_regcache_write( EEPROM_PAGE0 + ( reg & 0x7f ), value, vscp_timer );
+    }
+    appreg[ vscp_page_select & 0xff ][ reg & 0x7f ] = value;
+    return vscp_readAppReg( reg );
+}
+
+void vscp_readAppRegs( uint16_t page, uint8_t reg, uint8_t *pData, uint8_t cnt )
+{
+    cntAppRegsCalls++;
+    if ( ( reg + cnt ) > 0x80 ) printf("Bulk register read outside application registers.\n");
+    if ( 0 == page ) {
+        vscp_regcache_readBuf( EEPROM_PAGE0 + reg, pData, cnt );
+        return;
+    }
+    memcpy( pData, &appreg[ page & 0xff ][ reg & 0x7f ], cnt );
+}
+
+void vscp_writeAppRegs( uint16_t page, uint8_t reg, uint8_t *pData, uint8_t cnt )
+{
+    cntAppRegsCalls++;
+    if ( ( reg + cnt ) > 0x80 ) printf("Bulk register write outside application registers.\n");
+    if ( 0 == page ) {
+        vscp_regcache_writeBuf( EEPROM_PAGE0 + reg, pData, cnt, vscp_timer );
+        vscp_regcache_readBuf( EEPROM_PAGE0 + reg, pData, cnt );
+        return;
+    }
+    memcpy( &appreg[ page & 0xff ][ reg & 0x7f ], pData, cnt );
+}
+
+void vscp_regcache_loadStorage( uint16_t addr, uint8_t *pData, uint16_t cnt )
+{
+    memcpy( pData, &eeprom[ addr ], cnt );
+}
+
+void vscp_regcache_storePage( uint16_t addr, const uint8_t *pData, uint8_t cnt )
+{
+    if ( ( addr / VSCP_REGCACHE_PAGE_SIZE ) != ( ( addr + cnt - 1 ) / VSCP_REGCACHE_PAGE_SIZE ) ) {
+        printf("EEPROM write across page boundary.\n");
+    }
+    memcpy( &eeprom[ addr ], pData, cnt );
+    cntEepromWrites++;
+    cntEepromBytes += cnt;
+    eepromMs += EEPROM_WRITE_MS + cnt * EEPROM_BYTE_MS;
+}
+
+uint8_t vscp_getMajorVersion( void ) { return 1; }
+uint8_t vscp_getMinorVersion( void ) { return 2; }
+uint8_t vscp_getSubMinorVersion( void ) { return 3; }
+uint8_t vscp_getGUID( uint8_t idx ) { return guid[ idx & 0x0f ]; }
+void vscp_setGUID( uint8_t idx, uint8_t data ) { guid[ idx & 0x0f ] = data; }
+uint8_t vscp_getUserID( uint8_t idx ) { return userid[ idx % 5 ]; }
+void vscp_setUserID( uint8_t idx, uint8_t data ) { userid[ idx % 5 ] = data; }
+uint8_t vscp_getManufacturerId( uint8_t idx ) { return manufacturer[ idx & 7 ]; }
+void vscp_setManufacturerId( uint8_t idx, uint8_t data ) { manufacturer[ idx & 7 ] = data; }
+uint8_t vscp_getBootLoaderAlgorithm( void ) { return VSCP_BOOTLOADER_NONE; }
+uint8_t vscp_getBufferSize( void ) { return 8; }
+uint8_t vscp_getRegisterPagesUsed( void ) { return 1; }
+uint8_t vscp_getMDF_URL( uint8_t idx ) { return 0; }
+uint8_t vscp_readNicknamePermanent( void ) { return vscp_regcache_read( EEPROM_NICKNAME ); }
+void vscp_writeNicknamePermanent( uint8_t nick ) { vscp_regcache_write( EEPROM_NICKNAME, nick, vscp_timer ); }
+uint8_t vscp_getControlByte( uint8_t idx ) { return controlbyte[ idx & 1 ]; }
+void vscp_setControlByte( uint8_t idx, uint8_t ctrl ) { controlbyte[ idx & 1 ] = ctrl; }
+void vscp_init_pstorage( void ) { }
+void vscp_getMatrixInfo( char *pData ) { memset( pData, 0, 7 ); }
+void vscp_goBootloaderMode( uint8_t algorithm ) { }
+uint8_t vscp_getZone( void ) { return zoneReg; }
+uint8_t vscp_getSubzone( void ) { return subzoneReg; }
+uint32_t vscp_getFamilyCode( void ) { return 0; }
+uint32_t vscp_getFamilyType( void ) { return 0; }
+void vscp_restoreDefaults( void ) { }
+
+void vscp_dm_loadRow( uint16_t row, struct _dmrow *pRow )
+{
+    *pRow = dmstore[ row ];
+}
+
+void vscp_dm_doAction( const struct _dmrow *pRow, const vscpevent_t *pEvent )
+{
+    cntDMActions++;
+    dmActionSum = dmActionSum * 31 + pRow->action * 256 + pRow->action_param;
+
+    if ( dmReport ) {
+        uint8_t data[ 3 ] = { pRow->action, zoneReg, subzoneReg };
+        vscp_dm_sendEvent( VSCP_CLASS1_INFORMATION, pRow->action, pRow->action_param, 3, data );
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// Decision matrix reference
+//
+// Walks all rows and reads each of them and the zone for every event as
+// the decision matrix code of the node projects does.
+//
+
+static void refDM( const vscpevent_t *pe, uint16_t rows )
+{
+    struct _dmrow row;
+    uint16_t i, class_filter, class_mask;
+
+    for ( i = 0; i < rows; i++ ) {
+
+        vscp_dm_loadRow( i, &row );
+        if ( !( row.flags & VSCP_DM_FLAG_ENABLED ) ) continue;
+
+        if ( ( row.flags & VSCP_DM_FLAG_CHECK_OADDR ) && ( pe->oaddr != row.oaddr ) ) continue;
+
+        if ( ( row.flags & VSCP_DM_FLAG_CHECK_ZONE ) && ( 0xff != pe->data[ 1 ] ) &&
+                ( pe->data[ 1 ] != vscp_getZone() ) ) continue;
+
+        if ( ( row.flags & VSCP_DM_FLAG_CHECK_SUBZONE ) && ( 0xff != pe->data[ 2 ] ) &&
+                ( pe->data[ 2 ] != vscp_getSubzone() ) ) continue;
+
+        class_filter = ( ( row.flags & VSCP_DM_FLAG_CLASS_FILTER ) << 8 ) | row.class_filter;
+        class_mask = ( ( row.flags & VSCP_DM_FLAG_CLASS_MASK ) << 7 ) | row.class_mask;
+        if ( !( ( pe->vscp_class ^ class_filter ) & class_mask ) &&
+                !( ( pe->vscp_type ^ row.type_filter ) & row.type_mask ) ) {
+            vscp_dm_doAction( &row, pe );
+        }
+    }
+}
+
+// Classes used for decision matrix rows and events
+static const uint16_t dmclasses[] = { 10, 15, 20, 30, 40, 50, 60, 65, 85, 100, 102, 256 + 20 };
+#define DM_CLASSES  ( sizeof( dmclasses ) / sizeof( dmclasses[ 0 ] ) )
+
+static void makeDMRows( uint16_t rows )
+{
+    uint16_t i, cls;
+
+    for ( i = 0; i < rows; i++ ) {
+        struct _dmrow *pRow = &dmstore[ i ];
+        cls = dmclasses[ rand() % DM_CLASSES ];
+        pRow->oaddr = rand() % 4;
+        pRow->flags = ( ( rand() % 4 ) ? VSCP_DM_FLAG_ENABLED : 0 ) |
+                        ( ( rand() % 4 ) ? 0 : VSCP_DM_FLAG_CHECK_OADDR ) |
+                        ( ( rand() % 2 ) ? 0 : VSCP_DM_FLAG_CHECK_ZONE ) |
+                        ( ( rand() % 4 ) ? 0 : VSCP_DM_FLAG_CHECK_SUBZONE ) |
+                        ( ( cls >> 8 ) & VSCP_DM_FLAG_CLASS_FILTER );
+        pRow->class_filter = cls & 0xff;
+        pRow->class_mask = 0xff;
+        if ( 0 == ( rand() % 16 ) ) {
+            pRow->class_mask = 0;       // Any class
+        }
+        else {
+            pRow->flags |= VSCP_DM_FLAG_CLASS_MASK;
+        }
+        pRow->type_filter = rand() % 8;
+        pRow->type_mask = ( rand() % 2 ) ? 0xff : 0x00;
+        pRow->action = 1 + rand() % 8;
+        pRow->action_param = i;
+    }
+}
+
+static void makeDMEvent( vscpevent_t *pe )
+{
+    pe->flags = VSCP_VALID_MSG + 3;
+    pe->vscp_class = dmclasses[ rand() % DM_CLASSES ];
+    pe->vscp_type = rand() % 8;
+    pe->oaddr = rand() % 4;
+    pe->data[ 0 ] = 0;
+    pe->data[ 1 ] = ( rand() % 4 ) ? zoneReg : 0xff;
+    pe->data[ 2 ] = ( rand() % 2 ) ? subzoneReg : 1;
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// main
+//
+
+int main( int argc, char *argv[] )
+{
+    pthread_t timer;
+    int i, j;
+
+    for ( i = 0; i < 256; i++ ) {
+        for ( j = 0; j < 128; j++ ) {
+            appreg[ i ][ j ] = (uint8_t)( i * 3 + j );
+        }
+    }
+
+    eeprom[ EEPROM_NICKNAME ] = NICKNAME;
+    for ( j = 0; j < 128; j++ ) {
+        eeprom[ EEPROM_PAGE0 + j ] = (uint8_t)j;
+    }
+    vscp_regcache_init();
+
+    vscp_init();
+    vscp_node_state = VSCP_STATE_ACTIVE;
+
+    timerRun = 1;
+    pthread_create( &timer, NULL, timerThread, NULL );
+
+    // ------------------------------------------------------------------------
+
+    printf("Extended page read test 1\n");
+    {
+        uint8_t req[ 5 ] = { NICKNAME, 0x00, 0x01, 0x00, 0x00 };   // page 1, 256 regs
+        uint8_t rd[ 2 ] = { NICKNAME, 0x10 };
+        double start, t, maxLoop = 0;
+        int reply = -1;
+        uint8_t reg = 0;
+        int ok = 1;
+
+        cntTx = 0;
+        vscp_page_select = 7;
+        start = msNow();
+        putFrame( VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_READ, 5, req );
+
+        while ( ( cntTx < 65 ) && ( ( msNow() - start ) < 2000 ) ) {
+            t = mainLoop();
+            if ( t > maxLoop ) maxLoop = t;
+
+            // A register read while the page read is in progress
+            if ( 5 == cntTx && ( rxHead == rxTail ) && ( reply < 0 ) ) {
+                putFrame( VSCP_TYPE_PROTOCOL_READ_REGISTER, 2, rd );
+                reply = 0;
+            }
+            sched_yield();
+        }
+
+        printf("Extended page read: %d frames in %.1f ms, max main loop latency %.3f ms\n",
+                cntTx, msNow() - start, maxLoop );
+
+        for ( i = 0; i < cntTx; i++ ) {
+            frame_t *pf = &txq[ i ];
+            if ( VSCP_TYPE_PROTOCOL_RW_RESPONSE == pf->vscp_type ) {
+                if ( i >= 64 ) printf("Extended page read test 1, read register not served during page read.\n");
+                if ( pf->data[ 1 ] != appreg[ 7 ][ 0x10 ] ) printf("Extended page read test 1, wrong page for read register.\n");
+                reply = 1;
+                continue;
+            }
+            if ( ( VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_RESPONSE != pf->vscp_type ) ||
+                    ( 8 != pf->size ) || ( 1 != pf->data[ 2 ] ) || ( reg != pf->data[ 3 ] ) ) {
+                ok = 0;
+                break;
+            }
+            for ( j = 0; j < 4; j++, reg++ ) {
+                if ( ( reg < 0x80 ) && ( pf->data[ 4 + j ] != appreg[ 1 ][ reg ] ) ) ok = 0;
+            }
+        }
+        if ( !ok || ( 65 != cntTx ) ) printf("Extended page read test 1, response fail.\n");
+        if ( 1 != reply ) printf("Extended page read test 1, no read register reply.\n");
+        if ( 7 != vscp_page_select ) printf("Extended page read test 1, page select not restored.\n");
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("Page read/write test 1\n");
+    {
+        uint8_t wr[ 7 ] = { NICKNAME, 0x7d, 0xa1, 0xa2, 0xa3, 0x00, 0x00 };
+        uint8_t rd[ 3 ] = { NICKNAME, 0x70, 0x20 };             // 0x70 - 0x8f
+        uint8_t xwr[ 8 ] = { NICKNAME, 0x00, 0x09, 0x7e, 0xb1, 0xb2, 0xb3, 0xb4 };
+        uint8_t reg = 0x70;
+        int ok = 1;
+
+        cntTx = 0;
+        cntAppRegCalls = cntAppRegsCalls = 0;
+        vscp_page_select = 3;
+
+        // Page write 0x7d - 0x7f, the frame is three bytes
+        putFrame( VSCP_TYPE_PROTOCOL_PAGE_WRITE, 5, wr );
+        while ( rxHead != rxTail ) mainLoop();
+        if ( ( 1 != cntTx ) || ( 4 != txq[ 0 ].size ) ||
+                ( 0xa1 != txq[ 0 ].data[ 1 ] ) || ( 0xa3 != txq[ 0 ].data[ 3 ] ) ||
+                ( 0xa2 != appreg[ 3 ][ 0x7e ] ) ) {
+            printf("Page read/write test 1, page write fail.\n");
+        }
+
+        // Page read across the application/standard register boundary
+        putFrame( VSCP_TYPE_PROTOCOL_PAGE_READ, 3, rd );
+        while ( rxHead != rxTail ) mainLoop();
+        if ( 6 != cntTx ) printf("Page read/write test 1, page read frame count fail.\n");
+        for ( i = 1; i < cntTx; i++ ) {
+            frame_t *pf = &txq[ i ];
+            if ( ( VSCP_TYPE_PROTOCOL_RW_PAGE_RESPONSE != pf->vscp_type ) ||
+                    ( ( i - 1 ) != pf->data[ 0 ] ) ) {
+                ok = 0;
+                break;
+            }
+            for ( j = 1; j < pf->size; j++, reg++ ) {
+                if ( ( reg < 0x80 ) && ( pf->data[ j ] != appreg[ 3 ][ reg ] ) ) ok = 0;
+            }
+        }
+        if ( !ok || ( 0x90 != reg ) ) printf("Page read/write test 1, page read fail.\n");
+
+        // Extended page write on page 9
+        putFrame( VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_WRITE, 8, xwr );
+        while ( rxHead != rxTail ) mainLoop();
+        if ( ( 7 != cntTx ) || ( 0xb2 != appreg[ 9 ][ 0x7f ] ) ||
+                ( 0xb1 != txq[ 6 ].data[ 4 ] ) || ( 8 != txq[ 6 ].size ) ||
+                ( 3 != vscp_page_select ) ) {
+            printf("Page read/write test 1, extended page write fail.\n");
+        }
+
+        printf("Page read/write: %d bulk and %d per-byte application register calls\n",
+                cntAppRegsCalls, cntAppRegCalls );
+        if ( cntAppRegCalls ) printf("Page read/write test 1, per-byte register calls fail.\n");
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("Register cache test 1\n");
+    {
+        uint8_t wr[ 3 ] = { NICKNAME, 0, 0 };
+        double start, tFlush;
+        int pass, ok = 1;
+
+        cntTx = 0;
+        cntEepromWrites = cntEepromBytes = 0;
+        eepromMs = 0;
+        vscp_page_select = 0;
+
+        // Configure all of page 0 with WRITE_REGISTER, then do it again
+        // with the same values as a configuration tool would on a retry
+        for ( pass = 0; pass < 2; pass++ ) {
+            for ( i = 0; i < 128; i++ ) {
+                wr[ 1 ] = i;
+                wr[ 2 ] = (uint8_t)( i ^ 0x5a );
+                putFrame( VSCP_TYPE_PROTOCOL_WRITE_REGISTER, 3, wr );
+                mainLoop();
+                if ( ( VSCP_TYPE_PROTOCOL_RW_RESPONSE != txq[ cntTx - 1 ].vscp_type ) ||
+                        ( wr[ 2 ] != txq[ cntTx - 1 ].data[ 1 ] ) ) ok = 0;
+            }
+        }
+        if ( !ok || ( 256 != cntTx ) ) printf("Register cache test 1, write register response fail.\n");
+        if ( cntEepromWrites ) printf("Register cache test 1, EEPROM written before writing stopped.\n");
+
+        // Idle main loop until the cache is flushed
+        start = msNow();
+        while ( vscp_regcache_dirty() && ( ( msNow() - start ) < 2000 ) ) {
+            mainLoop();
+            sched_yield();
+        }
+        tFlush = msNow() - start;
+
+        for ( i = 0; i < 128; i++ ) {
+            if ( eeprom[ EEPROM_PAGE0 + i ] != (uint8_t)( i ^ 0x5a ) ) ok = 0;
+        }
+        if ( !ok ) printf("Register cache test 1, EEPROM content fail.\n");
+        if ( ( 128 / VSCP_REGCACHE_PAGE_SIZE ) != cntEepromWrites ) {
+            printf("Register cache test 1, EEPROM page write count fail.\n");
+        }
+        if ( tFlush < ( VSCP_REGCACHE_FLUSH_DELAY / 2 ) ) printf("Register cache test 1, flush too early.\n");
+
+        printf("Register cache: 256 register writes, %d EEPROM writes (%d bytes) %.1f ms, uncached 256 writes %.1f ms\n",
+                cntEepromWrites, cntEepromBytes, eepromMs,
+                256 * ( EEPROM_WRITE_MS + EEPROM_BYTE_MS ) );
+
+        // Nickname is written back on an explicit flush
+        vscp_writeNicknamePermanent( NICKNAME + 1 );
+        if ( NICKNAME != eeprom[ EEPROM_NICKNAME ] ) printf("Register cache test 1, nickname written too early.\n");
+        vscp_regcache_flush();
+        if ( ( NICKNAME + 1 ) != eeprom[ EEPROM_NICKNAME ] ) printf("Register cache test 1, nickname flush fail.\n");
+        vscp_writeNicknamePermanent( NICKNAME );
+        vscp_regcache_flush();
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("Decision matrix test 1\n");
+    {
+        static vscpevent_t events[ 1024 ];
+        static const uint16_t rowcnt[] = { 16, 64, 256 };
+        uint32_t sumRef, sumDM, cntRef, cntDM;
+        double start, tRef, tDM;
+        int r, n, loops;
+
+        srand( 1 );
+        for ( i = 0; i < 1024; i++ ) {
+            makeDMEvent( &events[ i ] );
+        }
+
+        for ( r = 0; r < 3; r++ ) {
+
+            makeDMRows( rowcnt[ r ] );
+            vscp_dm_init( rowcnt[ r ] );
+            loops = 65536 / rowcnt[ r ];
+
+            dmActionSum = cntDMActions = 0;
+            start = msNow();
+            for ( n = 0; n < loops; n++ ) {
+                for ( i = 0; i < 1024; i++ ) refDM( &events[ i ], rowcnt[ r ] );
+            }
+            tRef = msNow() - start;
+            sumRef = dmActionSum;
+            cntRef = cntDMActions;
+
+            dmActionSum = cntDMActions = 0;
+            start = msNow();
+            for ( n = 0; n < loops; n++ ) {
+                for ( i = 0; i < 1024; i++ ) vscp_dm_feed( &events[ i ] );
+            }
+            tDM = msNow() - start;
+            sumDM = dmActionSum;
+            cntDM = cntDMActions;
+
+            if ( ( sumRef != sumDM ) || ( cntRef != cntDM ) ) {
+                printf("Decision matrix test 1, %d rows, actions differ from reference.\n", rowcnt[ r ] );
+            }
+
+            printf("Decision matrix %3d rows (%3d enabled): row walk %.0f events/s, indexed %.0f events/s\n",
+                    rowcnt[ r ], vscp_dm_getEnabledRows(),
+                    loops * 1024 / tRef * 1000, loops * 1024 / tDM * 1000 );
+        }
+
+        // Changed rows are used after an invalidate
+        for ( i = 1; i < 256; i++ ) dmstore[ i ].flags = 0;
+        dmstore[ 0 ].flags = VSCP_DM_FLAG_ENABLED;
+        dmstore[ 0 ].class_mask = dmstore[ 0 ].type_mask = 0;
+        dmstore[ 0 ].action = 0x55;
+        vscp_dm_invalidate();
+        dmActionSum = cntDMActions = 0;
+        vscp_dm_feed( &events[ 0 ] );
+        if ( ( 1 != cntDMActions ) || ( 0x5500 != dmActionSum ) ) {
+            printf("Decision matrix test 1, invalidate fail.\n");
+        }
+
+        // Zone/subzone rows don't match events too short to carry them
+        events[ 0 ].data[ 1 ] = events[ 0 ].data[ 2 ] = 0xff;
+        dmstore[ 0 ].flags = VSCP_DM_FLAG_ENABLED | VSCP_DM_FLAG_CHECK_ZONE;
+        vscp_dm_invalidate();
+        events[ 0 ].flags = VSCP_VALID_MSG + 1;
+        if ( vscp_dm_feed( &events[ 0 ] ) ) printf("Decision matrix test 1, zone of short event fail.\n");
+        events[ 0 ].flags = VSCP_VALID_MSG + 2;
+        if ( !vscp_dm_feed( &events[ 0 ] ) ) printf("Decision matrix test 1, zone fail.\n");
+        dmstore[ 0 ].flags = VSCP_DM_FLAG_ENABLED | VSCP_DM_FLAG_CHECK_SUBZONE;
+        vscp_dm_invalidate();
+        if ( vscp_dm_feed( &events[ 0 ] ) ) printf("Decision matrix test 1, subzone of short event fail.\n");
+        events[ 0 ].flags = VSCP_VALID_MSG + 3;
+        if ( !vscp_dm_feed( &events[ 0 ] ) ) printf("Decision matrix test 1, subzone fail.\n");
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("Decision matrix test 2 (batched actions)\n");
+    {
+        // The second row has a stray bit above the priority set
+        static const uint8_t rowdef[ 4 ][ 2 ] = { { 3, 3 }, { 3, 0x09 }, { 5, 0 }, { 7, 6 } };
+        static const uint8_t expect[ 3 ][ 2 ] = { { 5, 0 }, { 3, 1 }, { 7, 6 } };
+        vscpevent_t ev;
+        int ok = 1;
+
+        // Four rows on the same event, two of them report the same thing
+        for ( i = 0; i < 4; i++ ) {
+            memset( &dmstore[ i ], 0, sizeof( struct _dmrow ) );
+            dmstore[ i ].flags = VSCP_DM_FLAG_ENABLED | VSCP_DM_FLAG_CLASS_MASK;
+            dmstore[ i ].class_mask = 0xff;
+            dmstore[ i ].class_filter = VSCP_CLASS1_CONTROL;
+            dmstore[ i ].action = rowdef[ i ][ 0 ];
+            dmstore[ i ].action_param = rowdef[ i ][ 1 ];
+        }
+        vscp_dm_init( 4 );
+
+        memset( &ev, 0, sizeof( ev ) );
+        ev.flags = VSCP_VALID_MSG + 3;
+        ev.vscp_class = VSCP_CLASS1_CONTROL;
+        dmReport = 1;
+
+        cntTx = 0;
+        if ( 4 != vscp_dm_feed( &ev ) ) printf("Decision matrix test 2, match count fail.\n");
+        if ( 3 != cntTx ) ok = 0;
+        for ( i = 0; ( i < 3 ) && ( i < cntTx ); i++ ) {
+            if ( ( VSCP_CLASS1_INFORMATION != txq[ i ].vscp_class ) ||
+                    ( expect[ i ][ 0 ] != txq[ i ].vscp_type ) ||
+                    ( expect[ i ][ 1 ] != txq[ i ].priority ) ) ok = 0;
+        }
+        if ( !ok ) printf("Decision matrix test 2, batch order/dedup fail.\n");
+
+        // A burst while the driver is full fills the transmit queue, after
+        // that only one of each is kept
+        cntTx = 0;
+        txBlocked = 1;
+        for ( i = 0; i < 20; i++ ) vscp_dm_feed( &ev );
+        if ( ( 0 != cntTx ) || ( VSCP_TX_QUEUE_SIZE != vscp_sendQueuedEvents() ) ||
+                ( 3 != vscp_dm_getPending() ) ) {
+            printf("Decision matrix test 2, burst queue fail.\n");
+        }
+
+        // and it is sent from the main loop when the driver has room
+        txBlocked = 0;
+        mainLoop();
+        if ( ( ( VSCP_TX_QUEUE_SIZE + 3 ) != cntTx ) || vscp_dm_getPending() ||
+                vscp_sendQueuedEvents() ) {
+            printf("Decision matrix test 2, retry fail.\n");
+        }
+
+        // DM events are sent in priority order with events already queued
+        cntTx = 0;
+        txBlocked = 1;
+        vscp_omsg.priority = VSCP_PRIORITY_LOW;
+        vscp_omsg.flags = VSCP_VALID_MSG + 1;
+        vscp_omsg.vscp_class = VSCP_CLASS1_INFORMATION;
+        vscp_omsg.vscp_type = VSCP_TYPE_INFORMATION_ON;
+        vscp_omsg.data[ 0 ] = 0;
+        vscp_sendEvent();
+        vscp_dm_feed( &ev );
+        txBlocked = 0;
+        mainLoop();
+        if ( ( 4 != cntTx ) || ( VSCP_TYPE_INFORMATION_ON != txq[ 3 ].vscp_type ) ) {
+            printf("Decision matrix test 2, queue order fail.\n");
+        }
+
+        dmReport = 0;
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("Event queue test 1\n");
+    {
+        uint8_t who = 0xff;
+        uint8_t errors = vscp_errorcnt;
+        int ok = 1;
+
+        // All seven WHO_IS_THERE responses are kept while the driver is full
+        cntTx = 0;
+        txBlocked = 1;
+        putFrame( VSCP_TYPE_PROTOCOL_WHO_IS_THERE, 1, &who );
+        mainLoop();
+        if ( ( 0 != cntTx ) || ( 7 != vscp_sendQueuedEvents() ) ||
+                ( errors != vscp_errorcnt ) ) {
+            printf("Event queue test 1, burst queue fail.\n");
+        }
+
+        // A high priority event queued later goes out first
+        vscp_omsg.priority = VSCP_PRIORITY_HIGH;
+        vscp_omsg.flags = VSCP_VALID_MSG + 1;
+        vscp_omsg.vscp_class = VSCP_CLASS1_INFORMATION;
+        vscp_omsg.vscp_type = VSCP_TYPE_INFORMATION_ON;
+        vscp_omsg.data[ 0 ] = 0;
+        vscp_sendEvent();
+
+        // Queue full, event dropped and counted
+        vscp_sendEvent();
+        if ( ( errors + 1 ) != vscp_errorcnt ) {
+            printf("Event queue test 1, full queue fail.\n");
+        }
+
+        txBlocked = 0;
+        mainLoop();
+        if ( ( 8 != cntTx ) || vscp_sendQueuedEvents() ) ok = 0;
+        if ( VSCP_TYPE_INFORMATION_ON != txq[ 0 ].vscp_type ) ok = 0;
+        for ( i = 1; ( i < 8 ) && ( i < cntTx ); i++ ) {
+            if ( ( VSCP_TYPE_PROTOCOL_WHO_IS_THERE_RESPONSE != txq[ i ].vscp_type ) ||
+                    ( ( i - 1 ) != txq[ i ].data[ 0 ] ) ) ok = 0;
+        }
+        if ( !ok ) printf("Event queue test 1, send order fail.\n");
+
+        // Frames are taken from the driver while vscp_imsg is busy
+        cntTx = 0;
+        for ( i = 0; i < 6; i++ ) putFrame( VSCP_TYPE_PROTOCOL_WHO_IS_THERE, 1, &who );
+        vscp_imsg.flags = 0;
+        vscp_getEvent();
+        if ( ( rxTail - rxHead ) != ( 5 - VSCP_RX_QUEUE_SIZE ) ) {
+            printf("Event queue test 1, receive queue fail.\n");
+        }
+        vscp_handleProtocolEvent();
+        for ( i = 0; i < 5; i++ ) mainLoop();
+        if ( ( rxHead != rxTail ) || ( 6 * 7 != cntTx ) ) {
+            printf("Event queue test 1, receive fail.\n");
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("Event queue test 2\n");
+    {
+        uint8_t req[ 5 ] = { NICKNAME, 0x00, 0x01, 0x00, 0x08 };   // page 1, 8 regs
+        uint8_t errors = vscp_errorcnt;
+        double start;
+
+        // An event queued while the driver is full
+        cntTx = 0;
+        txBlocked = 1;
+        vscp_omsg.priority = VSCP_PRIORITY_NORMAL;
+        vscp_omsg.flags = VSCP_VALID_MSG + 1;
+        vscp_omsg.vscp_class = VSCP_CLASS1_INFORMATION;
+        vscp_omsg.vscp_type = VSCP_TYPE_INFORMATION_ON;
+        vscp_omsg.data[ 0 ] = 0;
+        vscp_sendEvent();
+
+        // Page read retries while the driver is full are not errors
+        putFrame( VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_READ, 5, req );
+        start = msNow();
+        while ( ( msNow() - start ) < 20 ) mainLoop();
+        if ( errors != vscp_errorcnt ) printf("Event queue test 2, busy driver counted as error fail.\n");
+
+        // The queued event goes out before the page read reply
+        txBlocked = 0;
+        start = msNow();
+        while ( ( cntTx < 3 ) && ( ( msNow() - start ) < 200 ) ) mainLoop();
+        if ( ( 3 != cntTx ) ||
+                ( VSCP_TYPE_INFORMATION_ON != txq[ 0 ].vscp_type ) ||
+                ( VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_RESPONSE != txq[ 1 ].vscp_type ) ||
+                ( VSCP_TYPE_PROTOCOL_EXTENDED_PAGE_RESPONSE != txq[ 2 ].vscp_type ) ) {
+            printf("Event queue test 2, page read reply overtook queued event fail.\n");
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("CAN id test 1\n");
+    {
+        static const struct {
+            uint8_t priority;
+            uint16_t vscp_class;
+            uint8_t vscp_type;
+            uint8_t nickname;
+            uint32_t id;
+        } vectors[] = {
+            { 0, 0, 0, 0, 0x00000000 },
+            { 7, 0x1ff, 0xff, 0xff, 0x1dffffff },
+            { 3, 20, 9, 0x42, 0x0c140942 },
+            { 0, 256 + 10, 1, 0x10, 0x010a0110 },
+            { 4, 0x100, 0x80, 0x01, 0x11008001 },
+            { 1, 0x0ff, 0x00, 0xfe, 0x04ff00fe },
+        };
+        static vscp_canframe_t frames[ 1024 ];
+        static vscpevent_t evs[ 1024 ];
+        uint32_t id;
+        double start, tGlue, tMacro;
+        int n, ok = 1;
+
+        for ( i = 0; i < sizeof( vectors ) / sizeof( vectors[ 0 ] ); i++ ) {
+            id = VSCP_CANID_PACK( vectors[ i ].priority, vectors[ i ].vscp_class,
+                                    vectors[ i ].vscp_type, vectors[ i ].nickname );
+            if ( ( id != vectors[ i ].id ) ||
+                    ( VSCP_CANID_PRIORITY( id ) != vectors[ i ].priority ) ||
+                    ( VSCP_CANID_CLASS( id ) != vectors[ i ].vscp_class ) ||
+                    ( VSCP_CANID_TYPE( id ) != vectors[ i ].vscp_type ) ||
+                    ( VSCP_CANID_NICKNAME( id ) != vectors[ i ].nickname ) ||
+                    VSCP_CANID_HARDCODED( id ) ) ok = 0;
+
+            // The hard coded bit doesn't disturb the other fields
+            id |= VSCP_CANID_HARDCODED_BIT;
+            if ( !VSCP_CANID_HARDCODED( id ) ||
+                    ( VSCP_CANID_PRIORITY( id ) != vectors[ i ].priority ) ||
+                    ( VSCP_CANID_CLASS( id ) != vectors[ i ].vscp_class ) ) ok = 0;
+        }
+        if ( !ok ) printf("CAN id test 1, test vector fail.\n");
+
+        // Unpack matches the plain shifts for random ids
+        srand( 3 );
+        for ( i = 0; i < 100000; i++ ) {
+            id = ( (uint32_t)rand() ^ ( (uint32_t)rand() << 15 ) ) & 0x1fffffff;
+            if ( ( VSCP_CANID_PRIORITY( id ) != ( ( id >> 26 ) & 7 ) ) ||
+                    ( VSCP_CANID_CLASS( id ) != ( ( id >> 16 ) & 0x1ff ) ) ||
+                    ( VSCP_CANID_TYPE( id ) != ( ( id >> 8 ) & 0xff ) ) ||
+                    ( VSCP_CANID_NICKNAME( id ) != ( id & 0xff ) ) ||
+                    ( VSCP_CANID_PACK( VSCP_CANID_PRIORITY( id ), VSCP_CANID_CLASS( id ),
+                        VSCP_CANID_TYPE( id ), VSCP_CANID_NICKNAME( id ) ) !=
+                        ( id & ~VSCP_CANID_HARDCODED_BIT ) ) ) {
+                ok = 0;
+                break;
+            }
+        }
+        if ( !ok ) printf("CAN id test 1, random id fail.\n");
+
+        // Received frames end up in vscp_imsg
+        vscp_imsg.flags = 0;
+        rxHead = rxTail = 0;
+        rxq[ 0 ].id = VSCP_CANID_PACK( 2, VSCP_CLASS1_PROTOCOL, 0x30, 0x17 );
+        rxq[ 0 ].size = 3;
+        memcpy( rxq[ 0 ].data, "\x01\x02\x03", 3 );
+        rxTail = 1;
+        if ( !vscp_getEvent() || ( 2 != vscp_imsg.priority ) ||
+                ( VSCP_CLASS1_PROTOCOL != vscp_imsg.vscp_class ) ||
+                ( 0x30 != vscp_imsg.vscp_type ) || ( 0x17 != vscp_imsg.oaddr ) ||
+                ( ( VSCP_VALID_MSG | 3 ) != vscp_imsg.flags ) ||
+                ( 3 != vscp_imsg.data[ 2 ] ) || ( rxHead != rxTail ) ) {
+            printf("CAN id test 1, frame decode fail.\n");
+        }
+        vscp_imsg.flags = 0;
+
+        // Decode speed, port glue vs in place
+        for ( i = 0; i < 1024; i++ ) {
+            frames[ i ].id = ( (uint32_t)rand() ^ ( (uint32_t)rand() << 15 ) ) & 0x1fffffff;
+            frames[ i ].size = rand() % 9;
+            memset( frames[ i ].data, i, 8 );
+        }
+
+        start = msNow();
+        for ( n = 0; n < 1000; n++ ) {
+            for ( i = 0; i < 1024; i++ ) {
+                glueDecode( &frames[ i ], &evs[ i ].vscp_class, &evs[ i ].vscp_type,
+                            &evs[ i ].oaddr, &evs[ i ].priority, &evs[ i ].flags,
+                            evs[ i ].data );
+            }
+        }
+        tGlue = msNow() - start;
+
+        start = msNow();
+        for ( n = 0; n < 1000; n++ ) {
+            for ( i = 0; i < 1024; i++ ) {
+                id = frames[ i ].id;
+                evs[ i ].priority = VSCP_CANID_PRIORITY( id );
+                evs[ i ].vscp_class = VSCP_CANID_CLASS( id );
+                evs[ i ].vscp_type = VSCP_CANID_TYPE( id );
+                evs[ i ].oaddr = VSCP_CANID_NICKNAME( id );
+                evs[ i ].flags = frames[ i ].size;
+                memcpy( evs[ i ].data, frames[ i ].data, frames[ i ].size );
+            }
+        }
+        tMacro = msNow() - start;
+
+        printf("CAN frame decode: port glue %.1f ns/frame, in place %.1f ns/frame\n",
+                tGlue * 1e6 / ( 1000 * 1024 ), tMacro * 1e6 / ( 1000 * 1024 ) );
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("Acceptance filter test 1\n");
+    {
+        static const uint16_t rowcnt[] = { 4, 16, 64 };
+        static const uint8_t oaddrs[] = { 0, 1, 2, 3, NICKNAME, 0x80, 0xfe };
+        uint32_t cntNeeded, cntPassed;
+        uint16_t c, t;
+        int r, o, ok = 1;
+
+        srand( 7 );
+        vscp_nickname = NICKNAME;
+
+        for ( r = 0; r < 3; r++ ) {
+
+            // Rows for a specific class, the usual setup
+            makeDMRows( rowcnt[ r ] );
+            for ( i = 0; i < rowcnt[ r ]; i++ ) {
+                dmstore[ i ].flags |= VSCP_DM_FLAG_CLASS_MASK;
+                dmstore[ i ].class_mask = 0xff;
+            }
+            vscp_dm_init( rowcnt[ r ] );
+
+            // Programmed from the main loop when the matrix changes
+            cntProgram = 0;
+            mainLoop();
+            mainLoop();
+            if ( 1 != cntProgram ) printf("Acceptance filter test 1, reprogram fail.\n");
+
+            // Every needed id must pass
+            cntNeeded = cntPassed = 0;
+            for ( c = 0; c < 512; c++ ) {
+                for ( t = 0; t < 256; t++ ) {
+                    for ( o = 0; o < sizeof( oaddrs ); o++ ) {
+                        uint32_t id = ( (uint32_t)VSCP_PRIORITY_LOW << 26 ) |
+                                        ( (uint32_t)c << 16 ) | ( t << 8 ) | oaddrs[ o ];
+                        int needed = idNeeded( c, t, oaddrs[ o ], rowcnt[ r ] );
+                        int passed = hwAccept( id );
+                        if ( needed && !passed ) ok = 0;
+                        cntNeeded += needed;
+                        cntPassed += passed;
+                    }
+                }
+            }
+
+            printf("Acceptance filter %2d rows (%2d enabled): %d filters, needed %.2f%% of ids, let through %.2f%%\n",
+                    rowcnt[ r ], vscp_dm_getEnabledRows(), cntHwFilters,
+                    cntNeeded * 100.0 / ( 512 * 256 * sizeof( oaddrs ) ),
+                    cntPassed * 100.0 / ( 512 * 256 * sizeof( oaddrs ) ) );
+        }
+        if ( !ok ) printf("Acceptance filter test 1, needed id filtered out fail.\n");
+
+        // A new nickname is programmed too
+        cntProgram = 0;
+        vscp_nickname = 0x43;
+        mainLoop();
+        if ( ( 1 != cntProgram ) || !hwAccept( 0x43 | ( 511UL << 16 ) | ( 255 << 8 ) ) ) {
+            printf("Acceptance filter test 1, nickname change fail.\n");
+        }
+        vscp_nickname = NICKNAME;
+        mainLoop();
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("CAN TX scheduler test 1\n");
+    {
+        uint8_t data[ 8 ] = { 0 };
+        uint8_t last[ 8 ];
+        uint32_t id;
+        int ok = 1, alarmPos = -1;
+
+        vscp_cantx_init();
+        cntBus = 0;
+        mboxLoaded = mboxAbort = 0;
+
+        // Twelve status frames in priority 5-7 fill the mailboxes...
+        for ( i = 0; i < 12; i++ ) {
+            data[ 0 ] = i;
+            id = ( (uint32_t)( 5 + i % 3 ) << 26 ) |
+                    ( (uint32_t)VSCP_CLASS1_INFORMATION << 16 ) |
+                    ( VSCP_TYPE_INFORMATION_NODE_HEARTBEAT << 8 ) | NICKNAME;
+            if ( !vscp_cantx_send( id, 1, data ) ) ok = 0;
+        }
+        busStep();
+        busStep();
+
+        // ...then an alarm arrives
+        id = ( (uint32_t)VSCP_PRIORITY_HIGH << 26 ) |
+                ( (uint32_t)VSCP_CLASS1_ALARM << 16 ) |
+                ( VSCP_TYPE_ALARM_ALARM << 8 ) | NICKNAME;
+        data[ 0 ] = 0xaa;
+        if ( !vscp_cantx_send( id, 1, data ) ) ok = 0;
+
+        for ( i = 0; ( i < 100 ) && vscp_cantx_pending(); i++ ) busStep();
+
+        // Everything sent, alarm first, each priority in order
+        if ( ( 13 != cntBus ) || vscp_cantx_pending() ) ok = 0;
+        memset( last, 0, sizeof( last ) );
+        for ( i = 0; ( i < cntBus ) && ( i < 64 ); i++ ) {
+            uint8_t p = VSCP_CANTX_PRIORITY( busLog[ i ].id );
+            if ( 0 == p ) {
+                alarmPos = i;
+                continue;
+            }
+            if ( busLog[ i ].data[ 0 ] + 1 <= last[ p ] ) ok = 0;
+            last[ p ] = busLog[ i ].data[ 0 ] + 1;
+        }
+        if ( ( 2 != alarmPos ) || !vscp_cantx_stats.cntAborts ) ok = 0;
+        if ( !ok ) printf("CAN TX scheduler test 1, order fail.\n");
+
+        printf("CAN TX scheduler: alarm sent as frame %d of %d, %u aborts, %u reordered\n",
+                alarmPos + 1, cntBus,
+                (unsigned)vscp_cantx_stats.cntAborts,
+                (unsigned)vscp_cantx_stats.cntReordered );
+
+        // Frames that don't fit are refused and counted
+        mboxAbort = 0x80;   // Stall the bus
+        for ( i = 0; i < VSCP_CANTX_QUEUE_SIZE + 2; i++ ) vscp_cantx_send( id, 0, data );
+        if ( ( 2 != vscp_cantx_stats.cntOverruns ) ||
+                ( VSCP_CANTX_QUEUE_SIZE != vscp_cantx_pending() ) ) {
+            printf("CAN TX scheduler test 1, overrun fail.\n");
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+    timerRun = 0;
+    pthread_join( timer, NULL );
+
+    return 0;
+}
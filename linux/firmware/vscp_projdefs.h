@@ -0,0 +1,57 @@
+// FILE: vscp_projdefs.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Application registers are also accessed in runs through
+// vscp_readAppRegs()/vscp_writeAppRegs().
+#define VSCP_FIRMWARE_ENABLE_BULK_APPREGS
+
+// Register page 0 and the nickname are kept in a simulated EEPROM behind
+// the register cache.
+#define VSCP_FIRMWARE_ENABLE_REGCACHE
+#define VSCP_REGCACHE_SIZE          256
+
+// Decision matrix (common/vscp_dm.c), benchmark runs with up to 256 rows
+#define VSCP_FIRMWARE_ENABLE_DM
+#define VSCP_DM_ROWS                256
+
+// Outgoing and incoming events go through the firmware queues
+#define VSCP_FIRMWARE_ENABLE_QUEUES
+
+// Acceptance filters computed from the decision matrix (common/vscp_canfilt.c),
+// eight mask/filter pairs as on an AT90CAN (one MOb each) or an ECAN
+#define VSCP_FIRMWARE_ENABLE_CANFILT
+#define VSCP_CANFILT_SLOTS          8
+
+// Received frames are decoded in place from the driver buffer (vscp_canid.h)
+#define VSCP_FIRMWARE_ENABLE_CANFRAME
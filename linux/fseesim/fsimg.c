@@ -0,0 +1,416 @@
+// FILE: fsimg.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#include <string.h>
+#include <strings.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <ctype.h>
+
+#include "projdefs.h"
+#include "fsimg.h"
+
+#define FSIMG_HEADER_LEN    ( 5 )
+#define FATFLAG_END         ( 0x80 )
+#define FATFLAG_INDEX       ( 0x40 )
+
+// Compressed file extensions used by the Web Page Uploading program
+static const char *zipExt[][ 2 ] = {
+    { "htm", "zht" },
+    { "txt", "ztx" },
+    { "cla", "zcl" },
+    { "css", "zcs" },
+    { "js", "zjs" },
+    { NULL, NULL }
+};
+
+WORD fsimg_hash( const char *pName )
+{
+    WORD hash = 0;
+
+    while ( *pName != '\0' ) {
+        hash = ( WORD )( ( ( hash << 5 ) | ( hash >> 11 ) ) + ( BYTE )*pName++ );
+    }
+
+    return ( hash == 0 ) ? 1 : hash;
+}
+
+// Trim leading and trailing white space in place
+static char *trim( char *s )
+{
+    char *e;
+
+    while ( isspace( ( unsigned char )*s ) ) {
+        s++;
+    }
+
+    e = s + strlen( s );
+    while ( ( e > s ) && isspace( ( unsigned char )e[ -1 ] ) ) {
+        *--e = '\0';
+    }
+
+    return s;
+}
+
+// Read a whole file, or the gzip -9 output for it
+static BYTE *readFile( const char *pPath, BOOL bZip, unsigned long *pLen )
+{
+    FILE *fp;
+    BYTE *pData = NULL;
+    unsigned long len = 0;
+    unsigned long size = 0;
+    size_t n;
+    char cmd[ 1024 ];
+
+    if ( bZip ) {
+        snprintf( cmd, sizeof( cmd ), "gzip -9 -n -c '%s'", pPath );
+        fp = popen( cmd, "r" );
+    }
+    else {
+        fp = fopen( pPath, "rb" );
+    }
+
+    if ( NULL == fp ) {
+        return NULL;
+    }
+
+    do {
+        if ( len == size ) {
+            size = size ? size * 2 : 4096;
+            pData = realloc( pData, size );
+        }
+        n = fread( pData + len, 1, size - len, fp );
+        len += n;
+    } while ( n > 0 );
+
+    if ( bZip ) {
+        if ( pclose( fp ) != 0 ) {
+            free( pData );
+            return NULL;
+        }
+    }
+    else {
+        fclose( fp );
+    }
+
+    *pLen = len;
+    return pData;
+}
+
+// Add a file to the image. Returns FALSE on error.
+static BOOL addFile( fsimg_t *pImg, const char *pDir, char *pName, BOOL bZip )
+{
+    fsimg_file_t *pFile;
+    char path[ 512 ];
+    char *pExt;
+    int i;
+
+    if ( pImg->nFiles >= FSIMG_MAX_FILES ) {
+        fprintf( stderr, "fsimg: too many files\n" );
+        return FALSE;
+    }
+
+    if ( strlen( pName ) > FSIMG_NAME_LEN ) {
+        fprintf( stderr, "fsimg: %s is not a 8 + 3 file name\n", pName );
+        return FALSE;
+    }
+
+    pFile = &pImg->files[ pImg->nFiles ];
+    snprintf( path, sizeof( path ), "%s/%s", pDir, pName );
+    pFile->pData = readFile( path, bZip, &pFile->len );
+    if ( NULL == pFile->pData ) {
+        fprintf( stderr, "fsimg: can not read %s\n", path );
+        return FALSE;
+    }
+
+    strcpy( pFile->name, pName );
+
+    // Compressed files get the compressed file extension
+    if ( bZip ) {
+        pExt = strrchr( pFile->name, '.' );
+        for ( i = 0; ( pExt != NULL ) && ( zipExt[ i ][ 0 ] != NULL ); i++ ) {
+            if ( strcasecmp( pExt + 1, zipExt[ i ][ 0 ] ) == 0 ) {
+                strcpy( pExt + 1, zipExt[ i ][ 1 ] );
+                break;
+            }
+        }
+
+        if ( ( NULL == pExt ) || ( NULL == zipExt[ i ][ 0 ] ) ) {
+            fprintf( stderr, "fsimg: %s can not be compressed\n", pName );
+            free( pFile->pData );
+            return FALSE;
+        }
+    }
+
+    for ( i = 0; pFile->name[ i ] != '\0'; i++ ) {
+        pFile->name[ i ] = toupper( ( unsigned char )pFile->name[ i ] );
+    }
+
+    pImg->nFiles++;
+    return TRUE;
+}
+
+BOOL fsimg_readList( fsimg_t *pImg, const char *pListPath )
+{
+    FILE *fp;
+    char line[ 512 ];
+    char dir[ 512 ];
+    char *pKey;
+    char *pVal;
+    char *pOpt;
+    char *p;
+    BOOL bZip;
+    BOOL rslt = TRUE;
+
+    memset( pImg, 0, sizeof( fsimg_t ) );
+    pImg->reservedBlock = 64;
+    pImg->fsysId = 1;
+
+    // Files are in the same directory as the list
+    strncpy( dir, pListPath, sizeof( dir ) - 1 );
+    dir[ sizeof( dir ) - 1 ] = '\0';
+    p = strrchr( dir, '/' );
+    if ( NULL != p ) {
+        *p = '\0';
+    }
+    else {
+        strcpy( dir, "." );
+    }
+
+    fp = fopen( pListPath, "r" );
+    if ( NULL == fp ) {
+        fprintf( stderr, "fsimg: can not open %s\n", pListPath );
+        return FALSE;
+    }
+
+    while ( rslt && ( NULL != fgets( line, sizeof( line ), fp ) ) ) {
+        pKey = trim( line );
+        if ( ( *pKey == '\0' ) || ( *pKey == ';' ) ) {
+            continue;
+        }
+
+        pVal = strchr( pKey, '=' );
+        if ( NULL == pVal ) {
+            fprintf( stderr, "fsimg: invalid line: %s\n", pKey );
+            rslt = FALSE;
+            break;
+        }
+        *pVal++ = '\0';
+        pKey = trim( pKey );
+        pVal = trim( pVal );
+
+        if ( strcmp( pKey, "reserved_block" ) == 0 ) {
+            pImg->reservedBlock = strtoul( pVal, NULL, 0 );
+        }
+        else if ( strcmp( pKey, "fsys_id" ) == 0 ) {
+            pImg->fsysId = atoi( pVal );
+        }
+        else if ( strcmp( pKey, "file" ) == 0 ) {
+            // file = name [/c]
+            bZip = FALSE;
+            pOpt = strchr( pVal, ' ' );
+            if ( NULL != pOpt ) {
+                *pOpt++ = '\0';
+                bZip = ( strcasecmp( trim( pOpt ), "/c" ) == 0 );
+            }
+            rslt = addFile( pImg, dir, pVal, bZip );
+        }
+        // outfile is given on the command line of the host tools
+    }
+
+    fclose( fp );
+
+    if ( rslt && ( pImg->fsysId != 1 ) && ( pImg->fsysId != 2 ) ) {
+        fprintf( stderr, "fsimg: unknown fsys_id %d\n", pImg->fsysId );
+        rslt = FALSE;
+    }
+
+    if ( !rslt ) {
+        fsimg_free( pImg );
+    }
+
+    return rslt;
+}
+
+static int cmpFile( const void *a, const void *b )
+{
+    return strcasecmp( ( ( const fsimg_file_t * )a )->name,
+                       ( ( const fsimg_file_t * )b )->name );
+}
+
+// Write a FAT entry, returns its length
+static unsigned long putEntry( BYTE *p, int fsysId, BYTE attr, const char *pName,
+                               unsigned long address, unsigned long len )
+{
+    BYTE *pStart = p;
+    size_t n;
+
+    // Name is zero padded, a name that fills the field has no terminator
+    n = strlen( pName );
+    if ( n > FSIMG_NAME_LEN ) n = FSIMG_NAME_LEN;
+
+    *p++ = attr;
+    memcpy( p, pName, n );
+    memset( p + n, 0, FSIMG_NAME_LEN - n );
+    p += FSIMG_NAME_LEN;
+
+    *p++ = address & 0xff;
+    *p++ = ( address >> 8 ) & 0xff;
+    *p++ = ( address >> 16 ) & 0xff;
+
+    *p++ = len & 0xff;
+    *p++ = ( len >> 8 ) & 0xff;
+    if ( fsysId == 2 ) {
+        *p++ = ( len >> 16 ) & 0xff;
+    }
+
+    return ( unsigned long )( p - pStart );
+}
+
+BYTE *fsimg_build( const fsimg_t *pImg, BOOL bIndex, unsigned long *pLen )
+{
+    fsimg_file_t *pFiles;
+    BYTE *pOut;
+    BYTE *p;
+    int *pSlot = NULL;          // File in each index slot, or -1
+    unsigned long *pAdr;        // Address of each file
+    unsigned long entryLen;
+    unsigned long buckets = 0;
+    unsigned long slots = 0;
+    unsigned long indexAdr = 0;
+    unsigned long address;
+    unsigned long len;
+    unsigned long s;
+    int i;
+
+    entryLen = 1 + FSIMG_NAME_LEN + 3 + ( ( pImg->fsysId == 2 ) ? 3 : 2 );
+
+    pFiles = malloc( sizeof( fsimg_file_t ) * ( pImg->nFiles + 1 ) );
+    memcpy( pFiles, pImg->files, sizeof( fsimg_file_t ) * pImg->nFiles );
+    qsort( pFiles, pImg->nFiles, sizeof( fsimg_file_t ), cmpFile );
+
+    // Index has at least twice as many hash buckets as files. A file goes in
+    // the first free slot from its bucket on, slots do not wrap around, and
+    // the last slot is always empty.
+    if ( bIndex ) {
+        for ( buckets = 2; buckets < ( unsigned long )pImg->nFiles * 2; buckets <<= 1 );
+
+        pSlot = malloc( sizeof( int ) * ( buckets + pImg->nFiles + 1 ) );
+        for ( s = 0; s < buckets + pImg->nFiles + 1; s++ ) {
+            pSlot[ s ] = -1;
+        }
+
+        slots = buckets;
+        for ( i = 0; i < pImg->nFiles; i++ ) {
+            for ( s = fsimg_hash( pFiles[ i ].name ) & ( buckets - 1 ); pSlot[ s ] >= 0; s++ );
+            pSlot[ s ] = i;
+            if ( s + 2 > slots ) {
+                slots = s + 2;
+            }
+        }
+    }
+
+    // Header, FAT including end entry, index, data
+    len = FSIMG_HEADER_LEN + ( pImg->nFiles + 1 ) * entryLen + slots * ( 2 + entryLen );
+    indexAdr = pImg->reservedBlock + FSIMG_HEADER_LEN + ( pImg->nFiles + 1 ) * entryLen;
+    for ( i = 0; i < pImg->nFiles; i++ ) {
+        len += pFiles[ i ].len;
+    }
+
+    if ( ( pImg->reservedBlock + len ) > 0x1000000ul ) {
+        fprintf( stderr, "fsimg: image is too large\n" );
+        free( pFiles );
+        free( pSlot );
+        return NULL;
+    }
+
+    pOut = calloc( 1, len );
+    p = pOut;
+
+    *p++ = 0x04;
+    *p++ = 0x02;
+    *p++ = ( BYTE )pImg->fsysId;
+    *p++ = ( pImg->nFiles + 1 ) & 0xff;
+    *p++ = ( ( pImg->nFiles + 1 ) >> 8 ) & 0xff;
+
+    pAdr = malloc( sizeof( unsigned long ) * ( pImg->nFiles + 1 ) );
+    address = indexAdr + slots * ( 2 + entryLen );
+    for ( i = 0; i < pImg->nFiles; i++ ) {
+        pAdr[ i ] = address;
+        p += putEntry( p, pImg->fsysId, 0, pFiles[ i ].name, address, pFiles[ i ].len );
+        address += pFiles[ i ].len;
+    }
+
+    if ( bIndex ) {
+        p += putEntry( p, pImg->fsysId, FATFLAG_END | FATFLAG_INDEX, "ENDOFFAT.END", indexAdr, buckets );
+
+        for ( s = 0; s < slots; s++ ) {
+            if ( pSlot[ s ] < 0 ) {
+                memset( p, 0, 2 + entryLen );
+                p += 2 + entryLen;
+                continue;
+            }
+
+            i = pSlot[ s ];
+            *p++ = fsimg_hash( pFiles[ i ].name ) & 0xff;
+            *p++ = fsimg_hash( pFiles[ i ].name ) >> 8;
+            p += putEntry( p, pImg->fsysId, 0, pFiles[ i ].name, pAdr[ i ], pFiles[ i ].len );
+        }
+    }
+    else {
+        p += putEntry( p, pImg->fsysId, FATFLAG_END, "ENDOFFAT.END", 0, 0 );
+    }
+
+    for ( i = 0; i < pImg->nFiles; i++ ) {
+        memcpy( p, pFiles[ i ].pData, pFiles[ i ].len );
+        p += pFiles[ i ].len;
+    }
+
+    free( pFiles );
+    free( pSlot );
+    free( pAdr );
+
+    *pLen = len;
+    return pOut;
+}
+
+void fsimg_free( fsimg_t *pImg )
+{
+    int i;
+
+    for ( i = 0; i < pImg->nFiles; i++ ) {
+        free( pImg->files[ i ].pData );
+    }
+    pImg->nFiles = 0;
+}
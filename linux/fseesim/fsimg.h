@@ -0,0 +1,78 @@
+// FILE: fsimg.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Builds a Modtronix EEPROM File System (FSEE) image from a webpages
+// directory, like the Modtronix Web Page Uploading program does from a
+// filelist.mxweb file. Optionally adds the File Index that net/fsee.c uses
+// to find a file with a single sequencial read, see the "File Index"
+// section in net/fsee.h.
+
+#ifndef FSIMG_H
+#define FSIMG_H
+
+#define FSIMG_MAX_FILES     ( 256 )
+#define FSIMG_NAME_LEN      ( 12 )      // 8 + '.' + 3
+
+typedef struct
+{
+    char name[ FSIMG_NAME_LEN + 1 ];    // Upper case, as stored in the FAT
+    BYTE *pData;
+    unsigned long len;
+} fsimg_file_t;
+
+typedef struct
+{
+    unsigned long reservedBlock;        // reserved_block = x
+    int fsysId;                         // fsys_id = x, 1 = FSEE, 2 = FSEE16M
+    int nFiles;
+    fsimg_file_t files[ FSIMG_MAX_FILES ];
+} fsimg_t;
+
+// Hash of an upper case file name, as used by the File Index. Never 0.
+WORD fsimg_hash( const char *pName );
+
+// Read the filelist.mxweb file at the given path, and the files it lists
+// from the same directory. Files marked with /c are compressed with gzip,
+// and get the compressed file extension (htm = zht, js = zjs ...). Errors
+// are written to stderr.
+BOOL fsimg_readList( fsimg_t *pImg, const char *pListPath );
+
+// Build the image, sorted like the Web Page Uploading program does. The
+// image does not include the reserved block, it has to be written to the
+// EEPROM at address reservedBlock. Returns a malloc()ed buffer, or NULL.
+BYTE *fsimg_build( const fsimg_t *pImg, BOOL bIndex, unsigned long *pLen );
+
+void fsimg_free( fsimg_t *pImg );
+
+#endif
@@ -0,0 +1,137 @@
+// FILE: memxee.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#include <string.h>
+#include <ctype.h>
+
+#include "projdefs.h"
+#include "memxee.h"
+#include "net\xeeprom.h"
+
+static BYTE mem[ MEMXEE_SIZE ];
+static XEE_ADDR curAddr;
+
+unsigned long memxee_cntRead;
+unsigned long memxee_cntReadBytes;
+
+void memxee_erase( void )
+{
+    memset( mem, 0xff, sizeof( mem ) );
+}
+
+BOOL memxee_load( unsigned long address, const BYTE *pData, unsigned long len )
+{
+    if ( ( address + len ) > MEMXEE_SIZE ) {
+        return FALSE;
+    }
+
+    memcpy( mem + address, pData, len );
+    return TRUE;
+}
+
+void memxee_resetCounters( void )
+{
+    memxee_cntRead = 0;
+    memxee_cntReadBytes = 0;
+}
+
+void XEEInit( unsigned char baud )
+{
+    ( void )baud;
+}
+
+BYTE XEESetAddr( unsigned char control, XEE_ADDR address )
+{
+    ( void )control;
+    curAddr = address;
+    return XEE_SUCCESS;
+}
+
+BYTE XEEWrite( unsigned char val )
+{
+    mem[ curAddr++ ] = val;
+    return XEE_SUCCESS;
+}
+
+BYTE XEEEndWrite( void )
+{
+    return XEE_SUCCESS;
+}
+
+BYTE XEEBeginRead( unsigned char control, XEE_ADDR address )
+{
+    ( void )control;
+    memxee_cntRead++;
+    curAddr = address;
+    return XEE_SUCCESS;
+}
+
+unsigned char XEERead( void )
+{
+    memxee_cntReadBytes++;
+    return mem[ curAddr++ ];
+}
+
+BYTE XEEEndRead( void )
+{
+    return XEE_SUCCESS;
+}
+
+BYTE XEEReadArray( unsigned char control,
+                   XEE_ADDR address,
+                   unsigned char *buffer,
+                   unsigned char length )
+{
+    XEEBeginRead( control, address );
+    while ( length-- ) {
+        *buffer++ = XEERead();
+    }
+    return XEEEndRead();
+}
+
+BYTE XEEIsBusy( unsigned char control )
+{
+    ( void )control;
+    return XEE_READY;
+}
+
+char *strupr( char *s )
+{
+    char *p;
+
+    for ( p = s; *p != '\0'; p++ ) {
+        *p = toupper( ( unsigned char )*p );
+    }
+    return s;
+}
@@ -0,0 +1,60 @@
+// FILE: memxee.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// In-memory serial EEPROM for the host build of net/fsee.c. Implements the
+// net/xeeprom.h functions on a 64 Kbyte array, and counts the sequencial
+// reads started with XEEBeginRead() (one I2C transaction each: start,
+// control, address, restart) and the bytes read with XEERead().
+
+#ifndef MEMXEE_H
+#define MEMXEE_H
+
+#define MEMXEE_SIZE     ( 65536ul )
+
+// Number of XEEBeginRead() calls
+extern unsigned long memxee_cntRead;
+
+// Number of XEERead() calls
+extern unsigned long memxee_cntReadBytes;
+
+// Fill the EEPROM with 0xff, like an erased EEPROM
+void memxee_erase( void );
+
+// Copy a File System Image to the EEPROM at the given address, returns
+// FALSE if it does not fit
+BOOL memxee_load( unsigned long address, const BYTE *pData, unsigned long len );
+
+void memxee_resetCounters( void );
+
+#endif
@@ -0,0 +1,89 @@
+// FILE: mkfsee.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Builds a Modtronix EEPROM File System image from a webpages directory:
+//
+//   mkfsee [-n] webpages/default/filelist.mxweb default.img
+//
+// The image includes a File Index, unless -n is given. Without a File Index
+// the image is the same as the one the Web Page Uploading program writes.
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "projdefs.h"
+#include "fsimg.h"
+
+static fsimg_t img;
+
+int main( int argc, char *argv[] )
+{
+    BOOL bIndex = TRUE;
+    BYTE *pData;
+    unsigned long len;
+    FILE *fp;
+    int arg = 1;
+
+    if ( ( argc > 1 ) && ( strcmp( argv[ 1 ], "-n" ) == 0 ) ) {
+        bIndex = FALSE;
+        arg++;
+    }
+
+    if ( argc - arg != 2 ) {
+        fprintf( stderr, "usage: mkfsee [-n] filelist.mxweb out.img\n" );
+        return 1;
+    }
+
+    if ( !fsimg_readList( &img, argv[ arg ] ) ) {
+        return 1;
+    }
+
+    pData = fsimg_build( &img, bIndex, &len );
+    fsimg_free( &img );
+    if ( NULL == pData ) {
+        return 1;
+    }
+
+    fp = fopen( argv[ arg + 1 ], "wb" );
+    if ( ( NULL == fp ) || ( fwrite( pData, 1, len, fp ) != len ) ) {
+        fprintf( stderr, "mkfsee: can not write %s\n", argv[ arg + 1 ] );
+        return 1;
+    }
+    fclose( fp );
+    free( pData );
+
+    printf( "%s: %lu bytes%s\n", argv[ arg + 1 ], len, bIndex ? ", with File Index" : "" );
+    return 0;
+}
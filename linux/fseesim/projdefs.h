@@ -0,0 +1,85 @@
+// FILE: projdefs.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Host replacement for pic/modtronix/websrvr68_v310/src/projdefs.h and
+// net/compiler.h. Lets net/fsee.c be built with gcc against the in-memory
+// EEPROM in memxee.c. SWORD_VAL is 3 bytes like the 24 bit type of MCC18,
+// and fsee.c is built with -fpack-struct so that sizeof() of the FAT
+// structures matches the image format.
+
+#ifndef PROJDEFS_H
+#define PROJDEFS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum _BOOL { FALSE = 0, TRUE } BOOL;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t SWORD;
+
+typedef union _WORD_VAL
+{
+    WORD Val;
+    BYTE v[2];
+} WORD_VAL;
+
+typedef union _SWORD_VAL
+{
+    struct __attribute__(( packed ))
+    {
+        SWORD Val : 24;
+    };
+    BYTE v[3];
+} SWORD_VAL;
+
+#define IS_BIT_CLEAR( theByte, mask )   ( ( ( theByte ) & ( mask ) ) == 0 )
+
+#define FAST_USER_PROCESS()
+
+#define CLOCK_FREQ                  (40000000ul)
+#define EEPROM_CONTROL              (0xa0)
+
+#define FSEE_RESERVE_BLOCK          (64ul)
+#define FSEE_MAX_FILES              (2ul)
+
+// fsee.c calls fileRelease(). fsee.h maps it when FSEE_IS_PRIMARY_FS is
+// defined, but that also maps FILE, which clashes with stdio.h
+#define fileRelease                 fseeRelease
+#define DEBUG_FSEE                  LOG_OFF
+
+// Part of the MCC18 library
+char *strupr( char *s );
+
+#endif
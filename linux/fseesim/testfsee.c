@@ -0,0 +1,285 @@
+// FILE: testfsee.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Host tests for the Modtronix EEPROM File System (net/fsee.c) in
+// pic/modtronix/websrvr68_v310. Images are built from the webpages
+// directories with fsimg.c and loaded into the in-memory EEPROM in
+// memxee.c. Every file is opened by name, read back and compared, with and
+// without the File Index. The benchmark counts the I2C transactions
+// (XEEBeginRead() calls) and bytes needed to open each file.
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdio.h>
+
+#include "projdefs.h"
+#include "memxee.h"
+#include "fsimg.h"
+#include "net\fsee.h"
+
+#define WEBPAGES    "../../pic/modtronix/websrvr68_v310/src/webpages"
+
+static fsimg_t img;
+
+// Load the image for the given webpages directory into the EEPROM, and
+// initialize the File System. Returns FALSE on error.
+static BOOL loadImage( const char *pDir, BOOL bIndex )
+{
+    char path[ 256 ];
+    BYTE *pData;
+    unsigned long len;
+    BOOL rslt;
+
+    fsimg_free( &img );
+    snprintf( path, sizeof( path ), WEBPAGES "/%s/filelist.mxweb", pDir );
+    if ( !fsimg_readList( &img, path ) ) {
+        return FALSE;
+    }
+
+    pData = fsimg_build( &img, bIndex, &len );
+    if ( NULL == pData ) {
+        return FALSE;
+    }
+
+    memxee_erase();
+    rslt = memxee_load( img.reservedBlock, pData, len );
+    free( pData );
+
+    fseeInit();
+    return rslt;
+}
+
+// Open file by name, read it and compare it with the image content.
+// Returns FALSE on error.
+static BOOL checkFile( const fsimg_file_t *pFile, BOOL bByFAT )
+{
+    BYTE name[ 16 ];
+    FSEE_FILE f;
+    FSEE_POS pos;
+    unsigned long i;
+    BOOL rslt = TRUE;
+
+    strcpy( ( char * )name, pFile->name );
+
+    if ( bByFAT ) {
+        pos = fseeGetFAT( name );
+        f = fseeOpenFAT( pos );
+    }
+    else {
+        f = fseeOpen( name, 0 );
+    }
+
+    if ( f >= FSEE_MAX_FILES ) {
+        return FALSE;
+    }
+
+    if ( fseeGetLength( f ) != pFile->len ) {
+        rslt = FALSE;
+    }
+
+    for ( i = 0; rslt && ( i < pFile->len ); i++ ) {
+        if ( fseeGetByte( f ) != pFile->pData[ i ] ) {
+            rslt = FALSE;
+        }
+    }
+
+    if ( rslt && ( pFile->len != 0 ) && !fseeIsEOF( f ) ) {
+        rslt = FALSE;
+    }
+
+    fseeClose( f );
+    return rslt;
+}
+
+// Compare an image built without File Index with the .img file of the
+// Web Page Uploading program
+static BOOL sameAsUploader( const char *pDir )
+{
+    char path[ 256 ];
+    BYTE *pData;
+    BYTE *pRef;
+    unsigned long len;
+    unsigned long refLen;
+    FILE *fp;
+    BOOL rslt;
+
+    fsimg_free( &img );
+    snprintf( path, sizeof( path ), WEBPAGES "/%s/filelist.mxweb", pDir );
+    if ( !fsimg_readList( &img, path ) ) {
+        return FALSE;
+    }
+    pData = fsimg_build( &img, FALSE, &len );
+
+    snprintf( path, sizeof( path ), WEBPAGES "/%s.img", pDir );
+    fp = fopen( path, "rb" );
+    if ( NULL == fp ) {
+        free( pData );
+        return FALSE;
+    }
+    pRef = malloc( len + 1 );
+    refLen = fread( pRef, 1, len + 1, fp );
+    fclose( fp );
+
+    rslt = ( NULL != pData ) && ( refLen == len ) && ( memcmp( pData, pRef, len ) == 0 );
+    free( pData );
+    free( pRef );
+    return rslt;
+}
+
+static void benchmark( const char *pDir )
+{
+    BYTE name[ 16 ];
+    FSEE_FILE f;
+    unsigned long cnt[ 2 ], bytes[ 2 ], maxCnt[ 2 ], maxBytes[ 2 ];
+    int i, idx;
+
+    for ( idx = 0; idx < 2; idx++ ) {
+        cnt[ idx ] = bytes[ idx ] = maxCnt[ idx ] = maxBytes[ idx ] = 0;
+        loadImage( pDir, idx ? TRUE : FALSE );
+
+        for ( i = 0; i < img.nFiles; i++ ) {
+            strcpy( ( char * )name, img.files[ i ].name );
+            memxee_resetCounters();
+            f = fseeOpen( name, 0 );
+            if ( f >= FSEE_MAX_FILES ) {
+                printf("Benchmark, %s open fail.\n", img.files[ i ].name);
+                continue;
+            }
+            fseeClose( f );
+
+            cnt[ idx ] += memxee_cntRead;
+            bytes[ idx ] += memxee_cntReadBytes;
+            if ( memxee_cntRead > maxCnt[ idx ] ) maxCnt[ idx ] = memxee_cntRead;
+            if ( memxee_cntReadBytes > maxBytes[ idx ] ) maxBytes[ idx ] = memxee_cntReadBytes;
+        }
+    }
+
+    printf("  %-10s %3d files  FAT: %5.1f / %3lu  %6.1f / %4lu   Index: %4.1f / %lu  %5.1f / %lu\n",
+           pDir, img.nFiles,
+           ( double )cnt[ 0 ] / img.nFiles, maxCnt[ 0 ], ( double )bytes[ 0 ] / img.nFiles, maxBytes[ 0 ],
+           ( double )cnt[ 1 ] / img.nFiles, maxCnt[ 1 ], ( double )bytes[ 1 ] / img.nFiles, maxBytes[ 1 ] );
+}
+
+int main( int argc, char *argv[] )
+{
+    static const char *dirs[] = { "default", "pinstate", "html_io", "js_io", "js_adc", "webterm", "compress", NULL };
+    static const char *missing[] = { "NOFILE.HTM", "INDEX.HT", "INDEX.HTMX", "ENDOFFAT.END", "A", NULL };
+    BYTE name[ 16 ];
+    int d, i, idx;
+
+    ///////////////////////////////////////////////////////////////////////
+    printf("FSEE image test 1\n");
+    {
+        // Images without compressed files are the same as the uploader's
+        if ( !sameAsUploader( "pinstate" ) ) printf("FSEE image test 1, pinstate.img fail.\n");
+        if ( !sameAsUploader( "html_io" ) ) printf("FSEE image test 1, html_io.img fail.\n");
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    printf("FSEE open test 1\n");
+    {
+        // Open every file by name and by FAT position, with and without File Index
+        for ( d = 0; NULL != dirs[ d ]; d++ ) {
+            for ( idx = 0; idx < 2; idx++ ) {
+                if ( !loadImage( dirs[ d ], idx ? TRUE : FALSE ) ) {
+                    printf("FSEE open test 1, %s load fail.\n", dirs[ d ]);
+                    continue;
+                }
+
+                for ( i = 0; i < img.nFiles; i++ ) {
+                    if ( !checkFile( &img.files[ i ], FALSE ) )
+                        printf("FSEE open test 1, %s %s index=%d fail.\n", dirs[ d ], img.files[ i ].name, idx);
+                    if ( !checkFile( &img.files[ i ], TRUE ) )
+                        printf("FSEE open test 1, %s %s by FAT index=%d fail.\n", dirs[ d ], img.files[ i ].name, idx);
+                }
+
+                // Names are not case sensitive
+                strcpy( ( char * )name, "index.htm" );
+                if ( ( 0 == strcmp( dirs[ d ], "pinstate" ) ) && ( fseeOpen( name, 0 ) >= FSEE_MAX_FILES ) )
+                    printf("FSEE open test 1, lower case name index=%d fail.\n", idx);
+                fseeClose( 0 );
+
+                for ( i = 0; NULL != missing[ i ]; i++ ) {
+                    strcpy( ( char * )name, missing[ i ] );
+                    if ( FSEE_FILE_INVALID != fseeOpen( name, 0 ) )
+                        printf("FSEE open test 1, %s %s found index=%d fail.\n", dirs[ d ], missing[ i ], idx);
+                    if ( FSEE_POS_NOT_FOUND != fseeGetFAT( name ) )
+                        printf("FSEE open test 1, %s %s FAT found index=%d fail.\n", dirs[ d ], missing[ i ], idx);
+                }
+
+                name[ 0 ] = '\0';
+                if ( FSEE_FILE_INVALID != fseeOpen( name, 0 ) ) printf("FSEE open test 1, empty name fail.\n");
+            }
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    printf("FSEE open test 2\n");
+    {
+        // Write an image with File Index over one without, like the web
+        // page upload does. The File Index is used after fseeCloseImage().
+        BYTE *pData;
+        unsigned long len, l;
+
+        loadImage( "pinstate", FALSE );
+        fsimg_free( &img );
+        if ( !fsimg_readList( &img, WEBPAGES "/default/filelist.mxweb" ) ) printf("FSEE open test 2, read list fail.\n");
+        pData = fsimg_build( &img, TRUE, &len );
+
+        if ( !fseeOpenImage() ) printf("FSEE open test 2, open image fail.\n");
+        for ( l = 0; l < len; l++ ) fseePutByteImage( pData[ l ] );
+        fseeCloseImage();
+        free( pData );
+
+        memxee_resetCounters();
+        for ( i = 0; i < img.nFiles; i++ ) {
+            if ( !checkFile( &img.files[ i ], FALSE ) )
+                printf("FSEE open test 2, %s fail.\n", img.files[ i ].name);
+        }
+        if ( memxee_cntRead != ( unsigned long )img.nFiles * 2 )
+            printf("FSEE open test 2, File Index not used fail.\n");
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    printf("FSEE benchmark\n");
+    {
+        printf("  fseeOpen() I2C transactions and bytes read, average / max\n");
+        for ( d = 0; NULL != dirs[ d ]; d++ ) {
+            benchmark( dirs[ d ] );
+        }
+    }
+
+    fsimg_free( &img );
+    return 0;
+}
@@ -37,10 +37,210 @@
 #include <stdlib.h>
 #include <stdint.h>
 #include <stdio.h>
+#include <time.h>
+#include <pthread.h>
+#include <sched.h>
 
 #include "../../common/vscp_link.h"
+#include "../../common/vscp_filter.h"
+#include "../../common/fifo.h"
+#include "../../common/vscp_evring.h"
+#include "../../common/crc.h"
 
-void main()
+#define BENCH_ROUNDS    200000
+
+#define CRC_BENCH_BYTES     ( 4UL * 1024 * 1024 )
+
+#define FIFO_STRESS_BYTES   ( 16UL * 1024 * 1024 )
+
+// FIFO shared by the stress test threads
+static fifo_t stressFifo;
+static uint8_t stressBuf[ 1024 ];
+static unsigned long stressErrors;
+
+// Producer. Write a byte sequence in varying chunk sizes.
+static void *fifoProducer( void *arg )
+{
+    uint8_t chunk[ 300 ];
+    unsigned long cnt = 0;
+    uint16_t len, n, i;
+    uint8_t val = 0;
+    uint8_t *p;
+
+    while ( cnt < FIFO_STRESS_BYTES ) {
+        len = 1 + ( cnt % sizeof( chunk ) );
+        if ( len > FIFO_STRESS_BYTES - cnt ) len = FIFO_STRESS_BYTES - cnt;
+        if ( cnt & 0x100 ) {
+            // Zero copy
+            n = fifo_peekWrite( &stressFifo, &p );
+            if ( n > len ) n = len;
+            for ( i=0; i<n; i++ ) p[i] = val++;
+            fifo_commitWrite( &stressFifo, n );
+        }
+        else {
+            for ( i=0; i<len; i++ ) chunk[i] = val + i;
+            n = fifo_write( &stressFifo, chunk, len );
+            val += n;
+        }
+        if ( !n ) sched_yield();    // Full
+        cnt += n;
+    }
+
+    return NULL;
+}
+
+// Consumer. Check that the sequence arrives intact.
+static void *fifoConsumer( void *arg )
+{
+    uint8_t chunk[ 200 ];
+    unsigned long cnt = 0;
+    uint16_t n, i;
+    uint8_t val = 0;
+    uint8_t *p;
+
+    while ( cnt < FIFO_STRESS_BYTES ) {
+        if ( cnt & 0x80 ) {
+            n = fifo_peekRead( &stressFifo, &p );
+            for ( i=0; i<n; i++ ) {
+                if ( p[i] != val++ ) stressErrors++;
+            }
+            fifo_commitRead( &stressFifo, n );
+        }
+        else {
+            n = fifo_read( &stressFifo, chunk, sizeof( chunk ) );
+            for ( i=0; i<n; i++ ) {
+                if ( chunk[i] != val++ ) stressErrors++;
+            }
+        }
+        if ( !n ) sched_yield();    // Empty
+        cnt += n;
+    }
+
+    return NULL;
+}
+
+// Last reply sent to the client by the link code
+static char lastReply[ 512 ];
+
+int vscp_link_callback_writeClient( const char *msg )
+{
+    strncpy( lastReply, msg, sizeof( lastReply ) - 1 );
+    return VSCP_ERROR_SUCCESS;
+}
+
+// Batched output from the link code
+static char lastBatch[ VSCP_LINK_OUTBUF_SIZE + 1 ];
+static int cntBatchWrites;
+
+int vscp_link_callback_writeClientBuf( const char *buf, size_t len )
+{
+    memcpy( lastBatch, buf, len );
+    lastBatch[ len ] = 0;
+    cntBatchWrites++;
+    return VSCP_ERROR_SUCCESS;
+}
+
+// Output buffer of the (only) session
+static char sessionOutBuf[ VSCP_LINK_OUTBUF_SIZE ];
+
+char *vscp_link_callback_getOutBuf( void )
+{
+    return sessionOutBuf;
+}
+
+// Events sent by client
+static int cntReceived;
+static uint16_t lastReceivedType;
+
+int vscp_link_callback_eventReceived( const vscpEvent *ev )
+{
+    cntReceived++;
+    lastReceivedType = ev->vscp_type;
+    return VSCP_ERROR_SUCCESS;
+}
+
+// Events waiting to be read by client
+static int cntQueued;
+
+int vscp_link_callback_eventGet( vscpEvent *ev )
+{
+    if ( !cntQueued ) return VSCP_ERROR_RCV_EMPTY;
+    cntQueued--;
+    memset( ev->GUID, 0, 16 );
+    ev->head = 0;
+    ev->obid = 0;
+    ev->year = ev->month = ev->day = 0;
+    ev->hour = ev->minute = ev->second = 0;
+    ev->timestamp = 0;
+    ev->vscp_class = 10;
+    ev->vscp_type = 6;
+    ev->sizeData = 2;
+    ev->pdata[0] = 1;
+    ev->pdata[1] = 2;
+    return VSCP_ERROR_SUCCESS;
+}
+
+// Command dispatch as vscp_link_parser did it before the command table.
+// Each name is searched for anywhere in the line with strstr, in the order
+// of the old if/else chain, and the first hit wins.
+static const struct {
+    const char *name;
+    int (*handler)( const char *cmd );
+} refCommands[] = {
+    { "noop", vscp_link_doCmdNoop },
+    { "help", vscp_link_doCmdHelp },
+    { "quit", vscp_link_doCmdQuit },
+    { "user", vscp_link_doCmdUser },
+    { "pass", vscp_link_doCmdPassword },
+    { "challenge", vscp_link_doCmdChallenge },
+    { "send", vscp_link_doCmdSend },
+    { "retr", vscp_link_doCmdRetrive },
+    { "rcvloop", vscp_link_doCmdRcvLoop },
+    { "quitloop", vscp_link_doCmdQuitLoop },
+    { "cdta", vscp_link_doCmdCmdCheckData },
+    { "chkdata", vscp_link_doCmdCheckData },
+    { "clra", vscp_link_doCmdClearAll },
+    { "clrall", vscp_link_doCmdClearAll },
+    { "stat", vscp_link_doCmdStatistics },
+    { "info", vscp_link_doCmdInfo },
+    { "chid", vscp_link_doCmdGetChannelId },
+    { "getchid", vscp_link_doCmdGetChannelId },
+    { "sgid", vscp_link_doCmdSetChannelId },
+    { "setguid", vscp_link_doCmdSetChannelId },
+    { "ggid", vscp_link_doCmdGetGUID },
+    { "getguid", vscp_link_doCmdGetGUID },
+    { "vers", vscp_link_doCmdGetVersion },
+    { "version", vscp_link_doCmdGetVersion },
+    { "sflt", vscp_link_doCmdSetFilter },
+    { "setfilter", vscp_link_doCmdSetFilter },
+    { "smsk", vscp_link_doCmdSetMask },
+    { "setmask", vscp_link_doCmdSetMask },
+    { "wcyd", vscp_link_doCmdWhatCanYouDo },
+    { "whatcanyoudo", vscp_link_doCmdWhatCanYouDo },
+    { "+", vscp_link_doCmdCommandAgain },
+    { "dm", vscp_link_doCmdDM },
+};
+
+static int refParser( const char *cmd )
+{
+    const char *p;
+    size_t i;
+
+    while ( *cmd && ( ' ' == *cmd ) ) {
+        cmd++;
+    }
+
+    for ( i = 0; i < sizeof( refCommands ) / sizeof( refCommands[0] ); i++ ) {
+        if ( NULL != ( p = strstr( cmd, refCommands[i].name ) ) ) {
+            return refCommands[i].handler( p + strlen( refCommands[i].name ) );
+        }
+    }
+
+    vscp_link_reply( VSCP_LINK_MSG_UNKNOWN_COMMAND );
+    return VSCP_ERROR_SUCCESS;
+}
+
+int main()
 {
     uint8_t guid[16];
     char buf[512];
@@ -107,7 +307,6 @@ void main()
 
     printf("GUID test 6\n");
     const char *strGUID5 = "00:11:22:33:44:YW:66:77:88:99:AA:BB:CC:01:02:03"; 
-    const uint8_t GUID5_array[] = {0x00,0x11,0x22,0x33,0x44,0x55,0x66,0x77,0x88,0x99,0xAA,0xBB,0xCC,0x01,0x02,0x03};
     memset( guid, 0xff, 16 );   
     rv = parseGuid( strGUID5, NULL, guid );
     if ( VSCP_ERROR_SUCCESS == rv ) printf("GUID='00:11:22:33:44:YW:66:77:88:99:AA:BB:CC:01:02:03' parser return success but should have returned failure.\n");
@@ -161,6 +360,216 @@ void main()
 
     // ------------------------------------------------------------------------
 
+    printf("Filter test 3 (compiled)\n");
+    {
+        vscpCompiledFilter cf[3];
+        vscpEvent evs[2];
+        const vscpEvent *pevs[2] = { &evs[0], &evs[1] };
+        uint8_t match[ 2 * VSCP_FILTER_ROW_SIZE(3) ];
+
+        // Class 10 from node ..:FF only
+        memset( &evfilter, 0, sizeof(vscpEventFilter) );
+        evfilter.filter_class = 10;
+        evfilter.mask_class = 0xffff;
+        evfilter.filter_GUID[15] = 0xff;
+        evfilter.mask_GUID[15] = 0xff;
+        vscp_filter_compile( &evfilter, &cf[0] );
+
+        // Priority 3 type 6
+        memset( &evfilter, 0, sizeof(vscpEventFilter) );
+        evfilter.filter_priority = 3;
+        evfilter.mask_priority = 7;
+        evfilter.filter_type = 6;
+        evfilter.mask_type = 0xffff;
+        vscp_filter_compile( &evfilter, &cf[1] );
+
+        // Everything
+        vscp_filter_clear( &cf[2] );
+
+        memset( evs, 0, sizeof( evs ) );
+        evs[0].head = VSCP_PRIORITY_3;
+        evs[0].vscp_class = 10;
+        evs[0].vscp_type = 6;
+        memcpy( evs[0].GUID, GUID2_array, 16 );
+        evs[1].head = VSCP_PRIORITY_7;
+        evs[1].vscp_class = 20;
+        evs[1].vscp_type = 6;
+
+        if ( !vscp_filter_match( &cf[0], &evs[0] ) ) printf("Filter test 3, class/GUID filter failed.\n");
+        if ( vscp_filter_match( &cf[0], &evs[1] ) ) printf("Filter test 3, class/GUID filter passed wrong event.\n");
+        if ( !vscp_filter_match( &cf[1], &evs[0] ) ) printf("Filter test 3, priority filter failed.\n");
+        if ( vscp_filter_match( &cf[1], &evs[1] ) ) printf("Filter test 3, priority filter passed wrong event.\n");
+
+        if ( 4 != vscp_filter_matchBatch( cf, 3, pevs, 2, match ) ) printf("Filter test 3, batch count failed.\n");
+        if ( !VSCP_FILTER_IS_MATCH( match, 0 ) ||
+             !VSCP_FILTER_IS_MATCH( match, 1 ) ||
+             !VSCP_FILTER_IS_MATCH( match, 2 ) ||
+             VSCP_FILTER_IS_MATCH( match + VSCP_FILTER_ROW_SIZE(3), 0 ) ||
+             VSCP_FILTER_IS_MATCH( match + VSCP_FILTER_ROW_SIZE(3), 1 ) ||
+             !VSCP_FILTER_IS_MATCH( match + VSCP_FILTER_ROW_SIZE(3), 2 ) ) {
+            printf("Filter test 3, batch bitmap failed.\n");
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("FIFO test 1\n");
+    {
+        fifo_t fifo;
+        uint8_t fifobuf[ 16 ];
+        uint8_t *p;
+
+        if ( fifo_init( &fifo, fifobuf, 12 ) ) printf("FIFO test 1, size not power of two accepted.\n");
+        if ( !fifo_init( &fifo, fifobuf, sizeof( fifobuf ) ) ) printf("FIFO test 1, init failed.\n");
+        if ( 16 != fifo_getFree( &fifo ) ) printf("FIFO test 1, free failed.\n");
+        if ( 10 != fifo_write( &fifo, "0123456789", 10 ) ) printf("FIFO test 1, write failed.\n");
+        if ( 8 != fifo_read( &fifo, buf, 8 ) ) printf("FIFO test 1, read failed.\n");
+        // Wraps
+        if ( 14 != fifo_write( &fifo, "abcdefghijklmnopq", 17 ) ) printf("FIFO test 1, write full failed.\n");
+        if ( 0 != fifo_getFree( &fifo ) ) printf("FIFO test 1, free when full failed.\n");
+        // Peek gives the contiguous part up to the end of the buffer
+        if ( 8 != fifo_peekRead( &fifo, &p ) ) printf("FIFO test 1, peek failed.\n");
+        if ( memcmp( p, "89abcdef", 8 ) ) printf("FIFO test 1, peek data failed.\n");
+        fifo_commitRead( &fifo, 2 );
+        if ( 14 != fifo_read( &fifo, buf, sizeof( buf ) ) ) printf("FIFO test 1, read wrapped failed.\n");
+        if ( memcmp( buf, "abcdefghijklmn", 14 ) ) printf("FIFO test 1, wrapped data failed.\n");
+        if ( fifo_getUsed( &fifo ) ) printf("FIFO test 1, not empty.\n");
+    }
+
+    printf("FIFO stress test (one producer, one consumer)\n");
+    {
+        pthread_t producer, consumer;
+        struct timespec t0, t1;
+        double secs;
+
+        fifo_init( &stressFifo, stressBuf, sizeof( stressBuf ) );
+        clock_gettime( CLOCK_MONOTONIC, &t0 );
+        pthread_create( &consumer, NULL, fifoConsumer, NULL );
+        pthread_create( &producer, NULL, fifoProducer, NULL );
+        pthread_join( producer, NULL );
+        pthread_join( consumer, NULL );
+        clock_gettime( CLOCK_MONOTONIC, &t1 );
+        secs = ( t1.tv_sec - t0.tv_sec ) + ( t1.tv_nsec - t0.tv_nsec ) / 1e9;
+        if ( stressErrors ) printf("FIFO stress test failed, %lu errors.\n", stressErrors );
+        if ( secs > 0 ) printf("FIFO: %.1f MB/sec\n", FIFO_STRESS_BYTES / secs / 1e6 );
+    }
+
+    // ------------------------------------------------------------------------
+
+    // ------------------------------------------------------------------------
+
+    printf("Event ring test 1\n");
+    {
+        static vscpEventEx slots[ 3 ];
+        vscp_evring_t ring;
+        vscpEventEx *pex;
+
+        // Drop newest
+        vscp_evring_init( &ring, slots, 3, VSCP_EVRING_DROP_NEWEST );
+        if ( NULL != vscp_evring_getDequeuePtr( &ring ) ) printf("Event ring test 1, empty ring not empty.\n");
+        for ( i=0; i<4; i++ ) {
+            pex = vscp_evring_getEnqueuePtr( &ring );
+            if ( NULL == pex ) break;
+            pex->vscp_type = i;
+            vscp_evring_enqueue( &ring );
+        }
+        if ( 3 != i ) printf("Event ring test 1, full ring accepted event.\n");
+        if ( 1 != ring.cntOverruns ) printf("Event ring test 1, overrun count failed.\n");
+        if ( 3 != ring.highWater ) printf("Event ring test 1, high water mark failed.\n");
+        pex = vscp_evring_getDequeuePtr( &ring );
+        if ( ( NULL == pex ) || ( 0 != pex->vscp_type ) ) printf("Event ring test 1, drop newest order failed.\n");
+        vscp_evring_dequeue( &ring );
+
+        // Drop oldest
+        vscp_evring_init( &ring, slots, 3, VSCP_EVRING_DROP_OLDEST );
+        for ( i=0; i<5; i++ ) {
+            pex = vscp_evring_getEnqueuePtr( &ring );
+            pex->vscp_type = i;
+            vscp_evring_enqueue( &ring );
+        }
+        if ( 2 != ring.cntOverruns ) printf("Event ring test 1, drop oldest overrun count failed.\n");
+
+        // The oldest event is dropped on commit, the consumer must not get 
+        // the slot the producer is filling
+        pex = vscp_evring_getEnqueuePtr( &ring );
+        if ( ( 3 != vscp_evring_count( &ring ) ) || ( 2 != ring.cntOverruns ) ) {
+            printf("Event ring test 1, drop oldest on get failed.\n");
+        }
+        if ( NULL != vscp_evring_getDequeuePtr( &ring ) ) {
+            printf("Event ring test 1, enqueue slot visible to consumer failed.\n");
+        }
+        pex->vscp_type = 5;
+        vscp_evring_enqueue( &ring );
+        if ( 3 != ring.cntOverruns ) printf("Event ring test 1, drop oldest on commit failed.\n");
+        for ( i=3; i<6; i++ ) {
+            pex = vscp_evring_getDequeuePtr( &ring );
+            if ( ( NULL == pex ) || ( i != pex->vscp_type ) ) printf("Event ring test 1, drop oldest order failed.\n");
+            vscp_evring_dequeue( &ring );
+        }
+        if ( !vscp_evring_empty( &ring ) ) printf("Event ring test 1, ring not empty.\n");
+
+        // A full ring where the consumer holds the oldest event drops the
+        // new event
+        for ( i=6; i<9; i++ ) {
+            pex = vscp_evring_getEnqueuePtr( &ring );
+            pex->vscp_type = i;
+            vscp_evring_enqueue( &ring );
+        }
+        pex = vscp_evring_getDequeuePtr( &ring );
+        if ( NULL != vscp_evring_getEnqueuePtr( &ring ) ) {
+            printf("Event ring test 1, consumer slot handed to producer failed.\n");
+        }
+        if ( ( NULL == pex ) || ( 6 != pex->vscp_type ) || ( 4 != ring.cntOverruns ) ) {
+            printf("Event ring test 1, busy consumer failed.\n");
+        }
+        vscp_evring_dequeue( &ring );
+        if ( NULL == vscp_evring_getEnqueuePtr( &ring ) ) {
+            printf("Event ring test 1, enqueue after dequeue failed.\n");
+        }
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("CRC test 1\n");
+    {
+        const unsigned char check[] = "123456789";
+        crc state;
+
+        crcInit();
+        if ( CHECK_VALUE != crcSlow( check, 9 ) ) printf("CRC test 1, crcSlow failed.\n");
+        if ( CHECK_VALUE != crcFast( check, 9 ) ) printf("CRC test 1, crcFast failed.\n");
+        state = crcStart();
+        state = crcUpdate( state, check, 2 );
+        state = crcUpdate( state, check + 2, 0 );
+        state = crcUpdate( state, check + 2, 7 );
+        if ( CHECK_VALUE != crcFinish( state ) ) printf("CRC test 1, crcUpdate failed.\n");
+    }
+
+    printf("CRC benchmark\n");
+    {
+        unsigned char *pbuf = malloc( CRC_BENCH_BYTES );
+        crc crcslow, crcfast;
+        clock_t start;
+        double secs;
+
+        for ( i=0; i<CRC_BENCH_BYTES; i++ ) pbuf[ i ] = (unsigned char)( i * 7 + ( i >> 8 ) );
+
+        start = clock();
+        crcslow = crcSlow( pbuf, CRC_BENCH_BYTES );
+        secs = (double)( clock() - start ) / CLOCKS_PER_SEC;
+        if ( secs > 0 ) printf("crcSlow: %.1f MB/s\n", CRC_BENCH_BYTES / secs / 1e6 );
+
+        start = clock();
+        crcfast = crcFast( pbuf, CRC_BENCH_BYTES );
+        secs = (double)( clock() - start ) / CLOCKS_PER_SEC;
+        if ( secs > 0 ) printf("crcFast: %.1f MB/s\n", CRC_BENCH_BYTES / secs / 1e6 );
+
+        if ( crcslow != crcfast ) printf("CRC benchmark, crcSlow/crcFast mismatch.\n");
+        free( pbuf );
+    }
+
+    // ------------------------------------------------------------------------
+
     printf("Event test 1 (standard)\n");
     vscpEvent ev;
     memset( &ev, 0, sizeof(vscpEvent) );
@@ -269,6 +678,32 @@ void main()
     // ------------------------------------------------------------------------
 
 
+    printf("Event test 3 (caller buffer)\n");
+    {
+        uint8_t data[8];
+        memset( &ev, 0, sizeof(vscpEvent) );
+        if ( VSCP_ERROR_SUCCESS  != parseEventToBuffer( "1,0x21,3,,,,-,11,0x22,33", &ev, data, sizeof( data ) ) ) {
+            printf("Failed on event test 3\n"); 
+        }
+        if ( ev.pdata != data ) printf("Event test 3, pdata not caller buffer.\n");
+        if ( ev.sizeData != 3 ) printf("Event test 3, sizeData failed (%d).\n", (int)ev.sizeData );
+        if ( data[0] != 11 ) printf("Event test 3, Data byte 0 failed.\n");
+        if ( data[1] != 0x22 ) printf("Event test 3, Data byte 1 failed.\n");
+        if ( data[2] != 33 ) printf("Event test 3, Data byte 2 failed.\n");
+        if ( VSCP_ERROR_BUFFER_TO_SMALL != parseEventToBuffer( "1,0x21,3,,,,-,1,2,3,4,5,6,7,8,9", &ev, data, sizeof( data ) ) ) {
+            printf("Event test 3, data overflow not detected.\n"); 
+        }
+        memset( &ev, 0, sizeof(vscpEvent) );
+        if ( VSCP_ERROR_SUCCESS  != parseEventToBuffer( "1,0x21,3,,,,-,", &ev, data, sizeof( data ) ) ) {
+            printf("Failed on event test 3 (no data)\n"); 
+        }
+        if ( ev.sizeData != 0 ) printf("Event test 3, sizeData failed for no data (%d).\n", (int)ev.sizeData );
+    }
+
+
+    // ------------------------------------------------------------------------
+
+
     printf("Event to string test\n");
 
     if ( VSCP_ERROR_SUCCESS  != parseEvent( "1,0x21,3,1234567,2062-11-17T19:32:44,7654321,00:11:22:33:44:55:66:77:88:99:AA:BB:CC:DD:EE:FF,011,0x22,33,0x44,55", &ev ) ) {
@@ -283,6 +718,180 @@ void main()
         printf("OUT:%s\n", buf );
     }
 
+    if ( VSCP_ERROR_SUCCESS  != eventToString( &ev, buf, sizeof( buf ) ) ) {
+        printf("Failed to convert event to string\n");
+    }
+    else if ( strcmp( buf, "1,33,3,1234567,2062-11-17T19:32:44Z,7654321,00:11:22:33:44:55:66:77:88:99:AA:BB:CC:DD:EE:FF,9,34,33,68,55" ) ) {
+        printf("Event to string test, unexpected result %s\n", buf );
+    }
+
+    memset( &ev, 0, sizeof(vscpEvent) );
+    ev.vscp_class = 10;
+    ev.vscp_type = 6;
+    if ( VSCP_ERROR_SUCCESS  != eventToString( &ev, buf, sizeof( buf ) ) ) {
+        printf("Failed to convert event without date to string\n");
+    }
+    else if ( strcmp( buf, "0,10,6,0,,0,00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00" ) ) {
+        printf("Event to string test, unexpected result %s\n", buf );
+    }
+
+    // Every field at its maximum, date fields out of range, in a buffer of
+    // exactly VSCP_LINK_EVENT_STR_SIZE
+    {
+        uint8_t data[8];
+        char *pstr;
+        size_t size = VSCP_LINK_EVENT_STR_SIZE( sizeof( data ) );
+
+        memset( &ev, 0, sizeof(vscpEvent) );
+        memset( data, 255, sizeof( data ) );
+        memset( ev.GUID, 255, sizeof( ev.GUID ) );
+        ev.head = 0xffff;
+        ev.vscp_class = 0xffff;
+        ev.vscp_type = 0xffff;
+        ev.obid = 0xffffffff;
+        ev.timestamp = 0xffffffff;
+        ev.year = 0xffff;
+        ev.month = ev.day = ev.hour = ev.minute = ev.second = 255;
+        ev.sizeData = sizeof( data );
+        ev.pdata = data;
+
+        pstr = malloc( size + 16 );
+        memset( pstr, 0x5a, size + 16 );
+        if ( VSCP_ERROR_SUCCESS  != eventToString( &ev, pstr, size ) ) {
+            printf("Failed to convert worst case event to string\n");
+        }
+        else if ( ( size - 1 ) != strlen( pstr ) ) {
+            printf("Event to string test, worst case length %d fail.\n", (int)strlen( pstr ) );
+        }
+        for ( i = (int)size; i < ( (int)size + 16 ); i++ ) {
+            if ( 0x5a != (uint8_t)pstr[ i ] ) {
+                printf("Event to string test, worst case buffer overflow fail.\n");
+                break;
+            }
+        }
+        free( pstr );
+        ev.pdata = NULL;
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("Event to string benchmark\n");
+    {
+        const uint16_t sizes[] = { 0, 8, 512 };
+        uint8_t data[512];
+        char strbuf[ VSCP_LINK_EVENT_STR_SIZE( 512 ) ];
+        clock_t start;
+        double secs;
+
+        for ( i=0; i<sizeof( data ); i++ ) {
+            data[i] = (uint8_t)i;
+        }
+
+        memset( &ev, 0, sizeof(vscpEvent) );
+        ev.head = 0x60;
+        ev.vscp_class = 10;
+        ev.vscp_type = 6;
+        ev.obid = 1234567;
+        ev.year = 2019;
+        ev.month = 11;
+        ev.day = 17;
+        ev.timestamp = 7654321;
+        memcpy( ev.GUID, GUID2_array, 16 );
+        ev.pdata = data;
+
+        for ( k=0; k<sizeof(sizes)/sizeof(sizes[0]); k++ ) {
+            ev.sizeData = sizes[k];
+            start = clock();
+            for ( i=0; i<BENCH_ROUNDS; i++ ) {
+                eventToString( &ev, strbuf, sizeof( strbuf ) );
+            }
+            secs = (double)( clock() - start ) / CLOCKS_PER_SEC;
+            if ( secs > 0 ) {
+                printf("eventToString: %3d data bytes %.0f events/sec\n", 
+                        (int)sizes[k], BENCH_ROUNDS / secs );
+            }
+        }
+        ev.pdata = NULL;
+    }
+
+    // ------------------------------------------------------------------------
+
+    printf("Parser test 1 (dispatch)\n");
+    lastReply[0] = 0;
+    vscp_link_parser( "  NOOP\r\n" );
+    if ( strcmp( lastReply, "+OK\r\n" ) ) printf("Parser test 1, noop not dispatched.\n");
+    lastReply[0] = 0;
+    vscp_link_parser( "noopx" );
+    if ( lastReply[0] ) printf("Parser test 1, noopx dispatched as noop.\n");
+    lastReply[0] = 0;
+    vscp_link_parser( "send noop" );
+    if ( !strcmp( lastReply, "+OK\r\n" ) ) printf("Parser test 1, argument dispatched as command.\n");
+    lastReply[0] = 0;
+    vscp_link_parser( "\tnoop\t\r\n" );
+    if ( strcmp( lastReply, "+OK\r\n" ) ) printf("Parser test 1, tab not a separator.\n");
+
+    // ------------------------------------------------------------------------
+
+    printf("Parser test 2 (batched retr/send)\n");
+    cntQueued = 2;
+    cntBatchWrites = 0;
+    vscp_link_parser( "retr 5\r\n" );
+    if ( 1 != cntBatchWrites ) printf("Parser test 2, retr not written in one batch (%d).\n", cntBatchWrites );
+    if ( strcmp( lastBatch, "0,10,6,0,,0,00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00,1,2\r\n"
+                            "0,10,6,0,,0,00:00:00:00:00:00:00:00:00:00:00:00:00:00:00:00,1,2\r\n"
+                            VSCP_LINK_MSG_OK ) ) {
+        printf("Parser test 2, unexpected retr output %s\n", lastBatch );
+    }
+    vscp_link_parser( "retr" );
+    if ( strcmp( lastBatch, VSCP_LINK_MSG_NO_MSG ) ) printf("Parser test 2, retr on empty queue failed.\n");
+
+    cntReceived = 0;
+    lastReply[0] = 0;
+    vscp_link_parser( "send 0,20,3,,,,-,1,2,3;0,20,4,,,,-,;0,20,5,,,,-,7\r\n" );
+    if ( 3 != cntReceived ) printf("Parser test 2, send received %d events.\n", cntReceived );
+    if ( 5 != lastReceivedType ) printf("Parser test 2, send last type failed.\n");
+    if ( strcmp( lastReply, VSCP_LINK_MSG_OK ) ) printf("Parser test 2, send reply failed.\n");
+    vscp_link_parser( "send 0,20,3" );
+    if ( strcmp( lastReply, VSCP_LINK_MSG_PARAMETER_ERROR ) ) printf("Parser test 2, send error reply failed.\n");
+
+    // ------------------------------------------------------------------------
+
+    printf("Parser benchmark\n");
+    {
+        const char *cmds[] = { "noop", 
+                               "send 0,20,3,,,,-,1,2,3", 
+                               "retr 1", 
+                               "setfilter 0,0,0,-", 
+                               "whatcanyoudo", 
+                               "quitloop", 
+                               "bogus" };
+        const double cnt = (double)BENCH_ROUNDS * sizeof(cmds)/sizeof(cmds[0]);
+        clock_t start;
+        double secsRef, secs;
+
+        start = clock();
+        for ( i=0; i<BENCH_ROUNDS; i++ ) {
+            for ( j=0; j<sizeof(cmds)/sizeof(cmds[0]); j++ ) {
+                refParser( cmds[j] );
+            }
+        }
+        secsRef = (double)( clock() - start ) / CLOCKS_PER_SEC;
+
+        start = clock();
+        for ( i=0; i<BENCH_ROUNDS; i++ ) {
+            for ( j=0; j<sizeof(cmds)/sizeof(cmds[0]); j++ ) {
+                vscp_link_parser( cmds[j] );
+            }
+        }
+        secs = (double)( clock() - start ) / CLOCKS_PER_SEC;
+
+        if ( ( secsRef > 0 ) && ( secs > 0 ) ) {
+            printf("Parser: strstr chain %.0f commands/sec, command table %.0f commands/sec\n", 
+                    cnt / secsRef, cnt / secs );
+        }
+    }
+
+    return 0;
 }
 
 
@@ -0,0 +1,249 @@
+// FILE: memmac.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+#include <string.h>
+
+#include "projdefs.h"
+#include "memmac.h"
+#include "net\ipchksum.h"
+
+typedef struct
+{
+    BYTE data[ MAC_TX_BUFFER_SIZE ];
+    WORD len;           // Highest offset written
+    IP_CHECKSUM sum;    // Running checksum, saved while another buffer is active
+    BOOL bFree;
+} memmac_txbuf_t;
+
+static memmac_txbuf_t txbuf[ MAC_TX_BUFFER_COUNT ];
+static BUFFER curTxBuffer;
+static WORD curTxOffset;
+static IP_CHECKSUM txSum;
+
+static BYTE rxbuf[ MAC_RX_BUFFER_SIZE ];
+static WORD rxLen;
+static WORD rxOffset;
+static BOOL bRxFull;
+
+unsigned long memmac_cntFlush;
+
+void memmac_init( void )
+{
+    BUFFER i;
+
+    for ( i = 0; i < MAC_TX_BUFFER_COUNT; i++ ) {
+        txbuf[ i ].bFree = TRUE;
+        txbuf[ i ].len = 0;
+    }
+
+    curTxBuffer = 0;
+    curTxOffset = 0;
+    memmac_cntFlush = 0;
+
+    rxLen = 0;
+    rxOffset = 0;
+    bRxFull = FALSE;
+}
+
+int memmac_usedTxBuffers( void )
+{
+    BUFFER i;
+    int cnt = 0;
+
+    for ( i = 1; i < MAC_TX_BUFFER_COUNT; i++ ) {
+        if ( !txbuf[ i ].bFree ) cnt++;
+    }
+
+    return cnt;
+}
+
+const BYTE *memmac_getTxBuffer( BUFFER buffer )
+{
+    return txbuf[ buffer ].data;
+}
+
+BOOL MACIsTxReady( BOOL HighPriority )
+{
+    BUFFER i;
+
+    // The link takes frames at any time, it models the wire itself
+    if ( HighPriority ) return TRUE;
+
+    for ( i = 1; i < MAC_TX_BUFFER_COUNT; i++ ) {
+        if ( txbuf[ i ].bFree ) return TRUE;
+    }
+
+    return FALSE;
+}
+
+BUFFER MACGetTxBuffer( BOOL HighPriority )
+{
+    BUFFER i;
+
+    if ( HighPriority ) return 0;
+
+    for ( i = 1; i < MAC_TX_BUFFER_COUNT; i++ ) {
+        if ( txbuf[ i ].bFree ) {
+            txbuf[ i ].bFree = FALSE;
+            txbuf[ i ].len = 0;
+            return i;
+        }
+    }
+
+    return INVALID_BUFFER;
+}
+
+void MACReserveTxBuffer( BUFFER buffer )
+{
+    txbuf[ buffer ].bFree = FALSE;
+}
+
+void MACDiscardTx( BUFFER buffer )
+{
+    if ( buffer < MAC_TX_BUFFER_COUNT ) {
+        txbuf[ buffer ].bFree = TRUE;
+        curTxBuffer = buffer;
+    }
+}
+
+void MACSetTxBuffer( BUFFER buffer, WORD offset )
+{
+    txbuf[ curTxBuffer ].sum = txSum;
+    curTxBuffer = buffer;
+    txSum = txbuf[ curTxBuffer ].sum;
+    curTxOffset = offset;
+}
+
+void MACPut( BYTE val )
+{
+    IPChecksumAddByte( txSum, val, curTxOffset & 0x01 );
+    txbuf[ curTxBuffer ].data[ curTxOffset++ ] = val;
+    if ( curTxOffset > txbuf[ curTxBuffer ].len ) txbuf[ curTxBuffer ].len = curTxOffset;
+}
+
+void MACPutArray( BYTE *val, WORD len )
+{
+    IPChecksumAddArray( &txSum, val, len, curTxOffset & 0x01 );
+    memcpy( &txbuf[ curTxBuffer ].data[ curTxOffset ], val, len );
+    curTxOffset += len;
+    if ( curTxOffset > txbuf[ curTxBuffer ].len ) txbuf[ curTxBuffer ].len = curTxOffset;
+}
+
+void MACClearTxSum( void )
+{
+    txSum = 0;
+}
+
+WORD MACGetTxSum( void )
+{
+    return IPChecksumFold( txSum );
+}
+
+void MACFlush( void )
+{
+    memmac_cntFlush++;
+    memmac_transmit( curTxBuffer, txbuf[ curTxBuffer ].data, txbuf[ curTxBuffer ].len );
+
+    // As on the RTL8019AS, a transmitted buffer is free unless reserved again
+    txbuf[ curTxBuffer ].bFree = TRUE;
+}
+
+void MACPutHeader( MAC_ADDR *remote, BYTE type, WORD dataLen )
+{
+    // No Ethernet header, the IP header is written at the start of the buffer
+    curTxOffset = 0;
+}
+
+BOOL memmac_receive( const BYTE *pFrame, WORD len, WORD ipHeaderLen )
+{
+    if ( bRxFull || ( len > sizeof( rxbuf ) ) ) return FALSE;
+
+    memcpy( rxbuf, pFrame, len );
+    rxLen = len;
+    rxOffset = ipHeaderLen;
+    bRxFull = TRUE;
+
+    return TRUE;
+}
+
+BYTE MACGet( void )
+{
+    return ( rxOffset < rxLen ) ? rxbuf[ rxOffset++ ] : 0;
+}
+
+WORD MACGetArray( BYTE *val, WORD len )
+{
+    WORD i;
+
+    for ( i = 0; i < len; i++ ) {
+        if ( NULL == val ) {
+            MACGet();
+        }
+        else {
+            val[ i ] = MACGet();
+        }
+    }
+
+    return len;
+}
+
+WORD MACGetArrayChr( BYTE *val, BYTE len, BYTE chr )
+{
+    BYTE i;
+    BYTE c;
+
+    for ( i = 0; i < len; i++ ) {
+        c = MACGet();
+        if ( NULL != val ) val[ i ] = c;
+        if ( c == chr ) return ( (WORD)MAC_GETARR_TRM << 8 ) | ( i + 1 );
+    }
+
+    return ( (WORD)MAC_GETARR_ALL << 8 ) | len;
+}
+
+void MACDiscardRx( void )
+{
+    bRxFull = FALSE;
+    rxLen = 0;
+}
+
+void MACSetRxBuffer( WORD offset )
+{
+    rxOffset = offset;
+}
+
+WORD MACGetFreeRxSize( void )
+{
+    return 4 * MAC_RX_BUFFER_SIZE;
+}
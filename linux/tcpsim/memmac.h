@@ -0,0 +1,98 @@
+// FILE: memmac.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// In-memory MAC for the host build of the Modtronix TCP/IP stack. Has the
+// same TX buffer semantics as net/mac.c (RTL8019AS): buffer 0 is the high
+// priority buffer, MACFlush() transmits the current buffer and marks it
+// free, MACReserveTxBuffer() keeps it. Transmitted frames are handed to
+// memmac_transmit(), which the test program implements as its link.
+// MACPut() and MACPutArray() keep a running checksum like net/mac.c, the
+// parity of the buffer offset selects the byte lane. Frames start with the
+// IP header, there is no Ethernet header. The RX side holds the one frame
+// loaded with memmac_receive() until MACDiscardRx().
+
+#ifndef MEMMAC_H
+#define MEMMAC_H
+
+#define INVALID_BUFFER  (0xfful)
+
+#define MAC_IP          (0ul)
+
+#define MAC_GETARR_ALL          (0x00ul)
+#define MAC_GETARR_TRM          (0x20ul)
+#define MAC_GETARR_RETMASK      (0xF0ul)
+
+typedef struct _MAC_ADDR
+{
+    BYTE v[6];
+} MAC_ADDR;
+
+// Number of frames transmitted with MACFlush()
+extern unsigned long memmac_cntFlush;
+
+void memmac_init( void );
+
+// Number of TX buffers (excluding buffer 0) that are not free
+int memmac_usedTxBuffers( void );
+
+// Content of a TX buffer, as last written with MACPut()/MACPutArray()
+const BYTE *memmac_getTxBuffer( BUFFER buffer );
+
+// Implemented by the test program, called by MACFlush()
+void memmac_transmit( BUFFER buffer, const BYTE *pFrame, WORD len );
+
+// Load a received frame. The RX access pointer is set to the IP data, like
+// after IPGetHeader(). Returns FALSE if the last frame was not discarded yet.
+BOOL memmac_receive( const BYTE *pFrame, WORD len, WORD ipHeaderLen );
+
+BOOL MACIsTxReady( BOOL HighPriority );
+BUFFER MACGetTxBuffer( BOOL HighPriority );
+void MACReserveTxBuffer( BUFFER buffer );
+void MACDiscardTx( BUFFER buffer );
+void MACSetTxBuffer( BUFFER buffer, WORD offset );
+void MACPut( BYTE val );
+void MACPutArray( BYTE *val, WORD len );
+void MACClearTxSum( void );
+WORD MACGetTxSum( void );
+void MACFlush( void );
+void MACPutHeader( MAC_ADDR *remote, BYTE type, WORD dataLen );
+
+BYTE MACGet( void );
+WORD MACGetArray( BYTE *val, WORD len );
+WORD MACGetArrayChr( BYTE *val, BYTE len, BYTE chr );
+void MACDiscardRx( void );
+void MACSetRxBuffer( WORD offset );
+WORD MACGetFreeRxSize( void );
+
+#endif
@@ -0,0 +1,104 @@
+// FILE: projdefs.h
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Host replacement for pic/modtronix/websrvr68_v310/src/projdefs.h and
+// net/compiler.h. Lets the portable parts of the Modtronix TCP/IP stack
+// be built with gcc against the in-memory MAC in memmac.c.
+
+#ifndef PROJDEFS_H
+#define PROJDEFS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef enum _BOOL { FALSE = 0, TRUE } BOOL;
+typedef uint8_t BYTE;
+typedef uint16_t WORD;
+typedef uint32_t DWORD;
+typedef BYTE BUFFER;
+
+typedef union _WORD_VAL
+{
+    WORD Val;
+    BYTE v[2];
+} WORD_VAL;
+
+typedef union _DWORD_VAL
+{
+    DWORD Val;
+    struct
+    {
+        WORD LSW;
+        WORD MSW;
+    } word;
+    BYTE v[4];
+} DWORD_VAL;
+
+#define FAST_USER_PROCESS()
+
+#define STACK_USE_TCP
+
+#define MAX_SOCKETS                 (4)
+
+// Buffer 0 is kept for high priority (control) frames. TCPSIM_NON_MCHP_MAC
+// selects the TX buffer layout the SBC68EC build uses with NON_MCHP_MAC
+// (src/projdefs.h), otherwise the larger layout of the benchmarks is used
+#if defined(TCPSIM_NON_MCHP_MAC)
+#define MAC_TX_BUFFER_SIZE          (1024ul)
+#define MAC_TX_BUFFER_COUNT         (3ul)
+#else
+#define MAC_TX_BUFFER_SIZE          (576ul)
+#define MAC_TX_BUFFER_COUNT         (9)
+#endif
+
+// Benchmarks limit the window at run time, up to this many segments
+#define TCP_WIN_SEGMENTS            (8)
+
+// Used by net/tcp.c (testsock). HITECH_C18 makes it define its sockets
+// (TCB) itself, the remote node is the only one on the link
+#define HITECH_C18
+#define ROM                         const
+#define CLOCK_FREQ                  (40000000L)
+
+#define DEBUG_OFF
+#define DEBUG_TCP                   LOG_OFF
+
+#define MY_IP_BYTE1                 (192ul)
+#define MY_IP_BYTE2                 (168ul)
+#define MY_IP_BYTE3                 (1ul)
+#define MY_IP_BYTE4                 (10ul)
+
+#define MAC_RX_BUFFER_SIZE          (MAC_TX_BUFFER_SIZE)
+
+#endif
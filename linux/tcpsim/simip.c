@@ -0,0 +1,108 @@
+// FILE: simip.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Host replacement for the parts of net/ip.c and net/helpers.c that
+// net/tcp.c uses. IP headers are written without options, and received
+// frames are expected to have none either.
+
+#include <string.h>
+
+#include "projdefs.h"
+#include "net\ip.h"
+#include "net\helpers.h"
+
+WORD IPPutHeader( NODE_INFO *remote, BYTE protocol, WORD len )
+{
+    IP_HEADER header;
+
+    memset( &header, 0, sizeof( header ) );
+    header.VersionIHL = 0x45;
+    header.TotalLength.Val = swaps( sizeof( header ) + len );
+    header.TimeToLive = MY_IP_TTL;
+    header.Protocol = protocol;
+    header.SourceAddress.v[ 0 ] = MY_IP_BYTE1;
+    header.SourceAddress.v[ 1 ] = MY_IP_BYTE2;
+    header.SourceAddress.v[ 2 ] = MY_IP_BYTE3;
+    header.SourceAddress.v[ 3 ] = MY_IP_BYTE4;
+    header.DestAddress.Val = remote->IPAddr.Val;
+
+    MACPutHeader( &remote->MACAddr, MAC_IP, sizeof( header ) + len );
+    MACPutArray( (BYTE *)&header, sizeof( header ) );
+
+    return 0;
+}
+
+void IPSetRxBuffer( WORD offset )
+{
+    MACSetRxBuffer( offset + sizeof( IP_HEADER ) );
+}
+
+WORD swaps( WORD v )
+{
+    return (WORD)( ( v << 8 ) | ( v >> 8 ) );
+}
+
+DWORD swapl( DWORD v )
+{
+    return ( v << 24 ) | ( ( v << 8 ) & 0x00ff0000 ) | 
+            ( ( v >> 8 ) & 0x0000ff00 ) | ( v >> 24 );
+}
+
+// One's complement of the sum of the little endian words in buffer
+WORD CalcIPChecksum( BYTE *buffer, WORD count )
+{
+    DWORD sum = 0;
+    WORD i;
+
+    for ( i = 0; ( i + 1 ) < count; i += 2 ) {
+        sum += buffer[ i ] | ( (WORD)buffer[ i + 1 ] << 8 );
+    }
+
+    if ( count & 1 ) sum += buffer[ count - 1 ];
+
+    while ( sum >> 16 ) sum = ( sum & 0xffff ) + ( sum >> 16 );
+
+    return (WORD)~sum;
+}
+
+// Same sum over the next len bytes of the RX buffer, in network order
+WORD CalcIPBufferChecksum( WORD len )
+{
+    BYTE buf[ MAC_RX_BUFFER_SIZE ];
+
+    if ( len > sizeof( buf ) ) len = sizeof( buf );
+    MACGetArray( buf, len );
+
+    return swaps( CalcIPChecksum( buf, len ) );
+}
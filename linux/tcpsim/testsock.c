@@ -0,0 +1,350 @@
+// FILE: testsock.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Host tests for net/tcp.c of the Modtronix TCP/IP stack, built against
+// the in-memory MAC in memmac.c and the IP layer in simip.c. The test is
+// the remote node: frames the stack transmits are taken apart in
+// memmac_transmit(), and the segments it sends are given to TCPProcess()
+// as if IPGetHeader() had just read them. Time only moves when the test
+// advances tickCount.
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "projdefs.h"
+#include "memmac.h"
+#include "net\tick.h"
+#include "net\tcp.h"
+#include "net\helpers.h"
+
+// Tick counters, normally in tick.c
+TICK tickCount;
+TICK16 tickSec;
+unsigned char tickHelper;
+
+#define TCP_FIN             0x01
+#define TCP_SYN             0x02
+#define TCP_RST             0x04
+#define TCP_PSH             0x08
+#define TCP_ACK             0x10
+
+#define IP_HEADER_LEN       20
+#define TCP_HEADER_LEN      20
+
+#define MSS                 ( MAC_TX_BUFFER_SIZE - 54 )     // TCPGetMaxDataLength()
+#define LOCAL_PORT          80
+#define REMOTE_WINDOW       16384
+#define MAX_FRAMES          64
+#define MAX_TICKS           2000        // Give up waiting for the stack after 20 s
+
+// Segment sent by the stack
+typedef struct
+{
+    DWORD seq;
+    DWORD ack;
+    BYTE flags;
+    WORD len;
+    BYTE data[ MAC_TX_BUFFER_SIZE ];
+} seg_t;
+
+static seg_t sent[ MAX_FRAMES ];
+static int cntSent;
+static unsigned long cntBadSum;
+
+static NODE_INFO remote;
+static IP_ADDR localIP;
+static WORD remotePort;
+
+static void put16( BYTE *p, WORD v )
+{
+    p[ 0 ] = (BYTE)( v >> 8 );
+    p[ 1 ] = (BYTE)v;
+}
+
+static void put32( BYTE *p, DWORD v )
+{
+    put16( p, (WORD)( v >> 16 ) );
+    put16( p + 2, (WORD)v );
+}
+
+static WORD get16( const BYTE *p )
+{
+    return (WORD)( ( p[ 0 ] << 8 ) | p[ 1 ] );
+}
+
+static DWORD get32( const BYTE *p )
+{
+    return ( (DWORD)get16( p ) << 16 ) | get16( p + 2 );
+}
+
+// TCP checksum over the pseudo header and the segment, 0 if it is valid
+static WORD tcpChecksum( const IP_ADDR *src, const IP_ADDR *dst, const BYTE *pSeg, WORD len )
+{
+    static BYTE buf[ 12 + MAC_TX_BUFFER_SIZE + MAC_RX_BUFFER_SIZE ];
+
+    memcpy( buf, src->v, 4 );
+    memcpy( buf + 4, dst->v, 4 );
+    buf[ 8 ] = 0;
+    buf[ 9 ] = IP_PROT_TCP;
+    put16( buf + 10, len );
+    memcpy( buf + 12, pSeg, len );
+
+    return CalcIPChecksum( buf, 12 + len );
+}
+
+// Called by MACFlush()
+void memmac_transmit( BUFFER buffer, const BYTE *pFrame, WORD len )
+{
+    const BYTE *pSeg = pFrame + IP_HEADER_LEN;
+    WORD segLen = get16( pFrame + 2 ) - IP_HEADER_LEN;
+    WORD hdrLen = ( pSeg[ 12 ] >> 4 ) * 4;
+    seg_t *p;
+
+    if ( 0 != tcpChecksum( &localIP, &remote.IPAddr, pSeg, segLen ) ) cntBadSum++;
+
+    if ( cntSent >= MAX_FRAMES ) {
+        printf("Frame log overflow fail.\n");
+        return;
+    }
+
+    p = &sent[ cntSent++ ];
+    p->seq = get32( pSeg + 4 );
+    p->ack = get32( pSeg + 8 );
+    p->flags = pSeg[ 13 ];
+    p->len = segLen - hdrLen;
+    memcpy( p->data, pSeg + hdrLen, p->len );
+}
+
+// Send a segment without data from the remote node
+static void remoteSend( DWORD seq, DWORD ack, BYTE flags )
+{
+    BYTE frame[ IP_HEADER_LEN + TCP_HEADER_LEN ];
+    BYTE *pSeg = frame + IP_HEADER_LEN;
+    WORD sum;
+
+    memset( frame, 0, sizeof( frame ) );
+    frame[ 0 ] = 0x45;
+    put16( frame + 2, sizeof( frame ) );
+    frame[ 9 ] = IP_PROT_TCP;
+
+    put16( pSeg, remotePort );
+    put16( pSeg + 2, LOCAL_PORT );
+    put32( pSeg + 4, seq );
+    put32( pSeg + 8, ack );
+    pSeg[ 12 ] = ( TCP_HEADER_LEN / 4 ) << 4;
+    pSeg[ 13 ] = flags;
+    put16( pSeg + 14, REMOTE_WINDOW );
+
+    // Little endian sum, stored as it was calculated
+    sum = tcpChecksum( &remote.IPAddr, &localIP, pSeg, TCP_HEADER_LEN );
+    pSeg[ 16 ] = (BYTE)sum;
+    pSeg[ 17 ] = (BYTE)( sum >> 8 );
+
+    if ( !memmac_receive( frame, sizeof( frame ), IP_HEADER_LEN ) ) {
+        printf("Receive, last frame not discarded fail.\n");
+        return;
+    }
+
+    TCPProcess( &remote, &localIP, TCP_HEADER_LEN );
+}
+
+// Let time pass until the stack sends a segment with the given SEQ number
+// and flags, returns it or NULL
+static seg_t *waitFor( DWORD seq, BYTE flags )
+{
+    int i, t;
+
+    for ( t = 0; t < MAX_TICKS; t++ ) {
+        i = cntSent;
+        tickCount++;
+        TCPTick();
+        for ( ; i < cntSent; i++ ) {
+            if ( ( sent[ i ].seq == seq ) && ( ( sent[ i ].flags & flags ) == flags ) ) {
+                return &sent[ i ];
+            }
+        }
+    }
+
+    return NULL;
+}
+
+// Open a connection from the remote node, returns the SEQ number of the
+// first data byte the stack sends
+static DWORD remoteConnect( TCP_SOCKET s, WORD port, DWORD iss )
+{
+    remotePort = port;
+    cntSent = 0;
+
+    remoteSend( iss, 0, TCP_SYN );
+    if ( ( 1 != cntSent ) || ( ( TCP_SYN | TCP_ACK ) != sent[ 0 ].flags ) || ( ( iss + 1 ) != sent[ 0 ].ack ) ) {
+        printf("Connect, SYN|ACK fail.\n");
+    }
+
+    remoteSend( iss + 1, sent[ 0 ].seq + 1, TCP_ACK );
+    if ( !TCPIsConnected( s ) ) printf("Connect, not established fail.\n");
+
+    return sent[ 0 ].seq + 1;
+}
+
+// Write a response of up to cnt full segments, like the HTTP server does.
+// Returns the number of segments sent
+static int sendResponse( TCP_SOCKET s, int cnt )
+{
+    BYTE buf[ MAC_TX_BUFFER_SIZE ];
+    WORD len = MSS;
+    int i, j;
+
+    cntSent = 0;
+    for ( i = 0; ( i < cnt ) && TCPIsPutReady( s ); i++ ) {
+        for ( j = 0; j < len; j++ ) buf[ j ] = (BYTE)( j * 7 + i );
+
+        // A full TX Buffer is flushed right away
+        if ( len != TCPPutArray( s, buf, len ) ) {
+            printf("Response, short write fail.\n");
+            break;
+        }
+    }
+
+    if ( i != cntSent ) printf("Response, segment not sent fail.\n");
+
+    return cntSent;
+}
+
+int main( int argc, char *argv[] )
+{
+    TCP_SOCKET s;
+
+    remote.IPAddr.v[ 0 ] = 192;
+    remote.IPAddr.v[ 1 ] = 168;
+    remote.IPAddr.v[ 2 ] = 1;
+    remote.IPAddr.v[ 3 ] = 20;
+    localIP.v[ 0 ] = MY_IP_BYTE1;
+    localIP.v[ 1 ] = MY_IP_BYTE2;
+    localIP.v[ 2 ] = MY_IP_BYTE3;
+    localIP.v[ 3 ] = MY_IP_BYTE4;
+
+    memmac_init();
+    TCPInit();
+    s = TCPListen( LOCAL_PORT );
+
+    ///////////////////////////////////////////////////////////////////////
+    // Disconnect with segments in flight, the last one is lost
+    printf("Socket test 1\n");
+    {
+        seg_t last;
+        seg_t *p;
+        DWORD fin;
+        int cnt;
+
+        remoteConnect( s, 1234, 0x10000000 );
+
+        cnt = sendResponse( s, 3 );
+        if ( cnt < 2 ) printf("Socket test 1, multi segment response fail.\n");
+        last = sent[ cnt - 1 ];
+        fin = last.seq + last.len;
+
+        TCPDisconnect( s );
+        if ( ( ( cnt + 1 ) != cntSent ) || !( sent[ cnt ].flags & TCP_FIN ) || ( fin != sent[ cnt ].seq ) ) {
+            printf("Socket test 1, FIN fail.\n");
+        }
+
+        // The remote node ACKs what it got, the last segment is missing
+        remoteSend( 0x10000001, last.seq, TCP_ACK );
+        if ( TCP_FIN_WAIT_1 != TCB[ s ].smState ) printf("Socket test 1, FIN_WAIT_2 before FIN was ACKed fail.\n");
+        if ( 1 != memmac_usedTxBuffers() ) printf("Socket test 1, lost segment released fail.\n");
+
+        p = waitFor( last.seq, 0 );
+        if ( ( NULL == p ) || ( last.len != p->len ) || memcmp( last.data, p->data, last.len ) ) {
+            printf("Socket test 1, lost segment not resent fail.\n");
+        }
+
+        // Data is complete, the FIN was dropped as out of order and has to be sent again
+        remoteSend( 0x10000001, fin, TCP_ACK );
+        if ( TCP_FIN_WAIT_1 != TCB[ s ].smState ) printf("Socket test 1, data ACK taken for FIN fail.\n");
+        if ( 0 != memmac_usedTxBuffers() ) printf("Socket test 1, TX buffers not released fail.\n");
+
+        if ( NULL == waitFor( fin, TCP_FIN ) ) printf("Socket test 1, FIN not resent fail.\n");
+        remoteSend( 0x10000001, fin + 1, TCP_ACK );
+        if ( TCP_FIN_WAIT_2 != TCB[ s ].smState ) printf("Socket test 1, FIN_WAIT_2 fail.\n");
+
+        cntSent = 0;
+        remoteSend( 0x10000001, fin + 1, TCP_FIN | TCP_ACK );
+        if ( ( 1 != cntSent ) || ( TCP_ACK != sent[ 0 ].flags ) || ( 0x10000002 != sent[ 0 ].ack ) ) {
+            printf("Socket test 1, ACK for FIN fail.\n");
+        }
+        if ( TCP_LISTEN != TCB[ s ].smState ) printf("Socket test 1, close fail.\n");
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    // The remote node closes while segments are in flight, the last one is lost
+    printf("Socket test 2\n");
+    {
+        seg_t last;
+        seg_t *p;
+        DWORD fin;
+        int cnt;
+
+        remoteConnect( s, 1235, 0x20000000 );
+
+        cnt = sendResponse( s, 3 );
+        last = sent[ cnt - 1 ];
+        fin = last.seq + last.len;
+
+        cntSent = 0;
+        remoteSend( 0x20000001, last.seq, TCP_FIN | TCP_ACK );
+        if ( ( 1 != cntSent ) || ( ( TCP_FIN | TCP_ACK ) != sent[ 0 ].flags ) || ( fin != sent[ 0 ].seq ) ) {
+            printf("Socket test 2, FIN fail.\n");
+        }
+        if ( TCP_LAST_ACK != TCB[ s ].smState ) printf("Socket test 2, LAST_ACK fail.\n");
+
+        p = waitFor( last.seq, 0 );
+        if ( ( NULL == p ) || ( last.len != p->len ) || memcmp( last.data, p->data, last.len ) ) {
+            printf("Socket test 2, lost segment not resent fail.\n");
+        }
+
+        remoteSend( 0x20000002, fin, TCP_ACK );
+        if ( TCP_LAST_ACK != TCB[ s ].smState ) printf("Socket test 2, data ACK taken for FIN fail.\n");
+        if ( 0 != memmac_usedTxBuffers() ) printf("Socket test 2, TX buffers not released fail.\n");
+
+        if ( NULL == waitFor( fin, TCP_FIN ) ) printf("Socket test 2, FIN not resent fail.\n");
+        remoteSend( 0x20000002, fin + 1, TCP_ACK );
+        if ( TCP_LISTEN != TCB[ s ].smState ) printf("Socket test 2, close fail.\n");
+    }
+
+    if ( cntBadSum ) printf("Socket tests, %lu segments with bad checksum fail.\n", cntBadSum );
+
+    return 0;
+}
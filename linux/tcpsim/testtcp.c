@@ -0,0 +1,616 @@
+// FILE: testtcp.c
+
+/* ******************************************************************************
+ * 	VSCP (Very Simple Control Protocol)
+ * 	https://www.vscp.org
+ *
+ * The MIT License (MIT)
+ *
+ * Copyright (c) 2000-2019 Ake Hedman, Grodans Paradis AB <info@grodansparadis.com>
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ *	This file is part of VSCP - Very Simple Control Protocol
+ *	https://www.vscp.org
+ *
+ * ******************************************************************************
+ */
+
+// Host tests for the Modtronix TCP/IP stack in pic/modtronix/websrvr68_v310.
+// The portable stack modules are built against the in-memory MAC in
+// memmac.c. Transmitted frames go onto a simulated 10 Mbit/s link with a
+// configurable round trip time and loss, to a receiver that acknowledges
+// like a PC TCP stack (delayed ACKs, immediate duplicate ACKs for out of
+// order segments). Time is simulated, tickCount follows it in 10 ms ticks.
+
+#include <string.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "projdefs.h"
+#include "memmac.h"
+#include "net\tick.h"
+#include "net\tcpwin.h"
+#include "net\ipchksum.h"
+
+// Tick counters, normally in tick.c
+TICK tickCount;
+TICK16 tickSec;
+unsigned char tickHelper;
+
+#define US_PER_TICK         ( 1000000 / TICKS_PER_SECOND )
+
+// Link
+#define LINK_US_PER_BYTE    0.8         // 10 Mbit/s
+#define FRAME_OVERHEAD      54          // MAC, IP and TCP headers
+#define MSS                 ( MAC_TX_BUFFER_SIZE - FRAME_OVERHEAD )
+#define SEG_HEADER          6           // seq and len in front of the payload
+
+// Receiver
+#define DELACK_US           40000       // Delayed ACK timeout of the remote host
+
+#define WIRE_SIZE           256
+#define OOO_SIZE            64
+
+typedef struct
+{
+    double at;                  // Arrival time
+    uint32_t seq;               // Data frame
+    uint16_t len;
+    uint32_t ack;               // ACK frame
+} pkt_t;
+
+typedef struct
+{
+    pkt_t pkt[ WIRE_SIZE ];
+    int cnt;
+} wire_t;
+
+static double simNow;           // Simulated time in us
+static double rttUs;            // Round trip time
+static double wireFree;         // Time the link is free for the next frame
+static int lossPercent;
+
+static wire_t toRx;             // Data frames on their way to the receiver
+static wire_t toTx;             // ACKs on their way to the sender
+
+static uint32_t rcvNxt;         // Receiver
+static uint32_t ooo[ OOO_SIZE ];
+static int cntOoo;
+static int rcvUnacked;
+static double delackAt;
+
+static TCP_WIN win;             // Sender
+static uint32_t sndNxt;
+
+static unsigned long cntCorrupt;
+static unsigned long cntLost;
+static unsigned long cntFastRetx;
+static unsigned long cntTimeoutRetx;
+
+static uint32_t rnd = 1;
+
+static uint32_t random32( void )
+{
+    rnd = rnd * 1103515245 + 12345;
+    return ( rnd >> 8 );
+}
+
+static void setTime( double us )
+{
+    simNow = us;
+    tickCount = (TICK)( us / US_PER_TICK );
+}
+
+static void wirePut( wire_t *pw, const pkt_t *pp )
+{
+    if ( pw->cnt >= WIRE_SIZE ) {
+        printf("Link queue overflow fail.\n");
+        return;
+    }
+
+    pw->pkt[ pw->cnt++ ] = *pp;
+}
+
+// Gets the first packet that has arrived, packets arrive in the order sent
+static int wireGet( wire_t *pw, pkt_t *pp )
+{
+    if ( ( 0 == pw->cnt ) || ( pw->pkt[ 0 ].at > simNow ) ) return 0;
+
+    *pp = pw->pkt[ 0 ];
+    memmove( &pw->pkt[ 0 ], &pw->pkt[ 1 ], --pw->cnt * sizeof( pkt_t ) );
+
+    return 1;
+}
+
+// Called by MACFlush()
+void memmac_transmit( BUFFER buffer, const BYTE *pFrame, WORD len )
+{
+    pkt_t pkt;
+    WORD i;
+
+    memcpy( &pkt.seq, pFrame, 4 );
+    memcpy( &pkt.len, pFrame + 4, 2 );
+
+    // Retransmitted frames must still hold the data they were sent with
+    if ( ( len != ( SEG_HEADER + pkt.len ) ) ) cntCorrupt++;
+    for ( i = 0; i < pkt.len; i++ ) {
+        if ( pFrame[ SEG_HEADER + i ] != (BYTE)( pkt.seq + i ) ) {
+            cntCorrupt++;
+            break;
+        }
+    }
+
+    if ( wireFree < simNow ) wireFree = simNow;
+    wireFree += ( pkt.len + FRAME_OVERHEAD ) * LINK_US_PER_BYTE;
+    pkt.at = wireFree + rttUs / 2;
+
+    if ( ( random32() % 100 ) < (uint32_t)lossPercent ) {
+        cntLost++;
+        return;
+    }
+
+    wirePut( &toRx, &pkt );
+}
+
+static void sendAck( void )
+{
+    pkt_t pkt;
+
+    pkt.at = simNow + rttUs / 2;
+    pkt.ack = rcvNxt;
+    wirePut( &toTx, &pkt );
+
+    rcvUnacked = 0;
+    delackAt = 0;
+}
+
+static void receive( const pkt_t *pp )
+{
+    int i, found;
+
+    if ( pp->seq == rcvNxt ) {
+
+        rcvNxt += pp->len;
+
+        // Segment fills a hole, take what was received out of order
+        if ( cntOoo ) {
+            do {
+                found = 0;
+                for ( i = 0; i < cntOoo; i++ ) {
+                    if ( ooo[ i ] == rcvNxt ) {
+                        rcvNxt += MSS;
+                        ooo[ i ] = ooo[ --cntOoo ];
+                        found = 1;
+                    }
+                }
+            } while ( found );
+            sendAck();
+            return;
+        }
+
+        // ACK every second segment, else delay the ACK
+        if ( ++rcvUnacked >= 2 ) {
+            sendAck();
+        }
+        else {
+            delackAt = simNow + DELACK_US;
+        }
+    }
+    else if ( (int32_t)( pp->seq - rcvNxt ) > 0 ) {
+        // Out of order, keep it and send a duplicate ACK right away
+        for ( i = 0; i < cntOoo; i++ ) {
+            if ( ooo[ i ] == pp->seq ) break;
+        }
+        if ( ( i == cntOoo ) && ( cntOoo < OOO_SIZE ) ) ooo[ cntOoo++ ] = pp->seq;
+        sendAck();
+    }
+    else {
+        // Already received
+        sendAck();
+    }
+}
+
+static void sendSegment( TCP_WIN *pWin, uint32_t seq, uint16_t len )
+{
+    BUFFER b;
+    BYTE data[ SEG_HEADER + MSS ];
+    uint16_t i;
+
+    memcpy( data, &seq, 4 );
+    memcpy( data + 4, &len, 2 );
+    for ( i = 0; i < len; i++ ) data[ SEG_HEADER + i ] = (BYTE)( seq + i );
+
+    // Same sequence as TCPPutArray() and TCPFlush()
+    b = MACGetTxBuffer( FALSE );
+    MACSetTxBuffer( b, 0 );
+    MACPutArray( data, SEG_HEADER + len );
+    MACFlush();
+    TCPWinAdd( pWin, b, seq, len );
+}
+
+static void simInit( double rtt, int loss )
+{
+    memmac_init();
+    TCPWinInit( &win );
+
+    setTime( 0 );
+    rttUs = rtt;
+    lossPercent = loss;
+    wireFree = 0;
+    toRx.cnt = 0;
+    toTx.cnt = 0;
+
+    rcvNxt = sndNxt = 0x7ffff000;   // Wraps around at 2G and at 64K
+    cntOoo = 0;
+    rcvUnacked = 0;
+    delackAt = 0;
+
+    cntCorrupt = cntLost = cntFastRetx = cntTimeoutRetx = 0;
+}
+
+// Sends total bytes with at most winLimit segments in flight. Returns
+// the throughput in kbytes/s, or 0 if the transfer did not complete.
+static double transfer( uint32_t total, int winLimit )
+{
+    uint32_t start = sndNxt;
+    uint32_t len;
+    TCP_WIN_SEG *pSeg;
+    pkt_t pkt;
+
+    while ( (uint32_t)( rcvNxt - start ) < total ) {
+
+        // Receiver
+        while ( wireGet( &toRx, &pkt ) ) receive( &pkt );
+        if ( delackAt && ( simNow >= delackAt ) ) sendAck();
+
+        // Sender, as HandleTCPSeg() and TCPTick()
+        while ( wireGet( &toTx, &pkt ) ) {
+            TCPWinAck( &win, pkt.ack, 0 );
+        }
+
+        if ( NULL != ( pSeg = TCPWinGetExpired( &win ) ) ) {
+            if ( pSeg->retries >= 8 ) {
+                printf("Send window, segment not acknowledged fail.\n");
+                return 0;
+            }
+            if ( TCPWinIsFastRetx( &win ) ) cntFastRetx++;
+            else cntTimeoutRetx++;
+            TCPWinResend( &win, !TCPWinIsFastRetx( &win ) );
+        }
+
+        // Application, as TCPIsPutReady()
+        while ( ( (uint32_t)( sndNxt - start ) < total ) &&
+                ( win.count < winLimit ) &&
+                !TCPWinIsFull( &win ) &&
+                MACIsTxReady( FALSE ) ) {
+            len = total - ( sndNxt - start );
+            if ( len > MSS ) len = MSS;
+            sendSegment( &win, sndNxt, (uint16_t)len );
+            sndNxt += len;
+        }
+
+        if ( simNow > 600e6 ) {
+            printf("Send window, transfer timeout fail.\n");
+            return 0;
+        }
+
+        setTime( simNow + 50 );
+    }
+
+    // Let the last ACKs come in, they release the TX buffers
+    while ( !TCPWinIsEmpty( &win ) && ( simNow < 600e6 ) ) {
+        if ( delackAt && ( simNow >= delackAt ) ) sendAck();
+        while ( wireGet( &toTx, &pkt ) ) TCPWinAck( &win, pkt.ack, 0 );
+        setTime( simNow + 50 );
+    }
+
+    return total / simNow * 1e6 / 1024;
+}
+
+// RFC 1071 checksum of big endian words, folded but not complemented
+static uint16_t refSum( const uint8_t *p, int len )
+{
+    uint32_t sum = 0;
+    int i;
+
+    for ( i = 0; i < len; i++ ) {
+        sum += ( i & 1 ) ? p[ i ] : ( (uint32_t)p[ i ] << 8 );
+    }
+    while ( sum >> 16 ) sum = ( sum & 0xffff ) + ( sum >> 16 );
+    return (uint16_t)sum;
+}
+
+// As CalcIPChecksum() in helpers.c, little endian words
+static uint16_t calcIPChecksum( const uint8_t *p, int len )
+{
+    uint32_t sum = 0;
+    int i;
+
+    for ( i = 0; i < len; i++ ) {
+        sum += ( i & 1 ) ? ( (uint32_t)p[ i ] << 8 ) : p[ i ];
+    }
+    while ( sum >> 16 ) sum = ( sum & 0xffff ) + ( sum >> 16 );
+    return (uint16_t)~sum;
+}
+
+static uint16_t swap16( uint16_t v )
+{
+    return (uint16_t)( ( v << 8 ) | ( v >> 8 ) );
+}
+
+int main( int argc, char *argv[] )
+{
+    int i, j;
+
+#if ( MAC_TX_BUFFER_COUNT > 8 )
+    ///////////////////////////////////////////////////////////////////////
+    printf("Send window test 1\n");
+    {
+        TCP_WIN_SEG *p;
+
+        memmac_init();
+        TCPWinInit( &win );
+        setTime( 0 );
+        toRx.cnt = 0;
+        rttUs = 0;
+        lossPercent = 0;
+
+        // Four segments around the 32 bit SEQ wraparound
+        for ( i = 0; i < 4; i++ ) {
+            sendSegment( &win, 0xfffffe00 + i * 256, 256 );
+        }
+        if ( ( 4 != win.count ) || ( 4 != memmac_usedTxBuffers() ) ) printf("Send window test 1, add fail.\n");
+        if ( 4 != toRx.cnt ) printf("Send window test 1, transmit fail.\n");
+
+        // Partial ACK of the first segment releases nothing
+        if ( TCP_WIN_ACK_NONE != TCPWinAck( &win, 0xfffffe80, 0 ) ) printf("Send window test 1, partial ACK fail.\n");
+        if ( 4 != win.count ) printf("Send window test 1, partial ACK released segment fail.\n");
+
+        // Cumulative ACK for two segments, across the wraparound
+        if ( TCP_WIN_ACK_NEW != TCPWinAck( &win, 0x00000000, 0 ) ) printf("Send window test 1, ACK fail.\n");
+        if ( ( 2 != win.count ) || ( 2 != memmac_usedTxBuffers() ) ) printf("Send window test 1, ACK release fail.\n");
+        if ( 0x0000 != TCPWinGetOldest( &win )->seq ) printf("Send window test 1, oldest segment fail.\n");
+
+        // Duplicate ACKs, one carrying data is not counted
+        if ( TCP_WIN_ACK_DUP != TCPWinAck( &win, 0x00000000, 0 ) ) printf("Send window test 1, dup ACK 1 fail.\n");
+        if ( TCP_WIN_ACK_NONE != TCPWinAck( &win, 0x00000000, 10 ) ) printf("Send window test 1, dup ACK with data fail.\n");
+        if ( TCP_WIN_ACK_DUP != TCPWinAck( &win, 0x00000000, 0 ) ) printf("Send window test 1, dup ACK 2 fail.\n");
+        if ( TCP_WIN_ACK_FASTRETX != TCPWinAck( &win, 0x00000000, 0 ) ) printf("Send window test 1, fast retransmit fail.\n");
+
+        // Not sent by TCPWinAck(), TCPTick() finds it with TCPWinGetExpired()
+        if ( 4 != toRx.cnt ) printf("Send window test 1, resend from receive path fail.\n");
+        if ( !TCPWinIsFastRetx( &win ) || ( TCPWinGetOldest( &win ) != TCPWinGetExpired( &win ) ) ) printf("Send window test 1, fast retransmit mark fail.\n");
+        TCPWinResend( &win, FALSE );
+        if ( TCPWinIsFastRetx( &win ) || ( NULL != TCPWinGetExpired( &win ) ) ) printf("Send window test 1, fast retransmit mark cleared fail.\n");
+        if ( ( 5 != toRx.cnt ) || ( 0x00000000 != toRx.pkt[ 4 ].seq ) ) printf("Send window test 1, resend fail.\n");
+        if ( ( 2 != memmac_usedTxBuffers() ) || ( 1 != TCPWinGetOldest( &win )->retries ) ) printf("Send window test 1, resent buffer released fail.\n");
+
+        // More duplicate ACKs do not resend it again
+        if ( TCP_WIN_ACK_DUP != TCPWinAck( &win, 0x00000000, 0 ) ) printf("Send window test 1, dup ACK after fast retransmit fail.\n");
+
+        // The ACK above was received in the same tick the segments were sent
+        if ( ( 1 != win.srtt ) || ( TCP_WIN_MIN_RTO != win.rto ) ) printf("Send window test 1, first RTT sample fail.\n");
+
+        // Retransmit timer
+        if ( NULL != TCPWinGetExpired( &win ) ) printf("Send window test 1, early expiry fail.\n");
+        setTime( ( TCP_WIN_MIN_RTO + 1 ) * US_PER_TICK );
+        p = TCPWinGetExpired( &win );
+        if ( p != TCPWinGetOldest( &win ) ) printf("Send window test 1, expiry fail.\n");
+        TCPWinResend( &win, TRUE );
+        if ( ( 2 * TCP_WIN_MIN_RTO ) != win.rto ) printf("Send window test 1, backoff fail.\n");
+
+        // Retransmitted segment gives no RTT sample (Karn), the other one does
+        setTime( simNow + 5 * US_PER_TICK );
+        TCPWinAck( &win, 0x00000100, 0 );
+        if ( ( 1 != win.srtt ) || ( ( 2 * TCP_WIN_MIN_RTO ) != win.rto ) ) printf("Send window test 1, RTT sample from retransmitted segment fail.\n");
+        TCPWinAck( &win, 0x00000200, 0 );
+        if ( ( 1 == win.srtt ) || ( win.rto < TCP_WIN_MIN_RTO ) || ( win.rto >= ( 2 * TCP_WIN_MIN_RTO ) ) )
+            printf("Send window test 1, RTT sample fail.\n");
+        if ( !TCPWinIsEmpty( &win ) || ( 0 != memmac_usedTxBuffers() ) ) printf("Send window test 1, final release fail.\n");
+
+        for ( i = 0; i < 4; i++ ) sendSegment( &win, 0x1000 + i * 256, 256 );
+        TCPWinDiscard( &win );
+        if ( !TCPWinIsEmpty( &win ) || ( 0 != memmac_usedTxBuffers() ) ) printf("Send window test 1, discard fail.\n");
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    printf("Send window test 2\n");
+    {
+        static const double rtts[] = { 2000, 10000, 40000 };
+        static const int wins[] = { 1, 2, 4, 8 };
+        double kbs[ 3 ][ 4 ];
+
+        printf("Send window: 256 kbytes, %d byte segments, kbytes/s\n", (int)MSS );
+        printf("  RTT     win=1   win=2   win=4   win=8\n");
+        for ( i = 0; i < 3; i++ ) {
+            printf("  %2.0f ms", rtts[ i ] / 1000 );
+            for ( j = 0; j < 4; j++ ) {
+                simInit( rtts[ i ], 0 );
+                kbs[ i ][ j ] = transfer( 256 * 1024, wins[ j ] );
+                printf("  %6.1f", kbs[ i ][ j ] );
+                if ( cntCorrupt ) printf("\nSend window test 2, corrupt segment fail.\n");
+                if ( cntFastRetx || cntTimeoutRetx ) printf("\nSend window test 2, retransmit without loss fail.\n");
+                if ( memmac_usedTxBuffers() ) printf("\nSend window test 2, TX buffers not released fail.\n");
+            }
+            printf("\n");
+
+            // One segment per round trip (and delayed ACK) is what the old stack did
+            if ( kbs[ i ][ 2 ] < ( 3 * kbs[ i ][ 0 ] ) ) printf("Send window test 2, window 4 throughput fail.\n");
+            if ( kbs[ i ][ 3 ] < kbs[ i ][ 2 ] ) printf("Send window test 2, window 8 throughput fail.\n");
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    printf("Send window test 3\n");
+    {
+        double kb;
+
+        for ( i = 0; i < 2; i++ ) {
+            simInit( 10000, 3 );
+            kb = transfer( 512 * 1024, i ? 8 : 4 );
+            printf("Send window: 3%% loss, window %d, %.1f kbytes/s, %lu lost, %lu fast retransmits, %lu timeouts\n",
+                    i ? 8 : 4, kb, cntLost, cntFastRetx, cntTimeoutRetx );
+            if ( 0 == kb ) printf("Send window test 3, transfer fail.\n");
+            if ( cntCorrupt ) printf("Send window test 3, corrupt segment fail.\n");
+            if ( 0 == cntFastRetx ) printf("Send window test 3, no fast retransmit fail.\n");
+            if ( ( cntFastRetx + cntTimeoutRetx ) < cntLost ) printf("Send window test 3, lost segment not resent fail.\n");
+            if ( memmac_usedTxBuffers() ) printf("Send window test 3, TX buffers not released fail.\n");
+        }
+    }
+
+#endif
+
+    ///////////////////////////////////////////////////////////////////////
+    printf("Send window test 4\n");
+    {
+        // TX buffer sharing between two sockets, as TCPIsPutReady() and
+        // TCPCanSendSegment() in tcp.c. wins[ 0 ] is the busy socket
+        static TCP_WIN wins[ 2 ];
+        int expect = ( TCP_WIN_SEGMENTS < ( MAC_TX_BUFFER_COUNT - 1 ) ) ? TCP_WIN_SEGMENTS : ( MAC_TX_BUFFER_COUNT - 1 );
+
+        memmac_init();
+        TCPWinInit( &wins[ 0 ] );
+        TCPWinInit( &wins[ 1 ] );
+        setTime( 0 );
+        toRx.cnt = 0;
+        rttUs = 0;
+        lossPercent = 0;
+
+        // Alone, the busy socket may use all low priority TX buffers
+        for ( i = 0; TCPWinCanSend( &wins[ 0 ], 0 ) && MACIsTxReady( FALSE ); i++ ) {
+            sendSegment( &wins[ 0 ], 0x1000 + i * 256, 256 );
+        }
+        printf("Send window: %d TX buffers, %d segments in flight\n", (int)MAC_TX_BUFFER_COUNT, wins[ 0 ].count );
+        if ( wins[ 0 ].count < 2 ) printf("Send window test 4, single segment window fail.\n");
+        if ( expect != wins[ 0 ].count ) printf("Send window test 4, TX buffers left unused fail.\n");
+
+        // The other socket gets a TX buffer as soon as one segment is acknowledged
+        TCPWinAck( &wins[ 0 ], 0x1000 + 256, 0 );
+        if ( !TCPWinCanSend( &wins[ 1 ], wins[ 0 ].count ) || !MACIsTxReady( FALSE ) ) {
+            printf("Send window test 4, second socket blocked fail.\n");
+        }
+        sendSegment( &wins[ 1 ], 0x8000, 256 );
+
+        // Now the busy socket has to leave a TX buffer free
+        for ( i = 0; TCPWinCanSend( &wins[ 0 ], wins[ 1 ].count ) && MACIsTxReady( FALSE ); i++ ) {
+            sendSegment( &wins[ 0 ], 0x2000 + i * 256, 256 );
+        }
+        if ( ( i > 0 ) && ( memmac_usedTxBuffers() >= ( MAC_TX_BUFFER_COUNT - 1 ) ) ) {
+            printf("Send window test 4, last TX buffer taken fail.\n");
+        }
+
+        TCPWinDiscard( &wins[ 0 ] );
+        TCPWinDiscard( &wins[ 1 ] );
+        if ( 0 != memmac_usedTxBuffers() ) printf("Send window test 4, discard fail.\n");
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    printf("Checksum test 1\n");
+    {
+        // Random data added in random chunks, one byte at a time or as arrays
+        static uint8_t data[ 1500 ];
+        IP_CHECKSUM sum;
+        int len, pos, n;
+
+        for ( i = 0; i < 10000; i++ ) {
+            len = random32() % ( sizeof( data ) + 1 );
+            for ( j = 0; j < len; j++ ) data[ j ] = (uint8_t)random32();
+            if ( i & 1 ) memset( data, 0xff, len );    // Worst case for the accumulator
+
+            sum = 0;
+            for ( pos = 0; pos < len; pos += n ) {
+                n = 1 + random32() % 64;
+                if ( n > ( len - pos ) ) n = len - pos;
+                if ( random32() & 1 ) {
+                    for ( j = 0; j < n; j++ ) IPChecksumAddByte( sum, data[ pos + j ], ( pos + j ) & 1 );
+                }
+                else {
+                    IPChecksumAddArray( &sum, &data[ pos ], (WORD)n, ( pos & 1 ) ? TRUE : FALSE );
+                }
+            }
+
+            if ( IPChecksumFold( sum ) != swap16( refSum( data, len ) ) ) {
+                printf("Checksum test 1, length %d fail.\n", len);
+                break;
+            }
+        }
+    }
+
+    ///////////////////////////////////////////////////////////////////////
+    printf("Checksum test 2\n");
+    {
+        // Datagram checksum combined from pseudo header, header and the sum
+        // kept by the MAC while the data was written, as UDPFlush(). Now and
+        // then a high priority frame (ARP, ICMP) is built half way through
+        static uint8_t dgram[ 12 + 8 + MSS ];
+        uint8_t *pseudo = dgram, *hdr = dgram + 12, *payload = dgram + 20;
+        WORD checksums[ 3 ];
+        BUFFER buf;
+        int len, pos, n;
+        uint16_t chk;
+
+        for ( i = 0; i < 10000; i++ ) {
+            len = random32() % ( MSS + 1 );
+            for ( j = 0; j < 20 + len; j++ ) dgram[ j ] = (uint8_t)random32();
+            pseudo[ 8 ] = 0;
+            pseudo[ 9 ] = 17;
+            pseudo[ 10 ] = hdr[ 4 ] = (uint8_t)( ( 8 + len ) >> 8 );
+            pseudo[ 11 ] = hdr[ 5 ] = (uint8_t)( 8 + len );
+            hdr[ 6 ] = hdr[ 7 ] = 0;
+
+            buf = MACGetTxBuffer( FALSE );
+            if ( INVALID_BUFFER == buf ) {
+                printf("Checksum test 2, no TX buffer fail.\n");
+                break;
+            }
+            MACSetTxBuffer( buf, 14 + 20 + 8 );    // Data follows the MAC, IP and UDP headers
+            MACClearTxSum();
+            for ( pos = 0; pos < len; pos += n ) {
+                n = 1 + random32() % 64;
+                if ( n > ( len - pos ) ) n = len - pos;
+                if ( 1 == n ) MACPut( payload[ pos ] );
+                else MACPutArray( &payload[ pos ], (WORD)n );
+                if ( 0 == random32() % 8 ) {
+                    MACSetTxBuffer( 0, 14 + 20 );
+                    MACClearTxSum();
+                    MACPutArray( dgram, 9 );
+                    MACGetTxSum();
+                    MACSetTxBuffer( buf, 14 + 20 + 8 + pos + n );
+                }
+            }
+            checksums[ 2 ] = ( 0 == len ) ? 0 : MACGetTxSum();
+            MACDiscardTx( buf );
+
+            checksums[ 0 ] = (WORD)~calcIPChecksum( pseudo, 12 );
+            checksums[ 1 ] = (WORD)~calcIPChecksum( hdr, 8 );
+            chk = calcIPChecksum( (uint8_t *)checksums, sizeof( checksums ) );
+            hdr[ 6 ] = (uint8_t)chk;
+            hdr[ 7 ] = (uint8_t)( chk >> 8 );
+
+            if ( 0xffff != refSum( dgram, 20 + len ) ) {
+                printf("Checksum test 2, length %d fail.\n", len);
+                break;
+            }
+        }
+    }
+
+    return 0;
+}
@@ -32,6 +32,9 @@
  *
  * Author               Date        Comment
  *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
+ * 2026-10-17:
+ *      - Implemented fseeGetFAT() and fseeOpenFAT(), added fseeChangeCount
+ *      - Files are found with the File Index, if the File System Image contains one
  * 2006-01-14, David Hosken (DH):
  *      - made getFCB() a local function in stead of a global function
  *      - speed optimized
@@ -61,6 +64,10 @@ FSEE_FILE_INFO FCB[FSEE_MAX_FILES];
 BYTE fseeOpenCount;     /**< Current number of open files */
 BYTE fseeFlags;         /**< Current number of open files */
 BYTE pageWrite;         /**< Counts how many bytes have been written in current page write mode */
+BYTE fseeChangeCount;   /**< Incremented when writing a new File System Image starts, and when it is finished */
+
+static FSEE_POS fseeIndexAdr;   /**< Address of File Index, or 0 if the File System Image does not have one */
+static WORD fseeIndexMask;      /**< Number of hash buckets in File Index - 1 */
 
 
 /*
@@ -113,6 +120,18 @@ typedef struct _FSEE_HEADER
  */
 #define FATFLAG_READ_ONLY   0x01ul
 
+/**
+ * FILE Attribute. Only used in the last FAT entry. When set, indicates that a File Index follows the FAT.
+ * The address of the last FAT entry gives the address of the File Index, and the length the number of hash
+ * buckets.
+ */
+#define FATFLAG_INDEX       0x40ul
+
+/**
+ * Size of a File Index slot = 16 bit hash of name, followed by a copy of the file's FAT entry
+ */
+#define FSEE_INDEX_SLOT_SIZE    (2 + sizeof(FSEE_ENTRY))
+
 
 /**
  * Get a reference to the FCB for the given FSEE_FILE handle
@@ -129,130 +148,252 @@ typedef struct _FSEE_HEADER
 
 
 /**
- * Initializes the Modtronix File System
+ * Gets a free FSEE_FILE handle. The handle is not marked as used.
  *
- * @return      TRUE, if File System Storage access is initialized and File System is is ready to be used <br>
- *              FALSE otherwise
+ * @return      A free FSEE_FILE handle, or FSEE_NOT_AVAILABLE if all handles are used
  */
-BOOL fseeInit(void) {
+static FSEE_FILE fseeGetFreeHandle(void) {
     #if (FSEE_MAX_FILES > 1)
     BYTE i;
     #endif
-    fseeOpenCount = 0;
-    fseeFlags = FSEEFLAG_AVAILABLE;
 
-    //Initialize the EEPROM access routines. Use ~ 400 Khz.
-    XEEInit(EE_BAUD(CLOCK_FREQ, 400000));
-    
-    //Set all FILE object as free
     #if (FSEE_MAX_FILES == 1)
-        FCB[0].flags = 0;
+        if ( !(FCB[0].flags & FSEEFILE_USED)) {
+            return 0;
+        }
     #else
         for (i = 0; i < FSEE_MAX_FILES; i++) {
-            FCB[i].flags = 0;
+            if ( !(FCB[i].flags & FSEEFILE_USED)) {
+                return i;   //Found available handle, use it!
+            }
         }
     #endif
-    
-    //Read File System header, and varify that it is the same type as this File System
-    // TODO
-    
 
-    return TRUE;
+    #if (DEBUG_FSEE >= LOG_ERROR)
+    debugPutMsg(3); //No File handles available for fseeOpen() function
+    #endif
+
+    return FSEE_NOT_AVAILABLE;
 }
 
 
 /**
- * Opens the given file for reading or writing, and returns a handle to the file.
- * The file pointer (where next read or write will occur) will be positioned at the beginning of
- * the file. To modify the file pointer use the fileSetPos() function.
+ * Gets the hash of the given file name, as used by the File Index. It is never 0, 0 marks an empty slot.
  *
- * @param filename  NULL terminate file name.
- * @param mode      Currently not used. All files are opened with read and write permission. When writing
- *                  to a file, no data can be appended to it!
+ * @param name      NULL terminated file name, in upper case
  *
- * @return          - A FSEE_FILE Handle (value 0 - 127) if the file is found
- *                  - FSEE_FILE_INVALID if file could not be opened
- *                  - FSEE_NOT_AVAILABLE if the File System is not available
+ * @return          Hash of file name
  */
-FSEE_FILE fseeOpen(BYTE* filename, BYTE mode) {
-    BYTE c;
-    BYTE i;
-    
-    FSEE_FILE fhandle = FSEE_NOT_AVAILABLE;
+static WORD fseeHash(BYTE* name) {
+    WORD hash;
 
-    FSEE_POS fatAdr;    //Address of current FAT entry
-    
-    FSEE_FILE_INFO * pFileInfo;
-    
-    #if (DEBUG_FSEE >= LOG_DEBUG)
-    debugPutMsg(1); //fseeOpen called for %s
-    debugPutString(filename);
+    hash = 0;
+    while (*name != '\0') {
+        hash = ((hash << 5) | (hash >> 11)) + *name++;
+    }
+
+    if (hash == 0) {
+        hash = 1;
+    }
+
+    return hash;
+}
+
+
+/**
+ * Reads the address and length of a file from it's FAT entry into the given FSEE_FILE_INFO structure.
+ *
+ * @preCondition    A sequencial read has been started at the address field of the FAT entry
+ *
+ * @param pFileInfo Structure to receive address and length
+ */
+static void fseeReadFileInfo(FSEE_FILE_INFO* pFileInfo) {
+    //Read address from FAT, is always 3 bytes long!
+    pFileInfo->address.v[0] = XEERead();
+    pFileInfo->address.v[1] = XEERead();
+    pFileInfo->address.v[2] = XEERead();
+
+    //Read length from FAT, is 2 or 3 bytes long
+    pFileInfo->length.v[0] = XEERead();
+    pFileInfo->length.v[1] = XEERead();
+    #if defined(FSEE_FILE_SIZE_16MB)
+    pFileInfo->length.v[2] = XEERead();
     #endif
+}
 
-    //Check if File System is available
-    if (IS_BIT_CLEAR(fseeFlags, FSEEFLAG_AVAILABLE)) {
-        #if (DEBUG_FSEE >= LOG_ERROR)
-        debugPutMsg(2);    //File System not available for fseeOpen() function
-        #endif
-    
-        return FSEE_NOT_AVAILABLE;
+
+/**
+ * Checks if the File System Image contains a File Index. The "FAT Entries" value in the "FSYS Header"
+ * gives the last FAT entry. If it has the FATFLAG_INDEX attribute set, it's address and length give the
+ * File Index address and the number of hash buckets.
+ */
+static void fseeLoadIndex(void) {
+    WORD_VAL w;
+    SWORD_VAL indexAdr;
+    FSEE_POS fatAdr;
+    BYTE i;
+
+    fseeIndexAdr = 0;
+
+    //Read "FAT Entries" from "FSYS Header", it follows the length, identifier and version
+    if (XEEBeginRead(EEPROM_CONTROL, FSEE_RESERVE_BLOCK) != XEE_SUCCESS ) {
+        XEEEndRead();
+        return;
+    }
+    XEERead();
+    XEERead();
+    XEERead();
+    w.v[0] = XEERead();
+    w.v[1] = XEERead();
+    XEEEndRead();
+
+    //No File System Image, or EEPROM is erased
+    if ((w.Val == 0) || (w.Val == 0xffff)) {
+        return;
+    }
+
+    //Read last FAT entry
+    fatAdr = FSEE_RESERVE_BLOCK + sizeof(FSEE_HEADER) + ((FSEE_POS)(w.Val - 1) * sizeof(FSEE_ENTRY));
+    if (XEEBeginRead(EEPROM_CONTROL, fatAdr) != XEE_SUCCESS ) {
+        XEEEndRead();
+        return;
     }
-        
-    //Check if there are any FSEE_FILE handles available
-    #if (FSEE_MAX_FILES == 1)
-        if (FCB[0].flags & FSEEFILE_USED) {
-            #if (DEBUG_FSEE >= LOG_ERROR)
-            debugPutMsg(3); //No File handles available for fseeOpen() function
-            #endif
 
-            return FSEE_NOT_AVAILABLE;
+    if ((XEERead() & (FATFLAG_END | FATFLAG_INDEX)) == (FATFLAG_END | FATFLAG_INDEX)) {
+        //Skip name
+        for (i = 0; i < MAX_FILE_NAME_LEN; i++) {
+            XEERead();
         }
-        fhandle = 0;
-    #else
-        for (i = 0; i < FSEE_MAX_FILES; i++) {
-            if ( !(FCB[i].flags & FSEEFILE_USED)) {
-                fhandle = i;    //Found available handle, use it!
+
+        indexAdr.v[0] = XEERead();
+        indexAdr.v[1] = XEERead();
+        indexAdr.v[2] = XEERead();
+
+        //Number of hash buckets, must be a power of 2
+        w.v[0] = XEERead();
+        w.v[1] = XEERead();
+        if ((w.Val != 0) && ((w.Val & (w.Val - 1)) == 0)) {
+            fseeIndexAdr = indexAdr.Val;
+            fseeIndexMask = w.Val - 1;
+        }
+    }
+
+    XEEEndRead();
+
+    #if (DEBUG_FSEE >= LOG_INFO)
+    debugPutMsg(16);    //File Index found = %d
+    debugPutByte(fseeIndexAdr != 0);
+    #endif
+}
+
+
+/**
+ * Finds the FAT entry of the given file. If the File System Image contains a File Index, it is found with
+ * a single sequencial read of the File Index. Else the FAT is searched from the start.
+ *
+ * The File Index is a hash table. The slot given by the hash of the name is read first, files with the
+ * same hash bucket are in the slots that follow it. The first empty slot ends the search. The image
+ * builder ensures that the last slot in the File Index is always empty.
+ *
+ * @param name      NULL terminated file name, in upper case
+ * @param pFileInfo If not NULL, the file's address and length are read into this structure when it is found
+ *
+ * @return          - Address of the file's FAT entry if the file is found. If found via the File Index,
+ *                    this is the copy of the FAT entry contained in the File Index.
+ *                  - FSEE_POS_NOT_FOUND if the file is not found
+ *                  - FSEE_POS_NOT_AVAILABLE if the EEPROM could not be read
+ */
+static FSEE_POS fseeFindEntry(BYTE* name, FSEE_FILE_INFO* pFileInfo) {
+    BYTE c;
+    BYTE i;
+    BYTE match;
+    WORD_VAL hash;
+    WORD_VAL slotHash;
+    FSEE_POS fatAdr;    //Address of current FAT entry
+
+    /////////////////////////////////////////////////
+    //Use File Index
+    if (fseeIndexAdr != 0) {
+        hash.Val = fseeHash(name);
+
+        fatAdr = fseeIndexAdr + ((FSEE_POS)(hash.Val & fseeIndexMask) * FSEE_INDEX_SLOT_SIZE);
+        if (XEEBeginRead(EEPROM_CONTROL, fatAdr) != XEE_SUCCESS ) {
+            XEEEndRead();
+            return FSEE_POS_NOT_AVAILABLE;
+        }
+
+        while(1)
+        {
+            slotHash.v[0] = XEERead();
+            slotHash.v[1] = XEERead();
+            fatAdr += 2;    //Address of FAT entry in this slot
+
+            //Empty slot, file was not found
+            if (slotHash.Val == 0) {
+                fatAdr = FSEE_POS_NOT_FOUND;
                 break;
             }
-        }
-        
-        //All handles are used, return FSEE_NOT_AVAILABLE
-        if (fhandle == FSEE_NOT_AVAILABLE) {
-            #if (DEBUG_FSEE >= LOG_ERROR)
-            debugPutMsg(3); //No File handles available for fseeOpen() function
-            #endif
 
-            return FSEE_NOT_AVAILABLE;
+            XEERead();  //Attribute
+
+            //Read Filename from slot, and compare to given filename if the hash matches. The whole name is
+            //always read, so we are at the next field when done.
+            //match = 0 if no match, 1 while comparing, 2 if matched
+            match = (slotHash.Val == hash.Val) ? 1 : 0;
+            for (i = 0; i < MAX_FILE_NAME_LEN; i++) {
+                c = XEERead();
+                if (match == 1) {
+                    if (c != name[i])
+                        match = 0;
+                    else if (c == '\0')
+                        match = 2;
+                }
+            }
+
+            //Match!! Names are equal up to the NULL terminator, or for all MAX_FILE_NAME_LEN characters
+            if (match != 0) {
+                if (pFileInfo != NULL) {
+                    fseeReadFileInfo(pFileInfo);
+                }
+                break;
+            }
+
+            //Skip address and length, and go to next slot
+            for (i = 0; i < (sizeof(FSEE_ENTRY) - 1 - MAX_FILE_NAME_LEN); i++) {
+                XEERead();
+            }
+            fatAdr += sizeof(FSEE_ENTRY);
         }
-    #endif
 
-    //Set to first FAT entry, follows after "Reserve Block" and "File System Header"
-    fatAdr = FSEE_RESERVE_BLOCK + sizeof(FSEE_HEADER);
+        XEEEndRead();
 
-    //If string is empty, do not attempt to find it in FAT.
-    if ( *filename == '\0' )
-        return FSEE_FILE_INVALID;
+        return fatAdr;
+    }
 
-    filename = (BYTE*)strupr((char*)filename);
+    /////////////////////////////////////////////////
+    //Search FAT
+
+    //Set to first FAT entry, follows after "Reserve Block" and "File System Header"
+    fatAdr = FSEE_RESERVE_BLOCK + sizeof(FSEE_HEADER);
 
     while(1)
     {
         //Prepare for reading FAT
         if (XEEBeginRead(EEPROM_CONTROL, fatAdr) != XEE_SUCCESS ) {
-            fhandle = FSEE_NOT_AVAILABLE;
+            fatAdr = FSEE_POS_NOT_AVAILABLE;
             break;
         }
-            
+
         //Read first byte from FAT = Attribute
         c = XEERead();
         #if (DEBUG_FSEE >= LOG_DEBUG)
         debugPutMsg(4);     //Read FAT Attributes during fseeOpen = %x
         debugPutByteHex(c);
         #endif
-        
+
         //End of FAT reached, file was not found
         if (c & FATFLAG_END) {
-            fhandle = FSEE_FILE_INVALID;
+            fatAdr = FSEE_POS_NOT_FOUND;
             break;
         }
 
@@ -260,12 +401,11 @@ FSEE_FILE fseeOpen(BYTE* filename, BYTE mode) {
         for (i = 0; i < MAX_FILE_NAME_LEN; i++) {
             c = XEERead();
 
-            //No match, increment to next FAT entry
-            if (c != filename[i]) {
-                fatAdr += sizeof(FSEE_ENTRY);
+            //No match
+            if (c != name[i]) {
                 break;
             }
-            
+
             //Match!!
             if (c == '\0') {
                 //Increment past filename.
@@ -273,44 +413,128 @@ FSEE_FILE fseeOpen(BYTE* filename, BYTE mode) {
                 break;
             }
         }
-        
+
         //Match was found!
         if (i == MAX_FILE_NAME_LEN) {
-            #if (DEBUG_FSEE >= LOG_INFO)
-            debugPutMsg(5);     //fseeOpen() Found file, assigned to handle %d
-            debugPutByte(fhandle);
-            #endif
-        
-            pFileInfo = &getFCB(fhandle);
-            
-            pFileInfo->flags = FSEEFILE_USED;  //Indicate this FSEE_FILE handle is used
-            pFileInfo->offset = 0;             //After opening file, offset is 0
-            
-            //Read address from FAT, is always 3 bytes long!
-            pFileInfo->address.v[0] = XEERead();
-            pFileInfo->address.v[1] = XEERead();
-            pFileInfo->address.v[2] = XEERead();
-
-            //Read length from FAT, is 2 or 3 bytes long
-            pFileInfo->length.v[0] = XEERead();
-            pFileInfo->length.v[1] = XEERead();
-            #if defined(FSEE_FILE_SIZE_16MB)
-            pFileInfo->length.v[2] = XEERead();
-            #endif
-
-            fseeOpenCount++;
+            if (pFileInfo != NULL) {
+                fseeReadFileInfo(pFileInfo);
+            }
             break;
         }
 
-        //End current sequencial read. At top of this loop a new sequencial read XEEBeginRead() will be initiated
+        //Increment to next FAT entry. At top of this loop a new sequencial read XEEBeginRead() will be initiated
+        fatAdr += sizeof(FSEE_ENTRY);
         XEEEndRead();
-        
+
         FAST_USER_PROCESS();
     }
-    
+
     //End current sequencial read.
     XEEEndRead();
+
+    return fatAdr;
+}
+
+
+/**
+ * Initializes the Modtronix File System
+ *
+ * @return      TRUE, if File System Storage access is initialized and File System is is ready to be used <br>
+ *              FALSE otherwise
+ */
+BOOL fseeInit(void) {
+    #if (FSEE_MAX_FILES > 1)
+    BYTE i;
+    #endif
+    fseeOpenCount = 0;
+    fseeFlags = FSEEFLAG_AVAILABLE;
+
+    //Initialize the EEPROM access routines. Use ~ 400 Khz.
+    XEEInit(EE_BAUD(CLOCK_FREQ, 400000));
     
+    //Set all FILE object as free
+    #if (FSEE_MAX_FILES == 1)
+        FCB[0].flags = 0;
+    #else
+        for (i = 0; i < FSEE_MAX_FILES; i++) {
+            FCB[i].flags = 0;
+        }
+    #endif
+    
+    //Read File System header, and check if the File System Image contains a File Index
+    fseeLoadIndex();
+
+    return TRUE;
+}
+
+
+/**
+ * Opens the given file for reading or writing, and returns a handle to the file.
+ * The file pointer (where next read or write will occur) will be positioned at the beginning of
+ * the file. To modify the file pointer use the fileSetPos() function.
+ *
+ * @param filename  NULL terminate file name.
+ * @param mode      Currently not used. All files are opened with read and write permission. When writing
+ *                  to a file, no data can be appended to it!
+ *
+ * @return          - A FSEE_FILE Handle (value 0 - 127) if the file is found
+ *                  - FSEE_FILE_INVALID if file could not be opened
+ *                  - FSEE_NOT_AVAILABLE if the File System is not available
+ */
+FSEE_FILE fseeOpen(BYTE* filename, BYTE mode) {
+    FSEE_FILE fhandle;
+
+    FSEE_POS fatAdr;    //Address of current FAT entry
+    
+    FSEE_FILE_INFO * pFileInfo;
+    
+    #if (DEBUG_FSEE >= LOG_DEBUG)
+    debugPutMsg(1); //fseeOpen called for %s
+    debugPutString(filename);
+    #endif
+
+    //Check if File System is available
+    if (IS_BIT_CLEAR(fseeFlags, FSEEFLAG_AVAILABLE)) {
+        #if (DEBUG_FSEE >= LOG_ERROR)
+        debugPutMsg(2);    //File System not available for fseeOpen() function
+        #endif
+    
+        return FSEE_NOT_AVAILABLE;
+    }
+        
+    //Check if there are any FSEE_FILE handles available. If all handles are used, return FSEE_NOT_AVAILABLE
+    fhandle = fseeGetFreeHandle();
+    if (fhandle == FSEE_NOT_AVAILABLE) {
+        return FSEE_NOT_AVAILABLE;
+    }
+
+    //If string is empty, do not attempt to find it in FAT.
+    if ( *filename == '\0' )
+        return FSEE_FILE_INVALID;
+
+    filename = (BYTE*)strupr((char*)filename);
+
+    pFileInfo = &getFCB(fhandle);
+
+    //Find FAT entry, and read address and length of file into the FSEE_FILE_INFO structure
+    fatAdr = fseeFindEntry(filename, pFileInfo);
+    if (fatAdr == FSEE_POS_NOT_FOUND) {
+        return FSEE_FILE_INVALID;
+    }
+    if (fatAdr == FSEE_POS_NOT_AVAILABLE) {
+        return FSEE_NOT_AVAILABLE;
+    }
+
+    #if (DEBUG_FSEE >= LOG_INFO)
+    debugPutMsg(5);     //fseeOpen() Found file, assigned to handle %d
+    debugPutByte(fhandle);
+    #endif
+
+    pFileInfo->flags = FSEEFILE_USED;  //Indicate this FSEE_FILE handle is used
+    pFileInfo->offset = 0;             //After opening file, offset is 0
+
+    fseeOpenCount++;
+
     return fhandle;
 }
 
@@ -631,10 +855,37 @@ FSEE_FILE_POS fseeGetPos(FSEE_FILE fhandle) {
  * !!! IMPORTANT !!!
  * The File System FAT entry address obtained with the fileGetFAT() function will only be valid as long as no
  * modifications are made to the File System! If after obtaining a address with the fileGetFAT() function the
- * File System is modified, this value might not be valid any more!
+ * File System is modified, this value might not be valid any more! Use fseeChangeCount to detect this.
+ *
+ * @param name      NULL terminate file name. Is converted to upper case.
+ *
+ * @return          - Address of the file's FAT entry if the file is found
+ *                  - FSEE_POS_NOT_FOUND if the file is not found
+ *                  - FSEE_POS_NOT_AVAILABLE if the File System is not available, or busy with an open file
  */
 FSEE_POS fseeGetFAT(BYTE* name) {
-    return 0;
+
+    //Check if File System is available
+    if (IS_BIT_CLEAR(fseeFlags, FSEEFLAG_AVAILABLE)) {
+        return FSEE_POS_NOT_AVAILABLE;
+    }
+
+    //Check if the File System is not currently busy reading or writing from an open file
+    #if (FSEE_MAX_FILES == 1)
+    if (FCB[0].flags & (FSEEFILE_READING | FSEEFILE_WRITING)) {
+    #else
+    if (fseeFlags & FSEEFLAG_READING_WRITING) {
+    #endif
+        return FSEE_POS_NOT_AVAILABLE;
+    }
+
+    //If string is empty, do not attempt to find it in FAT.
+    if ( *name == '\0' )
+        return FSEE_POS_NOT_FOUND;
+
+    name = (BYTE*)strupr((char*)name);
+
+    return fseeFindEntry(name, NULL);
 }
 
 
@@ -656,7 +907,51 @@ FSEE_POS fseeGetFAT(BYTE* name) {
  *                  - FSEE_NOT_AVAILABLE if the File System is not available
  */
 FSEE_FILE fseeOpenFAT(FSEE_POS fatPos) {
-    return 0;
+    FSEE_FILE fhandle;
+    FSEE_FILE_INFO * pFileInfo;
+
+    //Check if File System is available
+    if (IS_BIT_CLEAR(fseeFlags, FSEEFLAG_AVAILABLE)) {
+        #if (DEBUG_FSEE >= LOG_ERROR)
+        debugPutMsg(2);    //File System not available for fseeOpen() function
+        #endif
+
+        return FSEE_NOT_AVAILABLE;
+    }
+
+    if ((fatPos == FSEE_POS_NOT_FOUND) || (fatPos == FSEE_POS_NOT_AVAILABLE)) {
+        return FSEE_FILE_INVALID;
+    }
+
+    //Check if there are any FSEE_FILE handles available. If all handles are used, return FSEE_NOT_AVAILABLE
+    fhandle = fseeGetFreeHandle();
+    if (fhandle == FSEE_NOT_AVAILABLE) {
+        return FSEE_NOT_AVAILABLE;
+    }
+
+    //Read address and length from FAT entry. They follow the attribute and file name
+    if (XEEBeginRead(EEPROM_CONTROL, fatPos + 1 + MAX_FILE_NAME_LEN) != XEE_SUCCESS ) {
+        XEEEndRead();
+        return FSEE_NOT_AVAILABLE;
+    }
+
+    pFileInfo = &getFCB(fhandle);
+
+    pFileInfo->flags = FSEEFILE_USED;  //Indicate this FSEE_FILE handle is used
+    pFileInfo->offset = 0;             //After opening file, offset is 0
+
+    fseeReadFileInfo(pFileInfo);
+
+    XEEEndRead();
+
+    #if (DEBUG_FSEE >= LOG_INFO)
+    debugPutMsg(5);     //fseeOpen() Found file, assigned to handle %d
+    debugPutByte(fhandle);
+    #endif
+
+    fseeOpenCount++;
+
+    return fhandle;
 }
 
 
@@ -697,7 +992,13 @@ BOOL fseeOpenImage(void) {
     #endif
     
     getFCB(0).flags = FSEEFILE_USED;    //Indicate this FSEE_FILE handle is used
-    
+
+    //All FAT entry addresses obtained with fseeGetFAT() are invalid from now on
+    fseeChangeCount++;
+
+    //Image is being overwritten, File Index can not be used until the new Image has been written
+    fseeIndexAdr = 0;
+
     //Use "address" member in FILE handle 0 to indicate next byte that will be written to
     //The first byte written to is the one following the "Reserved Block"
     getFCB(0).address.Val = FSEE_RESERVE_BLOCK;
@@ -793,5 +1094,11 @@ BOOL fseeCloseImage(void) {
 
     getFCB(0).flags = 0;      //Indicate this FSEE_FILE handle is free to be used
 
+    //FAT entry addresses obtained with fseeGetFAT() while the Image was being written are invalid
+    fseeChangeCount++;
+
+    //Check if the new File System Image contains a File Index
+    fseeLoadIndex();
+
     return TRUE;
 }
@@ -70,6 +70,8 @@
  * Author               Date        Comment
  *~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~
  * David Hosken         05/11/16     Original (Rev. 1.0)
+ *                      2026-10-17   Added fseeGetLength(), fseeChangeCount and the return values of fseeGetFAT()
+ *                      2026-10-17   Added File Index
 ********************************************************************/
 
 
@@ -93,6 +95,7 @@ Figure 1.
 <tr><td>FAT Entry 1</td></tr>
 <tr><td>.............</td></tr>
 <tr><td>FAT Entry n</td></tr>
+<tr><td>File Index <i>(optional)</i></td></tr>
 <tr><td>File 1</td></tr>
 <tr><td>.............</td></tr>
 <tr><td>File n</td></tr>
@@ -152,6 +155,22 @@ The data block format is shown in Figure 3.
 </tr></table>
 <i>Figure 3</i> - FSEE Data Block Format
 
+@section mod_sys_mxfs_index File Index
+The last FAT entry always has the "End of FAT" attribute (0x80) set. If it also has the "Index" attribute
+(0x40) set, a File Index follows the FAT. The address of the last FAT entry then gives the address of the
+File Index, and it's length the number of hash buckets, which is always a power of 2. Images without a
+File Index, and firmware that does not support it, search the FAT from the start as before.
+
+The File Index is a hash table of slots, each containing a 16 bit hash of the file name followed by a
+copy of the file's FAT entry. A hash of 0 marks an empty slot. The hash is calculated over the upper case
+file name with: hash = ((hash << 5) | (hash >> 11)) + c, and is replaced by 1 if it is 0. A file is stored
+in the first free slot starting at "hash & (buckets - 1)". Slots are not wrapped around, and the last slot
+of the File Index is always empty. This allows fseeOpen() to find a file with a single sequencial read from
+the EEPROM, reading slots until a matching name or an empty slot is found.
+
+The File Index is created by the image builder. The linux/fseesim directory contains a host version of
+this image builder (mkfsee), and a test that counts the I2C transactions needed to open each file.
+
 */
 
 #ifndef FSEE_H
@@ -188,12 +207,16 @@ The data block format is shown in Figure 3.
 #define fsysOpenImage       fseeOpenImage
 #define fsysPutByteImage    fseePutByteImage
 #define fsysCloseImage      fseeCloseImage
+#define fileGetLength       fseeGetLength
+#define fsysChangeCount     fseeChangeCount
 
 #define FILE                FSEE_FILE
 #define FSYS_POS            FSEE_POS
 #define FILE_POS            FSEE_FILE_POS
 #define FILE_INVALID        FSEE_FILE_INVALID
 #define FSYS_NOT_AVAILABLE  FSEE_NOT_AVAILABLE
+#define FSYS_POS_NOT_FOUND      FSEE_POS_NOT_FOUND
+#define FSYS_POS_NOT_AVAILABLE  FSEE_POS_NOT_AVAILABLE
 
 #endif
 
@@ -290,6 +313,11 @@ typedef struct _FSEE_FILE_INFO {
 
 #define FSEE_WRITE_PAGE_SIZE    (64ul)
 
+/////////////////////////////////////////////////
+// FSEE_POS values returned by fseeGetFAT()
+#define FSEE_POS_NOT_FOUND      (0x000000ul)    /**< File was not found */
+#define FSEE_POS_NOT_AVAILABLE  (0xfffffful)    /**< File System is not available */
+
 
 /////////////////////////////////////////////////
 //File System Flags
@@ -312,6 +340,7 @@ typedef struct _FSEE_FILE_INFO {
 #if !defined(THIS_IS_FSEE)
 extern BYTE fseeOpenCount;
 extern BYTE fseeFlags;
+extern BYTE fseeChangeCount;
 extern FSEE_FILE_INFO FCB[FSEE_MAX_FILES];
 #endif
 
@@ -440,6 +469,17 @@ BYTE fseeGetByte(FSEE_FILE fhandle);
     #define fseeIsOK(fhandle)     (FCB[fhandle].flags & (FSEEFILE_ERROR | FSEEFILE_EOF))
 #endif
 
+/**
+ * Gets the length of the given open file.
+ *
+ * @return          Length of the file in bytes
+ */
+#if (FSEE_MAX_FILES == 1)
+    #define fseeGetLength(fhandle)     (FCB[0].length.Val)
+#else
+    #define fseeGetLength(fhandle)     (FCB[fhandle].length.Val)
+#endif
+
 
 /**
  * Tests if the given FILE handle is a valid handle. A valid FILE handle is a value that
@@ -516,7 +556,14 @@ FSEE_FILE_POS fseeGetPos(FSEE_FILE fhandle);
  * !!! IMPORTANT !!!
  * The File System FAT entry address obtained with the fileGetFAT() function will only be valid as long as no
  * modifications are made to the File System! If after obtaining a address with the fileGetFAT() function the
- * File System is modified, this value might not be valid any more!
+ * File System is modified, this value might not be valid any more! fseeChangeCount is incremented when
+ * writing a new File System Image starts, and again when it is finished.
+ *
+ * @param name      NULL terminate file name. Is converted to upper case.
+ *
+ * @return          - Address of the file's FAT entry if the file is found
+ *                  - FSEE_POS_NOT_FOUND if the file is not found
+ *                  - FSEE_POS_NOT_AVAILABLE if the File System is not available, or busy with an open file
  */
 FSEE_POS fseeGetFAT(BYTE* name);
 
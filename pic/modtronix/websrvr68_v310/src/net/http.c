@@ -51,6 +51,11 @@
  *      - Added function for determining file type.
  *      - Modified for new multi implementation file system
  *      - Added check to see if HTTP Socket is holding on to an open file if forcefully closed
+ * 2026-10-17:
+ *      - Static files are sent with TCPPutArray() in stead of a TCPPut() call per byte
+ *      - Added persistent connections, pipelined requests and a FAT lookup cache
+ *      - Connections are served round robin, starting with a different connection each call
+ *      - GET commands of a pipelined request are only executed when it is that request's turn
  * 2002/07/09, Nilesh Rajbharti:    Rev 2.1 (Fixed HTTPParse bug)
  * 2002/05/22, Nilesh Rajbharti:    Rev 2.0 (See version.log for detail)
  * 2002/02/09, Nilesh Rajbharti:    Cleanup
@@ -66,6 +71,7 @@
 #include "net\http.h"
 #include "net\fsee.h"
 #include "net\tcp.h"
+#include "net\helpers.h"
 #include "cmd.h"
 
 #include "debug.h"
@@ -226,6 +232,10 @@ static ROM char *HTTPMessages[] =
 /////////////////////////////////////////////////
 // Standard HTTP messages.
 ROM char HTTPMSG_RESPONSE_OK[]              = "HTTP/1.0 200 OK";
+ROM char HTTPMSG_RESPONSE_OK11[]            = "HTTP/1.1 200 OK";
+ROM char HTTPMSG_CONTENT_LENGTH[]           = "Content-Length: ";
+ROM char HTTPMSG_CONNECTION_KEEPALIVE[]     = "Connection: keep-alive\r\n";
+ROM char HTTPMSG_CONNECTION_CLOSE[]         = "Connection: close\r\n";
 ROM char HTTPMSG_CONTENT_TYPE[]             = "Content-type: ";
 ROM char HTTPMSG_CONTENT_ENCODING_GZIP[]    = "Content-Encoding: gzip\r\n";
 ROM char HTTPMSG_EXPIRES_IMMEDIATELY[]      = "Expires: 0\r\n";
@@ -247,17 +257,40 @@ ROM BYTE HTTP_DEFAULT_FILE_STRING[]  = "INDEX.HTM";
 ROM char PAGE_LOGIN[] = "LOGIN.CGI";
 
 
+#if (HTTP_FAT_CACHE_SIZE > 0)
+/////////////////////////////////////////////////
+// FAT lookup cache entry. Remembers where the requested resource was found in the FAT, so the
+// FAT does not have to be searched again when it is requested next time.
+typedef struct _HTTP_FAT_CACHE
+{
+    WORD        hash;       //Hash of name
+    BYTE        name[HTTP_MAX_RESOURCE_NAME_LEN + 1];   //Requested resource, empty if entry is not used
+    FSYS_POS    fatPos;     //FAT entry of file, or FSYS_POS_NOT_FOUND if it does not exist
+    BYTE        bZipped;    //File was found under it's zipped file extension
+} HTTP_FAT_CACHE;
+#endif
+
+
 /////////////////////////////////////////////////
 // Static variables
 static HTTP_INFO HCB[MAX_HTTP_CONNECTIONS];
 static TICK16 lastActivity;     //Stores the value that the HTTP port was last accessed
+static BYTE nextConn;           //Connection that is processed first in next HTTPServer() call
+
+#if (HTTP_FAT_CACHE_SIZE > 0)
+static HTTP_FAT_CACHE fatCache[HTTP_FAT_CACHE_SIZE];
+static BYTE fatCacheNext;           //Entry that is replaced next
+static BYTE fatCacheChangeCount;    //Value of fsysChangeCount when the cache was filled
+#endif
 
 
 /////////////////////////////////////////////////
 // Static function prototypes.
 static void HTTPProcess(HTTP_HANDLE h);
+static void HTTPGetRqst(HTTP_HANDLE h);
+static FSYS_POS HTTPFindFile(HTTP_HANDLE h, BYTE* rqstRes, BYTE* fileType);
 static HTTP_COMMAND HTTPGetCommand(TCP_SOCKET s);
-static void HTTPParseHeader(HTTP_HANDLE h, BYTE* rqstRes);
+static BOOL HTTPParseHeader(HTTP_HANDLE h, BYTE* rqstRes);
 BOOL HTTPGetRqstRes(TCP_SOCKET s, BYTE* rqstRes);
 BYTE HTTPGetRqstResFiletype(BYTE* rqstRes);
 static BOOL sendFile(HTTP_HANDLE h);
@@ -277,6 +310,15 @@ void HTTPInit(void)
     BYTE i;
     
     lastActivity = TickGet16bit();
+    nextConn = 0;
+
+    #if (HTTP_FAT_CACHE_SIZE > 0)
+    fatCacheNext = 0;
+    fatCacheChangeCount = fsysChangeCount;
+    for ( i = 0; i < HTTP_FAT_CACHE_SIZE; i++ ) {
+        fatCache[i].name[0] = '\0';
+    }
+    #endif
 
     //Initialize all HTTP connections:
     // - Allocate each one a TCP sockets to listen on HTTP port
@@ -286,14 +328,16 @@ void HTTPInit(void)
         HCB[i].socket = TCPListen(HTTPSRVR_PORT);
         HCB[i].smHTTP = SM_HTTP_IDLE;
         HCB[i].flags.val = 0;   //Clear all flags
+        HCB[i].rqstCount = 0;
+        HCB[i].tick = 0;
     }
 }
 
 
 /**
- * Itterate through all connections and let it handle its connection. If a connection
- * is not finished, do not process next connections. This must be done, all
- * connections use some static variables that are common.
+ * Itterate through all connections and let each one handle its connection. Each connection
+ * sends at most what the TCP send window takes, and then returns. The first connection
+ * processed changes with each call, so that all connections get a fair share.
  * This function acts as a task (similar to one in RTOS). This function performs its task in
  * co-operative manner. Main application must call this function repeatdly to ensure all open
  * or new connections are served on time.
@@ -303,16 +347,24 @@ void HTTPInit(void)
 void HTTPServer(void)
 {
     BYTE conn;
+    BYTE i;
 
     //If no activity for 2 minutes, log out
     //if (TickGetDiff16bit(lastActivity) >= ((TICK16)TICKS_PER_SECOND * (TICK16)120) ) {
         //Future code might implement an auto logout method again
     //}
 
-    //Process each connection
-    for ( conn = 0;  conn < MAX_HTTP_CONNECTIONS; conn++ ) {
+    //Process each connection, starting with a different one each time
+    conn = nextConn;
+    for ( i = 0;  i < MAX_HTTP_CONNECTIONS; i++ ) {
         HTTPProcess(conn);
+
+        if (++conn >= MAX_HTTP_CONNECTIONS)
+            conn = 0;
     }
+
+    if (++nextConn >= MAX_HTTP_CONNECTIONS)
+        nextConn = 0;
 }
 
 
@@ -453,25 +505,22 @@ BOOL HTTPGetRqstRes(TCP_SOCKET s, BYTE* rqstRes)
  */
 static void HTTPProcess(HTTP_HANDLE h)
 {
-    BYTE rqstRes[HTTP_MAX_RESOURCE_NAME_LEN + 1];
-
-    HTTP_COMMAND httpCommand;
     BOOL lbContinue;
     BYTE i; //Temp variable
     HTTP_INFO* ph;
+    HTTP_RQST* pr;
     ROM char* romString;
-    WORD rxBufPos;
-    
+    BYTE buf[8];
+
     union
     {
         struct
         {
-            unsigned char bHasParameters : 1;
             unsigned char bTemp : 1;
         } bits;
         BYTE val;
     } flags;
-    
+
 
     ph = &HCB[h];
 
@@ -490,235 +539,80 @@ static void HTTPProcess(HTTP_HANDLE h)
                 ph->flags.bits.bOwnsFile = FALSE;
                 fileClose(ph->file);
             }
-            
-            //Indicate that no user is logged in
-            ph->flags.bits.bUserLoggedIn = FALSE;
+
+            //Clear all flags, this also indicates that no user is logged in
+            ph->flags.val = 0;
+
+            //Forget all requests that have not been served yet
+            ph->rqstCount = 0;
 
             //Return to idle state
             ph->smHTTP = SM_HTTP_IDLE;
-            
+
             break;
         }
 
+        //We are receiving something via HTTP. All requests contained in the packet are read now, and
+        //served one after the other. The packet has to be discarded before the stack receives the next one.
+        if ( TCPIsGetReady(ph->socket) )
+        {
+            HTTPGetRqst(h);
+        }
+
         switch(ph->smHTTP)
         {
         case SM_HTTP_IDLE:
-            //We are receiving something via HTTP
-            if ( TCPIsGetReady(ph->socket) )
+            //Serve the oldest request that has not been served yet
+            if (ph->rqstCount != 0)
             {
                 lbContinue = TRUE;
-                lastActivity = TickGet16bit();
+                pr = &ph->rqst[0];
 
-                ph->flags.val = 0;  //Reset all flags
-                
-                //Read HTTP command from current socket. Is all text on first line till first space.
-                //When returning, socket will point to first character after the space trailing
-                //the command, which will be the requested resource.
-                httpCommand = HTTPGetCommand(ph->socket);
-
-                //Get NULL terminated requested resource in "rqstRes" variable.
-                //The requested resource is all text following command till first space or '?'.
-                //If there is any name-value parameters included in URI, this function will
-                //return true. If there is, this must be a remote command. Execute it and then
-                //send the requested resource (file). The file name may be modified by command
-                //handler. The returned requested resouce (in rqstRes) is all uppercase!
-                flags.bits.bHasParameters = HTTPGetRqstRes(ph->socket, rqstRes);
-                
-                //Save current position, which will be:
-                // - First character of parameters if there are any
-                // - First character of "HTTP Version" string if there are no parmeters
-                rxBufPos = TCPGetRxBufferPos(ph->socket);
-
-                //Parse all HTTP Headers here. The HTTP headers are all lines following the "Request Line".
-                HTTPParseHeader(h, rqstRes);
+                ph->flags = pr->flags;
+                ph->smHTTP = pr->smHTTP;
 
-                //Get filetype of requested resource
-                ph->var.get.fileType = HTTPGetRqstResFiletype(rqstRes);
-                
-                //Check if the current file type is a dynamic file, and if it is, set bit so it will
-                //be parsed. All %nnn tags in a dynamic file are replaced by CGI server.
-                if ( (ph->var.get.fileType == HTTP_FILETYPE_CGI)
-                    || ((ph->var.get.fileType == HTTP_FILETYPE_HTML) && HTTP_PARSE_FILETYPE_HTML)
-                    || ((ph->var.get.fileType == HTTP_FILETYPE_JS) && HTTP_PARSE_FILETYPE_JS) )
+                if (pr->smHTTP == SM_HTTP_GET_TX_HDR)
                 {
-                    ph->flags.bits.bProcess = TRUE;     /* This is a Dynamic File */
-                }
-                else {
-                    ph->flags.bits.bProcess = FALSE;
-                }
+                    ph->var.get.fileType = pr->var;
 
-                // Check if Authentication is required
-                // - Authentication required for all pages
-                // - Authentication required for all CGI files
-                // - Authentication required for all pages that start with X
-                // - Authentication required for all Dynamic files
-                // - Authentication required for all pages with GET Methods
-                if (    HTTP_AUTH_REQ_FOR_ALL_FILES
-                    || ((ph->var.get.fileType == HTTP_FILETYPE_CGI) && HTTP_AUTH_REQ_FOR_CGI)    /* CGI Files */
-                    || ((rqstRes[0] == 'X') && HTTP_AUTH_REQ_FOR_X_FILES)
-                    || (ph->flags.bits.bProcess && HTTP_AUTH_REQ_FOR_DYN)    /* Dynamic Files */
-                    || (HTTP_AUTH_REQ_FOR_GET && (httpCommand == HTTP_CMD_GET) && flags.bits.bHasParameters) )
-                {
-                    if (ph->flags.bits.bUserLoggedIn == FALSE) {
-                        
-                        #if (DEBUG_HTTP >= LOG_INFO)
-                        debugPutOffsetMsg(h, 22);   //@mxd:22:Page requested without Authentication given!
-                        #endif
-
-                        TCPDiscard(ph->socket); //We are finished with this socket - discard it
-                        
-                        ph->var.gen.msgCode = HTTP_AUTHENTICATION;  //Message code
-                        ph->smHTTP = SM_HTTP_AUTHENTICATION;        //State to enter
-                        break;
-                    }
-                }
-
-                /////////////////////////////////////////////////
-                // Received a GET Command
-                if (httpCommand == HTTP_CMD_GET)
-                {
-                    #if (DEBUG_HTTP >= LOG_DEBUG)
-                    debugPutOffsetMsg(h, 19);   //@mxd:19:HTTPGetRqstRes() got %s
-                    debugPutString(rqstRes);
-                    #endif
-
-                    //Remeber admin flag
-                    flags.bits.bTemp = ph->flags.bits.bUserLoggedIn;
-
-                    //If no Authorization is required to display secure tags, set user to Admin.
-                    //This causes all commands to be executed in the HTTPExecGetCmd() function below
-                    //If the program has gotten this far, it also means that no Authorization is required to
-                    //view this page, and no Authorization is required to issue CGI GET Commands.
-                    //So, no Authorization is required for ANYTHING!
-                    if (HTTP_AUTH_REQ_FOR_SECTAG == 0) {
-                        ph->flags.bits.bUserLoggedIn = 1;
-                    }
-
-                    //The URL contains name-value parameters!
-                    if (flags.bits.bHasParameters) {
-                    
-                        //Reset receive buffer read pointer to first byte of parameters
-                        TCPSetRxBuffer(ph->socket, rxBufPos);
-
-                        #if (DEBUG_HTTP >= LOG_DEBUG)
-                        debugPutOffsetMsg(h, 10);   //@mxd:10:Calling HTTPExecGetCmd() for GET parameters
-                        #endif
-
-                        /*
-                         * Let main application handle this remote command. It can modify the
-                         * requested resource to actual file that will be sent as a result of
-                         * this remote command.
-                         */
-                        HTTPExecGetCmd(ph, rqstRes);
-                    }
-                    
-                    //Restore logged in flag
-                    ph->flags.bits.bUserLoggedIn = flags.bits.bTemp;
-                    
-                    #if (DEBUG_HTTP >= LOG_INFO)
-                    debugPutOffsetMsg(h, 01);   //@mxd:01:Received GET command for %s
-                    debugPutString(rqstRes);
-                    #endif
-                    
-                    #if (DEBUG_HTTP >= LOG_DEBUG)
-                    debugPutOffsetMsg(h, 11);   //@mxd:11:Filetype of requested resource is %d
-                    debugPutByte(ph->var.get.fileType);
-                    #endif
-
-                    TCPDiscard(ph->socket); //We are finished with this socket - discard it
-                    
-                    // Login required
-                    if (ph->flags.bits.bLoginReq && (ph->flags.bits.bUserLoggedIn == FALSE)) {
-                        ph->var.gen.msgCode = HTTP_AUTHENTICATION;  //Message code
-                        ph->smHTTP = SM_HTTP_AUTHENTICATION;        //State to enter
-                        break;
-                    }
-                    
-                    ph->smHTTP = SM_HTTP_NOT_FOUND;
-
-                    //Try and open the requested resource. If not found, check if it is a zippable file. If it
-                    //is, rename it to it's zipped filename, and try open that. For example, if "file.htm" was
-                    //not found, try and open "file.zht"
-                    ph->file = fileOpen(rqstRes, 0);
-                    if ( !fileIsValidHandle(ph->file)) {
-                        //If this is a zipped file type, we do the following:
-                        if (isZippableFiletype(ph->var.get.fileType))
-                        {
-                            i = strlen((char *)rqstRes);
-                            
-                            //Zippable file's extension is 3 characters long
-                            if (is3CharZippableFiletype(ph->var.get.fileType)) {
-                                i -= 3; //Get index of first character of file extension
-                            }
-                            //Zippable file's extension is 2 characters long
-                            else {
-                                i -= 2; //Get index of first character of file extension
-                            }
-                        
-                            //Update fileType to zipped version. For example, if type was HTM, it is now ZHT
-                            ph->var.get.fileType = ph->var.get.fileType + OFFSET_ZIPPED_EXTENSION;
-                            
-                            //Rename the file extension to what it will be for the zipped file. For example, if
-                            //this file is *.htm, rename to *.zht
-                            strcpypgm2ram((char *)&rqstRes[i], (ROM char*)httpFiles[ph->var.get.fileType].fileExt);
-                                
-                            #if (DEBUG_HTTP >= LOG_DEBUG)
-                            debugPutOffsetMsg(h, 15);   //@mxd:15:Zipped file name = %s
-                            debugPutString(rqstRes);
-                            #endif
-                        
-                            //Try and open zippable version of this file
-                            ph->file = fileOpen(rqstRes, 0);
-                        }
-                    }
-                    
-                    if ( ph->file == FILE_INVALID )
-                    {
-                        ph->var.gen.msgCode = HTTP_NOT_FOUND;   //Message code
-                        ph->smHTTP = SM_HTTP_NOT_FOUND;
-                    }
-                    else if ( ph->file == FSYS_NOT_AVAILABLE )
+                    //Open the file at the FAT entry found when the request was received
+                    ph->file = fileOpenFAT(pr->fatPos);
+                    if ( !fileIsValidHandle(ph->file) )
                     {
                         ph->var.gen.msgCode = HTTP_NOT_AVAILABLE; //Message code
                         ph->smHTTP = SM_HTTP_NOT_FOUND;
+                        ph->flags.bits.bKeepAlive = FALSE;
                     }
                     else
                     {
                         ph->flags.bits.bOwnsFile = TRUE;    //Indicate that this HTTP Connection has an open file.
-                        
-                        //Initiate sending of a HTTP packet - GET responce
-                        ph->smHTTP = SM_HTTP_GET_TX_HDR;
 
                         #if (DEBUG_HTTP >= LOG_INFO)
                         debugPutOffsetMsg(h, 02);   //@mxd:02:Found requested file
                         #endif
                     }
                 }
-                /////////////////////////////////////////////////
-                // Received a POST Command
-                else if (httpCommand == HTTP_CMD_POST)
-                {
-                    //At this stage ph->socket will point to first character after the space trailing the
-                    //POST command in the HTTP Header
-
-                    //We will be receiving the POST header next
-                    ph->smHTTP = SM_HTTP_POST_RX_HDR;
-
-                    #if (DEBUG_HTTP >= LOG_INFO)
-                    debugPutOffsetMsg(h, 03);   //@mxd:03:Received POST command
-                    #endif
-                }
-                /////////////////////////////////////////////////
-                // Unknown Command
                 else
                 {
-                    #if (DEBUG_HTTP >= LOG_WARN)
-                    debugPutOffsetMsg(h, 12);   //@mxd:12:Received unknown HTTP command
-                    #endif
+                    ph->var.gen.msgCode = pr->var;  //Message code
                 }
+
+                //Remove request from queue
+                ph->rqstCount--;
+                for (i = 0; i < ph->rqstCount; i++) {
+                    ph->rqst[i] = ph->rqst[i + 1];
+                }
+            }
+            //Close a persistent connection if the client did not send a new request in time
+            else if ( ph->flags.bits.bKeepAlive
+                && (TickGetDiff16bit(ph->tick) >= ((TICK16)TICKS_PER_SECOND * (TICK16)HTTP_KEEPALIVE_TIMEOUT)) )
+            {
+                ph->flags.bits.bKeepAlive = FALSE;
+                ph->smHTTP = SM_HTTP_DISCONNECT;
+                lbContinue = TRUE;
             }
             break;
-            
+
         //Send HTTP Header responce for GET message received from client. The header consist of header fields, each terminated by a blank line.
         case SM_HTTP_GET_TX_HDR:
             if ( TCPIsPutReady(ph->socket) )
@@ -732,8 +626,13 @@ static void HTTPProcess(HTTP_HANDLE h)
                 /////////////////////////////////////////////////
                 //Send HTTP Responce message
                 
-                //Send HTTP Status header line = "HTTP/1.0 200 OK"
-                sendRomStr(h, HTTPMSG_RESPONSE_OK);
+                //Send HTTP Status header line = "HTTP/1.0 200 OK", or "HTTP/1.1 200 OK" for a HTTP/1.1 request
+                if (ph->flags.bits.bHttp11) {
+                    sendRomStr(h, HTTPMSG_RESPONSE_OK11);
+                }
+                else {
+                    sendRomStr(h, HTTPMSG_RESPONSE_OK);
+                }
                 sendLineEnd(h);     //Terminate with "CRLF" characters
                 
                 //Send "Content-Type: " header line = "Content-type: xxxx" with current content type
@@ -761,7 +660,46 @@ static void HTTPProcess(HTTP_HANDLE h)
                 //else {
                 //    sendRomStr(h, (ROM char*)"Cache-Control: max-age=0, must-revalidate\r\n");
                 //}
-                
+
+                //Send "Content-Length: n" for static files. The length of a dynamic file is not known in
+                //advance, so the client can only find the end of it when the connection is closed.
+                if (ph->flags.bits.bProcess == FALSE) {
+                    #if defined(FSEE_FILE_SIZE_16MB)
+                    //itoa() can only convert 16 bit values
+                    if (fileGetLength(ph->file) > 0xfffful) {
+                        ph->flags.bits.bKeepAlive = FALSE;
+                    }
+                    else
+                    #endif
+                    {
+                        sendRomStr(h, HTTPMSG_CONTENT_LENGTH);
+                        itoa((WORD)fileGetLength(ph->file), (char *)buf);
+                        i = strlen((char *)buf);
+
+                        //The TX Buffer was sent before the whole length was written. The part of the header
+                        //that was sent can not be taken back, so close the connection in stead of sending a
+                        //wrong length.
+                        if (TCPPutArray(ph->socket, buf, i) != i) {
+                            ph->flags.bits.bOwnsFile = FALSE;
+                            fileClose(ph->file);
+                            ph->flags.bits.bKeepAlive = FALSE;
+                            ph->rqstCount = 0;
+                            ph->smHTTP = SM_HTTP_DISCONNECT;
+                            break;
+                        }
+                        sendLineEnd(h);     //Terminate with "CRLF" characters
+                    }
+                }
+
+                //Tell client if the connection is kept open after this response. HTTP/1.1 connections are
+                //persistent by default, and HTTP/1.0 connections are closed by default.
+                if (ph->flags.bits.bKeepAlive) {
+                    sendRomStr(h, HTTPMSG_CONNECTION_KEEPALIVE);
+                }
+                else if (ph->flags.bits.bHttp11) {
+                    sendRomStr(h, HTTPMSG_CONNECTION_CLOSE);
+                }
+
                 //Send end of header string = a blank line
                 sendLineEnd(h);     //Terminate with "CRLF" characters
 
@@ -776,10 +714,6 @@ static void HTTPProcess(HTTP_HANDLE h)
             break;
         //Send HTTP body responce for GET message received from client = requested files conents
         case SM_HTTP_GET_TX_BODY:
-            if ( TCPIsGetReady(ph->socket) ) {
-                TCPDiscard(ph->socket);
-            }
-
             //Remeber admin flag
             flags.bits.bTemp = ph->flags.bits.bUserLoggedIn;
 
@@ -797,11 +731,20 @@ static void HTTPProcess(HTTP_HANDLE h)
                 ph->flags.bits.bOwnsFile = FALSE;    //Indicate that this HTTP Connection does NOT own a file.
                 
                 fileClose(ph->file);
-                ph->smHTTP = SM_HTTP_DISCONNECT;
 
                 #if (DEBUG_HTTP >= LOG_INFO)
                 debugPutOffsetMsg(h, 05);   //@mxd:05:Successfully sent file
                 #endif
+
+                //Persistent connection, wait for the next request
+                if (ph->flags.bits.bKeepAlive) {
+                    ph->tick = TickGet16bit();
+                    ph->smHTTP = SM_HTTP_IDLE;
+                    lbContinue = TRUE;
+                }
+                else {
+                    ph->smHTTP = SM_HTTP_DISCONNECT;
+                }
             }
             
             //Restore logged in flag
@@ -899,6 +842,398 @@ static void HTTPProcess(HTTP_HANDLE h)
     }
 }
 
+/**
+ * Reads all requests contained in the packet received on the given connection, and adds them to the
+ * connection's request queue. The name-value parameters of GET requests are executed now, and the
+ * FAT entry of the requested file is looked up. The packet is discarded when done.
+ *
+ * If the packet ends with an incomplete request, or the request queue is full, the connection is
+ * closed after the requests in the queue have been served. All requests that follow are ignored,
+ * and have to be sent again by the client on a new connection.
+ *
+ * @preCondition    TCPIsGetReady(s) != 0
+ *
+ * @param h         The HTTP handle
+ */
+static void HTTPGetRqst(HTTP_HANDLE h)
+{
+    BYTE rqstRes[HTTP_MAX_RESOURCE_NAME_LEN + 1];
+
+    HTTP_COMMAND httpCommand;
+    HTTP_INFO* ph;
+    HTTP_RQST* pr;
+    HTTP_FLAGS flagsActive;
+    WORD rxBufPos;
+    WORD rqstEnd;
+    BYTE fileType;
+    BOOL bComplete;
+
+    union
+    {
+        struct
+        {
+            unsigned char bHasParameters : 1;
+            unsigned char bTemp : 1;
+        } bits;
+        BYTE val;
+    } flags;
+
+
+    ph = &HCB[h];
+
+    //The request is parsed into ph->flags, seeing that HTTPProcessHdr() and HTTPExecGetCmd() use it.
+    //Remember flags of the response currently being sent, they are restored when done.
+    flagsActive = ph->flags;
+
+    while ( TCPGetRxCount(ph->socket) != 0 )
+    {
+        //Connection is closed after the last request that was accepted, ignore all that follow
+        if (ph->rqstCount != 0) {
+            if ( !ph->rqst[ph->rqstCount - 1].flags.bits.bKeepAlive )
+                break;
+        }
+        else if ((ph->smHTTP != SM_HTTP_IDLE) && !flagsActive.bits.bKeepAlive) {
+            break;
+        }
+
+        //Request queue is full. Close connection after last request in queue, client has to send the
+        //rest again.
+        if (ph->rqstCount >= HTTP_PIPELINE_DEPTH) {
+            ph->rqst[ph->rqstCount - 1].flags.bits.bKeepAlive = FALSE;
+            break;
+        }
+
+        lastActivity = TickGet16bit();
+
+        pr = &ph->rqst[ph->rqstCount];
+        pr->var = 0;
+        flags.val = 0;
+
+        ph->flags.val = 0;  //Reset all flags
+
+        //Read HTTP command from current socket. Is all text on first line till first space.
+        //When returning, socket will point to first character after the space trailing
+        //the command, which will be the requested resource.
+        httpCommand = HTTPGetCommand(ph->socket);
+
+        //Get NULL terminated requested resource in "rqstRes" variable.
+        //The requested resource is all text following command till first space or '?'.
+        //If there is any name-value parameters included in URI, this function will
+        //return true. If there is, this must be a remote command. Execute it and then
+        //send the requested resource (file). The file name may be modified by command
+        //handler. The returned requested resouce (in rqstRes) is all uppercase!
+        flags.bits.bHasParameters = HTTPGetRqstRes(ph->socket, rqstRes);
+
+        //The commands in the parameters of a GET request may only be executed when it is this request's
+        //turn, seeing that they can change what the requests before it return. The parameters can not be
+        //kept until then, so close the connection after the requests before it. Client has to send it again.
+        if ( flags.bits.bHasParameters && (httpCommand == HTTP_CMD_GET)
+            && ((ph->rqstCount != 0) || (ph->smHTTP != SM_HTTP_IDLE)) )
+        {
+            if (ph->rqstCount != 0) {
+                ph->rqst[ph->rqstCount - 1].flags.bits.bKeepAlive = FALSE;
+            }
+            else {
+                flagsActive.bits.bKeepAlive = FALSE;
+            }
+            break;
+        }
+
+        //Save current position, which will be:
+        // - First character of parameters if there are any
+        // - First character of "HTTP Version" string if there are no parmeters
+        rxBufPos = TCPGetRxBufferPos(ph->socket);
+
+        //Parse all HTTP Headers here. The HTTP headers are all lines following the "Request Line".
+        bComplete = HTTPParseHeader(h, rqstRes);
+
+        //Save position of first character after this request
+        rqstEnd = TCPGetRxBufferPos(ph->socket);
+
+        //Get filetype of requested resource
+        fileType = HTTPGetRqstResFiletype(rqstRes);
+
+        //Check if the current file type is a dynamic file, and if it is, set bit so it will
+        //be parsed. All %nnn tags in a dynamic file are replaced by CGI server.
+        if ( (fileType == HTTP_FILETYPE_CGI)
+            || ((fileType == HTTP_FILETYPE_HTML) && HTTP_PARSE_FILETYPE_HTML)
+            || ((fileType == HTTP_FILETYPE_JS) && HTTP_PARSE_FILETYPE_JS) )
+        {
+            ph->flags.bits.bProcess = TRUE;     /* This is a Dynamic File */
+        }
+        else {
+            ph->flags.bits.bProcess = FALSE;
+        }
+
+        // Check if Authentication is required
+        // - Authentication required for all pages
+        // - Authentication required for all CGI files
+        // - Authentication required for all pages that start with X
+        // - Authentication required for all Dynamic files
+        // - Authentication required for all pages with GET Methods
+        if ( (HTTP_AUTH_REQ_FOR_ALL_FILES
+            || ((fileType == HTTP_FILETYPE_CGI) && HTTP_AUTH_REQ_FOR_CGI)    /* CGI Files */
+            || ((rqstRes[0] == 'X') && HTTP_AUTH_REQ_FOR_X_FILES)
+            || (ph->flags.bits.bProcess && HTTP_AUTH_REQ_FOR_DYN)    /* Dynamic Files */
+            || (HTTP_AUTH_REQ_FOR_GET && (httpCommand == HTTP_CMD_GET) && flags.bits.bHasParameters))
+            && (ph->flags.bits.bUserLoggedIn == FALSE) )
+        {
+            #if (DEBUG_HTTP >= LOG_INFO)
+            debugPutOffsetMsg(h, 22);   //@mxd:22:Page requested without Authentication given!
+            #endif
+
+            pr->var = HTTP_AUTHENTICATION;      //Message code
+            pr->smHTTP = SM_HTTP_AUTHENTICATION;    //State to enter
+        }
+        /////////////////////////////////////////////////
+        // Received a GET Command
+        else if (httpCommand == HTTP_CMD_GET)
+        {
+            #if (DEBUG_HTTP >= LOG_DEBUG)
+            debugPutOffsetMsg(h, 19);   //@mxd:19:HTTPGetRqstRes() got %s
+            debugPutString(rqstRes);
+            #endif
+
+            //Remeber admin flag
+            flags.bits.bTemp = ph->flags.bits.bUserLoggedIn;
+
+            //If no Authorization is required to display secure tags, set user to Admin.
+            //This causes all commands to be executed in the HTTPExecGetCmd() function below
+            //If the program has gotten this far, it also means that no Authorization is required to
+            //view this page, and no Authorization is required to issue CGI GET Commands.
+            //So, no Authorization is required for ANYTHING!
+            if (HTTP_AUTH_REQ_FOR_SECTAG == 0) {
+                ph->flags.bits.bUserLoggedIn = 1;
+            }
+
+            //The URL contains name-value parameters!
+            if (flags.bits.bHasParameters) {
+
+                //Reset receive buffer read pointer to first byte of parameters
+                TCPSetRxBuffer(ph->socket, rxBufPos);
+
+                #if (DEBUG_HTTP >= LOG_DEBUG)
+                debugPutOffsetMsg(h, 10);   //@mxd:10:Calling HTTPExecGetCmd() for GET parameters
+                #endif
+
+                /*
+                 * Let main application handle this remote command. It can modify the
+                 * requested resource to actual file that will be sent as a result of
+                 * this remote command.
+                 */
+                HTTPExecGetCmd(ph, rqstRes);
+
+                //Continue with next request, if the packet was not discarded by reading past it's end
+                if ( TCPIsGetReady(ph->socket) ) {
+                    TCPSetRxBuffer(ph->socket, rqstEnd);
+                }
+            }
+
+            //Restore logged in flag
+            ph->flags.bits.bUserLoggedIn = flags.bits.bTemp;
+
+            #if (DEBUG_HTTP >= LOG_INFO)
+            debugPutOffsetMsg(h, 01);   //@mxd:01:Received GET command for %s
+            debugPutString(rqstRes);
+            #endif
+
+            // Login required
+            if (ph->flags.bits.bLoginReq && (ph->flags.bits.bUserLoggedIn == FALSE)) {
+                pr->var = HTTP_AUTHENTICATION;      //Message code
+                pr->smHTTP = SM_HTTP_AUTHENTICATION;    //State to enter
+            }
+            else {
+                //Find the requested resource in the FAT. The file is only opened when the request is served.
+                pr->fatPos = HTTPFindFile(h, rqstRes, &fileType);
+
+                #if (DEBUG_HTTP >= LOG_DEBUG)
+                debugPutOffsetMsg(h, 11);   //@mxd:11:Filetype of requested resource is %d
+                debugPutByte(fileType);
+                #endif
+
+                if (pr->fatPos == FSYS_POS_NOT_FOUND)
+                {
+                    pr->var = HTTP_NOT_FOUND;       //Message code
+                    pr->smHTTP = SM_HTTP_NOT_FOUND;
+                }
+                else if (pr->fatPos == FSYS_POS_NOT_AVAILABLE)
+                {
+                    pr->var = HTTP_NOT_AVAILABLE;   //Message code
+                    pr->smHTTP = SM_HTTP_NOT_FOUND;
+                }
+                else
+                {
+                    pr->var = fileType;
+
+                    //Initiate sending of a HTTP packet - GET responce
+                    pr->smHTTP = SM_HTTP_GET_TX_HDR;
+                }
+            }
+        }
+        /////////////////////////////////////////////////
+        // Received a POST Command
+        else if (httpCommand == HTTP_CMD_POST)
+        {
+            //We will be receiving the POST header next
+            pr->smHTTP = SM_HTTP_POST_RX_HDR;
+
+            #if (DEBUG_HTTP >= LOG_INFO)
+            debugPutOffsetMsg(h, 03);   //@mxd:03:Received POST command
+            #endif
+        }
+        /////////////////////////////////////////////////
+        // Unknown Command
+        else
+        {
+            pr->smHTTP = SM_HTTP_DISCONNECT;
+
+            #if (DEBUG_HTTP >= LOG_WARN)
+            debugPutOffsetMsg(h, 12);   //@mxd:12:Received unknown HTTP command
+            #endif
+        }
+
+        //The connection can only be kept open after sending a static file that was requested with a
+        //complete request. The client can find the end of it with the "Content-Length" header.
+        if ( (pr->smHTTP != SM_HTTP_GET_TX_HDR) || ph->flags.bits.bProcess || !bComplete
+            || (HTTP_KEEPALIVE_TIMEOUT == 0) )
+        {
+            ph->flags.bits.bKeepAlive = FALSE;
+        }
+
+        pr->flags = ph->flags;
+        ph->rqstCount++;
+    }
+
+    //We are finished with this socket - discard it
+    if ( TCPIsGetReady(ph->socket) ) {
+        TCPDiscard(ph->socket);
+    }
+
+    //Restore flags of the response currently being sent
+    ph->flags = flagsActive;
+}
+
+
+/**
+ * Finds the given resource in the FAT. If it is not found, and it is a zippable file type, it's zipped
+ * version is looked for. For example, if "file.htm" was not found, "file.zht" is looked for.
+ * The result is kept in the FAT lookup cache, and the FAT is only searched if the resource is not in
+ * the cache. The cache is cleared each time a new File System Image is written.
+ *
+ * @param h             The HTTP handle
+ * @param rqstRes       Requested resource string, in upper case! Is changed to the zipped file name
+ *                      if the zipped version of the file was found.
+ * @param fileType      File type of the requested resource, is a HTTP_FILETYPE_XXX constant. Is changed
+ *                      to the zipped file type if the zipped version of the file was found.
+ *
+ * @return              FAT entry of the file, FSYS_POS_NOT_FOUND if the file was not found, or
+ *                      FSYS_POS_NOT_AVAILABLE if the File System is not available.
+ */
+static FSYS_POS HTTPFindFile(HTTP_HANDLE h, BYTE* rqstRes, BYTE* fileType)
+{
+    FSYS_POS fatPos;
+    BYTE i;
+    BYTE bZipped;
+    #if (HTTP_FAT_CACHE_SIZE > 0)
+    HTTP_FAT_CACHE* pc;
+    WORD hash;
+    BYTE* p;
+    #endif
+
+    #if (HTTP_FAT_CACHE_SIZE > 0)
+    //Clear cache if the File System has changed since it was filled
+    if (fatCacheChangeCount != fsysChangeCount) {
+        fatCacheChangeCount = fsysChangeCount;
+        for (i = 0; i < HTTP_FAT_CACHE_SIZE; i++) {
+            fatCache[i].name[0] = '\0';
+        }
+    }
+
+    //Get hash of name. Only names with the same hash have to be compared
+    hash = 0;
+    for (p = rqstRes; *p != '\0'; p++) {
+        hash = (hash << 3) + (hash >> 13) + *p;
+    }
+
+    //Search cache
+    for (i = 0; i < HTTP_FAT_CACHE_SIZE; i++) {
+        pc = &fatCache[i];
+        if ( (pc->hash == hash) && (pc->name[0] != '\0') && (strcmp((char *)pc->name, (char *)rqstRes) == 0) ) {
+            bZipped = pc->bZipped;
+            fatPos = pc->fatPos;
+            break;
+        }
+    }
+
+    //Found in cache
+    if (i < HTTP_FAT_CACHE_SIZE) {
+        if (bZipped) {
+            i = strlen((char *)rqstRes) - (is3CharZippableFiletype(*fileType) ? 3 : 2);
+            *fileType = *fileType + OFFSET_ZIPPED_EXTENSION;
+            strcpypgm2ram((char *)&rqstRes[i], (ROM char*)httpFiles[*fileType].fileExt);
+        }
+
+        return fatPos;
+    }
+
+    //Not found, replace oldest entry. Save name now, seeing that rqstRes might be changed below
+    pc = &fatCache[fatCacheNext];
+    strcpy((char *)pc->name, (char *)rqstRes);
+    pc->hash = hash;
+    #endif
+
+    bZipped = FALSE;
+    fatPos = fileGetFAT(rqstRes);
+
+    //If not found, and this is a zippable file, try the zipped version
+    if ( (fatPos == FSYS_POS_NOT_FOUND) && isZippableFiletype(*fileType) )
+    {
+        i = strlen((char *)rqstRes);
+        
+        //Zippable file's extension is 3 characters long
+        if (is3CharZippableFiletype(*fileType)) {
+            i -= 3; //Get index of first character of file extension
+        }
+        //Zippable file's extension is 2 characters long
+        else {
+            i -= 2; //Get index of first character of file extension
+        }
+    
+        //Update fileType to zipped version. For example, if type was HTM, it is now ZHT
+        *fileType = *fileType + OFFSET_ZIPPED_EXTENSION;
+        
+        //Rename the file extension to what it will be for the zipped file. For example, if
+        //this file is *.htm, rename to *.zht
+        strcpypgm2ram((char *)&rqstRes[i], (ROM char*)httpFiles[*fileType].fileExt);
+            
+        #if (DEBUG_HTTP >= LOG_DEBUG)
+        debugPutOffsetMsg(h, 15);   //@mxd:15:Zipped file name = %s
+        debugPutString(rqstRes);
+        #endif
+    
+        //Try and find zippable version of this file
+        fatPos = fileGetFAT(rqstRes);
+        bZipped = TRUE;
+    }
+
+    #if (HTTP_FAT_CACHE_SIZE > 0)
+    //Don't remember anything if the File System was not available
+    if (fatPos == FSYS_POS_NOT_AVAILABLE) {
+        pc->name[0] = '\0';
+    }
+    else {
+        pc->fatPos = fatPos;
+        pc->bZipped = bZipped;
+
+        if (++fatCacheNext >= HTTP_FAT_CACHE_SIZE)
+            fatCacheNext = 0;
+    }
+    #endif
+
+    return fatPos;
+}
+
+
 /**
  * Writes the name and value string to given param buffer. Both strings are
  * NULL terminated. On return name and value string can be accessed as follows: <br>
@@ -1043,8 +1378,11 @@ static BOOL sendFile(HTTP_HANDLE h)
 {
     BOOL lbTransmit;
     BYTE c;
+    WORD i;
+    WORD n;
     HTTP_INFO* ph;
     static GETTAG_INFO getTagInfo;
+    static BYTE buf[HTTP_TX_ARRAY_SIZE];
 
     #if (DEBUG_HTTP >= LOG_INFO)
     BOOL bSomethingWasSent;
@@ -1061,6 +1399,50 @@ static BOOL sendFile(HTTP_HANDLE h)
         bSomethingWasSent = TRUE;
         #endif
         
+        //Static file. Read as many bytes as the socket can take, and write them with a single
+        //TCPPutArray() call. This uses one Remote DMA transfer, in stead of one per byte.
+        if ( !ph->flags.bits.bProcess )
+        {
+            n = TCPGetPutSpace(ph->socket);
+            if (n > sizeof(buf))
+                n = sizeof(buf);
+            //Remote node's receive window is full
+            else if (n == 0)
+                break;
+
+            for (i = 0; (i < n) && !fileIsEOF(ph->file); i++)
+            {
+                buf[i] = fileGetByte(ph->file);
+
+                //If error, finish transmisstion. Close the connection, seeing that less bytes were sent
+                //then given in the "Content-Length" header.
+                if (fileHasError(ph->file)) {
+                    #if (DEBUG_HTTP >= LOG_ERROR)
+                    debugPutMsg(9);   //@mxd:9:Error while reading file
+                    #endif
+                    ph->flags.bits.bKeepAlive = FALSE;
+                    TCPFlush(ph->socket);
+                    return TRUE;
+                }
+            }
+
+            if (i != 0)
+                TCPPutArray(ph->socket, buf, i);
+
+            //If file has reached end, finish transmission
+            if ( fileIsEOF(ph->file) ) {
+                #if (DEBUG_HTTP >= LOG_INFO)
+                debugPutMsg(8);   //@mxd:8:Reached EOF
+                #endif
+
+                TCPFlush(ph->socket);
+                return TRUE;
+            }
+
+            FAST_USER_PROCESS();
+            continue;
+        }
+
         //Get next character from file system
         if ( ph->smHTTPSub != SM_HTTP_GET_VAR )
         {
@@ -1137,20 +1519,18 @@ static BOOL sendFile(HTTP_HANDLE h)
 
                 ph->smHTTPSub = SM_HTTP_GET_VAR;
                 ph->var.get.varRef = HTTP_START_OF_VAR;
-
-                //Initialize GETTAG_INFO structure
-                getTagInfo.ref = HTTP_START_OF_VAR;
-                getTagInfo.tagVal   = ph->var.get.tagVal;       //Value of requested tag
-                getTagInfo.tagGroup = ph->var.get.tagGroup;     //Group of requested tag
-                getTagInfo.val      = &c;
-                getTagInfo.user = HTTPGetCurrentUser(ph);       //Get the current user logged in for this HTTP connection
-            
                 break;
             case SM_HTTP_GET_VAR:
                 //Not handled in HTTPGetVar() any more, now use cmdGetTag() function
                 //ph->var.get.varRef = HTTPGetVar(ph, &c);
 
+                //Initialize GETTAG_INFO structure. Is done for each call, seeing that it is shared by all
+                //connections, and other connections can be served while this tag is being sent.
                 getTagInfo.ref = ph->var.get.varRef;       //Current callback reference with respect to 'var' variable.
+                getTagInfo.tagVal   = ph->var.get.tagVal;       //Value of requested tag
+                getTagInfo.tagGroup = ph->var.get.tagGroup;     //Group of requested tag
+                getTagInfo.val      = &c;
+                getTagInfo.user = HTTPGetCurrentUser(ph);       //Get the current user logged in for this HTTP connection
                 cmdGetTag(&getTagInfo);
                 ph->var.get.varRef = getTagInfo.ref;
 
@@ -1171,8 +1551,6 @@ static BOOL sendFile(HTTP_HANDLE h)
             if ( lbTransmit )
                 TCPPut(ph->socket, c);
         }
-        else
-            TCPPut(ph->socket, c);
             
         FAST_USER_PROCESS();
     }
@@ -1223,35 +1601,57 @@ static void sendRomStr(HTTP_HANDLE h, ROM char* s) {
  * Parse all HTTP headers
  * Note:    - When entering this function, s will point to first character after the space
  *            trailing this command.
+ *          - When leaving this function, s will point to first character after the blank line
+ *            that ends the HTTP headers. This is the first character of the next request, if the
+ *            client sent more then one request in this packet.
+ *
+ * The bHttp11 flag is set if this is a HTTP/1.1 request, and the bKeepAlive flag is set if the
+ * client requests the connection to be kept open after the response.
  *
  * @preCondition    TCPIsGetReady(s) != 0
  *
  * @param h         The HTTP handle
  * @param rqstRes   Requested resource string, in upper case!
+ *
+ * @return          TRUE if the complete request was read, FALSE if the end of the packet was
+ *                  reached before the end of the HTTP headers
  */
-static void HTTPParseHeader(HTTP_HANDLE h, BYTE* rqstRes) {
+static BOOL HTTPParseHeader(HTTP_HANDLE h, BYTE* rqstRes) {
     HTTP_INFO* ph;
     BYTE buf[128];
     BYTE index;
     BYTE c;
     BYTE i;
     WORD_VAL retLen;    //Variable to store return value and length
-    
+    BYTE bClose;        //Client sent "Connection: close" header
+    BYTE bKeepAlive;    //Client sent "Connection: keep-alive" header
+
     ph = &HCB[h];
-    
-    //Increment s to first HTTP header line
-    c = 4;  //Give up the search after searching 4 x 256 = 1024 bytes
-    while ( (TCPGetArrayChr(ph->socket, NULL, 255, '\n')>>8) != TCP_GETARR_TRM) {
-        if (c-- == 0) {
-            return;
+    bClose = FALSE;
+    bKeepAlive = FALSE;
+
+    //Increment s to first HTTP header line. The last part of the Request Line is the HTTP Version,
+    //for example "HTTP/1.1\r\n"
+    c = 8;  //Give up the search after searching 8 x 128 = 1024 bytes
+    while (1) {
+        retLen.Val = TCPGetArrayChr(ph->socket, buf, sizeof(buf), '\n');
+
+        if (retLen.byte.MSB == TCP_GETARR_TRM) {
+            i = retLen.byte.LSB;
+            if ((i >= 5) && (buf[i-5] == '1') && (buf[i-4] == '.') && (buf[i-3] == '1')) {
+                ph->flags.bits.bHttp11 = TRUE;
+            }
+            break;
+        }
+
+        //End of packet reached, or Request Line is too long
+        if ((retLen.byte.MSB != TCP_GETARR_ALL) || (c-- == 0)) {
+            return FALSE;
         }
     }
 
 
     //Read all HTTP header lines, each lines end with CRLF (\r\n) character sequence
-    // !!! Important !!!
-    //Do NOT read last character of header (LF character)! This is normally the last character
-    //of the packet, and will trigger the packet to be discarded!
     while(1) {
         retLen.Val = TCPGetArrayChr(ph->socket, buf, 128, '\r');
         
@@ -1263,7 +1663,7 @@ static void HTTPParseHeader(HTTP_HANDLE h, BYTE* rqstRes) {
                     #if (DEBUG_HTTP >= LOG_WARN)
                     debugPutMsg(21);    //@mxd:21:End of HTTP Header not found
                     #endif
-                    break;
+                    return FALSE;
                 }
             }
             
@@ -1273,17 +1673,22 @@ static void HTTPParseHeader(HTTP_HANDLE h, BYTE* rqstRes) {
         }
 
         //If 'r' character was NOT found
-        if (retLen.byte.MSB != TCP_GETARR_TRM) break;
-        
+        if (retLen.byte.MSB != TCP_GETARR_TRM) {
+            return FALSE;
+        }
+
+        //Skip LF character that always follows the CR. Only read it if it is there, else the packet
+        //is discarded!
+        if (TCPGetRxCount(ph->socket) != 0) {
+            TCPGet(ph->socket, &c);
+        }
+
         //If bytes read = 1 (only CR was read), this is an empty line = end of HTTP headers!
         if (retLen.byte.LSB == 1) {
             //End of HTTP headers, break
             break;
         }
         
-        //Skip LF character that always follows the CR
-        TCPGet(ph->socket, &c);
-        
         //Replace CR character with string terminating NULL
         buf[retLen.byte.LSB-1] = '\0';  //Null terminate
 
@@ -1295,7 +1700,20 @@ static void HTTPParseHeader(HTTP_HANDLE h, BYTE* rqstRes) {
         #endif
 
         //Handle HTTP header!
-        
+
+        //Check "Connection" header, it can be "close" or "keep-alive"
+        if (strBeginsWithIC((char *)buf, (ROM char *)"CONNECTION:")) {
+            //Skip white space following ':' character
+            for (i = 11; buf[i] == ' '; i++);
+
+            if (strBeginsWithIC((char *)&buf[i], (ROM char *)"CLOSE")) {
+                bClose = TRUE;
+            }
+            else if (strBeginsWithIC((char *)&buf[i], (ROM char *)"KEEP-ALIVE")) {
+                bKeepAlive = TRUE;
+            }
+        }
+
         /////////////////////////////////////////////////
         //If the user implements HTTP Header processing, call it here!
         #if defined(HTTP_USER_PROCESSES_HEADERS)
@@ -1308,6 +1726,17 @@ static void HTTPParseHeader(HTTP_HANDLE h, BYTE* rqstRes) {
             ph->flags.bits.bUserLoggedIn = TRUE;
         #endif
     }
+
+    //HTTP/1.1 connections are persistent, unless the client closes them. HTTP/1.0 connections are only
+    //persistent if the client asks for it.
+    if (ph->flags.bits.bHttp11) {
+        ph->flags.bits.bKeepAlive = !bClose;
+    }
+    else {
+        ph->flags.bits.bKeepAlive = bKeepAlive;
+    }
+
+    return TRUE;
 }
 
 /**
@@ -60,6 +60,22 @@
  //the HTTPProcessHdr() callback function must be implemented by the user
  #define HTTP_USER_PROCESSES_HEADERS
 
+ //Size of buffer used for sending static files. Each time it is filled, it is written to the
+ //TCP socket with a single TCPPutArray() call. Default is 32
+ #define HTTP_TX_ARRAY_SIZE (32)
+
+ //Time in seconds that a persistent (keep-alive) connection is kept open without receiving a new
+ //request. Define as 0 to close the connection after each response. Default is 10
+ #define HTTP_KEEPALIVE_TIMEOUT (10)
+
+ //Number of pipelined requests that can be queued for each connection. Each entry consumes 6 bytes
+ //per connection. Default is 2
+ #define HTTP_PIPELINE_DEPTH (2)
+
+ //Number of entries in the RAM cache of FAT lookups. Each entry consumes 19 bytes. Define as 0 to
+ //search the File System for each request. Default is 4
+ #define HTTP_FAT_CACHE_SIZE (4)
+
  @endcode
  *********************************************************************/
 
@@ -95,6 +111,9 @@
  *    - Rev 2.0 (See version.log for detail)
  * 2005-09-01, David Hosken (DH):
  *    - Created documentation for existing code
+ * 2026-10-17:
+ *    - Added HTTP_TX_ARRAY_SIZE
+ *    - Added persistent connections, pipelined requests and the FAT lookup cache
  *********************************************************************/
 
 
@@ -341,6 +360,26 @@ For a list of all tags, see @ref mod_tags_defined
 #define HTTP_START_OF_VAR       (0x0000ul)
 #define HTTP_END_OF_VAR         (0xFFFFul)
 
+#if !defined(HTTP_TX_ARRAY_SIZE)        //To change this default value, define it in projdefs.h
+#define HTTP_TX_ARRAY_SIZE      (32)
+#endif
+
+#if !defined(HTTP_KEEPALIVE_TIMEOUT)    //To change this default value, define it in projdefs.h
+#define HTTP_KEEPALIVE_TIMEOUT  (10)
+#endif
+
+#if !defined(HTTP_PIPELINE_DEPTH)       //To change this default value, define it in projdefs.h
+#define HTTP_PIPELINE_DEPTH     (2)
+#endif
+
+#if !defined(HTTP_FAT_CACHE_SIZE)       //To change this default value, define it in projdefs.h
+#define HTTP_FAT_CACHE_SIZE     (4)
+#endif
+
+#if (HTTP_PIPELINE_DEPTH < 1)
+#error HTTP : HTTP_PIPELINE_DEPTH must be at least 1
+#endif
+
 
 /////////////////////////////////////////////////
 // HTTP FSM states for each connection.
@@ -378,6 +417,35 @@ typedef enum _SM_HTTP_POST
 } SM_HTTP_POST;
 
 
+/////////////////////////////////////////////////
+// HTTP Connection flags
+typedef union _HTTP_FLAGS
+{
+    struct
+    {
+        unsigned int bProcess : 1;      /* Indicates if this is a Dynamic File */
+        unsigned int bOwnsFile : 1;     /* Indicate if this HTTP Connection currently has a file open. If true, file will contain file's FILE handle */
+        unsigned int bUserLoggedIn : 1; /* Indicates that the Admin or Super user is currently logged in, see bUserSuper to see which one it is! */
+        unsigned int bUserSuper : 1;    /* Indicates that the Admin user is currently logged in */
+        unsigned int bLoginReq : 1;     /* Indicates that the user is required to log in for this page to be displayed */
+        unsigned int bKeepAlive : 1;    /* Connection is kept open after the response to this request */
+        unsigned int bHttp11 : 1;       /* Request was a HTTP/1.1 request */
+    } bits;
+    BYTE val;
+} HTTP_FLAGS;
+
+
+/////////////////////////////////////////////////
+// Received HTTP request that still has to be served
+typedef struct _HTTP_RQST
+{
+    FSYS_POS    fatPos;     /* FAT entry of requested file, if smHTTP is SM_HTTP_GET_TX_HDR */
+    BYTE        smHTTP;     /* State to enter when this request is served */
+    BYTE        var;        /* File type (HTTP_FILETYPE_XXX) or message code, depending on smHTTP */
+    HTTP_FLAGS  flags;      /* Connection flags after the request was parsed */
+} HTTP_RQST;
+
+
 /////////////////////////////////////////////////
 // HTTP Connection Info - one for each connection.
 typedef struct _HTTP_INFO
@@ -386,6 +454,9 @@ typedef struct _HTTP_INFO
     FILE file;
     SM_HTTP smHTTP;     //State of main HTTP Server state machine
     BYTE smHTTPSub;     //State of any sub state machines
+    TICK16 tick;        //Time the last response was finished, used for keep-alive timeout
+    BYTE rqstCount;     //Number of requests in rqst[] that still have to be served
+    HTTP_RQST rqst[HTTP_PIPELINE_DEPTH];    //Received requests, oldest first
 
     //The following union contains variables used by different parts of the HTTP state maschine
     union {
@@ -411,17 +482,7 @@ typedef struct _HTTP_INFO
         } post;
     } var;
 
-    union {
-        struct
-        {
-            unsigned int bProcess : 1;      /* Indicates if this is a Dynamic File */
-            unsigned int bOwnsFile : 1;     /* Indicate if this HTTP Connection currently has a file open. If true, file will contain file's FILE handle */
-            unsigned int bUserLoggedIn : 1; /* Indicates that the Admin or Super user is currently logged in, see bUserSuper to see which one it is! */
-            unsigned int bUserSuper : 1;    /* Indicates that the Admin user is currently logged in */
-            unsigned int bLoginReq : 1;     /* Indicates that the user is required to log in for this page to be displayed */
-        } bits;
-        BYTE val;
-    } flags;
+    HTTP_FLAGS flags;
 
 } HTTP_INFO;
 
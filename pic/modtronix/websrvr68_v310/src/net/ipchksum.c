@@ -0,0 +1,98 @@
+/**
+ * @brief           Running IP Checksum for Modtronix TCP/IP Stack
+ * @file            ipchksum.c
+ * @author          <a href="www.modtronix.com">Modtronix Engineering</a>
+ * @dependencies    none
+ * @compiler        MPLAB C18 v2.10 or higher <br>
+ *                  HITECH PICC-18 V8.35PL3 or higher
+ **********************************************************************
+ * Software License Agreement
+ *
+ * The software supplied herewith is owned by Modtronix Engineering, and is
+ * protected under applicable copyright laws. The software supplied herewith is
+ * intended and supplied to you, the Company customer, for use solely and
+ * exclusively on products manufactured by Modtronix Engineering. The code may
+ * be modified and can be used free of charge for commercial and non commercial
+ * applications. All rights are reserved. Any use in violation of the foregoing
+ * restrictions may subject the user to criminal sanctions under applicable laws,
+ * as well as to civil liability for the breach of the terms and conditions of this license.
+ *
+ * THIS SOFTWARE IS PROVIDED IN AN 'AS IS' CONDITION. NO WARRANTIES, WHETHER EXPRESS,
+ * IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE
+ * COMPANY SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ **********************************************************************
+ * File History
+ *
+ * 2026-10-17:
+ *    - Initial version
+ *********************************************************************/
+
+#include "projdefs.h"
+#include "net\checkcfg.h"
+#include "net\ipchksum.h"
+
+
+/**
+ * Adds the given bytes to the given running sum.
+ *
+ * @param sum       Pointer to running sum
+ * @param buffer    Bytes to add
+ * @param count     Number of bytes to add
+ * @param bOdd      TRUE if the first byte is at an odd offset from the start of the checksummed data
+ */
+void IPChecksumAddArray(IP_CHECKSUM *sum, BYTE *buffer, WORD count, BOOL bOdd)
+{
+    WORD_VAL w;
+    DWORD s;
+
+    if (count == 0)
+        return;
+
+    s = *sum;
+
+    //First byte is the MSB of a word, add it so the rest starts on a word boundary
+    if (bOdd)
+    {
+        s += ((WORD)*buffer++) << 8;
+        count--;
+    }
+
+    //Add all 16 bit words, first byte is the LSB
+    while (count >= 2)
+    {
+        w.v[0] = *buffer++;
+        w.v[1] = *buffer++;
+        s += w.Val;
+        count -= 2;
+    }
+
+    //Trailing byte is the LSB of a word
+    if (count)
+        s += *buffer;
+
+    *sum = s;
+}
+
+
+/**
+ * Folds the given running sum to 16 bits.
+ *
+ * @param sum       Running sum
+ *
+ * @return          16 bit one's complement sum
+ */
+WORD IPChecksumFold(IP_CHECKSUM sum)
+{
+    DWORD_VAL s;
+
+    s.Val = sum;
+
+    //Add carries back in until there are none left
+    while (s.word.MSW != 0) {
+        s.Val = (DWORD)s.word.LSW + (DWORD)s.word.MSW;
+    }
+
+    return s.word.LSW;
+}
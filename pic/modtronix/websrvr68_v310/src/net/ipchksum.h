@@ -0,0 +1,89 @@
+/**
+ * @brief           Running IP Checksum for Modtronix TCP/IP Stack
+ * @file            ipchksum.h
+ * @author          <a href="www.modtronix.com">Modtronix Engineering</a>
+ * @dependencies    none
+ * @compiler        MPLAB C18 v2.10 or higher <br>
+ *                  HITECH PICC-18 V8.35PL3 or higher
+ * @ingroup         mod_tcpip_base
+ *
+ * @section description Description
+ **********************************
+ * Functions for calculating the 16 bit one's complement checksum used by IP, TCP and UDP
+ * (RFC 1071) a few bytes at a time. The MAC adds each byte written to a TX Buffer to a
+ * running checksum (see MACGetTxSum()), so the TCP and UDP layers don't have to read
+ * the data back from the NIC to calculate the checksum before sending a segment.
+ *
+ * The sum is kept in a DWORD, and only folded to 16 bits when it is read. Bytes at even
+ * offsets are added as the LSB of a 16 bit word, the same as CalcIPChecksum() does. This
+ * means a folded sum can be combined with values returned by CalcIPChecksum(). A DWORD
+ * can hold the sum of more than 64K words, much more than a single frame.
+ *********************************************************************/
+
+ /*********************************************************************
+ * Software License Agreement
+ *
+ * The software supplied herewith is owned by Modtronix Engineering, and is
+ * protected under applicable copyright laws. The software supplied herewith is
+ * intended and supplied to you, the Company customer, for use solely and
+ * exclusively on products manufactured by Modtronix Engineering. The code may
+ * be modified and can be used free of charge for commercial and non commercial
+ * applications. All rights are reserved. Any use in violation of the foregoing
+ * restrictions may subject the user to criminal sanctions under applicable laws,
+ * as well as to civil liability for the breach of the terms and conditions of this license.
+ *
+ * THIS SOFTWARE IS PROVIDED IN AN 'AS IS' CONDITION. NO WARRANTIES, WHETHER EXPRESS,
+ * IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE
+ * COMPANY SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ **********************************************************************
+ * File History
+ *
+ * 2026-10-17:
+ *    - Initial version
+ *********************************************************************/
+
+#ifndef IPCHKSUM_H
+#define IPCHKSUM_H
+
+
+/**
+ * Running one's complement sum, see IPChecksumAddByte() and IPChecksumAddArray().
+ * Set to 0 to start a new sum.
+ */
+typedef DWORD IP_CHECKSUM;
+
+
+/**
+ * Adds the given byte to the given running sum.
+ *
+ * @param sum   IP_CHECKSUM variable to add byte to
+ * @param b     Byte to add
+ * @param bOdd  Non zero if the byte is at an odd offset from the start of the checksummed data
+ */
+#define IPChecksumAddByte(sum, b, bOdd) ((sum) += ((bOdd) ? (((WORD)(b)) << 8) : (WORD)(b)))
+
+
+/**
+ * Adds the given bytes to the given running sum.
+ *
+ * @param sum       Pointer to running sum
+ * @param buffer    Bytes to add
+ * @param count     Number of bytes to add
+ * @param bOdd      TRUE if the first byte is at an odd offset from the start of the checksummed data
+ */
+void IPChecksumAddArray(IP_CHECKSUM *sum, BYTE *buffer, WORD count, BOOL bOdd);
+
+
+/**
+ * Folds the given running sum to 16 bits. The returned value is NOT complemented, it is
+ * the same as ~CalcIPChecksum() for the same data.
+ *
+ * @param sum       Running sum
+ *
+ * @return          16 bit one's complement sum
+ */
+WORD IPChecksumFold(IP_CHECKSUM sum);
+
+#endif
@@ -34,6 +34,13 @@
  * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
  *********************************************************************
  * File History
+ * 2026-10-17:
+ *    - The TX byte count is saved for each TX Buffer and set in MACFlush(), so a
+ *      reserved buffer can be sent again with MACSetTxBuffer() and MACFlush()
+ *    - MACPut() and MACPutArray() keep a running checksum of all bytes written, see MACGetTxSum().
+ *      It is kept for each TX Buffer, and saved and restored by MACSetTxBuffer()
+ *    - MACGetArray() splits reads that include the last byte of the RX Buffer, the same
+ *      RTL8019AS bug MACGet() works around corrupted that byte during bulk reads
  * 2008-07-10, David Hosken (DH):
  *    - Added some extra code for resetting the NIC
  * 2006-05-25, David Hosken (DH):
@@ -103,6 +110,7 @@
 #include "net\checkcfg.h" 
 #include "net\mac.h"
 #include "net\helpers.h"
+#include "net\ipchksum.h"
 #include "net\delay.h"
 #include "debug.h"
 
@@ -276,6 +284,8 @@ typedef struct _IEEE_HEADER
 typedef struct _DATA_BUFFER
 {
     BYTE Index; //Page of this buffer in NIC's SRAM
+    WORD Length; //Size of the packet in this buffer, set by MACPutHeader()
+    IP_CHECKSUM Sum; //Running checksum of this buffer, saved while another TX Buffer is active
     
     struct
     {
@@ -357,6 +367,13 @@ BYTE LastTXedBuffer;
 
 BYTE iochrdyCnt;
 
+//Running checksum of all bytes written with MACPut() and MACPutArray() since MACClearTxSum() was called.
+//TX Buffers start on a page boundary, so the parity of the Remote DMA address gives the position of a byte
+//in the IP, TCP and UDP headers and data, which all start at even offsets.
+//It belongs to CurrentTxBuffer. MACSetTxBuffer() saves it to TxBuffers[].Sum and loads the sum of the
+//new buffer, so a TCP segment that is half written keeps its sum while an ARP, ICMP or UDP frame is built.
+static IP_CHECKSUM MACTxSum;
+
 
 #ifdef MAC_CNTR1_3
 WORD_VAL cntr0;
@@ -373,6 +390,7 @@ void NICReset(void);
 void NICPut(BYTE reg, BYTE val);
 BYTE NICGet(BYTE reg);
 void NICSetAddr(WORD_VAL addr);
+static WORD MACGetArrayDma(BYTE *val, WORD len);
 
 void    MACInit(void)
 {
@@ -811,6 +829,8 @@ void MACPut(BYTE val)
     // TODO Is this needed??
     //WaitForDmaToFinish();
 
+    IPChecksumAddByte(MACTxSum, val, DMAAddr.v[0] & 0x01);
+
     //Update Remote DMA address pointer
     DMAAddr.Val++;
 }
@@ -853,6 +873,8 @@ void MACPutArray(BYTE *val, WORD len)
     //RAM via Remote DMA. After writing "len" bytes, DMA finished bit is set in ISR register
     FastNICPut(CMDR, 0x12);
 
+    IPChecksumAddArray(&MACTxSum, val, len, DMAAddr.v[0] & 0x01);
+
     //Update Remote DMA address pointer
     DMAAddr.Val += len;
 
@@ -885,6 +907,29 @@ void MACPutArray(BYTE *val, WORD len)
 }
 
 
+/**
+ * Clears the running checksum of bytes written to the TX Buffer. Call this function
+ * before writing the first byte that has to be included in the checksum.
+ */
+void MACClearTxSum(void)
+{
+    MACTxSum = 0;
+}
+
+
+/**
+ * Gets the one's complement sum of all bytes written with MACPut() and MACPutArray()
+ * since MACClearTxSum() was called.
+ *
+ * @return      16 bit one's complement sum, not complemented. Same byte order as
+ *              CalcIPChecksum() uses.
+ */
+WORD MACGetTxSum(void)
+{
+    return IPChecksumFold(MACTxSum);
+}
+
+
 /**
  * Reads a single byte via Remote DMA from the current MAC Receive buffer.
  * If the last byte of the RX Buffer was read, this function automatically
@@ -968,6 +1013,38 @@ BYTE    MACGet(void)
  *
  */
 WORD MACGetArray(BYTE *val, WORD len)
+{
+    WORD toEnd;
+
+    //Reading from the MAC RX Buffer, and not from a TX Buffer
+    if (DMAAddr.v[1] >= RXSTART) {
+        //Number of bytes up to and including the last byte of the MAC RX Buffer
+        toEnd = ((WORD)RXSTOP << 8) - DMAAddr.Val;
+
+        //Last byte of MAC RX Buffer is read wronge by RTL8019AS, see MACGet(). Read all bytes before
+        //it with a single Remote DMA transfer, and the last byte with MACGet(), that fixes it and
+        //rolls over to the first page of the RX Buffer. The rest is read with a second transfer.
+        if (len >= toEnd) {
+            MACGetArrayDma(val, toEnd - 1);
+            val[toEnd - 1] = MACGet();
+            MACGetArrayDma(&val[toEnd], len - toEnd);
+            return len;
+        }
+    }
+
+    return MACGetArrayDma(val, len);
+}
+
+/**
+ * Reads the given amount of bytes with a single Remote DMA transfer. Same as MACGetArray(),
+ * but does not fix the RTL8019AS bug when reading the last byte of the MAC RX Buffer.
+ *
+ * @param len       Length of array to be read
+ * @param val       Buffer to read packet into
+ *
+ * @return          Number of bytes read
+ */
+static WORD MACGetArrayDma(BYTE *val, WORD len)
 {
     WORD_VAL length;
     length.Val = len;
@@ -1506,11 +1583,9 @@ void    MACPutHeader(MAC_ADDR *remote,
     if ( dataLen < MINFRAME )
        dataLen = MINFRAME;
 
-    mytemp.Val = dataLen;
-
-    //Set Transmit byte count. These two resisters give the size of the packet to transmit
-    NICPut(TBCR0, mytemp.v[0]);
-    NICPut(TBCR1, mytemp.v[1]);
+    //Save Transmit byte count. It is only written to the NIC in MACFlush(), because a TX Buffer
+    //that has been reserved with MACReserveTxBuffer() can be sent again later
+    TxBuffers[CurrentTxBuffer].Length = dataLen;
 }
 
 
@@ -1521,6 +1596,8 @@ void    MACPutHeader(MAC_ADDR *remote,
  */
 void MACFlush(void)
 {
+    WORD_VAL mytemp;
+
     #if (MAC_TX_BUFFER_COUNT > 1)
     BYTE i;
     #endif
@@ -1528,8 +1605,11 @@ void MACFlush(void)
     //Configure to send a packet. To configure the NIC to send a packet, 3 registers have to
     //be set:
     // - TPSR: This gives the NIC RAM page of the packet to send
-    // - TBCR0 & 1: These two resisters give the size of the packet to transmit. Already set in MACPutHeader()!
+    // - TBCR0 & 1: These two resisters give the size of the packet to transmit. Saved by MACPutHeader()
     NICPut(TPSR, TxBuffers[CurrentTxBuffer].Index);
+    mytemp.Val = TxBuffers[CurrentTxBuffer].Length;
+    NICPut(TBCR0, mytemp.v[0]);
+    NICPut(TBCR1, mytemp.v[1]);
 
     //Complete remote DMA and transmit packet
     //xx1x xxxx = RD2 = complete remote DMA
@@ -1712,7 +1792,11 @@ void MACSetTxBuffer(BUFFER buffer, WORD offset)
 {
     WORD_VAL t;
 
+    //Save the running checksum of the previous buffer, and continue with the one of the given buffer
+    TxBuffers[CurrentTxBuffer].Sum = MACTxSum;
     CurrentTxBuffer = buffer;
+    MACTxSum = TxBuffers[CurrentTxBuffer].Sum;
+
     t.v[1] = TxBuffers[CurrentTxBuffer].Index;
     t.v[0] = sizeof(ETHER_HEADER);
 
@@ -405,6 +405,22 @@ void    MACPut(BYTE val);
 
 void    MACPutArray(BYTE *val, WORD len);
 
+/**
+ * Clears the running checksum of bytes written to the TX Buffer. All bytes written with
+ * MACPut() and MACPutArray() after calling this function are added to it.
+ */
+void    MACClearTxSum(void);
+
+/**
+ * Gets the one's complement sum of all bytes written with MACPut() and MACPutArray()
+ * since MACClearTxSum() was called. Used for calculating the TCP and UDP checksums
+ * without reading the data back from the NIC.
+ *
+ * @return      16 bit one's complement sum, not complemented. Same byte order as
+ *              CalcIPChecksum() uses.
+ */
+WORD    MACGetTxSum(void);
+
 /**
  * Flush the MAC
  */
@@ -45,6 +45,7 @@
 #include "projdefs.h"
 #include "net\checkcfg.h"
 #include "net\mac.h"
+#include "net\ipchksum.h"
 
 #if !defined(STACK_USE_SLIP)
 #error SLIP module is not enabled.
@@ -121,6 +122,13 @@ SLIP_RX_BUFFER RxBuffer @ 0x300;
 
 static BOOL bIsRxActive;
 
+/*
+ * Running checksum of all bytes written to the TX Buffer since MACClearTxSum().
+ * There is no Ethernet header, so the offset in the buffer gives the position
+ * of a byte in the IP, TCP and UDP headers and data.
+ */
+static IP_CHECKSUM TxSum;
+
 
 /*
  * SLIP escape character as per RFC 1055
@@ -584,6 +592,7 @@ void    MACPut(BYTE val)
     }
     else
     {
+        IPChecksumAddByte(TxSum, val, TxBuffer.CallerAccess & 0x01);
         TxBuffer.Data[TxBuffer.CallerAccess++] = val;
     }
 }
@@ -594,6 +603,16 @@ void    MACPutArray(BYTE *val, WORD len)
         MACPut(*val++);
 }
 
+void    MACClearTxSum(void)
+{
+    TxSum = 0;
+}
+
+WORD    MACGetTxSum(void)
+{
+    return IPChecksumFold(TxSum);
+}
+
 
 void    MACFlush(void)
 {
@@ -47,6 +47,15 @@
  * 2006-09-06, David Hosken (DH):
  *    - Replaced lots of code with code from new Microchip TCP/IP V3.75
  * 2006-09-08, David Hosken (DH): Implemented changes from Microchip TCP/IP stack 3.75
+ * 2026-10-17:
+ *    - Sent segments are kept in a send window (tcpwin.c) until acknowledged, with per segment
+ *      retransmit timers and fast retransmit. Removed TCP_SEND_EACH_SEGMENT_TWICE and TCP_NO_WAIT_FOR_ACK.
+ *    - TCPPutArray() returns number of bytes written, and takes remote window into account. Added TCPGetPutSpace()
+ *    - TCPGetArray() and TCPGetArrayChr() now update RxCount
+ *    - Checksum of TCP Data is calculated by the MAC while it is written, TransmitTCP() no longer reads it back
+ *    - Added TCPGetRxCount()
+ *    - Unacknowledged segments are also resent while the socket is writing its next segment. A socket
+ *      can only add a segment to its send window if that leaves a TX Buffer for the other sockets.
  *********************************************************************/
  
 #define THIS_IS_TCP
@@ -56,6 +65,7 @@
 #include "projdefs.h"
 #include "net\checkcfg.h"
 #include "net\tcp.h"
+#include "net\tcpwin.h"
 #include "net\helpers.h"
 #include "net\ip.h"
 #include "net\mac.h"
@@ -198,6 +208,12 @@ static WORD _NextPort = TCP_LOCAL_PORT_START_NUMBER;
     SOCKET_INFO TCB[MAX_SOCKETS];
 #endif
 
+/*
+ * Send window of each socket. Kept outside the TCB, seeing that TCP_SOCKET_INFO_SEG is already full.
+ * For the MPLAB C18 compiler, MAX_SOCKETS * sizeof(TCP_WIN) must fit in a bank (256 bytes).
+ */
+static TCP_WIN TCPWin[MAX_SOCKETS];
+
 //This variable can only be used as long as the TCP/IP stack reads a whole TCP message at a time.
 //If this stack would be modified so that multiple TCP messages can be read simultaniously, this
 //variable will could not be used anymore!
@@ -221,6 +237,8 @@ static  TCP_SOCKET FindMatchingSocket(TCP_HEADER *hdr,
                                     NODE_INFO *remote);
 static  void    SwapTCPHeader(TCP_HEADER* header);
 static void CloseSocket(SOCKET_INFO* ps);
+static BOOL TCPCanSendSegment(TCP_SOCKET s);
+static void TCPRestoreTxPtr(void);
 
 /**
  * Sends a TCP Message with the given data. The sent TCP Message will contain only a "TCP Header" with
@@ -231,6 +249,18 @@ static void CloseSocket(SOCKET_INFO* ps);
     TransmitTCP(remote, localPort, remotePort, seq, ack, flags, \
     INVALID_BUFFER, 0)
 
+/**
+ * Sent data can be acknowledged in these states, until the ACK for our FIN arrives. The send window
+ * of a socket is kept up to date, and its segments resent if required, as long as this is TRUE.
+ */
+#define TCPIsSendState(ps)  (((ps)->smState == TCP_ESTABLISHED) || ((ps)->smState == TCP_FIN_WAIT_1) || \
+                            ((ps)->smState == TCP_CLOSING) || ((ps)->smState == TCP_LAST_ACK))
+
+/**
+ * Checks if the given ACK number acknowledges our FIN, which is the last sequence number we sent.
+ */
+#define TCPIsFinAcked(ps, h)    ((h)->Flags.bits.flagACK && ((h)->AckNumber == (ps)->SND_SEQ))
+
 
 
 
@@ -257,6 +287,8 @@ void TCPInit(void)
         ps->TxBuffer            = INVALID_BUFFER;
         ps->TimeOut             = TCP_START_TIMEOUT_VAL;
         ps->TxCount                = 0;
+
+        TCPWinInit(&TCPWin[s]);
     }
 }
 
@@ -379,6 +411,9 @@ TCP_SOCKET TCPConnect(NODE_INFO *remote, TCP_PORT remotePort)
     // This is the port, we are trying to connect to.
     ps->remotePort = remotePort;
 
+    // New connection, nothing sent yet and round trip time not known
+    TCPWinInit(&TCPWin[s]);
+
     // Each new socket that is opened by this node, will
     // start with next the next seqeuence number (essentially random)
     ps->SND_SEQ++;
@@ -432,7 +467,8 @@ BOOL TCPIsConnected(TCP_SOCKET s)
 
 
 /**
- * A disconnect request is sent for given socket.
+ * A disconnect request is sent for given socket. The FIN follows any segments that have not been
+ * acknowledged yet, they are still resent if required until the remote node has acknowledged the FIN.
  *
  * @preCondition    TCPInit() is already called AND<br>
  *                  TCPIsPutReady(s) != 0
@@ -534,38 +570,30 @@ BOOL TCPFlush(TCP_SOCKET s)
         ps->TxBuffer,
         ps->TxCount);
     
+    //The TxBuffer is now owned by the send window, and kept until the remote host acknowledges it. It
+    //is resent from there if required. This socket can start a new segment with the next available
+    //TX Buffer, as long as the send window is not full.
+    TCPWinAdd(&TCPWin[s], ps->TxBuffer, ps->SND_SEQ, ps->TxCount);
+    ps->TxBuffer = INVALID_BUFFER;
+
     //Increment to SEQ number of next segment we will send, is also the ACK number we are expecting to receive
     ps->SND_SEQ += (DWORD)ps->TxCount;
-    ps->Flags.bIsPutReady       = FALSE;
+    ps->TxCount = 0;
     
     //Is set as soon as the TCPPut() or TCPPutArray() functions is called for this socket, cleared when flushed
     ps->Flags.bIsTxInProgress   = FALSE;
 
-
-    //If we do NOT wait for ACK, we can immediately discard the TxBuffer's data. If not, we have to keep it
-    //in case we have to resend the data!
-    #ifdef TCP_NO_WAIT_FOR_ACK
-    if(ps->TxBuffer != INVALID_BUFFER)
-    {
-        MACDiscardTx(ps->TxBuffer); //Discard buffer, and mark it as available
-
-        //By assigning the TxBuffer with INVALID_BUFFER, the first available TX Buffer will be used
-        //the first time the TCPPut() or TCPPutArray() function is called.
-        ps->TxBuffer        = INVALID_BUFFER;
-    }
-    ps->Flags.bIsPutReady       = TRUE;
-    #endif
-
     return TRUE;
 }
 
 
 /**
- * Each socket maintains only one transmit buffer. Hence until a data packet
- * is acknowledeged by remote node, socket will not be ready for next transmission.
+ * Each socket can have up to TCP_WIN_SEGMENTS segments that have not been acknowledged by the
+ * remote node yet. Once its send window is full, socket will not be ready for next transmission.
  * All control transmission such as Connect, Disconnect do not
  * consume/reserve any transmit buffer. This function will check:
  * - If the given socket is valid, is not equal to INVALID_SOCKET for example
+ * - If the send window of the given socket is not full
  * - If there is an available TX Buffer for writing data to via TCPPut() and TCPPutArray() functions.
  * - If the given socket is ready for transmission
  *
@@ -589,14 +617,53 @@ BOOL TCPIsPutReady(TCP_SOCKET s)
     //TCPPut() or TCPPutArray() function is called. Call the IPIsTxReady() function to see if there
     //are any free TX Buffers. This is the case when there is currently no unsent data in this socket's
     //TX Buffer. This socket will be assigned a free buffer during the TCPPut() and TCPPutArray() functions.
-    if ( TCB[s].TxBuffer == INVALID_BUFFER )
+    if ( TCB[s].TxBuffer == INVALID_BUFFER ) {
+        //All segments the window can hold are waiting to be acknowledged, or the TX Buffers left
+        //are needed by other sockets
+        if ( !TCPCanSendSegment(s) )
+            return FALSE;
+
         return IPIsTxReady(FALSE);
+    }
     //This flag is valid when the socket's TX Buffer contains unsent data.
     else
         return TCB[s].Flags.bIsPutReady;
 }
 
 
+/**
+ * Get the number of bytes that can be written to the given socket with a single call to
+ * TCPPutArray(), without it having to flush the transmit buffer first.
+ *
+ * @preCondition    TCPInit() is already called.
+ *
+ * @param s         socket to test
+ *
+ * @return          Number of bytes that can be written. 0 if TCPIsPutReady() is FALSE.
+ */
+WORD TCPGetPutSpace(TCP_SOCKET s)
+{
+    SOCKET_INFO* ps;
+    WORD space;
+
+    if ( !TCPIsPutReady(s) )
+        return 0;
+
+    ps = &TCB[s];
+
+    //Space left in the TX Buffer. If this socket does not own one yet, it will be assigned an empty one
+    space = (WORD)TCPGetMaxDataLength();
+    if ( ps->TxBuffer != INVALID_BUFFER )
+        space -= ps->TxCount;
+
+    //Remote node might not be able to accept all of it
+    if ( space > ps->RemoteWindow )
+        space = ps->RemoteWindow;
+
+    return space;
+}
+
+
 /**
  * Write the given byte to the given socket's transmit buffer.
  * The data is NOT sent yet, and the TCPFlush() function must be called
@@ -626,6 +693,10 @@ BOOL TCPPut(TCP_SOCKET s, BYTE byte)
     //Get next free TX Buffer and assign it to this socket.
     if(ps->TxBuffer == INVALID_BUFFER)
     {
+        //Send window is full, have to wait for ACK. Can happen when previous call flushed a full buffer
+        if ( !TCPCanSendSegment(s) )
+            return FALSE;
+
         //Get handle to next available TX Buffer. The TCPIsPutReady() function that has to be called
         //prior to this function will determine if there is an available TX Buffer.
         ps->TxBuffer = MACGetTxBuffer(FALSE);
@@ -642,6 +713,9 @@ BOOL TCPPut(TCP_SOCKET s, BYTE byte)
         //to given offset in "IP data", which is the first byte after the "TCP Header" = first byte of
         //the "TCP Data". Thus, future reads and writes to TX Buffer will access "TCP Data"
         IPSetTxBuffer(ps->TxBuffer, sizeof(TCP_HEADER));
+
+        //The MAC calculates the checksum of the "TCP Data" while it is written, used by TransmitTCP()
+        MACClearTxSum();
     }
 
     //Is set as soon as the TCPPut() or TCPPutArray() function is called for this socket, cleared when flushed
@@ -659,16 +733,16 @@ BOOL TCPPut(TCP_SOCKET s, BYTE byte)
 
 
 /**
- * !!!!!!!!!! Important !!!!!!!!!!!!!
- * This function has not been tested!!
- *
  * Given number of data bytes from the given array are put into the given socket's
  * transmit buffer. The data is NOT sent yet, and the TCPFlush() function must be called
- * to send all data contained in the transmit buffer.
+ * to send all data contained in the transmit buffer. All bytes are written to the TX Buffer
+ * with a single Remote DMA transfer, which is much faster than calling TCPPut() for each byte.
  *
  * If there is not enough space in the transmit buffer for all the data, the contents of
  * the transmit buffer will be sent, and this function will return the actual amount of
- * bytes that were sent. In this case, it is VERY IMPORTANT to call the TCPIsPutReady()
+ * bytes that were sent. The same is true if the remote node's receive window is smaller
+ * than the given number of bytes. Use TCPGetPutSpace() to get the number of bytes that
+ * will be accepted. In this case, it is VERY IMPORTANT to call the TCPIsPutReady()
  * function again before calling the TCPPut() or TCPPutArray() functions! This will however
  * only happen if the transmit buffer fills up. The transmit buffer for TCP data is
  * = (MAC_TX_BUFFER_SIZE - 54), which is usually 970 bytes. If writing less then this to
@@ -681,12 +755,11 @@ BOOL TCPPut(TCP_SOCKET s, BYTE byte)
  * @param[in] buffer Buffer containing data that has to be sent.
  * @param count     Number of bytes to send
  *
- * @return          TRUE if transmit buffer is still ready to accept more data bytes <br>
- *                  FALSE if transmit buffer can no longer accept any more data byte.<br>
- *                  If FALSE is returned, then TCPIsPutReady() has to be called again before
- *                  calling TCPPut() or TCPPutArray() functions!
+ * @return          Number of bytes written to the transmit buffer. If less than count,
+ *                  then TCPIsPutReady() has to be called again before calling TCPPut() or
+ *                  TCPPutArray() functions!
  */
-BOOL TCPPutArray(TCP_SOCKET s, BYTE *buffer, WORD count)
+WORD TCPPutArray(TCP_SOCKET s, BYTE *buffer, WORD count)
 {
     SOCKET_INFO* ps;
 
@@ -694,19 +767,23 @@ BOOL TCPPutArray(TCP_SOCKET s, BYTE *buffer, WORD count)
 
     // Make sure that the remote node is able to accept our data
     if(ps->RemoteWindow == 0)
-        return FALSE;
+        return 0;
 
     //This TCP Socket does not contain any unsent data, and currently does not own a TX Buffer!
     //Get next free TX Buffer and assign it to this socket.
     if ( ps->TxBuffer == INVALID_BUFFER )
     {
+        //Send window is full, have to wait for ACK. Can happen when previous call flushed a full buffer
+        if ( !TCPCanSendSegment(s) )
+            return 0;
+
         //Get handle to next available TX Buffer. The TCPIsPutReady() function that has to be called
         //prior to this function will determine if there is an available TX Buffer.
         ps->TxBuffer = MACGetTxBuffer(FALSE);
 
         // Check to make sure that we received a TX Buffer
         if(ps->TxBuffer == INVALID_BUFFER)
-            return FALSE;
+            return 0;
 
         ps->TxCount = 0;
 
@@ -714,6 +791,9 @@ BOOL TCPPutArray(TCP_SOCKET s, BYTE *buffer, WORD count)
         //to given offset in "IP data", which is the first byte after the "TCP Header" = first byte of
         //the "TCP Data". Thus, future reads and writes to TX Buffer will access "TCP Data"
         IPSetTxBuffer(ps->TxBuffer, sizeof(TCP_HEADER));
+
+        //The MAC calculates the checksum of the "TCP Data" while it is written, used by TransmitTCP()
+        MACClearTxSum();
     }
 
     //This function request more bytes to be written to the TX Buffer then there is space 
@@ -723,7 +803,9 @@ BOOL TCPPutArray(TCP_SOCKET s, BYTE *buffer, WORD count)
     }
     
     //Check if remote window has enough space, and update count if required
-    // TODO!!!!!!
+    if (count > ps->RemoteWindow) {
+        count = ps->RemoteWindow;
+    }
 
     //Is set as soon as the TCPPut() or TCPPutArray() function is called for this socket, cleared when flushed
     ps->Flags.bIsTxInProgress = TRUE;
@@ -732,7 +814,7 @@ BOOL TCPPutArray(TCP_SOCKET s, BYTE *buffer, WORD count)
     MACPutArray(buffer, count);
 
     //Update remote window
-      ps->RemoteWindow -= count;
+    ps->RemoteWindow -= count;
 
     //Increment TxCount
     ps->TxCount += count;
@@ -777,10 +859,8 @@ BOOL TCPDiscard(TCP_SOCKET s)
 
 
 /**
- * !!!!!!!!!! Important !!!!!!!!!!!!!
- * This function has not been tested!!
- *
  * Read the requested number of bytes from the given socket into the given buffer.
+ * All bytes are read with a single Remote DMA transfer.
  *
  * @preCondition    TCPInit() is already called AND <br>
  *                  TCPIsGetReady(s) != 0
@@ -824,6 +904,7 @@ WORD TCPGetArray(TCP_SOCKET s, BYTE *buffer, WORD count)
         }
 
         //Read the requested amount of data from the current MAC RX Buffer
+        ps->RxCount -= count;
         return MACGetArray(buffer, count);
     }
     else
@@ -901,6 +982,7 @@ WORD TCPGetArrayChr(TCP_SOCKET s, BYTE *buffer, BYTE count, BYTE chr)
         
         //Read the requested amount of data from the current MAC RX Buffer
         ret.Val = MACGetArrayChr(buffer, count, chr);
+        ps->RxCount -= ret.v[0];
         
         //The terminating character was found
         if (ret.v[1] == MAC_GETARR_TRM) {
@@ -999,6 +1081,29 @@ BOOL TCPIsGetReady(TCP_SOCKET s)
 }
 
 
+/**
+ * Gets the number of bytes in the current TCP packet that have not been read yet.
+ *
+ * @preCondition    TCPInit() is already called.
+ *
+ * @param s         socket
+ *
+ * @return          Number of bytes that can still be read from socket 's'. Is 0 if the socket does
+ *                  not contain any data.
+ */
+WORD TCPGetRxCount(TCP_SOCKET s)
+{
+    //Check if the given socket is valid
+    if (s >= MAX_SOCKETS)
+        return 0;
+
+    if (!TCB[s].Flags.bIsGetReady)
+        return 0;
+
+    return TCB[s].RxCount;
+}
+
+
 /**
  * Check each socket for any timeout conditions
  * 
@@ -1010,21 +1115,76 @@ void TCPTick(void)
     TICK diffTicks;
     TICK tick;
     SOCKET_INFO* ps;
+    TCP_WIN_SEG* pSeg;
     DWORD seq;
     BYTE flags;
+    BOOL bFinResent;
 
-    flags = 0x00;
     // Periodically all "not closed" sockets must perform timed operation.
     for(s = 0; s < MAX_SOCKETS; s++)
     {
         ps = &TCB[s];
+        flags = 0x00;
+        bFinResent = FALSE;
+
+        // While there are unacknowledged segments, the retransmit timer of the oldest one is used in
+        // stead of the connection timeout below. This is also done while the socket is writing its next
+        // segment (bIsTxInProgress), seeing that a lost segment would otherwise only be resent after that
+        // one has been flushed. The RX Buffer access pointer of a socket that is being read can not be
+        // restored, so in that case wait for TCPDiscard(). A segment HandleTCPSeg() marked for a fast
+        // retransmit is also resent here, so the receive path never waits for a TX Buffer. This
+        // continues after our FIN was sent, it follows the data.
+        if ( TCPIsSendState(ps) && !TCPWinIsEmpty(&TCPWin[s]) && !ps->Flags.bIsGetReady )
+        {
+            pSeg = TCPWinGetExpired(&TCPWin[s]);
+            if (pSeg == NULL)
+                continue;
+
+            if(!IPIsTxReady(TRUE))
+                return;
+
+            if (pSeg->retries < TCP_MAX_RETRY_COUNTS)
+            {
+                #if (DEBUG_TCP >= LOG_WARN)
+                debugPutOffsetMsg(s, 6);    //@mxd:6:Resending TCP Message. Previously sent data was NOT acknowledged!
+                #endif
+
+                //A fast retransmit (duplicate ACKs) does not back off the retransmit timer
+                TCPWinResend(&TCPWin[s], !TCPWinIsFastRetx(&TCPWin[s]));
+                TCPRestoreTxPtr();
+                continue;
+            }
+
+            // Can not close the connection while data is still being written to it
+            if ( ps->Flags.bIsTxInProgress )
+                continue;
+
+            // Forget about previous transmissions, and make their TX Buffers available to
+            // other connections. Request closure, or close if our FIN was already sent.
+            TCPWinDiscard(&TCPWin[s]);
+
+            if (ps->smState != TCP_ESTABLISHED)
+            {
+                CloseSocket(ps);
+                continue;
+            }
+
+            #if (DEBUG_TCP >= LOG_WARN)
+            debugPutOffsetMsg(s, 5);    //@mxd:5:state FIN-WAIT-1: Max Retries, connection closed! Sending ACK|FIN
+            #endif
+
+            ps->startTick   = TickGet16bit();
+            ps->RetryCount  = 0;
+            flags = FIN | ACK;
+            ps->smState = TCP_FIN_WAIT_1;
+            goto SendTCPTimeoutPacket;
+        }
 
         // - bIsTxInProgress is set as soon as the TCPPut() or TCPPutArray() functions is called for a
         //   socket, cleared when flushed
         if ( ps->Flags.bIsGetReady || ps->Flags.bIsTxInProgress )
             continue;
 
-
         // Closed or Passively Listening socket do not care
         // about timeout conditions.
         if ( (ps->smState == TCP_CLOSED) ||
@@ -1104,42 +1264,20 @@ void TCPTick(void)
             break;
 
         case TCP_ESTABLISHED:
-    #if !defined(TCP_NO_WAIT_FOR_ACK)   //If Wait for ACK is enabled, include this code
             // Don't let this connection idle for very long time.
             // If we did not receive or send any message before timeout
-            // expires, close this connection.
+            // expires, close this connection. There is no unacknowledged
+            // data, that is handled by the send window above.
             if(ps->RetryCount <= TCP_MAX_RETRY_COUNTS)
             {
-                //This connection is assigned a TX Buffer - resend the data contained in it!
-                if ( ps->TxBuffer != INVALID_BUFFER )
-                {
-                    #if (DEBUG_TCP >= LOG_WARN)
-                    debugPutOffsetMsg(s, 6);    //@mxd:6:Resending TCP Message. Previously sent data was NOT acknowledged!
-                    #endif
-
-                    MACSetTxBuffer(ps->TxBuffer, 0);
-                    MACFlush();
-                }
-                else {
-                    #if (DEBUG_TCP >= LOG_WARN)
-                    debugPutOffsetMsg(s, 41);    //@mxd:41:Timeout, resending ACK
-                    #endif
+                #if (DEBUG_TCP >= LOG_WARN)
+                debugPutOffsetMsg(s, 41);    //@mxd:41:Timeout, resending ACK
+                #endif
 
-                    flags = ACK;
-                }
+                flags = ACK;
             }
             else
             {
-                // Forget about previous transmission. If this socket is assigned a TX Buffer, discard it and
-                // make it available to other connections!
-                if(ps->TxBuffer != INVALID_BUFFER)
-                {
-                    MACDiscardTx(ps->TxBuffer);
-                    //By assigning the TxBuffer with INVALID_BUFFER, the first available TX Buffer will be used
-                    //the first time the TCPPut() or TCPPutArray() function is called.
-                    ps->TxBuffer = INVALID_BUFFER;
-                }
-    #endif
                 #if (DEBUG_TCP >= LOG_WARN)
                 debugPutOffsetMsg(s, 5);    //@mxd:5:state FIN-WAIT-1: Max Retries, connection closed! Sending ACK|FIN
                 #endif
@@ -1147,18 +1285,16 @@ void TCPTick(void)
                 // Request closure.
                 flags = FIN | ACK;
 
-
                 ps->smState = TCP_FIN_WAIT_1;
-    #if !defined(TCP_NO_WAIT_FOR_ACK)   //If Wait for ACK is enabled, include this code
             }
-    #endif
             break;
 
         case TCP_FIN_WAIT_1:
             if(ps->RetryCount <= TCP_MAX_RETRY_COUNTS)
             {
                 // Send another FIN
-                flags = FIN;
+                flags = FIN | ACK;
+                bFinResent = TRUE;
 
                 #if (DEBUG_TCP >= LOG_WARN)
                 debugPutOffsetMsg(s, 42);    //@mxd:42:Timeout, resending FIN
@@ -1210,19 +1346,29 @@ void TCPTick(void)
         case TCP_LAST_ACK:
             // Send some more FINs or close anyway
             if(ps->RetryCount <= TCP_MAX_RETRY_COUNTS)
+            {
                 // Added ACK to re-sent FIN packets
                 //flags = FIN;
                 flags = FIN | ACK;
+                bFinResent = TRUE;
+            }
             else
                 CloseSocket(ps);
             break;
         }
 
+SendTCPTimeoutPacket:
         //Check if any flags have been set, and send requested TCP packet
         //Flags can be: FIN, SYN, RST, PSH, ACK and URG
         if(flags)
         {
-            if(flags & ACK)
+            //A FIN that is sent again keeps its sequence number, the one before the ACK number we expect for it.
+            //A new FIN takes up a sequence number.
+            if(bFinResent)
+                seq = ps->SND_SEQ - 1;
+            else if((flags & FIN) && (ps->smState == TCP_FIN_WAIT_1))
+                seq = ps->SND_SEQ++;
+            else if(flags & ACK)
                 seq = ps->SND_SEQ;    //Timeout, resending ACK. Set the sequence number equal to the last sequence number we sent.
             else
                 seq = ps->SND_SEQ++;      //Increment to SEQ number of next segment we will send, is also the ACK number we are expecting to receive
@@ -1391,6 +1537,8 @@ BOOL TCPProcess(NODE_INFO *remote, IP_ADDR *localIP, WORD len)
  * @param flags     Segment flags
  * @param buffer    Buffer which this segment has to transmit. If this value is INVALID_BUFFER, a
  *                  available transmit buffer will be assigned to it, and len parameter should be 0!
+ *                  The data must have been written to it after calling MACClearTxSum(), and nothing
+ *                  else may have been written with MACPut() or MACPutArray() since.
  * @param len       Total data length for this segment.
  */
 static void TransmitTCP(NODE_INFO *remote,
@@ -1402,7 +1550,7 @@ static void TransmitTCP(NODE_INFO *remote,
                         BUFFER buffer,
                         WORD len)
 {
-    WORD_VAL        checkSum;
+    WORD            checksums[3];
     TCP_HEADER      header;
     TCP_OPTIONS     options;
     PSEUDO_HEADER   pseudoHeader;
@@ -1421,6 +1569,10 @@ static void TransmitTCP(NODE_INFO *remote,
     if(buffer == INVALID_BUFFER)
         return;
 
+    //Sum of the "TCP Data", calculated by the MAC while it was written to the TX Buffer. Must be
+    //read before the headers are written below.
+    checksums[2] = (len == 0) ? 0 : MACGetTxSum();
+
     IPSetTxBuffer(buffer, 0);
 
     header.SourcePort.Val       = localPort;
@@ -1494,8 +1646,12 @@ static void TransmitTCP(NODE_INFO *remote,
 
     header.Checksum.Val = ~CalcIPChecksum((BYTE*)&pseudoHeader,
         sizeof(pseudoHeader));
-    checkSum.Val = header.Checksum.Val;
 
+    //Add the "TCP Header" (its checksum field now contains the pseudo header sum), "TCP Options" and
+    //"TCP Data" sums. The TCP Header and Options have an even size, so the TCP Data starts on a word.
+    checksums[0] = ~CalcIPChecksum((BYTE*)&header, sizeof(header));
+    checksums[1] = (flags & SYN) ? ~CalcIPChecksum((BYTE*)&options, sizeof(options)) : 0;
+    header.Checksum.Val = CalcIPChecksum((BYTE*)checksums, sizeof(checksums));
 
     //Write the Ethernet Header (MAC Header) and IP Header to the current TX buffer.
     //The last parameter (len) is the length of the data to follow, which is the "TCP Header" + "TCP Data"
@@ -1508,19 +1664,6 @@ static void TransmitTCP(NODE_INFO *remote,
     if ( flags & SYN )
         IPPutArray((BYTE*)&options, sizeof(options));
 
-    //Set TX Buffer access pointer (All future read and writes to the TX Buffer will be to the set location)
-    //to first byte of "IP data" = "TCP Header" in this case
-    //CalcIPBufferChecksum() function requires buffer access pointer to be set
-    IPSetTxBuffer(buffer, 0);
-
-    checkSum.Val = CalcIPBufferChecksum(len);   //Performs checksum calculation in MAC buffer itself.
-
-    //Set TX Buffer access pointer (All future read and writes to the TX Buffer will be to the set location)
-    //to 16th byte of "IP data" = 16th byte of "TCP Header" = TCP Header's checksum field
-    IPSetTxBuffer(buffer, 16);
-    MACPut(checkSum.v[1]);
-    MACPut(checkSum.v[0]);
-    
     //Set TX Buffer access pointer (All future read and writes to the TX Buffer will be to the set location)
     //to first byte of "IP data" = "TCP Header" in this case
     MACSetTxBuffer(buffer, 0);
@@ -1537,16 +1680,6 @@ static void TransmitTCP(NODE_INFO *remote,
 
     //Transmits the contents of the current transmit buffer = "TCP Header" and "TCP Data"
     MACFlush();
-
-    // If we send the packet again, the remote node might think that we timed 
-    // out and retransmitted.  It could thus immediately send back an ACK and 
-    // dramatically improve throuput.
-    #if !defined(TCP_NO_WAIT_FOR_ACK)
-        #if defined(TCP_SEND_EACH_SEGMENT_TWICE)
-        while(!IPIsTxReady(TRUE)) FAST_USER_PROCESS();
-        MACFlush();
-        #endif
-    #endif
 }
 
 
@@ -1626,6 +1759,10 @@ static TCP_SOCKET FindMatchingSocket(TCP_HEADER *h, NODE_INFO *remote)
         ps->TxBuffer        = INVALID_BUFFER;
     }
     ps->Flags.bIsPutReady   = TRUE;
+
+    // New connection, nothing sent yet and round trip time not known
+    TCPWinDiscard(&TCPWin[partialMatch]);
+    TCPWinInit(&TCPWin[partialMatch]);
     
     return partialMatch;
 }
@@ -1676,6 +1813,55 @@ static void SwapTCPHeader(TCP_HEADER* header)
 }
 
 
+/**
+ * Checks if the given socket can get a TX Buffer for a new segment, see TCPWinCanSend(). Counts
+ * the TX Buffers held by the other sockets, by their send windows and by the segments they are
+ * busy writing.
+ *
+ * @param s         Socket to check
+ *
+ * @return          TRUE if a new segment can be added to the socket's send window
+ */
+static BOOL TCPCanSendSegment(TCP_SOCKET s)
+{
+    TCP_SOCKET i;
+    BYTE held;
+
+    held = 0;
+    for (i = 0; i < MAX_SOCKETS; i++)
+    {
+        if (i == s)
+            continue;
+
+        held += TCPWin[i].count;
+        if ( TCB[i].TxBuffer != INVALID_BUFFER )
+            held++;
+    }
+
+    return TCPWinCanSend(&TCPWin[s], held);
+}
+
+
+/**
+ * Sets the TX Buffer access pointer back to the end of the data written to the socket that is
+ * busy writing a segment (bIsTxInProgress). Must be called after a segment was resent, seeing that
+ * resending it moved the pointer to another TX Buffer.
+ */
+static void TCPRestoreTxPtr(void)
+{
+    TCP_SOCKET s;
+
+    for (s = 0; s < MAX_SOCKETS; s++)
+    {
+        if ( TCB[s].Flags.bIsTxInProgress && (TCB[s].TxBuffer != INVALID_BUFFER) )
+        {
+            IPSetTxBuffer(TCB[s].TxBuffer, sizeof(TCP_HEADER) + TCB[s].TxCount);
+            return;
+        }
+    }
+}
+
+
 /**
  * Forcefully closed socket, no message is sent via TCP
  *
@@ -1697,6 +1883,9 @@ static void CloseSocket(SOCKET_INFO* ps)
         ps->Flags.bIsPutReady   = TRUE;
     }
 
+    //Release the TX Buffers of all sent segments that were not acknowledged
+    TCPWinDiscard(&TCPWin[ps - TCB]);
+
     ps->remote.IPAddr.Val = 0x00;
     ps->remotePort = 0x00;
     if(ps->Flags.bIsGetReady)
@@ -1862,7 +2051,7 @@ static void HandleTCPSeg(TCP_SOCKET s,
         // Send out an ACK
         flags = ACK;
 
-        ps->RemoteWindow = h->Window.Val;
+        // RemoteWindow has already been set above, less the bytes that have not been acknowledged yet
 
         // Check for application data and make it 
         // available, if present
@@ -1898,6 +2087,8 @@ static void HandleTCPSeg(TCP_SOCKET s,
         }
 
         ps->SND_ACK = h->SeqNumber + len + 1;
+
+        // The AckNumber of a SYN is not valid, but nothing has been sent on this connection yet
         ps->RemoteWindow = h->Window.Val;
 
         // This socket has received connection request (SYN).
@@ -1985,23 +2176,24 @@ static void HandleTCPSeg(TCP_SOCKET s,
                 // can be detected in the future.
                 ps->SND_ACK = ack;
 
-                // Handle packets received while connection established. Current state = ESTABLISHED
-                if(ps->smState == TCP_ESTABLISHED)
+                // If this packet has the ACK set, all sent segments it acknowledges are no longer
+                // needed for possible retransmission. If the remote node keeps acknowledging the
+                // start of our oldest segment, that segment got lost. Resend it right away. Our FIN
+                // follows the data, so this is also done while waiting for its ACK.
+                if(h->Flags.bits.flagACK && TCPIsSendState(ps))
                 {
-                    // If this packet has the ACK set, mark the packet it refers to (Ack Number)
-                    // as no longer needed for possible retransmission.
-                    // TODO: Make this more sophisticated so that partial ACKs due to fragmentation are handled correctly.  i.e. Keep a real output stream buffer with slidable window capability.
-                    if(h->Flags.bits.flagACK && (h->AckNumber == ps->SND_SEQ) && !ps->Flags.bIsPutReady)
+                    if (TCPWinAck(&TCPWin[s], h->AckNumber, len) == TCP_WIN_ACK_FASTRETX)
                     {
-                        //Data ACK, can now be discarded. Does not have to be retransmitted
-                        if(ps->TxBuffer != INVALID_BUFFER)
-                        {
-                            MACDiscardTx(ps->TxBuffer);
-                            ps->TxBuffer            = INVALID_BUFFER;
-                            ps->Flags.bIsPutReady   = TRUE;
-                        }
+                        //The segment is marked, and resent by TCPTick() once a TX Buffer is free
+                        #if (DEBUG_TCP >= LOG_WARN)
+                        debugPutOffsetMsg(s, 53);    //@mxd:53:Fast retransmit, received duplicate ACKs for unacknowledged data
+                        #endif
                     }
+                }
 
+                // Handle packets received while connection established. Current state = ESTABLISHED
+                if(ps->smState == TCP_ESTABLISHED)
+                {
                     // Check if the remote node is closing the connection, Received FIN flag
                     if(h->Flags.bits.flagFIN)
                     {
@@ -2065,7 +2257,7 @@ static void HandleTCPSeg(TCP_SOCKET s,
                 {
                     MACDiscardRx();
 
-                    if(h->Flags.bits.flagACK)
+                    if(TCPIsFinAcked(ps, h))
                     {
                         #if (DEBUG_TCP >= LOG_INFO)
                         if ( ps->Flags.bServer ) {
@@ -2087,7 +2279,7 @@ static void HandleTCPSeg(TCP_SOCKET s,
                     {
                         flags = ACK;
                         ack = ++ps->SND_ACK;
-                        if(h->Flags.bits.flagACK)
+                        if(TCPIsFinAcked(ps, h))
                         {
                             #if (DEBUG_TCP >= LOG_INFO)
                             if ( ps->Flags.bServer ) {
@@ -2108,7 +2300,8 @@ static void HandleTCPSeg(TCP_SOCKET s,
                             ps->smState = TCP_CLOSING;
                         }
                     }
-                    else if(h->Flags.bits.flagACK)
+                    //Only once our FIN is acknowledged, the ACKs before that are for data we sent
+                    else if(TCPIsFinAcked(ps, h))
                     {
                         #if (DEBUG_TCP >= LOG_INFO)
                         debugPutOffsetMsg(s, 50);    //@mxd:50:state FIN-WAIT-2: Received ACK, waiting for FIN
@@ -2144,7 +2337,7 @@ static void HandleTCPSeg(TCP_SOCKET s,
                 {
                     MACDiscardRx(); //Discard the contents of the current RX buffer
 
-                    if ( h->Flags.bits.flagACK )
+                    if ( TCPIsFinAcked(ps, h) )
                     {
                         #if (DEBUG_TCP >= LOG_INFO)
                         if ( ps->Flags.bServer ) {
@@ -2187,32 +2380,17 @@ static void HandleTCPSeg(TCP_SOCKET s,
     }
 
 SendTCPControlPacket:
+    //Unacknowledged data is not piggybacked, it is resent by the send window if required
     if(flags)
     {
-        // If the last message sent was not ackonwledged, send it again with piggyback flags
-        if(!ps->Flags.bIsPutReady && (ps->TxBuffer != INVALID_BUFFER) && (ps->TxCount != 0) ) {
-            ps->SND_SEQ -= ps->TxCount; //Shift back the sliding window
-            TransmitTCP(&ps->remote,    //Remote node info
-                ps->localPort,          //Source port number
-                ps->remotePort,         //Destination port number
-                ps->SND_SEQ,            //Segment sequence number
-                ps->SND_ACK,            //Segment acknowledge number
-                flags | PSH,            //Add PSH flag since frame contains data
-                ps->TxBuffer,
-                ps->TxCount);
-            ps->SND_SEQ += ps->TxCount;   //Re-align the sliding window
-        // If there is no message pending for retries, send a new one without data
-        } else {
-            
-            //Send TCP Message with given flags. Sends a TCP Message with the given data. The sent TCP Message
-            //will contain only a "TCP Header" with possible "TCP Options". No "TCP Data" is transmitted.
-            SendTCP(remote,
-                h->DestPort.Val,
-                h->SourcePort.Val,
-                seq,
-                ack,
-                flags);
-        }
+        //Send TCP Message with given flags. Sends a TCP Message with the given data. The sent TCP Message
+        //will contain only a "TCP Header" with possible "TCP Options". No "TCP Data" is transmitted.
+        SendTCP(remote,
+            h->DestPort.Val,
+            h->SourcePort.Val,
+            seq,
+            ack,
+            flags);
     }
 }
 
@@ -40,14 +40,9 @@
  //is defined for smallest size.
  #define TCP_SPEED_OPTIMIZE
 
- //When defined, each TCP segment is sent twice. This might cause the remote node to
- //think that we timed out and retransmitted. It could thus immediately send back an
- //ACK and dramatically improve throuput.
- #define TCP_SEND_EACH_SEGMENT_TWICE
-
- //Comment following line if StackTsk should wait for acknowledgement from remote host
- //before transmitting another packet. Commenting following line may reduce throughput.
- #define TCP_NO_WAIT_FOR_ACK
+ //Maximum number of unacknowledged segments per socket, see tcpwin.h for other window defines.
+ //Each segment holds a MAC TX Buffer until it is acknowledged.
+ #define TCP_WIN_SEGMENTS    (2)
  @endcode
  *********************************************************************/
 
@@ -83,6 +78,10 @@
  *    - Created documentation for existing code
  * 2006-05-03, David Hosken (DH):
  *    - Added bACKValid flag. Got this fix from new Microchip V3.02 stack!
+ * 2026-10-17:
+ *    - Added send window (tcpwin.h), removed TCP_SEND_EACH_SEGMENT_TWICE and TCP_NO_WAIT_FOR_ACK
+ *    - TCPPutArray() returns number of bytes written. Added TCPGetPutSpace()
+ *    - Added TCPGetRxCount()
  *********************************************************************/
 
 
@@ -122,15 +121,13 @@ NIC SRAM is used as a buffer space. But if SLIP is used as a MAC, the microcontr
 RAM is used.
 
 The TCP layer of the Modtronix TCP/IP Stack implements most of the TCP state machine states proposed by
-RFC793. It also implements automatic retry and timed operations, which users can enable or disable by
-the compile time definition TCP_NO_WAIT_FOR_ACK. When automatic retry is enabled, each socket transmit
-buffer is reserved until an acknowledgement from the remote host is received. This design effectively
-creates a transmit window of one TCP segment. Thus, data throughput would be considerably lower than
-that in "No Retry" mode. If only the HTTP Server application is used, the user may disable automatic
-retry and effectively increase throughput. If the main applications logic requires that each packet
-be acknowledged before a new one can be transmitted, the user should enable the "Automatic Retry" mode.
-With Automatic Retry enabled, some opened connections may not get served on time, and the remote host
-may get time-out or RESET errors.
+RFC793. It also implements automatic retry and timed operations. Each segment that is sent stays in its
+transmit buffer until an acknowledgement from the remote host is received, so it can be retransmitted.
+Each socket has a send window (see "tcpwin.h") of up to TCP_WIN_SEGMENTS unacknowledged segments. A socket
+can thus send a new segment before the previous one has been acknowledged, and throughput is not limited
+to one segment per round trip. Each unacknowledged segment has its own retransmit timer, and a segment is
+retransmitted immediately when the remote host sends duplicate ACKs for it (fast retransmit). Note that the
+window is also limited by the number of free transmit buffers, which are shared by all sockets.
 
 
 @section mod_tcpip_user_tcp_conf Configuration
@@ -142,6 +139,7 @@ For details on configuring this module, see @ref tcp_conf section of tcp.h file.
 
 #include "net\ip.h"
 #include "net\tick.h"
+#include "net\tcpwin.h"
 
 /** A TCP socket. Is a number from 0-255 that identifies a TCP socket */
 typedef BYTE TCP_SOCKET;
@@ -218,7 +216,7 @@ typedef struct _SOCKET_INFO
     TCP_PORT localPort;     //2 bytes
     TCP_PORT remotePort;    //2 bytes
 
-    BUFFER TxBuffer;        //1 byte
+    BUFFER TxBuffer;        //1 byte - TX Buffer currently being written to, INVALID_BUFFER if none
     WORD TxCount;           //2 bytes
     WORD RxCount;           //2 bytes - Length of TCP Data (NOT including header, only data) that still has to be read
     WORD RemoteWindow;      //2 bytes
@@ -326,11 +324,12 @@ void TCPDisconnect(TCP_SOCKET s);
 
 
 /**
- * Each socket maintains only one transmit buffer. Hence until a data packet
- * is acknowledeged by remote node, socket will not be ready for next transmission.
+ * Each socket can have up to TCP_WIN_SEGMENTS segments that have not been acknowledged by the
+ * remote node yet. Once its send window is full, socket will not be ready for next transmission.
  * All control transmission such as Connect, Disconnect do not
  * consume/reserve any transmit buffer. This function will check:
  * - If the given socket is valid, is not equal to INVALID_SOCKET for example
+ * - If the send window of the given socket is not full
  * - If there is an available TX Buffer for writing data to via TCPPut() and TCPPutArray() functions.
  * - If the given socket is ready for transmission
  *
@@ -350,6 +349,20 @@ void TCPDisconnect(TCP_SOCKET s);
 BOOL TCPIsPutReady(TCP_SOCKET s);
 
 
+/**
+ * Get the number of bytes that can be written to the given socket with a single call to
+ * TCPPutArray(), without it having to flush the transmit buffer first. This is the space
+ * left in the socket's transmit buffer, limited by the remote node's receive window.
+ *
+ * @preCondition    TCPInit() is already called.
+ *
+ * @param s         socket to test
+ *
+ * @return          Number of bytes that can be written. 0 if TCPIsPutReady() is FALSE.
+ */
+WORD TCPGetPutSpace(TCP_SOCKET s);
+
+
 /**
  * Returns the maximum size the TCP data is allowed to be. This value should never be execeed when
  * writting data to the TCP transmit buffer before calling TCPFlush().
@@ -392,11 +405,14 @@ BOOL TCPPut(TCP_SOCKET s, BYTE byte);
 /**
  * Given number of data bytes from the given array are put into the given socket's
  * transmit buffer. The data is NOT sent yet, and the TCPFlush() function must be called
- * to send all data contained in the transmit buffer.
+ * to send all data contained in the transmit buffer. All bytes are written to the TX Buffer
+ * with a single Remote DMA transfer, which is much faster than calling TCPPut() for each byte.
  *
  * If there is not enough space in the transmit buffer for all the data, the contents of
  * the transmit buffer will be sent, and this function will return the actual amount of
- * bytes that were sent. In this case, it is VERY IMPORTANT to call the TCPIsPutReady()
+ * bytes that were sent. The same is true if the remote node's receive window is smaller
+ * than the given number of bytes. Use TCPGetPutSpace() to get the number of bytes that
+ * will be accepted. In this case, it is VERY IMPORTANT to call the TCPIsPutReady()
  * function again before calling the TCPPut() or TCPPutArray() functions! This will however
  * only happen if the transmit buffer fills up. The transmit buffer for TCP data is
  * = (MAC_TX_BUFFER_SIZE - 54), which is usually 970 bytes. If writing less then this to
@@ -409,12 +425,11 @@ BOOL TCPPut(TCP_SOCKET s, BYTE byte);
  * @param[in] buffer Buffer containing data that has to be sent.
  * @param count     Number of bytes to send
  *
- * @return          TRUE if transmit buffer is still ready to accept more data bytes <br>
- *                  FALSE if transmit buffer can no longer accept any more data byte.<br>
- *                  If FALSE is returned, then TCPIsPutReady() has to be called again before
- *                  calling TCPPut() or TCPPutArray() functions!
+ * @return          Number of bytes written to the transmit buffer. If less than count,
+ *                  then TCPIsPutReady() has to be called again before calling TCPPut() or
+ *                  TCPPutArray() functions!
  */
-BOOL TCPPutArray(TCP_SOCKET s, BYTE *buffer, WORD count);
+WORD TCPPutArray(TCP_SOCKET s, BYTE *buffer, WORD count);
 
 /**
  * All and any data associated with this socket
@@ -453,6 +468,20 @@ BOOL TCPFlush(TCP_SOCKET s);
 BOOL TCPIsGetReady(TCP_SOCKET s);
 
 
+/**
+ * Gets the number of bytes in the current TCP packet that have not been read yet. When all bytes
+ * have been read, TCPDiscard() still has to be called to release the packet.
+ *
+ * @preCondition    TCPInit() is already called.
+ *
+ * @param s         socket
+ *
+ * @return          Number of bytes that can still be read from socket 's'. Is 0 if the socket does
+ *                  not contain any data.
+ */
+WORD TCPGetRxCount(TCP_SOCKET s);
+
+
 /**
  * This function reads the next byte from the current TCP packet.
  * Reads a single byte from the given socket into the given byte pointer
@@ -471,6 +500,7 @@ BOOL TCPGet(TCP_SOCKET s, BYTE *byte);
 
 /**
  * Read the requested number of bytes from the given socket into the given buffer.
+ * All bytes are read with a single Remote DMA transfer.
  *
  * @preCondition    TCPInit() is already called AND <br>
  *                  TCPIsGetReady(s) != 0
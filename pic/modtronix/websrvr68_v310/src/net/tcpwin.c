@@ -0,0 +1,316 @@
+/**
+ * @brief           TCP Send Window for Modtronix TCP/IP Stack
+ * @file            tcpwin.c
+ * @author          <a href="www.modtronix.com">Modtronix Engineering</a>
+ * @dependencies    tick.h, mac.h
+ * @compiler        MPLAB C18 v2.10 or higher <br>
+ *                  HITECH PICC-18 V8.35PL3 or higher
+ **********************************************************************
+ * Software License Agreement
+ *
+ * The software supplied herewith is owned by Modtronix Engineering, and is
+ * protected under applicable copyright laws. The software supplied herewith is
+ * intended and supplied to you, the Company customer, for use solely and
+ * exclusively on products manufactured by Modtronix Engineering. The code may
+ * be modified and can be used free of charge for commercial and non commercial
+ * applications. All rights are reserved. Any use in violation of the foregoing
+ * restrictions may subject the user to criminal sanctions under applicable laws,
+ * as well as to civil liability for the breach of the terms and conditions of this license.
+ *
+ * THIS SOFTWARE IS PROVIDED IN AN 'AS IS' CONDITION. NO WARRANTIES, WHETHER EXPRESS,
+ * IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE
+ * COMPANY SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ **********************************************************************
+ * File History
+ *
+ * 2026-10-17:
+ *    - Initial version
+ *********************************************************************/
+
+#include <string.h>
+
+#include "projdefs.h"
+#include "net\checkcfg.h"
+#include "net\tcpwin.h"
+#include "net\mac.h"
+#include "net\tick.h"
+
+#if defined(STACK_USE_TCP)
+
+//Index of the segment following the given one in the ring
+#if ((TCP_WIN_SEGMENTS & (TCP_WIN_SEGMENTS - 1)) == 0)
+    #define TCPWinNext(i) (((i) + 1) & (TCP_WIN_SEGMENTS - 1))
+#else
+    #define TCPWinNext(i) (((i) + 1) >= TCP_WIN_SEGMENTS ? 0 : ((i) + 1))
+#endif
+
+
+/**
+ * Initializes the given window.
+ *
+ * @param pWin  Pointer to window
+ */
+void TCPWinInit(TCP_WIN *pWin)
+{
+    pWin->head      = 0;
+    pWin->count     = 0;
+    pWin->dupAcks   = 0;
+    pWin->bFastRetx = FALSE;
+    pWin->srtt      = 0;
+    pWin->rttvar    = 0;
+    pWin->rto       = TCP_WIN_START_RTO;
+}
+
+
+/**
+ * Releases the TX Buffers of all unacknowledged segments, and empties the window.
+ *
+ * @param pWin  Pointer to window
+ */
+void TCPWinDiscard(TCP_WIN *pWin)
+{
+    while (pWin->count != 0)
+    {
+        MACDiscardTx(pWin->seg[pWin->head].buffer);
+        pWin->head = TCPWinNext(pWin->head);
+        pWin->count--;
+    }
+
+    pWin->head      = 0;
+    pWin->dupAcks   = 0;
+    pWin->bFastRetx = FALSE;
+}
+
+
+/**
+ * Checks if the given window can take a TX Buffer for a new segment.
+ *
+ * @param pWin          Pointer to window
+ * @param heldOthers    Number of TX Buffers held by all other sockets
+ *
+ * @return              TRUE if a new segment can be added to the window
+ */
+BOOL TCPWinCanSend(TCP_WIN *pWin, BYTE heldOthers)
+{
+    BYTE avail;
+
+    if ( TCPWinIsEmpty(pWin) )
+        return TRUE;
+
+    if ( TCPWinIsFull(pWin) )
+        return FALSE;
+
+    //TX Buffer 0 is used for high priority messages
+    if ( (pWin->count + heldOthers) >= (MAC_TX_BUFFER_COUNT - 1) )
+        return FALSE;
+    avail = (MAC_TX_BUFFER_COUNT - 1) - (pWin->count + heldOthers);
+
+    //The last free TX Buffer is only taken if no other socket is using TX Buffers
+    return ( (heldOthers == 0) || (avail >= 2) );
+}
+
+
+/**
+ * Adds a segment that has just been sent to the window.
+ *
+ * @param pWin      Pointer to window
+ * @param buffer    TX Buffer containing the segment
+ * @param seq       SEQ number of first data byte in segment
+ * @param len       Number of TCP Data bytes in segment
+ */
+void TCPWinAdd(TCP_WIN *pWin, BUFFER buffer, DWORD seq, WORD len)
+{
+    BYTE i;
+    TCP_WIN_SEG *p;
+
+    //Get index of first free segment in ring
+    i = pWin->head + pWin->count;
+    if (i >= TCP_WIN_SEGMENTS)
+        i -= TCP_WIN_SEGMENTS;
+
+    p = &pWin->seg[i];
+    p->seq      = (WORD)seq;
+    p->len      = len;
+    p->buffer   = buffer;
+    p->retries  = 0;
+    p->sentTick = TickGet16bit();
+
+    //MACFlush() marks the buffer as free once it is sent. Keep it until the segment is acknowledged.
+    MACReserveTxBuffer(buffer);
+
+    pWin->count++;
+}
+
+
+/**
+ * Updates the round trip time estimate with the given sample, and recalculates the
+ * retransmit timeout. Uses the integer method from RFC 2988: srtt is scaled by 8,
+ * and rttvar by 4.
+ *
+ * @param pWin      Pointer to window
+ * @param rtt       Measured round trip time in ticks
+ */
+static void TCPWinUpdateRTT(TCP_WIN *pWin, TICK16 rtt)
+{
+    short delta;
+    TICK16 rto;
+
+    //Limit sample, so the scaled values below can not overflow
+    if (rtt > TCP_WIN_MAX_RTO)
+        rtt = TCP_WIN_MAX_RTO;
+
+    //First measurement
+    if (pWin->srtt == 0)
+    {
+        pWin->srtt      = (rtt << 3) | 1;   //Ensure srtt is never 0 once measured
+        pWin->rttvar    = rtt << 1;
+    }
+    else
+    {
+        //srtt = 7/8 srtt + 1/8 rtt
+        delta = (short)rtt - (short)(pWin->srtt >> 3);
+        pWin->srtt += delta;
+
+        //rttvar = 3/4 rttvar + 1/4 |delta|
+        if (delta < 0)
+            delta = -delta;
+        delta -= (short)(pWin->rttvar >> 2);
+        pWin->rttvar += delta;
+    }
+
+    //rto = srtt + 4 x rttvar
+    rto = (pWin->srtt >> 3) + pWin->rttvar;
+
+    if (rto < TCP_WIN_MIN_RTO)
+        rto = TCP_WIN_MIN_RTO;
+    else if (rto > TCP_WIN_MAX_RTO)
+        rto = TCP_WIN_MAX_RTO;
+
+    pWin->rto = rto;
+}
+
+
+/**
+ * Processes the ACK number of a received segment.
+ *
+ * @param pWin      Pointer to window
+ * @param ack       ACK number of received segment
+ * @param len       Number of TCP Data bytes in received segment
+ *
+ * @return          TCP_WIN_ACK_NONE, TCP_WIN_ACK_NEW, TCP_WIN_ACK_DUP or TCP_WIN_ACK_FASTRETX
+ */
+BYTE TCPWinAck(TCP_WIN *pWin, DWORD ack, WORD len)
+{
+    TCP_WIN_SEG *p;
+    BYTE ret;
+
+    ret = TCP_WIN_ACK_NONE;
+
+    //Remove all segments that are completely acknowledged, oldest first
+    while (pWin->count != 0)
+    {
+        p = &pWin->seg[pWin->head];
+
+        //Signed difference, so that SEQ number wraparound is handled
+        if ((short)((WORD)ack - (WORD)(p->seq + p->len)) < 0)
+            break;
+
+        //Only take a RTT sample if the segment was sent once, else we don't know which one was ACKed (Karn)
+        if (p->retries == 0)
+            TCPWinUpdateRTT(pWin, TickGet16bit() - p->sentTick);
+
+        MACDiscardTx(p->buffer);
+        pWin->head = TCPWinNext(pWin->head);
+        pWin->count--;
+
+        ret = TCP_WIN_ACK_NEW;
+    }
+
+    if (ret == TCP_WIN_ACK_NEW)
+    {
+        pWin->dupAcks = 0;
+        pWin->bFastRetx = FALSE;
+        return ret;
+    }
+
+    //A duplicate ACK is an ACK without data, for the first byte of the oldest segment. Once the oldest
+    //segment has been fast retransmitted, further duplicate ACKs are for segments sent before that.
+    if ((pWin->count != 0) && (len == 0) && ((WORD)ack == pWin->seg[pWin->head].seq))
+    {
+        if (pWin->dupAcks < TCP_WIN_DUPACK_THRESHOLD)
+        {
+            if (++pWin->dupAcks == TCP_WIN_DUPACK_THRESHOLD)
+            {
+                //Sent from TCPTick() once a TX Buffer is free, see TCPWinGetExpired()
+                pWin->bFastRetx = TRUE;
+                return TCP_WIN_ACK_FASTRETX;
+            }
+        }
+
+        return TCP_WIN_ACK_DUP;
+    }
+
+    return ret;
+}
+
+
+/**
+ * Checks if the retransmit timer of the oldest unacknowledged segment has expired.
+ *
+ * @param pWin      Pointer to window
+ *
+ * @return          Pointer to the oldest segment if it has to be resent, else NULL.
+ */
+TCP_WIN_SEG* TCPWinGetExpired(TCP_WIN *pWin)
+{
+    TCP_WIN_SEG *p;
+
+    if (pWin->count == 0)
+        return NULL;
+
+    p = &pWin->seg[pWin->head];
+
+    if (pWin->bFastRetx)
+        return p;
+
+    if (TickGetDiff16bit(p->sentTick) <= pWin->rto)
+        return NULL;
+
+    return p;
+}
+
+
+/**
+ * Resends the oldest unacknowledged segment.
+ *
+ * @param pWin      Pointer to window
+ * @param bTimeout  TRUE if resent because the retransmit timer expired
+ */
+void TCPWinResend(TCP_WIN *pWin, BOOL bTimeout)
+{
+    TCP_WIN_SEG *p;
+
+    p = &pWin->seg[pWin->head];
+
+    //The TX Buffer still contains the complete frame, including the MAC and IP headers
+    MACSetTxBuffer(p->buffer, 0);
+    MACFlush();
+    MACReserveTxBuffer(p->buffer);
+
+    p->retries++;
+    p->sentTick = TickGet16bit();
+    pWin->bFastRetx = FALSE;
+
+    //Back off the retransmit timer. It is restored when the next RTT sample is taken.
+    if (bTimeout)
+    {
+        if (pWin->rto >= (TCP_WIN_MAX_RTO / 2))
+            pWin->rto = TCP_WIN_MAX_RTO;
+        else
+            pWin->rto <<= 1;
+    }
+}
+
+#endif //#if defined(STACK_USE_TCP)
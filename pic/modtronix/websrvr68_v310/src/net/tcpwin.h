@@ -0,0 +1,277 @@
+/**
+ * @brief           TCP Send Window for Modtronix TCP/IP Stack
+ * @file            tcpwin.h
+ * @author          <a href="www.modtronix.com">Modtronix Engineering</a>
+ * @dependencies    tick.h, mac.h
+ * @compiler        MPLAB C18 v2.10 or higher <br>
+ *                  HITECH PICC-18 V8.35PL3 or higher
+ * @ingroup         mod_tcpip_base_tcp
+ *
+ * @section description Description
+ **********************************
+ * This module keeps track of the TCP segments a socket has sent, but that have not been
+ * acknowledged by the remote host yet. Each segment stays in its MAC TX Buffer until it
+ * is acknowledged, so it can be retransmitted without the application having to write
+ * it again. This allows a socket to have up to TCP_WIN_SEGMENTS segments in flight,
+ * in stead of waiting a full round trip for each segment.
+ *
+ * Lost segments are recovered in two ways:
+ * - Each segment is timestamped when it is sent. When the oldest segment is not acknowledged
+ *   within the retransmit timeout, it is resent and the timeout is doubled.
+ * - When TCP_WIN_DUPACK_THRESHOLD duplicate ACKs are received for the oldest segment, it is
+ *   resent on the next TCPTick() that has a free TX Buffer (fast retransmit), without waiting
+ *   for the retransmit timeout.
+ *
+ * The retransmit timeout is calculated from the measured round trip time (RFC 2988), using
+ * only segments that were not retransmitted (Karn's algorithm).
+ *
+ * @section tcpwin_conf Configuration
+ *****************************************
+ * The following defines are used to configure this module, and should be placed
+ * in the projdefs.h (or similar) file.
+ * For details, see @ref mod_conf_projdefs "Project Configuration".
+ * To configure the module, the required
+ * defines should be uncommended, and the rest commented out.
+ @code
+ //*********************************************************************
+ //---------------------- TCP Window Configuration ---------------------
+ //*********************************************************************
+ //Maximum number of unacknowledged segments per socket. Each one holds a MAC TX Buffer!
+ #define TCP_WIN_SEGMENTS            (2)
+
+ //Number of duplicate ACKs that will cause the oldest segment to be resent
+ #define TCP_WIN_DUPACK_THRESHOLD    (3)
+
+ //Retransmit timeout to use before the round trip time has been measured
+ #define TCP_WIN_START_RTO           ((TICK16)TICKS_PER_SECOND * (TICK16)1)
+ @endcode
+ *********************************************************************/
+
+ /*********************************************************************
+ * Software License Agreement
+ *
+ * The software supplied herewith is owned by Modtronix Engineering, and is
+ * protected under applicable copyright laws. The software supplied herewith is
+ * intended and supplied to you, the Company customer, for use solely and
+ * exclusively on products manufactured by Modtronix Engineering. The code may
+ * be modified and can be used free of charge for commercial and non commercial
+ * applications. All rights are reserved. Any use in violation of the foregoing
+ * restrictions may subject the user to criminal sanctions under applicable laws,
+ * as well as to civil liability for the breach of the terms and conditions of this license.
+ *
+ * THIS SOFTWARE IS PROVIDED IN AN 'AS IS' CONDITION. NO WARRANTIES, WHETHER EXPRESS,
+ * IMPLIED OR STATUTORY, INCLUDING, BUT NOT LIMITED TO, IMPLIED WARRANTIES OF
+ * MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE APPLY TO THIS SOFTWARE. THE
+ * COMPANY SHALL NOT, IN ANY CIRCUMSTANCES, BE LIABLE FOR SPECIAL, INCIDENTAL OR
+ * CONSEQUENTIAL DAMAGES, FOR ANY REASON WHATSOEVER.
+ **********************************************************************
+ * File History
+ *
+ * 2026-10-17:
+ *    - Initial version, replaces TCP_SEND_EACH_SEGMENT_TWICE and TCP_NO_WAIT_FOR_ACK
+ *********************************************************************/
+
+#ifndef TCPWIN_H
+#define TCPWIN_H
+
+#include "net\tick.h"
+
+
+/////////////////////////////////////////////////
+//Defines
+#if !defined(TCP_WIN_SEGMENTS)          //To change this default value, define it in projdefs.h
+#define TCP_WIN_SEGMENTS            (2)
+#endif
+
+#if !defined(TCP_WIN_DUPACK_THRESHOLD)  //To change this default value, define it in projdefs.h
+#define TCP_WIN_DUPACK_THRESHOLD    (3)
+#endif
+
+#if !defined(TCP_WIN_START_RTO)         //To change this default value, define it in projdefs.h
+#define TCP_WIN_START_RTO           ((TICK16)TICKS_PER_SECOND * (TICK16)1)  //Default value of 1 second
+#endif
+
+#if !defined(TCP_WIN_MIN_RTO)           //To change this default value, define it in projdefs.h
+#define TCP_WIN_MIN_RTO             ((TICK16)TICKS_PER_SECOND / (TICK16)5)  //Default value of 200ms
+#endif
+
+#if !defined(TCP_WIN_MAX_RTO)           //To change this default value, define it in projdefs.h
+#define TCP_WIN_MAX_RTO             ((TICK16)TICKS_PER_SECOND * (TICK16)30) //Default value of 30 seconds
+#endif
+
+#if (TCP_WIN_SEGMENTS <= 0 || TCP_WIN_SEGMENTS > 16)
+#error Invalid TCP_WIN_SEGMENTS value specified.
+#endif
+
+/**
+ * Return values of TCPWinAck()
+ */
+#define TCP_WIN_ACK_NONE        (0x00ul)    //ACK did not acknowledge anything new
+#define TCP_WIN_ACK_NEW         (0x01ul)    //ACK acknowledged one or more segments
+#define TCP_WIN_ACK_DUP         (0x02ul)    //Duplicate ACK for the oldest segment
+#define TCP_WIN_ACK_FASTRETX    (0x03ul)    //Duplicate ACK threshold reached, oldest segment has to be resent
+
+
+/**
+ * A TCP segment that has been sent, but not acknowledged yet.
+ * Only the lower 16 bits of the SEQ number are stored to save RAM. This is sufficient because the
+ * bytes in flight are always much less than 32K, so (WORD) differences are unambiguous.
+ */
+typedef struct _TCP_WIN_SEG
+{
+    WORD    seq;            //2 bytes - Lower 16 bits of SEQ number of first data byte in this segment
+    WORD    len;            //2 bytes - Number of TCP Data bytes in this segment
+    BUFFER  buffer;         //1 byte - MAC TX Buffer containing the complete frame
+    BYTE    retries;        //1 byte - Number of times this segment has been resent
+    TICK16  sentTick;       //2 bytes - Tick value when this segment was last sent
+} TCP_WIN_SEG;  //8 bytes
+
+
+/**
+ * The send window of a TCP socket. Segments are kept in a ring, oldest segment first.
+ */
+typedef struct _TCP_WIN
+{
+    TCP_WIN_SEG seg[TCP_WIN_SEGMENTS];
+
+    BYTE    head;           //1 byte - Index of oldest unacknowledged segment
+    BYTE    count;          //1 byte - Number of unacknowledged segments
+    BYTE    dupAcks;        //1 byte - Number of duplicate ACKs received for oldest segment
+    BYTE    bFastRetx;      //1 byte - Oldest segment has to be fast retransmitted, set by TCPWinAck()
+
+    TICK16  srtt;           //2 bytes - Smoothed round trip time, in ticks x 8. 0 if not measured yet
+    TICK16  rttvar;         //2 bytes - Round trip time variation, in ticks x 4
+    TICK16  rto;            //2 bytes - Current retransmit timeout, in ticks
+} TCP_WIN;  //10 bytes + 8 bytes per segment
+
+
+/**
+ * Checks if the given window can take another segment.
+ *
+ * @param pWin  Pointer to window
+ *
+ * @return      TRUE if the window is full, and no more segments can be sent until some are acknowledged.
+ */
+#define TCPWinIsFull(pWin) ((pWin)->count >= TCP_WIN_SEGMENTS)
+
+/**
+ * Checks if the given window has any unacknowledged segments.
+ *
+ * @param pWin  Pointer to window
+ *
+ * @return      TRUE if all sent segments have been acknowledged.
+ */
+#define TCPWinIsEmpty(pWin) ((pWin)->count == 0)
+
+/**
+ * Gets the oldest unacknowledged segment. Only valid if TCPWinIsEmpty() is FALSE.
+ *
+ * @param pWin  Pointer to window
+ *
+ * @return      Pointer to oldest unacknowledged segment
+ */
+#define TCPWinGetOldest(pWin) (&(pWin)->seg[(pWin)->head])
+
+/**
+ * Checks if the oldest segment is waiting to be fast retransmitted.
+ *
+ * @param pWin  Pointer to window
+ *
+ * @return      TRUE if TCPWinGetExpired() returns the oldest segment because of duplicate ACKs,
+ *              in which case it has to be resent with TCPWinResend(pWin, FALSE).
+ */
+#define TCPWinIsFastRetx(pWin) ((pWin)->bFastRetx)
+
+
+/**
+ * Checks if the given window can take a TX Buffer for a new segment. Each unacknowledged segment
+ * holds a TX Buffer until it is acknowledged, and all sockets share the MAC_TX_BUFFER_COUNT - 1
+ * low priority TX Buffers (buffer 0 is kept for high priority messages). A window can always send
+ * its first segment. Further segments have to leave a TX Buffer free for the other sockets, unless
+ * no other socket holds one. In that case the window may also use the last one, and the other
+ * sockets get it back with the next ACK.
+ *
+ * @param pWin          Pointer to window
+ * @param heldOthers    Number of TX Buffers held by all other sockets, by their windows and by
+ *                      segments they are busy writing
+ *
+ * @return              TRUE if a new segment can be added to the window
+ */
+BOOL TCPWinCanSend(TCP_WIN *pWin, BYTE heldOthers);
+
+
+/**
+ * Initializes the given window. No segments are in flight, and the retransmit timeout is
+ * reset to TCP_WIN_START_RTO. Any TX Buffers the window holds are NOT released, use
+ * TCPWinDiscard() for that.
+ *
+ * @param pWin  Pointer to window
+ */
+void TCPWinInit(TCP_WIN *pWin);
+
+
+/**
+ * Releases the TX Buffers of all unacknowledged segments, and empties the window.
+ * The round trip time estimate is kept.
+ *
+ * @param pWin  Pointer to window
+ */
+void TCPWinDiscard(TCP_WIN *pWin);
+
+
+/**
+ * Adds a segment that has just been sent to the window. The given TX Buffer is reserved
+ * until the segment is acknowledged or discarded.
+ *
+ * @preCondition    TCPWinIsFull() == FALSE, and the given buffer has just been transmitted with MACFlush()
+ *
+ * @param pWin      Pointer to window
+ * @param buffer    TX Buffer containing the segment
+ * @param seq       SEQ number of first data byte in segment
+ * @param len       Number of TCP Data bytes in segment
+ */
+void TCPWinAdd(TCP_WIN *pWin, BUFFER buffer, DWORD seq, WORD len);
+
+
+/**
+ * Processes the ACK number of a received segment. All segments that are completely
+ * acknowledged are removed from the window, and their TX Buffers released.
+ *
+ * @param pWin      Pointer to window
+ * @param ack       ACK number of received segment
+ * @param len       Number of TCP Data bytes in received segment. A segment carrying data
+ *                  is never counted as a duplicate ACK.
+ *
+ * @return          TCP_WIN_ACK_NONE, TCP_WIN_ACK_NEW, TCP_WIN_ACK_DUP or TCP_WIN_ACK_FASTRETX.
+ *                  If TCP_WIN_ACK_FASTRETX is returned, the oldest segment is marked for a
+ *                  fast retransmit. It is not sent here, TCPWinGetExpired() returns it until
+ *                  it has been resent or acknowledged.
+ */
+BYTE TCPWinAck(TCP_WIN *pWin, DWORD ack, WORD len);
+
+
+/**
+ * Checks if the retransmit timer of the oldest unacknowledged segment has expired, or if
+ * it is marked for a fast retransmit (see TCPWinIsFastRetx()).
+ *
+ * @param pWin      Pointer to window
+ *
+ * @return          Pointer to the oldest segment if it has to be resent, else NULL.
+ *                  The segment's retries field gives the number of times it has already
+ *                  been resent.
+ */
+TCP_WIN_SEG* TCPWinGetExpired(TCP_WIN *pWin);
+
+
+/**
+ * Resends the oldest unacknowledged segment, exactly as it was sent the first time.
+ *
+ * @preCondition    TCPWinIsEmpty() == FALSE, and IPIsTxReady(TRUE) == TRUE
+ *
+ * @param pWin      Pointer to window
+ * @param bTimeout  TRUE if resent because the retransmit timer expired, in which case
+ *                  the retransmit timeout is doubled. FALSE for a fast retransmit.
+ */
+void TCPWinResend(TCP_WIN *pWin, BOOL bTimeout);
+
+#endif
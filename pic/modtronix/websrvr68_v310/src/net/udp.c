@@ -53,6 +53,8 @@
  * 2005-12-28, David Hosken (DH):
  *    - Fixed problem with UDP lenght of received message
  * 2006-09-08, David Hosken (DH): Implemented changes from Microchip TCP/IP stack 3.75
+ * 2026-10-17:
+ *    - UDPFlush() sets the UDP checksum. The checksum of the UDP Data is calculated by the MAC while it is written.
  *********************************************************************/
  
 #define THIS_IS_UDP_MODULE
@@ -272,6 +274,9 @@ BOOL UDPPut(BYTE v)
         //write pointer to be set to firt byte after the UDP header, which is the UDP data area.
         IPSetTxBuffer(p->TxBuffer, sizeof(UDP_HEADER));
 
+        //The MAC calculates the checksum of the "UDP Data" while it is written, used by UDPFlush()
+        MACClearTxSum();
+
         //p->TxOffset = 0;  /* TxOffset is not required! */
     }
 
@@ -345,6 +350,9 @@ WORD UDPPutArray(BYTE *buffer, WORD count)
         //write pointer to be set to firt byte after the UDP header, which is the UDP data
         //area.
         IPSetTxBuffer(p->TxBuffer, sizeof(UDP_HEADER));
+
+        //The MAC calculates the checksum of the "UDP Data" while it is written, used by UDPFlush()
+        MACClearTxSum();
     }
     
     //This function request more bytes to be written to the TX Buffer then there is space 
@@ -384,6 +392,8 @@ void UDPFlush(void)
 {
     UDP_HEADER      h;
     UDP_SOCKET_INFO *p;
+    PSEUDO_HEADER   pseudoHeader;
+    WORD            checksums[3];
 
     // Wait for TX hardware to become available (finish transmitting 
     // any previous packet)
@@ -391,12 +401,31 @@ void UDPFlush(void)
 
     p = &UDPSocketInfo[activeUDPSocket];
 
+    //Sum of the "UDP Data", calculated by the MAC while it was written to the TX Buffer. Must be
+    //read before the headers are written below.
+    checksums[2] = (p->TxCount == 0) ? 0 : MACGetTxSum();
+
     h.SourcePort.Val        = swaps(p->localPort);
     h.DestinationPort.Val   = swaps(p->remotePort);
     h.Length.Val            = (WORD)((WORD)p->TxCount + (WORD)sizeof(UDP_HEADER));
     // Do not swap h.Length yet.  It is needed in IPPutHeader.
     h.Checksum.Val      = 0x00;
 
+    // Calculate IP pseudoheader checksum.
+    pseudoHeader.SourceAddress.v[0] = MY_IP_BYTE1;
+    pseudoHeader.SourceAddress.v[1] = MY_IP_BYTE2;
+    pseudoHeader.SourceAddress.v[2] = MY_IP_BYTE3;
+    pseudoHeader.SourceAddress.v[3] = MY_IP_BYTE4;
+    pseudoHeader.DestAddress        = p->remoteNode.IPAddr;
+    pseudoHeader.Zero               = 0x0;
+    pseudoHeader.Protocol           = IP_PROT_UDP;
+    pseudoHeader.Length             = h.Length.Val;
+
+    SwapPseudoHeader(pseudoHeader);
+
+    checksums[0] = ~CalcIPChecksum((BYTE*)&pseudoHeader,
+                                    sizeof(pseudoHeader));
+
     //Makes the given TX Buffer active, and set's the pointer to the first byte after the IP
     //header. This is the first byte of the UDP header. The UDP header follows the IP header.
     IPSetTxBuffer(p->TxBuffer, 0);
@@ -410,11 +439,16 @@ void UDPFlush(void)
     //Now swap h.Length.Val
     h.Length.Val        = swaps(h.Length.Val);
 
+    //Add the "UDP Header" and "UDP Data" sums. A calculated checksum of 0 is sent as all ones,
+    //seeing that 0 indicates that the sender did not calculate a checksum.
+    checksums[1] = ~CalcIPChecksum((BYTE*)&h, sizeof(h));
+    h.Checksum.Val = CalcIPChecksum((BYTE*)checksums, sizeof(checksums));
+    if (h.Checksum.Val == 0)
+        h.Checksum.Val = 0xffff;
+
     //Now load UDP header.
     IPPutArray((BYTE*)&h, sizeof(h));
 
-    //Update checksum. !!!!!!!!!!!!!!! TO BE IMPLEMENTED !!!!!!!!!!!!!!!!!!!
-
     //Send data contained in TX Buffer via MAC
     MACFlush();
 
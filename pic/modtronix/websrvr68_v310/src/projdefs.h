@@ -448,14 +448,11 @@ extern void fastUserProcess(void);
 //When defined, the code will be compiled for optimal speed. If not defined, code is defined for smallest size.
 #define TCP_SPEED_OPTIMIZE
 
-//When defined, each TCP segment is sent twice. This might cause the remote node to
-//think that we timed out and retransmitted. It could thus immediately send back an
-//ACK and dramatically improve throuput.
-//#define TCP_SEND_EACH_SEGMENT_TWICE
-
-//Comment following line if StackTsk should wait for acknowledgement from remote host
-//before transmitting another packet. Commenting following line may reduce throughput.
-//#define TCP_NO_WAIT_FOR_ACK
+//Maximum number of unacknowledged segments per socket. Each one holds a MAC TX Buffer until it is
+//acknowledged. Only the first one is always allowed, further ones have to leave a TX Buffer free for the
+//other sockets, unless no other socket holds one. See MAC_TX_BUFFER_COUNT, and tcpwin.h for other send
+//window defines.
+#define TCP_WIN_SEGMENTS    (2)
 /********************************************************/
 /** @addtogroup mod_conf_projdefs
  * - @b TCP: For details on configuring the TCP module @ref udp_conf "click here"
@@ -1036,6 +1033,11 @@ extern WORD AdcValues[ADC_CHANNELS];
     // output buffer that hasn't been acked.  Changing this value
     // is recommended only if the rammifications of doing so are 
     // properly understood.  
+    // A socket only gets a TX Buffer for a second unacknowledged segment
+    // (TCP_WIN_SEGMENTS) if that leaves one free, so the send windows of
+    // busy sockets can not use up the buffers needed by the other sockets.
+    // When no other socket holds a TX Buffer, the last one can be used too,
+    // so with 3 buffers a single busy socket still has 2 segments in flight.
     #if defined(NON_MCHP_MAC)
         #define MAC_TX_BUFFER_SIZE          (1024ul)
         #define MAC_TX_BUFFER_COUNT         (3ul)
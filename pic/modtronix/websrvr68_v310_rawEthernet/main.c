@@ -233,6 +233,9 @@ void main(void)
     //Initialize Stack and application related NV variables.
     appcfgInit();
 
+    //Decision matrix rows are read from EEPROM when the first event arrives
+    vscp_dm2_init( DM_ENTERIES );
+
     //First call appcfgCpuIOValues() and then only appcfgCpuIO()!!! This ensures the value are set, before enabling ports.
     appcfgCpuIOValues();    //Configure the CPU's I/O port pin default values
     appcfgCpuIO();          //Configure the CPU's I/O port pin directions - input or output
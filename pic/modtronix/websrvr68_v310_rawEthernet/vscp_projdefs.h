@@ -83,6 +83,11 @@
 // The define below set the size for the action parameters.
 #define VSCP_ACTION_PARAM_SIZE              18 
 
+// Level II decision matrix (common/vscp_dm2.h). Rows must match DM_ENTERIES.
+// The rows in EEPROM are VSCP_ACTION_PARAM_SIZE parameter bytes wide.
+#define VSCP_DM2_ROWS               16
+#define VSCP_DM2_PARAM_SIZE         VSCP_ACTION_PARAM_SIZE
+
 // Uncoment to send a hearbeat every minute
 #define VSCP_SEND_MINUTE_HEARTBEAT
 
@@ -55,6 +55,7 @@
 #include "xeeprom.h"
 
 #include "vscp_firmware_level2.h"
+#include "vscp_dm2.h"
 #include "vscp_class.h"      
 #include "vscp_type.h"
 
@@ -926,11 +927,13 @@ uint8_t vscp_writeAppReg(uint32_t reg, uint8_t data) {
                 case VSCP_REG_MODULE_ZONE:
                     appcfgPutc( APPCFG_VSCP_EEPROM_REG_MODULE_ZONE, data );
                     rv = appcfgGetc( APPCFG_VSCP_EEPROM_REG_MODULE_ZONE );
+                    vscp_dm2_invalidate();  // Rows are matched against the zone
                     break;
 
                 case VSCP_REG_MODULE_SUBZONE:
                     appcfgPutc( APPCFG_VSCP_EEPROM_REG_MODULE_SUBZONE, ( data & 0xe0 ) );
                     rv = appcfgGetc( APPCFG_VSCP_EEPROM_REG_MODULE_SUBZONE );
+                    vscp_dm2_invalidate();  // Rows are matched against the subzone
                     break;
 
                 case VSCP_REG_MODULE_CONTROL:
@@ -1148,6 +1151,7 @@ uint8_t vscp_writeAppReg(uint32_t reg, uint8_t data) {
             // Write internal EEPROM
             appcfgPutc( VSCP_DM_MATRIX_BASE + reg - 0x100, data );
             rv = appcfgGetc( VSCP_DM_MATRIX_BASE + reg - 0x100 );
+            vscp_dm2_invalidate();  // DM rows may have changed
         } else if ( reg >= 0x10000 ) {
 
             addr = ( reg & 0xffff );
@@ -1211,6 +1215,11 @@ uint8_t vscp_writeAppReg(uint32_t reg, uint8_t data) {
 
     }
 
+    // Registers 0x80 and up of pages 1-4 hold the DM rows
+    if ( ( reg >= 128 ) && ( vscp_page_select >= 1 ) && ( vscp_page_select <= 4 ) ) {
+        vscp_dm2_invalidate();
+    }
+
     return rv;
 }
 
@@ -1230,9 +1239,10 @@ uint8_t vscp_writeUserRegister_Level2(uint32_t reg, uint8_t data) {
 
 
     if (reg < 1024) {
-        // Write internal EEPROM
+        // Write internal EEPROM, DM rows may have changed
         appcfgPutc(VSCP_DM_MATRIX_BASE + reg - 0x100, data);
         rv = appcfgGetc(VSCP_DM_MATRIX_BASE + reg - 0x100);
+        vscp_dm2_invalidate();
     } else if (reg >= 0x10000) {
 
         addr = (reg & 0xffff);
@@ -1264,59 +1274,52 @@ uint8_t vscp_writeUserRegister_Level2(uint32_t reg, uint8_t data) {
 //
 
 void vscp_feedDM(void) {
-    uint8_t i, j;
-    uint8_t *p;
-
-    // Not that we can't use the stucture as the endian may be different
-    uint8_t dm[ 14 + VSCP_ACTION_PARAM_SIZE ]; // Full DM row
-    uint32_t control, mask, filter;
-    uint16_t action;
-
-    // Search the DM enteries for a match
-    for (i = 0; i < DM_ENTERIES; i++) {
-
-        // Read in DM row
-        for (j = 0; j < sizeof (dm); j++) {
-            dm[j] = appcfgGetc(i * (14 + VSCP_ACTION_PARAM_SIZE) + j);
-        }
+    // wrkEvent holds its data in an array (data[]), not through pdata
+    vscp_dm2_feedData( wrkEvent.vscp_class,
+                        wrkEvent.vscp_type,
+                        wrkEvent.GUID,
+                        wrkEvent.data,
+                        wrkEvent.sizeData );
+}
 
-        control = (uint32_t) dm[ VSCP_DM_POS_CONTROL ] << 24 +
-                (uint32_t) dm[ VSCP_DM_POS_CONTROL + 1 ] << 16 +
-                (uint32_t) dm[ VSCP_DM_POS_CONTROL + 2 ] << 8 +
-                (uint32_t) dm[ VSCP_DM_POS_CONTROL + 3 ];
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_loadRow
+//
+// DM rows are VSCP_DM2_ROW_SIZE bytes each from VSCP_DM_MATRIX_BASE.
+//
 
-        // Check if enabled
-        if (!(VSCP_DM_CONTROL_ENABLED & control)) continue;
+void vscp_dm2_loadRow( uint16_t row, uint8_t *pRow ) {
+    uint8_t j;
 
-        // Check if GUID should me matched
-        if ((VSCP_DM_CONTROL_MATCH_GUID & control)) {
-            if (memcmp((void *) wrkEvent.GUID, (void *) (dm + VSCP_DM_POS_PARAM), VSCP_SIZE_GUID)) {
-                continue; // No match
-            }
-        }
+    for (j = 0; j < VSCP_DM2_ROW_SIZE; j++) {
+        pRow[j] = appcfgGetc(VSCP_DM_MATRIX_BASE + row * VSCP_DM2_ROW_SIZE + j);
+    }
+}
 
-        // Check mask/filter
-        if (((filter ^ ((wrkEvent.vscp_class << 16) + wrkEvent.vscp_class)) & mask)) continue;
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_getZone/vscp_dm2_getSubzone
+//
 
-        // Should zone be checked
-        if (VSCP_DM_CONTROL_MATCH_ZONE & control) {
-            if (wrkEvent.vscp_class >= 1024) continue; // not valid for Level II events
-            if (appcfgGetc(APPCFG_VSCP_EEPROM_REG_MODULE_ZONE) != wrkEvent.data[1]) continue;
-        }
+uint8_t vscp_dm2_getZone( void ) {
+    return appcfgGetc(APPCFG_VSCP_EEPROM_REG_MODULE_ZONE);
+}
 
-        // Should subzone be checked
-        if (VSCP_DM_CONTROL_MATCH_SUBZONE & control) {
-            if (wrkEvent.vscp_class >= 1024) continue; // not valid for Level II events
-            if (appcfgGetc(APPCFG_VSCP_EEPROM_REG_MODULE_SUBZONE) != wrkEvent.data[2]) continue;
-        }
+uint8_t vscp_dm2_getSubzone( void ) {
+    return appcfgGetc(APPCFG_VSCP_EEPROM_REG_MODULE_SUBZONE);
+}
 
-        // We have an event that should trigger this row if no extra
-        // conditions are required by the action itself.
-        action = (uint16_t) dm[ VSCP_DM_POS_ACTION ] << 8 +
-                (uint16_t) dm[ VSCP_DM_POS_ACTION ];
+///////////////////////////////////////////////////////////////////////////////
+// vscp_dm2_doAction
+//
 
-        doAction(action);
-    }
+void vscp_dm2_doAction( const vscp_dm2_row_t *pRow,
+                            uint16_t vscp_class,
+                            uint16_t vscp_type,
+                            const uint8_t *pData,
+                            uint16_t sizeData ) {
+    // We have an event that should trigger this row if no extra
+    // conditions are required by the action itself.
+    doAction(pRow->action);
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -38,6 +38,7 @@
 // D:\dev\can\can\src\canal\delivery>cancmd --level=2 --class=0 --type=0x0b --data="0xff,0xff,0xff,0xff,0xff,0xff,0xff,0xfe,0x00,0x00,0x00,0xa3,0x04,0x00,0x90,0x01,0x92,0x12"
 
 #include <crc.h>
+#include <vscp_dm2.h>
 
 // Version
 #define FIRMWARE_MAJOR_VERSION                          0x00